@@ -151,6 +151,10 @@ void JNICCC::setACKInterval(const int& pktINT){
 	CCC::setACKInterval(pktINT);
 }
 
+void JNICCC::setLightACKRange(const int& minPktINT, const int& maxPktINT){
+	CCC::setLightACKRange(minPktINT, maxPktINT);
+}
+
 void JNICCC::setRTO(const int& usRTO){
 	CCC::setRTO(usRTO);
 }
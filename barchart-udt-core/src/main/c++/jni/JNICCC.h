@@ -74,6 +74,8 @@ public:
 
 	void setACKInterval(const int& pktINT);
 
+	void setLightACKRange(const int& minPktINT, const int& maxPktINT);
+
 	void setRTO(const int& usRTO);
 
 	void setPacketSndPeriod(const double sndPeriod);
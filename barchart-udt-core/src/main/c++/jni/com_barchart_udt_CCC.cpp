@@ -108,6 +108,24 @@ JNIEXPORT void JNICALL Java_com_barchart_udt_CCC_setACKInterval
 }
 
 
+/*
+ * Class:     com_barchart_udt_CCC
+ * Method:    setLightACKRange
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL Java_com_barchart_udt_CCC_setLightACKRange
+  (JNIEnv * env, jobject obj, jint minPktINT, jint maxPktINT){
+
+	JNICCC* jniCCC = getNativeJNICCC(env,obj);
+
+	if(jniCCC==NULL)
+		return;
+
+	jniCCC->setLightACKRange(minPktINT, maxPktINT);
+
+}
+
+
 /*
  * Class:     com_barchart_udt_CCC
  * Method:    setRTO
@@ -141,7 +141,15 @@ static jfieldID udt_M_pktSentACKTotal; // total number of sent ACK packets
 static jfieldID udt_M_pktRecvACKTotal; // total number of received ACK packets
 static jfieldID udt_M_pktSentNAKTotal; // total number of sent NAK packets
 static jfieldID udt_M_pktRecvNAKTotal; // total number of received NAK packets
+static jfieldID udt_M_pktRcvSpuriousTotal; // total number of duplicate packets received (spurious retransmissions)
+static jfieldID udt_M_pktSentParityTotal; // total number of sent FEC parity packets
+static jfieldID udt_M_pktRecvParityTotal; // total number of received FEC parity packets
+static jfieldID udt_M_pktRcvRecoveredTotal; // total number of data packets rebuilt from FEC parity
+static jfieldID udt_M_pktSentCtrlTotal; // total number of sent control packets of all types
+static jfieldID udt_M_pktRecvCtrlTotal; // total number of received control packets of all types
 static jfieldID udt_M_usSndDurationTotal; // total time duration when UDT is sending data (idle time exclusive)
+static jfieldID udt_M_msgSentTotal; // total number of messages handed to sendmsg
+static jfieldID udt_M_msgRecvTotal; // total number of messages delivered by recvmsg/recvlend
 //
 // local measurements
 static jfieldID udt_M_pktSent; // number of sent data packets, including retransmissions
@@ -153,8 +161,17 @@ static jfieldID udt_M_pktSentACK; // number of sent ACK packets
 static jfieldID udt_M_pktRecvACK; // number of received ACK packets
 static jfieldID udt_M_pktSentNAK; // number of sent NAK packets
 static jfieldID udt_M_pktRecvNAK; // number of received NAK packets
+static jfieldID udt_M_pktRcvSpurious; // number of duplicate packets received (spurious retransmissions)
+static jfieldID udt_M_pktSentParity; // number of sent FEC parity packets
+static jfieldID udt_M_pktRecvParity; // number of received FEC parity packets
+static jfieldID udt_M_pktRcvRecovered; // number of data packets rebuilt from FEC parity
+static jfieldID udt_M_pktSentCtrl; // number of sent control packets of all types
+static jfieldID udt_M_pktRecvCtrl; // number of received control packets of all types
 static jfieldID udt_M_mbpsSendRate; // sending rate in Mb/s
 static jfieldID udt_M_mbpsRecvRate; // receiving rate in Mb/s
+static jfieldID udt_M_msgpsSendRate; // messages handed to sendmsg per second
+static jfieldID udt_M_msgpsRecvRate; // messages delivered to the application per second
+static jfieldID udt_M_bytePktPayload; // average payload of the sent data packets, in bytes
 static jfieldID udt_M_usSndDuration; // busy sending time (i.e., idle time exclusive)
 //
 // instant measurements
@@ -166,6 +183,15 @@ static jfieldID udt_M_msRTT; // RTT, in milliseconds
 static jfieldID udt_M_mbpsBandwidth; // estimated bandwidth, in Mb/s
 static jfieldID udt_M_byteAvailSndBuf; // available UDT sender buffer size
 static jfieldID udt_M_byteAvailRcvBuf; // available UDT receiver buffer size
+static jfieldID udt_M_pktReorderTolerance; // current reorder window before a gap is reported as loss, in packets
+static jfieldID udt_M_pktLightACKInterval; // current number of data packets between two light ACKs
+static jfieldID udt_M_byteMSS; // current packet size used on the path, including the IP/UDP headers
+static jfieldID udt_M_ccPhase; // phase of the congestion control, algorithm specific, 0 is slow start
+static jfieldID udt_M_pktSlowStartThreshold; // congestion window at which slow start ends, in number of packets
+static jfieldID udt_M_pktMaxWindow; // congestion window before the last reduction, in number of packets
+static jfieldID udt_M_msQueuingDelay; // queuing delay seen by the congestion control, in milliseconds
+static jfieldID udt_M_mbpsModelBandwidth; // bottleneck bandwidth in the congestion control model, in Mb/s
+static jfieldID udt_M_byteMemUsed; // memory held by the buffers, loss lists and ACK history of the connection, in bytes
 
 // ########################################################
 
@@ -286,7 +312,15 @@ void UDT_InitFieldMonitor( //
 	udt_M_pktRecvACKTotal = env->GetFieldID(cls, "pktRecvACKTotal", "I"); // total number of received ACK packets
 	udt_M_pktSentNAKTotal = env->GetFieldID(cls, "pktSentNAKTotal", "I"); // total number of sent NAK packets
 	udt_M_pktRecvNAKTotal = env->GetFieldID(cls, "pktRecvNAKTotal", "I"); // total number of received NAK packets
+	udt_M_pktRcvSpuriousTotal = env->GetFieldID(cls, "pktRcvSpuriousTotal", "I"); // total number of duplicate packets received (spurious retransmissions)
+	udt_M_pktSentParityTotal = env->GetFieldID(cls, "pktSentParityTotal", "I"); // total number of sent FEC parity packets
+	udt_M_pktRecvParityTotal = env->GetFieldID(cls, "pktRecvParityTotal", "I"); // total number of received FEC parity packets
+	udt_M_pktRcvRecoveredTotal = env->GetFieldID(cls, "pktRcvRecoveredTotal", "I"); // total number of data packets rebuilt from FEC parity
+	udt_M_pktSentCtrlTotal = env->GetFieldID(cls, "pktSentCtrlTotal", "J"); // total number of sent control packets of all types
+	udt_M_pktRecvCtrlTotal = env->GetFieldID(cls, "pktRecvCtrlTotal", "J"); // total number of received control packets of all types
 	udt_M_usSndDurationTotal = env->GetFieldID(cls, "usSndDurationTotal", "J"); // total time duration when UDT is sending data (idle time exclusive)
+	udt_M_msgSentTotal = env->GetFieldID(cls, "msgSentTotal", "J"); // total number of messages handed to sendmsg
+	udt_M_msgRecvTotal = env->GetFieldID(cls, "msgRecvTotal", "J"); // total number of messages delivered by recvmsg/recvlend
 
 	// local measurements
 	udt_M_pktSent = env->GetFieldID(cls, "pktSent", "J"); // number of sent data packets, including retransmissions
@@ -298,8 +332,17 @@ void UDT_InitFieldMonitor( //
 	udt_M_pktRecvACK = env->GetFieldID(cls, "pktRecvACK", "I"); // number of received ACK packets
 	udt_M_pktSentNAK = env->GetFieldID(cls, "pktSentNAK", "I"); // number of sent NAK packets
 	udt_M_pktRecvNAK = env->GetFieldID(cls, "pktRecvNAK", "I"); // number of received NAK packets
+	udt_M_pktRcvSpurious = env->GetFieldID(cls, "pktRcvSpurious", "I"); // number of duplicate packets received (spurious retransmissions)
+	udt_M_pktSentParity = env->GetFieldID(cls, "pktSentParity", "I"); // number of sent FEC parity packets
+	udt_M_pktRecvParity = env->GetFieldID(cls, "pktRecvParity", "I"); // number of received FEC parity packets
+	udt_M_pktRcvRecovered = env->GetFieldID(cls, "pktRcvRecovered", "I"); // number of data packets rebuilt from FEC parity
+	udt_M_pktSentCtrl = env->GetFieldID(cls, "pktSentCtrl", "J"); // number of sent control packets of all types
+	udt_M_pktRecvCtrl = env->GetFieldID(cls, "pktRecvCtrl", "J"); // number of received control packets of all types
 	udt_M_mbpsSendRate = env->GetFieldID(cls, "mbpsSendRate", "D"); // sending rate in Mb/s
 	udt_M_mbpsRecvRate = env->GetFieldID(cls, "mbpsRecvRate", "D"); // receiving rate in Mb/s
+	udt_M_msgpsSendRate = env->GetFieldID(cls, "msgpsSendRate", "D"); // messages handed to sendmsg per second
+	udt_M_msgpsRecvRate = env->GetFieldID(cls, "msgpsRecvRate", "D"); // messages delivered to the application per second
+	udt_M_bytePktPayload = env->GetFieldID(cls, "bytePktPayload", "D"); // average payload of the sent data packets, in bytes
 	udt_M_usSndDuration = env->GetFieldID(cls, "usSndDuration", "J"); // busy sending time (i.e., idle time exclusive)
 
 	// instant measurements
@@ -312,6 +355,15 @@ void UDT_InitFieldMonitor( //
 	udt_M_mbpsBandwidth = env->GetFieldID(cls, "mbpsBandwidth", "D"); // estimated bandwidth, in Mb/s
 	udt_M_byteAvailSndBuf = env->GetFieldID(cls, "byteAvailSndBuf", "I"); // available UDT sender buffer size
 	udt_M_byteAvailRcvBuf = env->GetFieldID(cls, "byteAvailRcvBuf", "I"); // available UDT receiver buffer size
+	udt_M_pktReorderTolerance = env->GetFieldID(cls, "pktReorderTolerance", "I"); // current reorder window before a gap is reported as loss, in packets
+	udt_M_pktLightACKInterval = env->GetFieldID(cls, "pktLightACKInterval", "I"); // current number of data packets between two light ACKs
+	udt_M_byteMSS = env->GetFieldID(cls, "byteMSS", "I"); // current packet size used on the path, including the IP/UDP headers
+	udt_M_ccPhase = env->GetFieldID(cls, "ccPhase", "I"); // phase of the congestion control, algorithm specific, 0 is slow start
+	udt_M_pktSlowStartThreshold = env->GetFieldID(cls, "pktSlowStartThreshold", "I"); // congestion window at which slow start ends, in number of packets
+	udt_M_pktMaxWindow = env->GetFieldID(cls, "pktMaxWindow", "I"); // congestion window before the last reduction, in number of packets
+	udt_M_msQueuingDelay = env->GetFieldID(cls, "msQueuingDelay", "D"); // queuing delay seen by the congestion control, in milliseconds
+	udt_M_mbpsModelBandwidth = env->GetFieldID(cls, "mbpsModelBandwidth", "D"); // bottleneck bandwidth in the congestion control model, in Mb/s
+	udt_M_byteMemUsed = env->GetFieldID(cls, "byteMemUsed", "J"); // memory held by the buffers, loss lists and ACK history of the connection, in bytes
 
 }
 
@@ -666,6 +718,136 @@ JNIEXPORT jobject JNICALL Java_com_barchart_udt_SocketUDT_accept0( //
 
 }
 
+// return values, if exception is NOT thrown
+// >0 : number of accepted sockets stored at the start of the array
+// =0 : no connections in the queue (non-blocking only)
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_acceptMany0( //
+		JNIEnv * const env, //
+		const jobject self, //
+		const jobjectArray objSocketArray //
+		) {
+
+	const jint socketID = UDT_GetSocketID(env, self);
+
+	const jsize size = env->GetArrayLength(objSocketArray);
+
+	MALLOC(socketList, UDTSOCKET, size);
+
+	CHK_NUL_RET_ERR(socketList, "socketList");
+
+	const int count = UDT::acceptmany(socketID, socketList, size);
+
+	if (count == UDT::ERROR) {
+
+		FREE(socketList);
+
+		UDT::ERRORINFO errorInfo = UDT::getlasterror();
+
+		const jint errorCode = errorInfo.getErrorCode();
+
+		if (errorCode == UDT::ERRORINFO::EASYNCRCV) {
+			// not a java exception: non-blocking mode return, when not connections in the queue
+			return 0;
+		} else {
+			// really exception
+			UDT_ThrowExceptionUDT_ErrorInfo( //
+					env, socketID, "acceptMany0:acceptmany", &errorInfo);
+			return JNI_ERR;
+		}
+
+	}
+
+	jobject objTypeUDT = env->GetObjectField(self, udt_S_type);
+
+	int index = 0;
+
+	// one java wrapper per accepted socket; sockets left without one are closed
+	for (; objTypeUDT != NULL && index < count; index++) {
+
+		jobject objSocketUDT = env->NewObject(udt_SocketUDT,
+				udt_SocketUDT_init1, objTypeUDT, socketList[index]);
+
+		if (objSocketUDT == NULL) {
+			break;
+		}
+
+		env->SetObjectArrayElement(objSocketArray, index, objSocketUDT);
+
+		env->DeleteLocalRef(objSocketUDT);
+
+	}
+
+	for (int k = index; k < count; k++) {
+		UDT::close(socketList[k]);
+	}
+
+	FREE(socketList);
+
+	CHK_NUL_RET_ERR(objTypeUDT, "objTypeUDT");
+
+	return static_cast<jint>(index);
+
+}
+
+// return values, if exception is NOT thrown
+// -1 : no new streams (non-blocking mode only)
+// >0 : stream id
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_acceptStream0( //
+		JNIEnv * const env, //
+		const jobject self //
+		) {
+
+	const jint socketID = UDT_GetSocketID(env, self);
+
+	const int rv = UDT::acceptstream(socketID);
+
+	if (rv == UDT::ERROR) {
+		UDT::ERRORINFO errorInfo = UDT::getlasterror();
+		UDT_ThrowExceptionUDT_ErrorInfo( //
+				env, socketID, "acceptStream0:acceptstream", &errorInfo);
+		return JNI_ERR;
+	}
+
+	return rv;
+
+}
+
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_openStream0( //
+		JNIEnv * const env, //
+		const jobject self //
+		) {
+
+	const jint socketID = UDT_GetSocketID(env, self);
+
+	const int rv = UDT::openstream(socketID);
+
+	if (rv == UDT::ERROR) {
+		UDT::ERRORINFO errorInfo = UDT::getlasterror();
+		UDT_ThrowExceptionUDT_ErrorInfo( //
+				env, socketID, "openStream0:openstream", &errorInfo);
+		return JNI_ERR;
+	}
+
+	return rv;
+
+}
+
+JNIEXPORT void JNICALL Java_com_barchart_udt_SocketUDT_closeStream0( //
+		JNIEnv * const env, //
+		const jobject self, //
+		const jint streamID //
+		) {
+
+	const jint socketID = UDT_GetSocketID(env, self);
+
+	if (UDT::closestream(socketID, streamID) == UDT::ERROR) {
+		UDT::ERRORINFO errorInfo = UDT::getlasterror();
+		UDT_ThrowExceptionUDT_ErrorInfo( //
+				env, socketID, "closeStream0:closestream", &errorInfo);
+	}
+
+}
+
 JNIEXPORT void JNICALL Java_com_barchart_udt_SocketUDT_bind0( //
 		JNIEnv * const env, //
 		const jobject self, //
@@ -769,6 +951,75 @@ JNIEXPORT void JNICALL Java_com_barchart_udt_SocketUDT_connect0( //
 
 }
 
+// return values, if exception is NOT thrown
+// >0 : number of sockets from the start of the array with a connection request under way
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_connectMany0( //
+		JNIEnv * const env, //
+		const jclass clsSocketUDT, //
+		const jobjectArray objSocketArray, //
+		const jobjectArray objAddressArray //
+		) {
+
+	UNUSED(clsSocketUDT);
+
+	const jsize size = env->GetArrayLength(objSocketArray);
+
+	MALLOC(socketList, UDTSOCKET, size);
+	MALLOC(addressList, sockaddr, size);
+
+	if (socketList == NULL || addressList == NULL) {
+		FREE(socketList);
+		FREE(addressList);
+		CHK_LOG("CHK_NUL_RET_ERR;", "socketList");
+		return JNI_ERR;
+	}
+
+	for (jsize index = 0; index < size; index++) {
+
+		const jobject objSocketUDT = env->GetObjectArrayElement(objSocketArray,
+				index);
+		const jobject objAddress = env->GetObjectArrayElement(objAddressArray,
+				index);
+
+		socketList[index] = UDT_GetSocketID(env, objSocketUDT);
+
+		X_InitSockAddr(&addressList[index]);
+
+		const int rv = X_ConvertInetSocketAddressToSockaddr(env, objAddress,
+				&addressList[index]);
+
+		env->DeleteLocalRef(objSocketUDT);
+		env->DeleteLocalRef(objAddress);
+
+		if (rv == JNI_ERR) {
+			UDT_ThrowExceptionUDT_Message(env, socketList[index],
+					"can not X_ConvertInetSocketAddressToSockaddr");
+			FREE(socketList);
+			FREE(addressList);
+			return JNI_ERR;
+		}
+
+	}
+
+	const int count = UDT::connectmany(socketList, addressList,
+			sizeof(sockaddr), size);
+
+	const UDTSOCKET firstID = socketList[0];
+
+	FREE(socketList);
+	FREE(addressList);
+
+	if (count == UDT::ERROR) {
+		UDT::ERRORINFO errorInfo = UDT::getlasterror();
+		UDT_ThrowExceptionUDT_ErrorInfo( //
+				env, firstID, "connectMany0:connectmany", &errorInfo);
+		return JNI_ERR;
+	}
+
+	return static_cast<jint>(count);
+
+}
+
 JNIEXPORT jboolean JNICALL Java_com_barchart_udt_SocketUDT_hasLoadedRemoteSocketAddress( //
 		JNIEnv * const env, //
 		const jobject self //
@@ -1235,6 +1486,153 @@ JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_receive2( //
 
 }
 
+// #######################################################################
+
+// segments handled without a heap allocation in send3 / receive3
+#define UDT_IOV_STACK 16
+
+// fill "iov" with the regions of direct byte buffers given by "bounds"
+bool X_LoadSegments( //
+		JNIEnv * const env, //
+		const jint socketID, //
+		const jobjectArray buffers, //
+		const jint offset, //
+		const jint length, //
+		const jintArray bounds, //
+		UDT::IOVEC * const iov //
+		) {
+
+	jint * const pairs = env->GetIntArrayElements(bounds, NULL); // note: must release
+
+	bool isValid = true;
+
+	for (jint index = 0; index < length; index++) {
+
+		const jobject bufferObj = //
+				env->GetObjectArrayElement(buffers, offset + index);
+
+		jbyte * const address = //
+				static_cast<jbyte*>(env->GetDirectBufferAddress(bufferObj));
+		const jlong capacity = env->GetDirectBufferCapacity(bufferObj);
+
+		env->DeleteLocalRef(bufferObj);
+
+		const jint position = pairs[2 * index];
+		const jint limit = pairs[2 * index + 1];
+
+		if (address == NULL
+				|| !X_IsValidRange(env, socketID, position, limit, capacity)) {
+			if (address == NULL) {
+				UDT_ThrowExceptionUDT_Message(env, socketID,
+						"segment is not a direct buffer");
+			}
+			isValid = false;
+			break;
+		}
+
+		iov[index].data = (char*) (address + position);
+		iov[index].len = (int) (limit - position);
+
+	}
+
+	env->ReleaseIntArrayElements(bounds, pairs, JNI_ABORT); // do not copy back
+
+	return isValid;
+
+}
+
+// receive into a sequence of direct byte buffers
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_receive3( //
+		JNIEnv * const env, //
+		const jclass clsSocketUDT, //
+		const jint socketID, //
+		const jint socketType, //
+		const jobjectArray buffers, //
+		const jint offset, //
+		const jint length, //
+		const jintArray bounds //
+		) {
+
+	UNUSED(clsSocketUDT);
+
+	if (socketType != SOCK_STREAM && socketType != SOCK_DGRAM) {
+		UDT_ThrowExceptionUDT_Message(env, socketID,
+				"recvv/recvmsgv : unexpected socketType");
+		return JNI_ERR;
+	}
+
+	UDT::IOVEC stack[UDT_IOV_STACK];
+	UDT::IOVEC * const iov = (length <= UDT_IOV_STACK) ? stack : //
+			(UDT::IOVEC *) malloc(sizeof(UDT::IOVEC) * length);
+
+	if (iov == NULL) {
+		UDT_ThrowExceptionUDT_Message(env, socketID,
+				"recvv/recvmsgv : can not allocate segment array");
+		return JNI_ERR;
+	}
+
+	if (!X_LoadSegments(env, socketID, buffers, offset, length, bounds, iov)) {
+		if (iov != stack) {
+			free(iov);
+		}
+		return JNI_ERR;
+	}
+
+	const int rv = (socketType == SOCK_STREAM) ? //
+			UDT::recvv(socketID, iov, (int) length, 0) : //
+			UDT::recvmsgv(socketID, iov, (int) length);
+
+	if (iov != stack) {
+		free(iov);
+	}
+
+	if (rv > 0) { // normal
+		return rv;
+	} else if (rv < 0) { //  UDT::ERROR
+		return UDT_ReturnReceiveError(env, socketID);
+	} else { // ==0; UDT_TIMEOUT
+		return UDT_TIMEOUT;
+	}
+
+}
+
+// receive stream data into direct byte buffer
+// return values, if exception is NOT thrown
+// -1 : nothing received (non-blocking only)
+// =0 : end of stream
+// >0 : normal receive
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_receiveStream0( //
+		JNIEnv * const env, //
+		const jclass clsSocketUDT, //
+		const jint socketID, //
+		const jint streamID, //
+		const jobject bufferObj, //
+		const jint position, //
+		const jint limit //
+		) {
+
+	UNUSED(clsSocketUDT);
+
+	const jlong capacity = env->GetDirectBufferCapacity(bufferObj);
+
+	if (!X_IsValidRange(env, socketID, position, limit, capacity)) {
+		return JNI_ERR;
+	}
+
+	jbyte * const data = //
+			static_cast<jbyte*>(env->GetDirectBufferAddress(bufferObj)) + position;
+
+	const int rv = UDT::recvstream(socketID, streamID, (char*) data,
+			(int) (limit - position));
+
+	if (rv < 0) { // UDT::ERROR
+		return UDT_ReturnReceiveError(env, socketID);
+	}
+
+	return rv;
+
+}
+
 JNIEXPORT jlong JNICALL Java_com_barchart_udt_SocketUDT_receiveFile0(
 		JNIEnv * const env, //
 		const jclass clsSocketUDT, //
@@ -1266,6 +1664,56 @@ JNIEXPORT jlong JNICALL Java_com_barchart_udt_SocketUDT_receiveFile0(
 
 }
 
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_loadCache0( //
+		JNIEnv * const env, //
+		const jclass clsSocketUDT, //
+		const jstring path //
+		) {
+
+	UNUSED(clsSocketUDT);
+
+	const char * filePath = env->GetStringUTFChars(path, NULL);
+
+	const int rv = UDT::loadcache(filePath);
+
+	env->ReleaseStringUTFChars(path, filePath);
+
+	if (rv == UDT::ERROR) {
+		UDT::ERRORINFO errorInfo = UDT::getlasterror();
+		UDT_ThrowExceptionUDT_ErrorInfo( //
+				env, 0, "loadCache0:loadcache", &errorInfo);
+		return JNI_ERR;
+	}
+
+	return static_cast<jint>(rv);
+
+}
+
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_saveCache0( //
+		JNIEnv * const env, //
+		const jclass clsSocketUDT, //
+		const jstring path //
+		) {
+
+	UNUSED(clsSocketUDT);
+
+	const char * filePath = env->GetStringUTFChars(path, NULL);
+
+	const int rv = UDT::savecache(filePath);
+
+	env->ReleaseStringUTFChars(path, filePath);
+
+	if (rv == UDT::ERROR) {
+		UDT::ERRORINFO errorInfo = UDT::getlasterror();
+		UDT_ThrowExceptionUDT_ErrorInfo( //
+				env, 0, "saveCache0:savecache", &errorInfo);
+		return JNI_ERR;
+	}
+
+	return static_cast<jint>(rv);
+
+}
+
 // return values, if exception is NOT thrown
 // -1 : no buffer space (non-blocking only )
 // =0 : timeout expired (blocking only)
@@ -1462,6 +1910,100 @@ JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_send2( //
 
 }
 
+// send from a sequence of direct byte buffers
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_send3( //
+		JNIEnv * const env, //
+		const jclass clsSocketUDT, //
+		const jint socketID, //
+		const jint socketType, //
+		const jint timeToLive, //
+		const jboolean isOrdered, //
+		const jobjectArray buffers, //
+		const jint offset, //
+		const jint length, //
+		const jintArray bounds //
+		) {
+
+	UNUSED(clsSocketUDT);
+
+	if (socketType != SOCK_STREAM && socketType != SOCK_DGRAM) {
+		UDT_ThrowExceptionUDT_Message(env, socketID,
+				"sendv/sendmsgv : unexpected socketType");
+		return JNI_ERR;
+	}
+
+	UDT::IOVEC stack[UDT_IOV_STACK];
+	UDT::IOVEC * const iov = (length <= UDT_IOV_STACK) ? stack : //
+			(UDT::IOVEC *) malloc(sizeof(UDT::IOVEC) * length);
+
+	if (iov == NULL) {
+		UDT_ThrowExceptionUDT_Message(env, socketID,
+				"sendv/sendmsgv : can not allocate segment array");
+		return JNI_ERR;
+	}
+
+	if (!X_LoadSegments(env, socketID, buffers, offset, length, bounds, iov)) {
+		if (iov != stack) {
+			free(iov);
+		}
+		return JNI_ERR;
+	}
+
+	const int rv = (socketType == SOCK_STREAM) ? //
+			UDT::sendv(socketID, iov, (int) length, 0) : //
+			UDT::sendmsgv(socketID, iov, (int) length, (int) timeToLive,
+					BOOL(isOrdered));
+
+	if (iov != stack) {
+		free(iov);
+	}
+
+	if (rv > 0) { // normal
+		return rv;
+	} else if (rv < 0) { // UDT::ERROR
+		return UDT_ReturnSendError(env, socketID);
+	} else { // ==0; UDT_TIMEOUT
+		return UDT_TIMEOUT;
+	}
+
+}
+
+// send stream data from direct byte buffer
+// return values, if exception is NOT thrown
+// -1 : sending queue is full (non-blocking only)
+// >0 : normal send
+JNIEXPORT jint JNICALL Java_com_barchart_udt_SocketUDT_sendStream0( //
+		JNIEnv * const env, //
+		const jclass clsSocketUDT, //
+		const jint socketID, //
+		const jint streamID, //
+		const jobject bufferObj, //
+		const jint position, //
+		const jint limit //
+		) {
+
+	UNUSED(clsSocketUDT);
+
+	const jlong capacity = env->GetDirectBufferCapacity(bufferObj);
+
+	if (!X_IsValidRange(env, socketID, position, limit, capacity)) {
+		return JNI_ERR;
+	}
+
+	const jbyte * const data = //
+			static_cast<jbyte*>(env->GetDirectBufferAddress(bufferObj)) + position;
+
+	const int rv = UDT::sendstream(socketID, streamID, (const char*) data,
+			(int) (limit - position));
+
+	if (rv < 0) { // UDT::ERROR
+		return UDT_ReturnSendError(env, socketID);
+	}
+
+	return rv;
+
+}
+
 JNIEXPORT jlong JNICALL Java_com_barchart_udt_SocketUDT_sendFile0( //
 		JNIEnv * const env, //
 		const jclass clsSocketUDT, //
@@ -1573,8 +2115,24 @@ JNIEXPORT void JNICALL Java_com_barchart_udt_SocketUDT_updateMonitor0( //
 			monitor.pktSentNAKTotal); // total number of sent NAK packets
 	env->SetIntField(objMonitor, udt_M_pktRecvNAKTotal,
 			monitor.pktRecvNAKTotal); // total number of received NAK packets
+	env->SetIntField(objMonitor, udt_M_pktRcvSpuriousTotal,
+			monitor.pktRcvSpuriousTotal); // total number of duplicate packets received (spurious retransmissions)
+	env->SetIntField(objMonitor, udt_M_pktSentParityTotal,
+			monitor.pktSentParityTotal); // total number of sent FEC parity packets
+	env->SetIntField(objMonitor, udt_M_pktRecvParityTotal,
+			monitor.pktRecvParityTotal); // total number of received FEC parity packets
+	env->SetIntField(objMonitor, udt_M_pktRcvRecoveredTotal,
+			monitor.pktRcvRecoveredTotal); // total number of data packets rebuilt from FEC parity
+	env->SetLongField(objMonitor, udt_M_pktSentCtrlTotal,
+			monitor.pktSentCtrlTotal); // total number of sent control packets of all types
+	env->SetLongField(objMonitor, udt_M_pktRecvCtrlTotal,
+			monitor.pktRecvCtrlTotal); // total number of received control packets of all types
 	env->SetLongField(objMonitor, udt_M_usSndDurationTotal,
 			monitor.usSndDurationTotal); // total time duration when UDT is sending data (idle time exclusive)
+	env->SetLongField(objMonitor, udt_M_msgSentTotal,
+			monitor.msgSentTotal); // total number of messages handed to sendmsg
+	env->SetLongField(objMonitor, udt_M_msgRecvTotal,
+			monitor.msgRecvTotal); // total number of messages delivered by recvmsg/recvlend
 
 	// local measurements
 	env->SetLongField(objMonitor, udt_M_pktSent, monitor.pktSent); // number of sent data packets, including retransmissions
@@ -1586,8 +2144,17 @@ JNIEXPORT void JNICALL Java_com_barchart_udt_SocketUDT_updateMonitor0( //
 	env->SetIntField(objMonitor, udt_M_pktRecvACK, monitor.pktRecvACK); // number of received ACK packets
 	env->SetIntField(objMonitor, udt_M_pktSentNAK, monitor.pktSentNAK); // number of sent NAK packets
 	env->SetIntField(objMonitor, udt_M_pktRecvNAK, monitor.pktRecvNAK); // number of received NAK packets
+	env->SetIntField(objMonitor, udt_M_pktRcvSpurious, monitor.pktRcvSpurious); // number of duplicate packets received (spurious retransmissions)
+	env->SetIntField(objMonitor, udt_M_pktSentParity, monitor.pktSentParity); // number of sent FEC parity packets
+	env->SetIntField(objMonitor, udt_M_pktRecvParity, monitor.pktRecvParity); // number of received FEC parity packets
+	env->SetIntField(objMonitor, udt_M_pktRcvRecovered, monitor.pktRcvRecovered); // number of data packets rebuilt from FEC parity
+	env->SetLongField(objMonitor, udt_M_pktSentCtrl, monitor.pktSentCtrl); // number of sent control packets of all types
+	env->SetLongField(objMonitor, udt_M_pktRecvCtrl, monitor.pktRecvCtrl); // number of received control packets of all types
 	env->SetDoubleField(objMonitor, udt_M_mbpsSendRate, monitor.mbpsSendRate); // sending rate in Mb/s
 	env->SetDoubleField(objMonitor, udt_M_mbpsRecvRate, monitor.mbpsRecvRate); // receiving rate in Mb/s
+	env->SetDoubleField(objMonitor, udt_M_msgpsSendRate, monitor.msgpsSendRate); // messages handed to sendmsg per second
+	env->SetDoubleField(objMonitor, udt_M_msgpsRecvRate, monitor.msgpsRecvRate); // messages delivered to the application per second
+	env->SetDoubleField(objMonitor, udt_M_bytePktPayload, monitor.bytePktPayload); // average payload of the sent data packets, in bytes
 	env->SetLongField(objMonitor, udt_M_usSndDuration, monitor.usSndDuration); // busy sending time (i.e., idle time exclusive)
 
 	// instant measurements
@@ -1603,6 +2170,24 @@ JNIEXPORT void JNICALL Java_com_barchart_udt_SocketUDT_updateMonitor0( //
 			monitor.byteAvailSndBuf); // available UDT sender buffer size
 	env->SetIntField(objMonitor, udt_M_byteAvailRcvBuf,
 			monitor.byteAvailRcvBuf); // available UDT receiver buffer size
+	env->SetIntField(objMonitor, udt_M_pktReorderTolerance,
+			monitor.pktReorderTolerance); // current reorder window before a gap is reported as loss, in packets
+	env->SetIntField(objMonitor, udt_M_pktLightACKInterval,
+			monitor.pktLightACKInterval); // current number of data packets between two light ACKs
+	env->SetIntField(objMonitor, udt_M_byteMSS,
+			monitor.byteMSS); // current packet size used on the path, including the IP/UDP headers
+	env->SetIntField(objMonitor, udt_M_ccPhase,
+			monitor.ccPhase); // phase of the congestion control, algorithm specific, 0 is slow start
+	env->SetIntField(objMonitor, udt_M_pktSlowStartThreshold,
+			monitor.pktSlowStartThreshold); // congestion window at which slow start ends, in number of packets
+	env->SetIntField(objMonitor, udt_M_pktMaxWindow,
+			monitor.pktMaxWindow); // congestion window before the last reduction, in number of packets
+	env->SetDoubleField(objMonitor, udt_M_msQueuingDelay,
+			monitor.msQueuingDelay); // queuing delay seen by the congestion control, in milliseconds
+	env->SetDoubleField(objMonitor, udt_M_mbpsModelBandwidth,
+			monitor.mbpsModelBandwidth); // bottleneck bandwidth in the congestion control model, in Mb/s
+	env->SetLongField(objMonitor, udt_M_byteMemUsed,
+			monitor.byteMemUsed); // memory held by the buffers, loss lists and ACK history of the connection, in bytes
 
 }
 
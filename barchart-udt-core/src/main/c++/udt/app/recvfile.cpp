@@ -1,29 +1,24 @@
 #ifndef WIN32
    #include <arpa/inet.h>
    #include <netdb.h>
+   #include <sys/time.h>
 #else
    #include <winsock2.h>
    #include <ws2tcpip.h>
 #endif
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <cstdlib>
 #include <cstring>
 #include <udt.h>
 
 using namespace std;
 
-int main(int argc, char* argv[])
+UDTSOCKET connectto(const char* host, int port)
 {
-   if ((argc != 5) || (0 == atoi(argv[2])))
-   {
-      cout << "usage: recvfile server_ip server_port remote_filename local_filename" << endl;
-      return -1;
-   }
-
-   // use this function to initialize the UDT library
-   UDT::startup();
-
    struct addrinfo hints, *peer;
 
    memset(&hints, 0, sizeof(struct addrinfo));
@@ -31,45 +26,67 @@ int main(int argc, char* argv[])
    hints.ai_family = AF_INET;
    hints.ai_socktype = SOCK_STREAM;
 
-   UDTSOCKET fhandle = UDT::socket(hints.ai_family, hints.ai_socktype, hints.ai_protocol);
+   stringstream service;
+   service << port;
 
-   if (0 != getaddrinfo(argv[1], argv[2], &hints, &peer))
+   if (0 != getaddrinfo(host, service.str().c_str(), &hints, &peer))
    {
-      cout << "incorrect server/peer address. " << argv[1] << ":" << argv[2] << endl;
-      return -1;
+      cout << "incorrect server/peer address. " << host << ":" << port << endl;
+      return UDT::INVALID_SOCK;
    }
 
+   UDTSOCKET fhandle = UDT::socket(peer->ai_family, peer->ai_socktype, peer->ai_protocol);
+
    // connect to the server, implict bind
    if (UDT::ERROR == UDT::connect(fhandle, peer->ai_addr, peer->ai_addrlen))
    {
       cout << "connect: " << UDT::getlasterror().getErrorMessage() << endl;
-      return -1;
+      UDT::close(fhandle);
+      fhandle = UDT::INVALID_SOCK;
    }
 
    freeaddrinfo(peer);
 
+   return fhandle;
+}
 
-   // send name information of the requested file
-   int len = strlen(argv[3]);
-
-   if (UDT::ERROR == UDT::send(fhandle, (char*)&len, sizeof(int), 0))
+int main(int argc, char* argv[])
+{
+   if ((argc < 5) || (argc > 7) || (0 == atoi(argv[2])) || ((argc >= 6) && (0 >= atoi(argv[5]))))
    {
-      cout << "send: " << UDT::getlasterror().getErrorMessage() << endl;
+      cout << "usage: recvfile server_ip server_port remote_filename local_filename [streams] [manifest]" << endl;
+      cout << "       streams: number of connections the file is striped over, 1 by default" << endl;
+      cout << "       manifest: record of received stripes to resume from, local_filename.manifest by default" << endl;
       return -1;
    }
 
-   if (UDT::ERROR == UDT::send(fhandle, argv[3], len, 0))
+   // use this function to initialize the UDT library
+   UDT::startup();
+
+   int port = atoi(argv[2]);
+   int streams = (argc >= 6) ? atoi(argv[5]) : 1;
+   string manifest = (argc >= 7) ? string(argv[6]) : string(argv[4]) + ".manifest";
+
+   UDTSOCKET fhandle = connectto(argv[1], port);
+   if (UDT::INVALID_SOCK == fhandle)
+      return -1;
+
+   // send name information of the requested file, and how many connections will carry it
+   int len = strlen(argv[3]);
+
+   if ((UDT::ERROR == UDT::send(fhandle, (char*)&len, sizeof(int), 0)) || (UDT::ERROR == UDT::send(fhandle, argv[3], len, 0)) || (UDT::ERROR == UDT::send(fhandle, (char*)&streams, sizeof(int), 0)))
    {
       cout << "send: " << UDT::getlasterror().getErrorMessage() << endl;
       return -1;
    }
 
-   // get size information
+   // get size information, the session the other connections join and how many ports the server listens on
    int64_t size;
+   int reply[2];
 
-   if (UDT::ERROR == UDT::recv(fhandle, (char*)&size, sizeof(int64_t), 0))
+   if ((UDT::ERROR == UDT::recv(fhandle, (char*)&size, sizeof(int64_t), 0)) || (UDT::ERROR == UDT::recv(fhandle, (char*)reply, sizeof(reply), 0)))
    {
-      cout << "send: " << UDT::getlasterror().getErrorMessage() << endl;
+      cout << "recv: " << UDT::getlasterror().getErrorMessage() << endl;
       return -1;
    }
 
@@ -79,20 +96,56 @@ int main(int argc, char* argv[])
       return -1;
    }
 
-   // receive the file
-   fstream ofs(argv[4], ios::out | ios::binary | ios::trunc);
-   int64_t recvsize; 
-   int64_t offset = 0;
+   int session = reply[0];
+   int shards = (reply[1] > 0) ? reply[1] : 1;
+
+   // spread the other connections over the server ports
+   vector<UDTSOCKET> socks;
+   socks.push_back(fhandle);
+
+   for (int i = 1; i < streams; ++ i)
+   {
+      UDTSOCKET s = connectto(argv[1], port + i % shards);
+      if (UDT::INVALID_SOCK == s)
+         break;
+
+      int join = -session;
+      if (UDT::ERROR == UDT::send(s, (char*)&join, sizeof(int), 0))
+      {
+         UDT::close(s);
+         break;
+      }
+
+      socks.push_back(s);
+   }
+
+   #ifndef WIN32
+      timeval t1, t2;
+      gettimeofday(&t1, 0);
+   #else
+      DWORD t1 = GetTickCount();
+   #endif
 
-   if (UDT::ERROR == (recvsize = UDT::recvfile(fhandle, ofs, offset, size)))
+   // receive the file; stripes already in the manifest are not asked for again
+   int64_t recvsize;
+
+   if (UDT::ERROR == (recvsize = UDT::recvfilestriped(&socks[0], socks.size(), argv[4], size, manifest.c_str())))
    {
       cout << "recvfile: " << UDT::getlasterror().getErrorMessage() << endl;
       return -1;
    }
 
-   UDT::close(fhandle);
+   #ifndef WIN32
+      gettimeofday(&t2, 0);
+      double ms = (t2.tv_sec - t1.tv_sec) * 1000.0 + (t2.tv_usec - t1.tv_usec) / 1000.0;
+   #else
+      double ms = GetTickCount() - t1;
+   #endif
+
+   cout << "received " << recvsize << " bytes over " << socks.size() << " connections in " << ms << " ms" << endl;
 
-   ofs.close();
+   for (vector<UDTSOCKET>::iterator i = socks.begin(); i != socks.end(); ++ i)
+      UDT::close(*i);
 
    // use this function to release the UDT library
    UDT::cleanup();
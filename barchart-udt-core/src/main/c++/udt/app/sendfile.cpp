@@ -1,73 +1,147 @@
 #ifndef WIN32
    #include <cstdlib>
    #include <netdb.h>
+   #include <unistd.h>
 #else
    #include <winsock2.h>
    #include <ws2tcpip.h>
 #endif
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <cstring>
+#include <map>
+#include <vector>
 #include <udt.h>
 
 using namespace std;
 
 #ifndef WIN32
 void* sendfile(void*);
+void* acceptor(void*);
 #else
 DWORD WINAPI sendfile(LPVOID);
+DWORD WINAPI acceptor(LPVOID);
+#endif
+
+// a transfer over several connections: the first one names the file, the others join it by session number
+struct Session
+{
+   vector<UDTSOCKET> socks;
+   int streams;
+};
+
+map<int, Session*> sessions;
+int lastsession = 0;
+int shards = 1;
+
+#ifndef WIN32
+   pthread_mutex_t sessionlock = PTHREAD_MUTEX_INITIALIZER;
+   #define LOCK_SESSIONS() pthread_mutex_lock(&sessionlock)
+   #define UNLOCK_SESSIONS() pthread_mutex_unlock(&sessionlock)
+   #define SLEEP_MS(ms) usleep((ms) * 1000)
+#else
+   HANDLE sessionlock = CreateMutex(NULL, false, NULL);
+   #define LOCK_SESSIONS() WaitForSingleObject(sessionlock, INFINITE)
+   #define UNLOCK_SESSIONS() ReleaseMutex(sessionlock)
+   #define SLEEP_MS(ms) Sleep(ms)
 #endif
 
 int main(int argc, char* argv[])
 {
-   //usage: sendfile [server_port]
-   if ((2 < argc) || ((2 == argc) && (0 == atoi(argv[1]))))
+   //usage: sendfile [server_port] [shards]
+   if ((3 < argc) || ((2 <= argc) && (0 == atoi(argv[1]))) || ((3 == argc) && (0 >= atoi(argv[2]))))
    {
-      cout << "usage: sendfile [server_port]" << endl;
+      cout << "usage: sendfile [server_port] [shards]" << endl;
+      cout << "       shards: number of ports from server_port up, each served by its own sending and receiving threads" << endl;
       return 0;
    }
 
    // use this function to initialize the UDT library
    UDT::startup();
 
-   addrinfo hints;
-   addrinfo* res;
-
-   memset(&hints, 0, sizeof(struct addrinfo));
-   hints.ai_flags = AI_PASSIVE;
-   hints.ai_family = AF_INET;
-   hints.ai_socktype = SOCK_STREAM;
+   int port = 9000;
+   if (2 <= argc)
+      port = atoi(argv[1]);
+   if (3 == argc)
+      shards = atoi(argv[2]);
 
-   string service("9000");
-   if (2 == argc)
-      service = argv[1];
+   vector<UDTSOCKET> servs;
 
-   if (0 != getaddrinfo(NULL, service.c_str(), &hints, &res))
+   for (int i = 0; i < shards; ++ i)
    {
-      cout << "illegal port number or port is busy.\n" << endl;
-      return 0;
-   }
+      addrinfo hints;
+      addrinfo* res;
 
-   UDTSOCKET serv = UDT::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+      memset(&hints, 0, sizeof(struct addrinfo));
+      hints.ai_flags = AI_PASSIVE;
+      hints.ai_family = AF_INET;
+      hints.ai_socktype = SOCK_STREAM;
 
-   // Windows UDP issue
-   // For better performance, modify HKLM\System\CurrentControlSet\Services\Afd\Parameters\FastSendDatagramThreshold
+      stringstream service;
+      service << port + i;
+
+      if (0 != getaddrinfo(NULL, service.str().c_str(), &hints, &res))
+      {
+         cout << "illegal port number or port is busy.\n" << endl;
+         return 0;
+      }
+
+      UDTSOCKET serv = UDT::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+
+      // Windows UDP issue
+      // For better performance, modify HKLM\System\CurrentControlSet\Services\Afd\Parameters\FastSendDatagramThreshold
 #ifdef WIN32
-   int mss = 1052;
-   UDT::setsockopt(serv, 0, UDT_MSS, &mss, sizeof(int));
+      int mss = 1052;
+      UDT::setsockopt(serv, 0, UDT_MSS, &mss, sizeof(int));
 #endif
 
-   if (UDT::ERROR == UDT::bind(serv, res->ai_addr, res->ai_addrlen))
+      if (UDT::ERROR == UDT::bind(serv, res->ai_addr, res->ai_addrlen))
+      {
+         cout << "bind: " << UDT::getlasterror().getErrorMessage() << endl;
+         return 0;
+      }
+
+      freeaddrinfo(res);
+
+      UDT::listen(serv, 64);
+
+      cout << "server is ready at port: " << service.str() << endl;
+
+      servs.push_back(serv);
+   }
+
+   // every port but the first is served from a thread of its own
+   for (int i = 1; i < shards; ++ i)
    {
-      cout << "bind: " << UDT::getlasterror().getErrorMessage() << endl;
-      return 0;
+      #ifndef WIN32
+         pthread_t acceptthread;
+         pthread_create(&acceptthread, NULL, acceptor, new UDTSOCKET(servs[i]));
+         pthread_detach(acceptthread);
+      #else
+         CreateThread(NULL, 0, acceptor, new UDTSOCKET(servs[i]), 0, NULL);
+      #endif
    }
 
-   freeaddrinfo(res);
+   acceptor(new UDTSOCKET(servs[0]));
 
-   cout << "server is ready at port: " << service << endl;
+   for (int i = 0; i < shards; ++ i)
+      UDT::close(servs[i]);
 
-   UDT::listen(serv, 10);
+   // use this function to release the UDT library
+   UDT::cleanup();
+
+   return 0;
+}
+
+#ifndef WIN32
+void* acceptor(void* usocket)
+#else
+DWORD WINAPI acceptor(LPVOID usocket)
+#endif
+{
+   UDTSOCKET serv = *(UDTSOCKET*)usocket;
+   delete (UDTSOCKET*)usocket;
 
    sockaddr_storage clientaddr;
    int addrlen = sizeof(clientaddr);
@@ -79,7 +153,7 @@ int main(int argc, char* argv[])
       if (UDT::INVALID_SOCK == (fhandle = UDT::accept(serv, (sockaddr*)&clientaddr, &addrlen)))
       {
          cout << "accept: " << UDT::getlasterror().getErrorMessage() << endl;
-         return 0;
+         break;
       }
 
       char clienthost[NI_MAXHOST];
@@ -96,12 +170,11 @@ int main(int argc, char* argv[])
       #endif
    }
 
-   UDT::close(serv);
-
-   // use this function to release the UDT library
-   UDT::cleanup();
-
-   return 0;
+   #ifndef WIN32
+      return NULL;
+   #else
+      return 0;
+   #endif
 }
 
 #ifndef WIN32
@@ -113,7 +186,7 @@ DWORD WINAPI sendfile(LPVOID usocket)
    UDTSOCKET fhandle = *(UDTSOCKET*)usocket;
    delete (UDTSOCKET*)usocket;
 
-   // aquiring file name information from client
+   // aquiring file name information from client, or the session a new connection joins
    char file[1024];
    int len;
 
@@ -123,44 +196,93 @@ DWORD WINAPI sendfile(LPVOID usocket)
       return 0;
    }
 
-   if (UDT::ERROR == UDT::recv(fhandle, file, len, 0))
+   if (len < 0)
+   {
+      LOCK_SESSIONS();
+      map<int, Session*>::iterator i = sessions.find(-len);
+      if (i != sessions.end())
+         i->second->socks.push_back(fhandle);
+      else
+         UDT::close(fhandle);
+      UNLOCK_SESSIONS();
+
+      return 0;
+   }
+
+   if ((len >= (int)sizeof(file)) || (UDT::ERROR == UDT::recv(fhandle, file, len, 0)))
    {
       cout << "recv: " << UDT::getlasterror().getErrorMessage() << endl;
       return 0;
    }
    file[len] = '\0';
 
-   // open the file
-   fstream ifs(file, ios::in | ios::binary);
-
-   ifs.seekg(0, ios::end);
-   int64_t size = ifs.tellg();
-   ifs.seekg(0, ios::beg);
-
-   // send file size information
-   if (UDT::ERROR == UDT::send(fhandle, (char*)&size, sizeof(int64_t), 0))
+   int streams;
+   if (UDT::ERROR == UDT::recv(fhandle, (char*)&streams, sizeof(int), 0))
    {
-      cout << "send: " << UDT::getlasterror().getErrorMessage() << endl;
+      cout << "recv: " << UDT::getlasterror().getErrorMessage() << endl;
       return 0;
    }
+   if (streams < 1)
+      streams = 1;
 
-   UDT::TRACEINFO trace;
-   UDT::perfmon(fhandle, &trace);
+   // get the file size
+   fstream ifs(file, ios::in | ios::binary);
 
-   // send the file
-   int64_t offset = 0;
-   if (UDT::ERROR == UDT::sendfile(fhandle, ifs, offset, size))
+   int64_t size = -1;
+   if (!ifs.fail())
    {
-      cout << "sendfile: " << UDT::getlasterror().getErrorMessage() << endl;
-      return 0;
+      ifs.seekg(0, ios::end);
+      size = ifs.tellg();
    }
+   ifs.close();
 
-   UDT::perfmon(fhandle, &trace);
-   cout << "speed = " << trace.mbpsSendRate << "Mbits/sec" << endl;
+   Session session;
+   session.socks.push_back(fhandle);
+   session.streams = streams;
 
-   UDT::close(fhandle);
+   LOCK_SESSIONS();
+   int id = ++ lastsession;
+   sessions[id] = &session;
+   UNLOCK_SESSIONS();
 
-   ifs.close();
+   // send file size information, and where the other connections go
+   int reply[2] = {id, shards};
+   if ((UDT::ERROR == UDT::send(fhandle, (char*)&size, sizeof(int64_t), 0)) || (UDT::ERROR == UDT::send(fhandle, (char*)reply, sizeof(reply), 0)))
+      cout << "send: " << UDT::getlasterror().getErrorMessage() << endl;
+   else if (size >= 0)
+   {
+      // wait a little for the other connections, then start with those that came
+      for (int t = 0; t < 1000; ++ t)
+      {
+         LOCK_SESSIONS();
+         bool ready = (int)session.socks.size() >= streams;
+         UNLOCK_SESSIONS();
+         if (ready)
+            break;
+         SLEEP_MS(10);
+      }
+
+      LOCK_SESSIONS();
+      vector<UDTSOCKET> socks = session.socks;
+      sessions.erase(id);
+      UNLOCK_SESSIONS();
+
+      UDT::TRACEINFO trace;
+      UDT::perfmon(fhandle, &trace);
+
+      // send the file, each connection takes the ranges the receiver asks it for
+      if (UDT::ERROR == UDT::sendfilestriped(&socks[0], socks.size(), file))
+         cout << "sendfile: " << UDT::getlasterror().getErrorMessage() << endl;
+
+      UDT::perfmon(fhandle, &trace);
+      cout << "speed = " << trace.mbpsSendRate << "Mbits/sec over " << socks.size() << " connections" << endl;
+   }
+
+   LOCK_SESSIONS();
+   sessions.erase(id);
+   for (vector<UDTSOCKET>::iterator i = session.socks.begin(); i != session.socks.end(); ++ i)
+      UDT::close(*i);
+   UNLOCK_SESSIONS();
 
    #ifndef WIN32
       return NULL;
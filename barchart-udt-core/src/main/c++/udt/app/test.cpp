@@ -3,6 +3,7 @@
    #include <cstring>
    #include <netdb.h>
    #include <signal.h>
+   #include <arpa/inet.h>
    #include <unistd.h>
 #else
    #include <winsock2.h>
@@ -10,7 +11,12 @@
    #include <wspiapi.h>
 #endif
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "udt.h"
 
@@ -23,14 +29,14 @@ const char g_Localhost[] = "127.0.0.1";
 const int g_Server_Port = 9000;
 
 
-int createUDTSocket(UDTSOCKET& usock, int port = 0, bool rendezvous = false)
+int createUDTSocket(UDTSOCKET& usock, int port = 0, bool rendezvous = false, int type = g_Socket_Type)
 {
    addrinfo hints;
    addrinfo* res;
    memset(&hints, 0, sizeof(struct addrinfo));
    hints.ai_flags = AI_PASSIVE;
    hints.ai_family = g_IP_Version;
-   hints.ai_socktype = g_Socket_Type;
+   hints.ai_socktype = type;
 
    char service[16];
    sprintf(service, "%d", port);
@@ -690,9 +696,733 @@ DWORD WINAPI Test_4_Cli(LPVOID)
 }
 
 
-int main()
+// Test zero-copy receive: lent units go back to the shared unit queue and carry new data.
+
+const int g_LendMsgNum = 500;
+const int g_LendMsgSize = 3000;
+
+#ifndef WIN32
+void* Test_5_Srv(void* param)
+#else
+DWORD WINAPI Test_5_Srv(LPVOID param)
+#endif
 {
-   const int test_case = 4;
+   cout << "Testing zero-copy receive.\n";
+
+   UDTSOCKET serv;
+   if (createUDTSocket(serv, g_Server_Port, false, SOCK_DGRAM) < 0)
+      return NULL;
+
+   UDT::listen(serv, 1);
+   UDTSOCKET new_sock = UDT::accept(serv, NULL, NULL);
+   UDT::close(serv);
+
+   if (new_sock == UDT::INVALID_SOCK)
+   {
+      cout << "accept: " << UDT::getlasterror().getErrorMessage() << endl;
+      return NULL;
+   }
+
+   int eid = UDT::epoll_create();
+   int events = UDT_EPOLL_IN;
+   UDT::epoll_add_usock(eid, new_sock, &events);
+
+   // the receiver buffer holds 32 packets, so the whole transfer only gets through if released units are used again
+   UDT::RCVSLICE slices[8];
+   set<void*> handles;
+   int reused = 0;
+   int received = 0;
+
+   while (received < g_LendMsgNum)
+   {
+      UDTSOCKET readfds[1];
+      int num = 1;
+      if (UDT::epoll_wait2(eid, readfds, &num, NULL, NULL, 5000) <= 0)
+      {
+         cout << "epoll: " << UDT::getlasterror().getErrorMessage() << endl;
+         break;
+      }
+
+      int n = 0;
+      while ((received < g_LendMsgNum) && ((n = UDT::recvlend(new_sock, slices, 8)) > 0))
+      {
+         int size = 0;
+         for (int i = 0; i < n; ++ i)
+         {
+            for (int j = 0; j < slices[i].len; ++ j)
+            {
+               if (slices[i].data[j] != char(received + size + j))
+               {
+                  cout << "DATA ERROR " << received << " " << size + j << endl;
+                  break;
+               }
+            }
+            size += slices[i].len;
+
+            if (!handles.insert(slices[i].handle).second)
+               ++ reused;
+         }
+
+         if (size != g_LendMsgSize)
+            cout << "SIZE ERROR " << received << " " << size << endl;
+
+         UDT::recvrelease(new_sock, slices, n);
+         ++ received;
+      }
+
+      if ((n < 0) && (UDT::getlasterror().getErrorCode() != UDT::ERRORINFO::EASYNCRCV))
+      {
+         cout << "recvlend: " << UDT::getlasterror().getErrorMessage() << endl;
+         break;
+      }
+   }
+
+   if (received != g_LendMsgNum)
+      cout << "MESSAGE ERROR " << received << " of " << g_LendMsgNum << " received" << endl;
+   else if (0 == reused)
+      cout << "UNIT ERROR released units were not used again" << endl;
+
+   UDT::epoll_release(eid);
+   UDT::close(new_sock);
+
+   return NULL;
+}
+
+#ifndef WIN32
+void* Test_5_Cli(void* param)
+#else
+DWORD WINAPI Test_5_Cli(LPVOID param)
+#endif
+{
+   UDTSOCKET client;
+   if (createUDTSocket(client, 0, false, SOCK_DGRAM) < 0)
+      return NULL;
+
+   connect(client, g_Server_Port);
+
+   char buffer[g_LendMsgSize];
+   for (int i = 0; i < g_LendMsgNum; ++ i)
+   {
+      for (int j = 0; j < g_LendMsgSize; ++ j)
+         buffer[j] = char(i + j);
+
+      if (UDT::sendmsg(client, buffer, g_LendMsgSize, -1, true) < 0)
+      {
+         cout << "sendmsg: " << UDT::getlasterror().getErrorMessage() << endl;
+         break;
+      }
+   }
+
+   UDT::close(client);
+   return NULL;
+}
+
+
+// Test FEC recovery: a relay between the peers drops data packets, the parity rebuilds them.
+
+const int g_FECGroup = 8;
+const int g_FECDropInterval = 13;   // every 13th data packet is lost, at most one per parity group
+const int g_FECDataSize = 2000000;
+const int g_Relay_Port = g_Server_Port + 1;
+volatile bool g_RelayDone = false;
+
+int createFECSocket(UDTSOCKET& usock, int port)
+{
+   usock = UDT::socket(AF_INET, SOCK_STREAM, 0);
+
+   // the buffers of the other tests hold fewer packets than a parity group and its retransmissions need
+   int group = g_FECGroup;
+   int fc = 1024;
+   int buf = 1000000;
+   UDT::setsockopt(usock, 0, UDT_FEC, &group, sizeof(int));
+   UDT::setsockopt(usock, 0, UDT_FC, &fc, sizeof(int));
+   UDT::setsockopt(usock, 0, UDT_SNDBUF, &buf, sizeof(int));
+   UDT::setsockopt(usock, 0, UDT_RCVBUF, &buf, sizeof(int));
+
+   if (0 == port)
+      return 0;
+
+   sockaddr_in addr;
+   memset(&addr, 0, sizeof(sockaddr_in));
+   addr.sin_family = AF_INET;
+   addr.sin_port = htons(port);
+   addr.sin_addr.s_addr = INADDR_ANY;
+
+   if (UDT::ERROR == UDT::bind(usock, (sockaddr*)&addr, sizeof(sockaddr_in)))
+   {
+      cout << "bind: " << UDT::getlasterror().getErrorMessage() << endl;
+      return -1;
+   }
+
+   return 0;
+}
+
+#ifndef WIN32
+void* Test_6_Srv(void* param)
+#else
+DWORD WINAPI Test_6_Srv(LPVOID param)
+#endif
+{
+   cout << "Testing FEC recovery over a lossy link.\n";
+
+   UDTSOCKET serv;
+   if (createFECSocket(serv, g_Server_Port) < 0)
+      return NULL;
+
+   UDT::listen(serv, 1);
+   UDTSOCKET new_sock = UDT::accept(serv, NULL, NULL);
+   UDT::close(serv);
+
+   if (new_sock == UDT::INVALID_SOCK)
+   {
+      cout << "accept: " << UDT::getlasterror().getErrorMessage() << endl;
+      return NULL;
+   }
+
+   // the counters are read as the data comes, the client may close right after the last packet
+   char* buffer = new char[g_FECDataSize];
+   UDT::TRACEINFO perf;
+   memset(&perf, 0, sizeof(perf));
+   int received = 0;
+   while (received < g_FECDataSize)
+   {
+      int rcvd = UDT::recv(new_sock, buffer + received, g_FECDataSize - received, 0);
+      if (UDT::ERROR == rcvd)
+      {
+         cout << "recv: " << UDT::getlasterror().getErrorMessage() << endl;
+         break;
+      }
+      received += rcvd;
+      UDT::perfmon(new_sock, &perf, false);
+   }
+
+   for (int i = 0; i < received; ++ i)
+   {
+      if (buffer[i] != char(i * 7))
+      {
+         cout << "DATA ERROR " << i << endl;
+         break;
+      }
+   }
+
+   if (received != g_FECDataSize)
+      cout << "SIZE ERROR " << received << " of " << g_FECDataSize << " received" << endl;
+   else if (0 == perf.pktRcvRecoveredTotal)
+      cout << "RECOVERY ERROR no packet was rebuilt from parity, " << perf.pktRcvLossTotal << " lost" << endl;
+
+   delete [] buffer;
+   UDT::close(new_sock);
+
+   return NULL;
+}
+
+#ifndef WIN32
+void* Test_6_Relay(void* param)
+#else
+DWORD WINAPI Test_6_Relay(LPVOID param)
+#endif
+{
+   // the client talks to g_Relay_Port, the server sees the relay's other socket as its peer
+   SYSSOCKET cli_side = socket(AF_INET, SOCK_DGRAM, 0);
+   SYSSOCKET srv_side = socket(AF_INET, SOCK_DGRAM, 0);
+
+   sockaddr_in relay_addr, srv_addr, cli_addr;
+   memset(&relay_addr, 0, sizeof(sockaddr_in));
+   relay_addr.sin_family = AF_INET;
+   relay_addr.sin_port = htons(g_Relay_Port);
+   relay_addr.sin_addr.s_addr = inet_addr(g_Localhost);
+   srv_addr = relay_addr;
+   srv_addr.sin_port = htons(g_Server_Port);
+   memset(&cli_addr, 0, sizeof(sockaddr_in));
+
+   if (0 != bind(cli_side, (sockaddr*)&relay_addr, sizeof(sockaddr_in)))
+   {
+      cout << "relay bind failed" << endl;
+      return NULL;
+   }
+
+   char packet[65536];
+   int data = 0;
+
+   while (!g_RelayDone)
+   {
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(cli_side, &fds);
+      FD_SET(srv_side, &fds);
+      timeval tv;
+      tv.tv_sec = 0;
+      tv.tv_usec = 100000;
+      if (select(int(max(cli_side, srv_side)) + 1, &fds, NULL, NULL, &tv) <= 0)
+         continue;
+
+      if (FD_ISSET(cli_side, &fds))
+      {
+         socklen_t len = sizeof(sockaddr_in);
+         int size = recvfrom(cli_side, packet, sizeof(packet), 0, (sockaddr*)&cli_addr, &len);
+
+         // data packets have the first bit clear, control packets all go through
+         if ((size > 0) && ((packet[0] & 0x80) || (0 != ++ data % g_FECDropInterval)))
+            sendto(srv_side, packet, size, 0, (sockaddr*)&srv_addr, sizeof(sockaddr_in));
+      }
+
+      if (FD_ISSET(srv_side, &fds))
+      {
+         int size = recvfrom(srv_side, packet, sizeof(packet), 0, NULL, NULL);
+         if ((size > 0) && (0 != cli_addr.sin_port))
+            sendto(cli_side, packet, size, 0, (sockaddr*)&cli_addr, sizeof(sockaddr_in));
+      }
+   }
+
+#ifndef WIN32
+   close(cli_side);
+   close(srv_side);
+#else
+   closesocket(cli_side);
+   closesocket(srv_side);
+#endif
+
+   return NULL;
+}
+
+#ifndef WIN32
+void* Test_6_Cli(void* param)
+#else
+DWORD WINAPI Test_6_Cli(LPVOID param)
+#endif
+{
+   g_RelayDone = false;
+#ifndef WIN32
+   pthread_t relay;
+   pthread_create(&relay, NULL, Test_6_Relay, NULL);
+#else
+   HANDLE relay = CreateThread(NULL, 0, Test_6_Relay, NULL, 0, NULL);
+#endif
+
+   UDTSOCKET client;
+   if (createFECSocket(client, 0) == 0)
+   {
+      connect(client, g_Relay_Port);
+
+      char* buffer = new char[g_FECDataSize];
+      for (int i = 0; i < g_FECDataSize; ++ i)
+         buffer[i] = char(i * 7);
+
+      int sent = 0;
+      while (sent < g_FECDataSize)
+      {
+         int ss = UDT::send(client, buffer + sent, g_FECDataSize - sent, 0);
+         if (UDT::ERROR == ss)
+         {
+            cout << "send: " << UDT::getlasterror().getErrorMessage() << endl;
+            break;
+         }
+         sent += ss;
+      }
+
+      // closing lingers until the server has everything
+      UDT::close(client);
+      delete [] buffer;
+   }
+
+   g_RelayDone = true;
+#ifndef WIN32
+   pthread_join(relay, NULL);
+#else
+   WaitForSingleObject(relay, INFINITE);
+#endif
+
+   return NULL;
+}
+
+
+// Test resuming a striped file transfer: the first one is cut off, the second only fetches the stripes not in the manifest.
+
+const int g_StripeConns = 2;
+const int64_t g_StripeSize = 1048576;
+const int64_t g_StripeFileSize = 32 * g_StripeSize + 1000;   // the last stripe is not a whole page
+const char g_StripeSrc[] = "test_stripe.src";
+const char g_StripeDst[] = "test_stripe.dst";
+const char g_StripeLog[] = "test_stripe.manifest";
+volatile bool g_StripeDone = false;
+
+int createStripeSocket(UDTSOCKET& usock, int port)
+{
+   usock = UDT::socket(AF_INET, SOCK_STREAM, 0);
+
+   // with the small buffers of the other tests, a stripe takes seconds to go through
+   int fc = 1024;
+   int buf = 1000000;
+   UDT::setsockopt(usock, 0, UDT_FC, &fc, sizeof(int));
+   UDT::setsockopt(usock, 0, UDT_SNDBUF, &buf, sizeof(int));
+   UDT::setsockopt(usock, 0, UDT_RCVBUF, &buf, sizeof(int));
+
+   if (0 == port)
+      return 0;
+
+   sockaddr_in addr;
+   memset(&addr, 0, sizeof(sockaddr_in));
+   addr.sin_family = AF_INET;
+   addr.sin_port = htons(port);
+   addr.sin_addr.s_addr = INADDR_ANY;
+
+   if (UDT::ERROR == UDT::bind(usock, (sockaddr*)&addr, sizeof(sockaddr_in)))
+   {
+      cout << "bind: " << UDT::getlasterror().getErrorMessage() << endl;
+      return -1;
+   }
+
+   return 0;
+}
+
+#ifndef WIN32
+void* Test_7_Interrupt(void* param)
+#else
+DWORD WINAPI Test_7_Interrupt(LPVOID param)
+#endif
+{
+   UDTSOCKET* socks = (UDTSOCKET*)param;
+
+   // the manifest has a header line, then one line per stripe on the disk
+   while (!g_StripeDone)
+   {
+      ifstream log(g_StripeLog);
+      string line;
+      int lines = 0;
+      while (getline(log, line))
+         ++ lines;
+
+      if (lines > 2)
+      {
+         for (int i = 0; i < g_StripeConns; ++ i)
+            UDT::close(socks[i]);
+         break;
+      }
+
+#ifndef WIN32
+      usleep(1000);
+#else
+      Sleep(1);
+#endif
+   }
+
+   return NULL;
+}
+
+#ifndef WIN32
+void* Test_7_Srv(void* param)
+#else
+DWORD WINAPI Test_7_Srv(LPVOID param)
+#endif
+{
+   cout << "Testing an interrupted striped file transfer.\n";
+
+   remove(g_StripeDst);
+   remove(g_StripeLog);
+
+   UDTSOCKET serv;
+   if (createStripeSocket(serv, g_Server_Port) < 0)
+      return NULL;
+
+   UDT::listen(serv, g_StripeConns);
+
+   int64_t received[2] = {UDT::ERROR, UDT::ERROR};
+   for (int round = 0; round < 2; ++ round)
+   {
+      UDTSOCKET socks[g_StripeConns];
+      for (int i = 0; i < g_StripeConns; ++ i)
+      {
+         socks[i] = UDT::accept(serv, NULL, NULL);
+         if (socks[i] == UDT::INVALID_SOCK)
+         {
+            cout << "accept: " << UDT::getlasterror().getErrorMessage() << endl;
+            UDT::close(serv);
+            return NULL;
+         }
+      }
+
+      g_StripeDone = false;
+#ifndef WIN32
+      pthread_t interrupt;
+      if (0 == round)
+         pthread_create(&interrupt, NULL, Test_7_Interrupt, socks);
+#else
+      HANDLE interrupt = NULL;
+      if (0 == round)
+         interrupt = CreateThread(NULL, 0, Test_7_Interrupt, socks, 0, NULL);
+#endif
+
+      received[round] = UDT::recvfilestriped(socks, g_StripeConns, g_StripeDst, g_StripeFileSize, g_StripeLog, g_StripeSize);
+
+      g_StripeDone = true;
+      if (0 == round)
+      {
+#ifndef WIN32
+         pthread_join(interrupt, NULL);
+#else
+         WaitForSingleObject(interrupt, INFINITE);
+#endif
+      }
+
+      for (int i = 0; i < g_StripeConns; ++ i)
+         UDT::close(socks[i]);
+   }
+
+   UDT::close(serv);
+
+   if (UDT::ERROR != received[0])
+      cout << "INTERRUPT ERROR the first transfer was not cut off" << endl;
+   else if ((received[1] <= 0) || (received[1] >= g_StripeFileSize))
+      cout << "RESUME ERROR " << received[1] << " of " << g_StripeFileSize << " received by the second transfer" << endl;
+   else if (ifstream(g_StripeLog).good())
+      cout << "MANIFEST ERROR the manifest is left after a complete transfer" << endl;
+   else
+   {
+      ifstream src(g_StripeSrc, ios::in | ios::binary);
+      ifstream dst(g_StripeDst, ios::in | ios::binary);
+      int64_t i = 0;
+      char a, b;
+      while (src.get(a))
+      {
+         if (!dst.get(b) || (a != b))
+         {
+            cout << "DATA ERROR " << i << endl;
+            break;
+         }
+         ++ i;
+      }
+      if ((i == g_StripeFileSize) && dst.get(b))
+         cout << "SIZE ERROR the received file is longer" << endl;
+   }
+
+   remove(g_StripeSrc);
+   remove(g_StripeDst);
+   remove(g_StripeLog);
+
+   return NULL;
+}
+
+#ifndef WIN32
+void* Test_7_Cli(void* param)
+#else
+DWORD WINAPI Test_7_Cli(LPVOID param)
+#endif
+{
+   ofstream ofs(g_StripeSrc, ios::out | ios::binary | ios::trunc);
+   for (int64_t i = 0; i < g_StripeFileSize; ++ i)
+      ofs.put(char(i * 7 + (i >> 12)));
+   ofs.close();
+
+   for (int round = 0; round < 2; ++ round)
+   {
+      UDTSOCKET socks[g_StripeConns];
+      for (int i = 0; i < g_StripeConns; ++ i)
+      {
+         createStripeSocket(socks[i], 0);
+         connect(socks[i], g_Server_Port);
+      }
+
+      // the first round fails when the server cuts it off
+      UDT::sendfilestriped(socks, g_StripeConns, g_StripeSrc);
+
+      for (int i = 0; i < g_StripeConns; ++ i)
+         UDT::close(socks[i]);
+   }
+
+   return NULL;
+}
+
+
+// Test lending from packed packets: messages read by copy between lent ones must not give back a unit still lent,
+// and a slice released a second time must not take back a later loan of its unit.
+
+const int g_CoalMsgNum = 3000;
+const int g_CoalMsgSize = 400;
+const int g_CoalHeld = 32;          // lent messages kept by the reader while more data arrives
+
+#ifndef WIN32
+void* Test_8_Srv(void* param)
+#else
+DWORD WINAPI Test_8_Srv(LPVOID param)
+#endif
+{
+   cout << "Testing lent messages of packed packets.\n";
+
+   UDTSOCKET serv;
+   if (createUDTSocket(serv, g_Server_Port, false, SOCK_DGRAM) < 0)
+      return NULL;
+
+   int delay = 1000;
+   UDT::setsockopt(serv, 0, UDT_COALESCE, &delay, sizeof(int));
+
+   UDT::listen(serv, 1);
+   UDTSOCKET new_sock = UDT::accept(serv, NULL, NULL);
+   UDT::close(serv);
+
+   if (new_sock == UDT::INVALID_SOCK)
+   {
+      cout << "accept: " << UDT::getlasterror().getErrorMessage() << endl;
+      return NULL;
+   }
+
+   bool block = false;
+   UDT::setsockopt(new_sock, 0, UDT_RCVSYN, &block, sizeof(bool));
+
+   int eid = UDT::epoll_create();
+   int events = UDT_EPOLL_IN;
+   UDT::epoll_add_usock(eid, new_sock, &events);
+
+   // every other message is lent and held for a while, the ones between are copied out
+   UDT::RCVSLICE held[g_CoalHeld];
+   int heldno[g_CoalHeld];
+   int nheld = 0;
+   UDT::RCVSLICE stale;
+   bool hasstale = false;
+   char buffer[g_CoalMsgSize * 2];
+   int received = 0;
+   bool intact = true;
+
+   while (intact && (received < g_CoalMsgNum))
+   {
+      UDTSOCKET readfds[1];
+      int num = 1;
+      if (UDT::epoll_wait2(eid, readfds, &num, NULL, NULL, 5000) <= 0)
+      {
+         cout << "epoll: " << UDT::getlasterror().getErrorMessage() << endl;
+         break;
+      }
+
+      while (intact && (received < g_CoalMsgNum))
+      {
+         int size;
+         if (0 == received % 2)
+         {
+            // the oldest loan goes back once the reader holds enough of them
+            if (g_CoalHeld == nheld)
+            {
+               UDT::recvrelease(new_sock, held, 1);
+
+               // keep the first slice whose unit has no other message held for releasing it again
+               bool last = !hasstale;
+               for (int i = 1; i < nheld; ++ i)
+               {
+                  if (held[i].handle == held[0].handle)
+                     last = false;
+               }
+               if (last)
+               {
+                  stale = held[0];
+                  hasstale = true;
+               }
+
+               for (int i = 1; i < nheld; ++ i)
+               {
+                  held[i - 1] = held[i];
+                  heldno[i - 1] = heldno[i];
+               }
+               -- nheld;
+            }
+
+            if (UDT::recvlend(new_sock, held + nheld, 1) <= 0)
+               break;
+            size = held[nheld].len;
+            memcpy(buffer, held[nheld].data, min(size, int(sizeof(buffer))));
+            heldno[nheld ++] = received;
+         }
+         else if ((size = UDT::recvmsg(new_sock, buffer, sizeof(buffer))) <= 0)
+            break;
+
+         if (size != g_CoalMsgSize)
+         {
+            cout << "SIZE ERROR " << received << " " << size << endl;
+            intact = false;
+         }
+         for (int j = 0; intact && (j < g_CoalMsgSize); ++ j)
+         {
+            if (buffer[j] != char(received * 7 + j))
+            {
+               cout << "DATA ERROR " << received << " " << j << endl;
+               intact = false;
+            }
+         }
+         ++ received;
+
+         // what is still lent must not have been overwritten by the packets that came since
+         for (int i = 0; intact && (i < nheld); ++ i)
+         {
+            for (int j = 0; j < g_CoalMsgSize; ++ j)
+            {
+               if (held[i].data[j] != char(heldno[i] * 7 + j))
+               {
+                  cout << "LEND ERROR message " << heldno[i] << " changed while lent, " << received << " received" << endl;
+                  intact = false;
+                  break;
+               }
+            }
+         }
+
+         // a slice already given back may name a unit lent again since, releasing it twice must change nothing
+         if (intact && hasstale && (UDT::recvrelease(new_sock, &stale, 1) != 0))
+         {
+            cout << "STALE ERROR second release freed a unit, " << received << " received" << endl;
+            intact = false;
+         }
+      }
+
+      if (UDT::getlasterror().getErrorCode() != UDT::ERRORINFO::EASYNCRCV)
+      {
+         cout << "recv: " << UDT::getlasterror().getErrorMessage() << endl;
+         break;
+      }
+   }
+
+   if (intact && (received != g_CoalMsgNum))
+      cout << "MESSAGE ERROR " << received << " of " << g_CoalMsgNum << " received" << endl;
+
+   UDT::recvrelease(new_sock, held, nheld);
+   UDT::epoll_release(eid);
+   UDT::close(new_sock);
+
+   return NULL;
+}
+
+#ifndef WIN32
+void* Test_8_Cli(void* param)
+#else
+DWORD WINAPI Test_8_Cli(LPVOID param)
+#endif
+{
+   UDTSOCKET client;
+   if (createUDTSocket(client, 0, false, SOCK_DGRAM) < 0)
+      return NULL;
+
+   int delay = 1000;
+   UDT::setsockopt(client, 0, UDT_COALESCE, &delay, sizeof(int));
+
+   connect(client, g_Server_Port);
+
+   char buffer[g_CoalMsgSize];
+   for (int i = 0; i < g_CoalMsgNum; ++ i)
+   {
+      for (int j = 0; j < g_CoalMsgSize; ++ j)
+         buffer[j] = char(i * 7 + j);
+
+      if (UDT::sendmsg(client, buffer, g_CoalMsgSize, -1, true) < 0)
+      {
+         cout << "sendmsg: " << UDT::getlasterror().getErrorMessage() << endl;
+         break;
+      }
+   }
+
+   UDT::close(client);
+   return NULL;
+}
+
+
+int main(int argc, char* argv[])
+{
+   // usage: test [case ...], all cases by default
+   const int test_case = 8;
 
 #ifndef WIN32
    void* (*Test_Srv[test_case])(void*);
@@ -710,9 +1440,30 @@ int main()
    Test_Cli[2] = Test_3_Cli;
    Test_Srv[3] = Test_4_Srv;
    Test_Cli[3] = Test_4_Cli;
+   Test_Srv[4] = Test_5_Srv;
+   Test_Cli[4] = Test_5_Cli;
+   Test_Srv[5] = Test_6_Srv;
+   Test_Cli[5] = Test_6_Cli;
+   Test_Srv[6] = Test_7_Srv;
+   Test_Cli[6] = Test_7_Cli;
+   Test_Srv[7] = Test_8_Srv;
+   Test_Cli[7] = Test_8_Cli;
+
+   vector<int> cases;
+   for (int i = 1; i < argc; ++ i)
+   {
+      if ((atoi(argv[i]) >= 1) && (atoi(argv[i]) <= test_case))
+         cases.push_back(atoi(argv[i]) - 1);
+   }
+   if (cases.empty())
+   {
+      for (int i = 0; i < test_case; ++ i)
+         cases.push_back(i);
+   }
 
-   for (int i = 0; i < test_case; ++ i)
+   for (vector<int>::iterator c = cases.begin(); c != cases.end(); ++ c)
    {
+      int i = *c;
       cout << "Start Test # " << i + 1 << endl;
       UDT::startup();
 
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Compares the built-in congestion control algorithms over an emulated bottleneck:
+# 10 ms one way and 4000 packets per second behind a drop-tail queue.
+#
+# usage: ./cc.sh [port] [seconds]
+#
+# Algorithms (UDT_CCALGO): 0 native DAIMD, 1 BBR-style, 2 CUBIC, 3 LEDBAT. ALGOS lists the ones
+# to run alone, PAIRS the "first,second" ones to share the link, the second joining after 3 s.
+
+PORT=${1:-9200}
+SECS=${2:-8}
+ALGOS=${ALGOS:-"0 1 2 3"}
+PAIRS=${PAIRS:-"2,2 0,2 2,0 2,3 3,3"}
+
+export DELAY_US=${DELAY_US:-10000}
+export RATE_PPS=${RATE_PPS:-4000}
+
+LD_PRELOAD=./impair.so ./ccflows server $PORT &
+SERVER=$!
+sleep 1
+
+for QLEN in 100 20
+do
+   for LOSS in 0 0.01
+   do
+      echo "queue $QLEN, loss $LOSS"
+      for ALGO in $ALGOS
+      do
+         QLEN=$QLEN LOSS=$LOSS LD_PRELOAD=./impair.so ./ccflows client $PORT $SECS $ALGO
+      done
+   done
+done
+
+# a queue of 100 ms, a delay based algorithm should keep it short
+echo "queue 400"
+for ALGO in $ALGOS
+do
+   QLEN=400 LD_PRELOAD=./impair.so ./ccflows client $PORT $SECS $ALGO
+done
+
+for PAIR in $PAIRS
+do
+   echo "queue 400, algorithms $PAIR"
+   QLEN=400 LD_PRELOAD=./impair.so ./ccflows client $PORT 20 ${PAIR%,*} ${PAIR#*,} 3
+done
+
+kill $SERVER
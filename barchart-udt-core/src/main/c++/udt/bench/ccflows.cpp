@@ -0,0 +1,201 @@
+// Congestion control benchmark: one flow, or two flows of different algorithms sharing a link.
+//
+// usage: ccflows server port
+//        ccflows client port seconds algo [algo start]
+//
+// The client sends for the given number of seconds with the first UDT_CCALGO; with a second
+// one, another flow joins after start seconds. Both flows leave from the same process, so under
+// impair.so they queue behind the same bottleneck, see cc.sh.
+//
+// A single flow reports its throughput from the first send until the server acknowledged
+// everything. Two flows report the throughput of each while both were running, leaving out the
+// two seconds after the second one joined, their shares and Jain's fairness index.
+
+#ifndef WIN32
+   #include <unistd.h>
+   #include <sys/time.h>
+   #include <arpa/inet.h>
+   #include <pthread.h>
+#else
+   #include <winsock2.h>
+   #include <ws2tcpip.h>
+#endif
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <udt.h>
+
+using namespace std;
+
+struct Flow
+{
+   int m_iAlgo;                 // UDT_CCALGO of the flow
+   double m_dStart;             // when the flow starts, in seconds after the client did
+   double m_dMeasure;           // when its bytes start to count
+   double m_dElapsed;           // time from the first send until the peer acknowledged everything
+   int64_t m_llBytes;           // bytes sent in the measured period
+   UDT::TRACEINFO m_Perf;       // counters when the flow ended
+   bool m_bOK;
+};
+
+sockaddr_in g_Addr;
+double g_dStartTime;
+double g_dSeconds;
+
+double now()
+{
+   timeval t;
+   gettimeofday(&t, 0);
+   return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+void* sendFlow(void* param)
+{
+   Flow* f = (Flow*)param;
+
+   while (now() - g_dStartTime < f->m_dStart)
+      usleep(1000);
+
+   UDTSOCKET u = UDT::socket(AF_INET, SOCK_STREAM, 0);
+   if ((UDT::ERROR == UDT::setsockopt(u, 0, UDT_CCALGO, &f->m_iAlgo, sizeof(int))) ||
+       (UDT::ERROR == UDT::connect(u, (sockaddr*)&g_Addr, sizeof(g_Addr))))
+   {
+      cout << "algo " << f->m_iAlgo << ": " << UDT::getlasterror().getErrorMessage() << endl;
+      UDT::close(u);
+      return NULL;
+   }
+
+   const int size = 100000;
+   char* data = new char[size];
+   memset(data, 0, size);
+
+   double start = now();
+   while (now() - g_dStartTime < g_dSeconds)
+   {
+      int ss = UDT::send(u, data, size, 0);
+      if (UDT::ERROR == ss)
+         break;
+      if (now() - g_dStartTime >= f->m_dMeasure)
+         f->m_llBytes += ss;
+   }
+
+   int pending = 1;
+   int len = sizeof(int);
+   while ((UDT::ERROR != UDT::getsockopt(u, 0, UDT_SNDDATA, &pending, &len)) && (pending > 0) && (now() - g_dStartTime < g_dSeconds + 10))
+      usleep(1000);
+   f->m_dElapsed = now() - start;
+
+   f->m_bOK = (UDT::ERROR != UDT::perfmon(u, &f->m_Perf, false));
+
+   delete [] data;
+   UDT::close(u);
+
+   return NULL;
+}
+
+void* recvFlow(void* param)
+{
+   UDTSOCKET u = *(UDTSOCKET*)param;
+   delete (UDTSOCKET*)param;
+
+   const int size = 1000000;
+   char* data = new char[size];
+   while (UDT::ERROR != UDT::recv(u, data, size, 0)) {}
+
+   delete [] data;
+   UDT::close(u);
+
+   return NULL;
+}
+
+void report(const Flow& f, double mbps)
+{
+   printf("algo %d: %.1f Mb/s, retransmitted %.1f%%, RTT %.1f ms, queuing delay %.1f ms\n", f.m_iAlgo, mbps,
+          (f.m_Perf.pktSentTotal > 0) ? 100.0 * f.m_Perf.pktRetransTotal / f.m_Perf.pktSentTotal : 0.0,
+          f.m_Perf.msRTT, f.m_Perf.msQueuingDelay);
+}
+
+int main(int argc, char* argv[])
+{
+   bool server = (argc >= 3) && (0 == strcmp(argv[1], "server"));
+   bool client = (argc >= 5) && (0 == strcmp(argv[1], "client"));
+   if ((!server && !client) || (client && (6 == argc)) || (argc > 7) || (0 == atoi(argv[2])))
+   {
+      cout << "usage: ccflows server port" << endl;
+      cout << "       ccflows client port seconds algo [algo start]" << endl;
+      return 0;
+   }
+
+   UDT::startup();
+
+   memset(&g_Addr, 0, sizeof(g_Addr));
+   g_Addr.sin_family = AF_INET;
+   g_Addr.sin_port = htons(atoi(argv[2]));
+   g_Addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+   if (server)
+   {
+      UDTSOCKET serv = UDT::socket(AF_INET, SOCK_STREAM, 0);
+      if ((UDT::ERROR == UDT::bind(serv, (sockaddr*)&g_Addr, sizeof(g_Addr))) || (UDT::ERROR == UDT::listen(serv, 2)))
+      {
+         cout << "listen: " << UDT::getlasterror().getErrorMessage() << endl;
+         return 1;
+      }
+
+      // serve until killed, each flow in its own thread
+      while (true)
+      {
+         UDTSOCKET u = UDT::accept(serv, NULL, NULL);
+         if (UDT::INVALID_SOCK == u)
+            break;
+
+         pthread_t t;
+         pthread_create(&t, NULL, recvFlow, new UDTSOCKET(u));
+         pthread_detach(t);
+      }
+
+      UDT::close(serv);
+   }
+   else
+   {
+      g_dSeconds = atof(argv[3]);
+      int num = (7 == argc) ? 2 : 1;
+
+      Flow flows[2];
+      memset(flows, 0, sizeof(flows));
+      flows[0].m_iAlgo = atoi(argv[4]);
+      if (2 == num)
+      {
+         flows[1].m_iAlgo = atoi(argv[5]);
+         flows[1].m_dStart = atof(argv[6]);
+         flows[0].m_dMeasure = flows[1].m_dMeasure = flows[1].m_dStart + 2;
+      }
+
+      g_dStartTime = now();
+      pthread_t t[2];
+      for (int i = 0; i < num; ++ i)
+         pthread_create(&t[i], NULL, sendFlow, &flows[i]);
+      for (int i = 0; i < num; ++ i)
+         pthread_join(t[i], NULL);
+
+      if (1 == num)
+      {
+         if (flows[0].m_bOK)
+            report(flows[0], flows[0].m_llBytes * 8 / flows[0].m_dElapsed / 1000000);
+      }
+      else if (flows[0].m_bOK && flows[1].m_bOK)
+      {
+         double x = flows[0].m_llBytes * 8 / (g_dSeconds - flows[0].m_dMeasure) / 1000000;
+         double y = flows[1].m_llBytes * 8 / (g_dSeconds - flows[1].m_dMeasure) / 1000000;
+         report(flows[0], x);
+         report(flows[1], y);
+         if (x + y > 0)
+            printf("share %.0f/%.0f%%, Jain index %.3f\n", 100 * x / (x + y), 100 * y / (x + y), (x + y) * (x + y) / (2 * (x * x + y * y)));
+      }
+   }
+
+   UDT::cleanup();
+
+   return 0;
+}
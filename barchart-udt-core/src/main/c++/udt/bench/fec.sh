@@ -0,0 +1,24 @@
+#!/bin/sh
+# Transfers over a lossy loopback link with and without parity packets.
+#
+# usage: ./fec.sh [port] [loss ...]
+#
+# FECGROUPS lists the parity group sizes to compare, 0 turns FEC off; any impair.so
+# setting can be given in the environment as well, e.g. DELAY_US=20000 ./fec.sh
+
+PORT=${1:-9100}
+[ $# -gt 0 ] && shift
+LOSSES=${*:-"0.01 0.03"}
+FECGROUPS=${FECGROUPS:-"0 8 16"}
+
+for LOSS in $LOSSES
+do
+   for FEC in $FECGROUPS
+   do
+      echo "loss $LOSS, fec $FEC"
+      LOSS=$LOSS LD_PRELOAD=./impair.so ./transfer server $PORT fec=$FEC &
+      sleep 1
+      LOSS=$LOSS LD_PRELOAD=./impair.so ./transfer client $PORT fec=$FEC
+      wait
+   done
+done
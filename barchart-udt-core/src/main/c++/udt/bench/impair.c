@@ -0,0 +1,290 @@
+/*
+   Impaired link for the transfer benchmarks: an LD_PRELOAD shim over sendmsg(),
+   which is what UDT sends every packet with on Linux.
+
+   usage: LD_PRELOAD=./impair.so [settings] program ...
+
+   The settings are read from the environment, all of them are off by default:
+      LOSS=p         drop each packet with probability p
+      DELAY_US=n     one-way delay added to every packet, in microseconds
+      RATE_PPS=n     bottleneck rate in packets per second, packets queue behind it
+      QLEN=n         bottleneck queue length in packets, the tail is dropped (default 100)
+      MTU=n          drop packets whose IP datagram would exceed n bytes, unless the sender
+                     cleared DF (IP_PMTUDISC_DONT), then the routers would fragment them
+      MTU2=n         path MTU after MTU2_MS milliseconds, to watch a route change
+      MTU2_MS=n
+      REORDER=p      hold a data packet with probability p ...
+      DEPTH=n        ... until n more packets have been sent (default 8)
+      SHIMSTATS=1    print the packet counts of the process when it exits
+
+   Both ends of a loopback transfer load the shim, so each direction is impaired
+   independently.
+*/
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct Packet
+{
+   struct Packet* next;
+   long long due;                      /* time to send it, in microseconds */
+   int fd;
+   struct sockaddr_storage to;
+   socklen_t tolen;
+   size_t len;
+   char data[1];
+} Packet;
+
+static ssize_t (*real_sendmsg)(int, const struct msghdr*, int);
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static double loss;
+static long long delay;
+static double rate;
+static long qlen;
+static long mtu;
+static long mtu2;
+static long long mtu2_time;
+static double reorder;
+static int depth;
+
+/* the delay line: packets leave in order of arrival once they are due */
+static Packet* head;
+static Packet* tail;
+static long long last_departure;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+/* the packet held back for reordering */
+static Packet* held;
+static int held_countdown;
+
+static unsigned seed = 12345;
+static long long data_pkts, ctrl_pkts, loss_drops, mtu_drops, fragmented, queue_drops, reordered;
+
+static long long now()
+{
+   struct timespec t;
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return t.tv_sec * 1000000LL + t.tv_nsec / 1000;
+}
+
+static double env_double(const char* name, double def)
+{
+   const char* v = getenv(name);
+   return (NULL != v) ? atof(v) : def;
+}
+
+static void send_packet(Packet* p)
+{
+   struct iovec v;
+   struct msghdr m;
+
+   v.iov_base = p->data;
+   v.iov_len = p->len;
+   memset(&m, 0, sizeof(m));
+   m.msg_name = &p->to;
+   m.msg_namelen = p->tolen;
+   m.msg_iov = &v;
+   m.msg_iovlen = 1;
+   real_sendmsg(p->fd, &m, 0);
+
+   free(p);
+}
+
+static void* worker(void* arg)
+{
+   (void)arg;
+
+   for (;;)
+   {
+      Packet* p;
+      long long wait;
+
+      pthread_mutex_lock(&lock);
+      while (NULL == head)
+         pthread_cond_wait(&cond, &lock);
+      p = head;
+      wait = p->due - now();
+      if (wait > 0)
+      {
+         struct timespec ts;
+         pthread_mutex_unlock(&lock);
+         ts.tv_sec = wait / 1000000;
+         ts.tv_nsec = (wait % 1000000) * 1000;
+         nanosleep(&ts, NULL);
+         continue;
+      }
+      head = p->next;
+      if (NULL == head)
+         tail = NULL;
+      pthread_mutex_unlock(&lock);
+
+      send_packet(p);
+   }
+
+   return NULL;
+}
+
+static void init()
+{
+   pthread_t t;
+
+   real_sendmsg = (ssize_t (*)(int, const struct msghdr*, int))dlsym(RTLD_NEXT, "sendmsg");
+
+   loss = env_double("LOSS", 0);
+   delay = (long long)env_double("DELAY_US", 0);
+   rate = env_double("RATE_PPS", 0);
+   qlen = (long)env_double("QLEN", 100);
+   mtu = (long)env_double("MTU", 0);
+   mtu2 = (long)env_double("MTU2", 0);
+   mtu2_time = now() + (long long)env_double("MTU2_MS", 0) * 1000;
+   reorder = env_double("REORDER", 0);
+   depth = (int)env_double("DEPTH", 8);
+
+   if ((delay > 0) || (rate > 0))
+   {
+      pthread_create(&t, NULL, worker, NULL);
+      pthread_detach(t);
+   }
+}
+
+__attribute__((destructor)) static void fini()
+{
+   char buf[256];
+   int len;
+
+   if (NULL == getenv("SHIMSTATS"))
+      return;
+
+   len = snprintf(buf, sizeof(buf), "[impair %d] data=%lld ctrl=%lld loss=%lld mtu=%lld fragmented=%lld queue=%lld reordered=%lld\n",
+                  (int)getpid(), data_pkts, ctrl_pkts, loss_drops, mtu_drops, fragmented, queue_drops, reordered);
+   if (write(2, buf, len) < 0)
+      return;
+}
+
+/* queues a copy of the packet on the delay line, or sends it at once; called with the lock held */
+static void forward(Packet* p)
+{
+   if ((delay <= 0) && (rate <= 0))
+   {
+      send_packet(p);
+      return;
+   }
+
+   p->due = now();
+   if (rate > 0)
+   {
+      long long gap = (long long)(1000000.0 / rate);
+      long long departure = (last_departure > p->due) ? last_departure + gap : p->due + gap;
+      if ((departure - p->due) / gap > qlen)
+      {
+         ++ queue_drops;
+         free(p);
+         return;
+      }
+      last_departure = departure;
+      p->due = departure;
+   }
+   p->due += delay;
+
+   p->next = NULL;
+   if (NULL != tail)
+      tail->next = p;
+   else
+      head = p;
+   tail = p;
+   pthread_cond_signal(&cond);
+}
+
+ssize_t sendmsg(int fd, const struct msghdr* m, int flags)
+{
+   size_t len = 0;
+   size_t i;
+   int data;
+   long path_mtu;
+   Packet* p;
+
+   pthread_once(&once, init);
+
+   for (i = 0; i < m->msg_iovlen; ++ i)
+      len += m->msg_iov[i].iov_len;
+
+   /* UDT control packets have the top bit of the header set */
+   data = (m->msg_iovlen > 0) && (m->msg_iov[0].iov_len > 0) && !(((unsigned char*)m->msg_iov[0].iov_base)[0] & 0x80);
+
+   pthread_mutex_lock(&lock);
+
+   if (data)
+      ++ data_pkts;
+   else
+      ++ ctrl_pkts;
+
+   path_mtu = ((mtu2 > 0) && (now() > mtu2_time)) ? mtu2 : mtu;
+   if ((path_mtu > 0) && ((long)len + 28 > path_mtu))
+   {
+      int pmtudisc = IP_PMTUDISC_WANT;
+      socklen_t optlen = sizeof(int);
+      getsockopt(fd, IPPROTO_IP, IP_MTU_DISCOVER, &pmtudisc, &optlen);
+      if (IP_PMTUDISC_DONT != pmtudisc)
+      {
+         ++ mtu_drops;
+         pthread_mutex_unlock(&lock);
+         return len;
+      }
+      ++ fragmented;
+   }
+
+   if ((loss > 0) && ((double)rand_r(&seed) / RAND_MAX < loss))
+   {
+      ++ loss_drops;
+      pthread_mutex_unlock(&lock);
+      return len;
+   }
+
+   if ((NULL == m->msg_name) || ((delay <= 0) && (rate <= 0) && (reorder <= 0)))
+   {
+      pthread_mutex_unlock(&lock);
+      return real_sendmsg(fd, m, flags);
+   }
+
+   p = (Packet*)malloc(sizeof(Packet) + len);
+   p->fd = fd;
+   memcpy(&p->to, m->msg_name, m->msg_namelen);
+   p->tolen = m->msg_namelen;
+   p->len = len;
+   len = 0;
+   for (i = 0; i < m->msg_iovlen; ++ i)
+   {
+      memcpy(p->data + len, m->msg_iov[i].iov_base, m->msg_iov[i].iov_len);
+      len += m->msg_iov[i].iov_len;
+   }
+
+   if (data && (NULL == held) && (reorder > 0) && ((double)rand_r(&seed) / RAND_MAX < reorder))
+   {
+      held = p;
+      held_countdown = depth;
+      ++ reordered;
+   }
+   else
+   {
+      forward(p);
+      if ((NULL != held) && (-- held_countdown <= 0))
+      {
+         forward(held);
+         held = NULL;
+      }
+   }
+
+   pthread_mutex_unlock(&lock);
+
+   return len;
+}
@@ -0,0 +1,206 @@
+// Loss list check: random operations on the receiver and sender loss lists, compared with a
+// plain set of lost sequence numbers after every step. A third of the rounds start just below
+// the largest sequence number, so the lists wrap around.
+//
+// usage: losscheck [rounds] [seed]
+
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "common.h"
+#include "list.h"
+
+using namespace std;
+
+int32_t seqof(int32_t base, int64_t off)
+{
+   return CSeqNo::incseq(base, int32_t(off));
+}
+
+// expand an encoded NAK array into sequence offsets
+void decode(const int32_t* array, int len, int32_t base, vector<int64_t>& offs)
+{
+   for (int i = 0; i < len; ++ i)
+   {
+      int32_t s1 = array[i] & 0x7FFFFFFF;
+      int32_t s2 = (array[i] & 0x80000000) ? array[++ i] : s1;
+      for (int64_t off = CSeqNo::seqoff(base, s1); off <= CSeqNo::seqoff(base, s2); ++ off)
+         offs.push_back(off);
+   }
+}
+
+bool checkRcv(int32_t base, int size, long& ops)
+{
+   CRcvLossList list(size);
+   set<int64_t> model;
+   int64_t cur = 0;
+
+   for (int k = 0; k < 300; ++ k, ++ ops)
+   {
+      int op = rand() % 6;
+
+      if (op < 2)
+      {
+         // a new gap after the largest sequence number seen
+         int64_t s1 = cur + 1 + rand() % 3;
+         int64_t s2 = s1 + rand() % 20;
+         int64_t head = model.empty() ? s1 : *model.begin();
+         if (s2 - head + 1 >= size)
+            continue;
+
+         list.insert(seqof(base, s1), seqof(base, s2));
+         for (int64_t i = s1; i <= s2; ++ i)
+            model.insert(i);
+         cur = s2;
+      }
+      else if (op == 2)
+      {
+         int64_t off = rand() % (cur + 1);
+         if (list.remove(seqof(base, off)) != (model.erase(off) > 0))
+         {
+            cout << "receiver remove mismatch at " << off << endl;
+            return false;
+         }
+      }
+      else if (op == 3)
+      {
+         int64_t a = rand() % (cur + 1);
+         int64_t b = a + rand() % 10;
+         bool found = (model.lower_bound(a) != model.end()) && (*model.lower_bound(a) <= b);
+         if (list.find(seqof(base, a), seqof(base, b)) != found)
+         {
+            cout << "receiver find mismatch at " << a << "-" << b << endl;
+            return false;
+         }
+
+         if (0 == rand() % 4)
+         {
+            list.remove(seqof(base, a), seqof(base, b));
+            model.erase(model.lower_bound(a), model.upper_bound(b));
+         }
+      }
+      else
+      {
+         int32_t array[4096];
+         int len;
+         int limit = (op == 4) ? 2 + rand() % 50 : 4096;
+         list.getLossArray(array, len, limit);
+
+         vector<int64_t> offs;
+         decode(array, len, base, offs);
+
+         // a short array reports the first losses, a long one all of them
+         vector<int64_t> expect(model.begin(), model.end());
+         if ((offs.size() > expect.size()) || ((op == 5) && (offs.size() != expect.size())) || !equal(offs.begin(), offs.end(), expect.begin()))
+         {
+            cout << "receiver loss array mismatch" << endl;
+            return false;
+         }
+      }
+
+      if ((list.getLossLength() != int(model.size())) ||
+         (list.getFirstLostSeq() != (model.empty() ? -1 : seqof(base, *model.begin()))))
+      {
+         cout << "receiver length or head mismatch" << endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool checkSnd(int32_t base, int size, long& ops)
+{
+   CSndLossList list(size);
+   set<int64_t> model;
+   int64_t ack = 0;
+
+   for (int k = 0; k < 300; ++ k, ++ ops)
+   {
+      int op = rand() % 5;
+
+      if (op < 2)
+      {
+         // a NAK range anywhere in the half window after the ACK
+         int64_t s1 = ack + rand() % (size / 2);
+         int64_t s2 = s1 + rand() % 20;
+         if (s2 - ack + 1 >= size)
+            continue;
+
+         int fresh = 0;
+         for (int64_t i = s1; i <= s2; ++ i)
+            fresh += model.insert(i).second ? 1 : 0;
+         if (list.insert(seqof(base, s1), seqof(base, s2)) != fresh)
+         {
+            cout << "sender insert mismatch at " << s1 << "-" << s2 << endl;
+            return false;
+         }
+      }
+      else if (op == 2)
+      {
+         // an ACK removes everything below it
+         ack += rand() % 50;
+         list.remove(seqof(base, ack - 1));
+         model.erase(model.begin(), model.lower_bound(ack));
+      }
+      else if (op == 3)
+      {
+         int64_t a = ack + rand() % (size / 2);
+         int64_t b = a + rand() % 30;
+         int removed = 0;
+         for (int64_t i = a; i <= b; ++ i)
+            removed += int(model.erase(i));
+         if (list.remove(seqof(base, a), seqof(base, b)) != removed)
+         {
+            cout << "sender range remove mismatch at " << a << "-" << b << endl;
+            return false;
+         }
+      }
+      else
+      {
+         int32_t seq = list.getLostSeq();
+         int32_t expect = model.empty() ? -1 : seqof(base, *model.begin());
+         if (seq != expect)
+         {
+            cout << "sender head mismatch" << endl;
+            return false;
+         }
+         if (!model.empty())
+            model.erase(model.begin());
+      }
+
+      if (list.getLossLength() != int(model.size()))
+      {
+         cout << "sender length mismatch" << endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int main(int argc, char* argv[])
+{
+   int rounds = (argc > 1) ? atoi(argv[1]) : 2000;
+   srand((argc > 2) ? atoi(argv[2]) : 7);
+
+   long ops = 0;
+
+   for (int r = 0; r < rounds; ++ r)
+   {
+      int size = 64 + rand() % 3000;
+      int32_t base = (r % 3 == 0) ? CSeqNo::m_iMaxSeqNo - rand() % 5000 : rand() % CSeqNo::m_iMaxSeqNo;
+
+      if (!checkRcv(base, size, ops) || !checkSnd(base, size, ops))
+      {
+         cout << "round " << r << " failed, base " << base << " size " << size << endl;
+         return 1;
+      }
+   }
+
+   cout << ops << " operations checked" << endl;
+
+   return 0;
+}
@@ -0,0 +1,137 @@
+// Loss list benchmark: the receiver and sender loss lists under three loss patterns.
+//
+// One round over a window of packets:
+//    the receiver inserts the losses as it detects them, in order;
+//    20 NAK reports are built from the receiver list and inserted into the sender list;
+//    the retransmissions arrive in scattered order and are removed from the receiver list,
+//    with a find over the window every 64 packets;
+//    the sender list is drained.
+//
+// usage: losslist [window] [rounds]
+//
+// Build it against another source tree to compare implementations:
+//    make losslist SRC=/path/to/udt/src
+
+#ifndef WIN32
+   #include <sys/time.h>
+#else
+   #include <windows.h>
+#endif
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "common.h"
+#include "list.h"
+
+using namespace std;
+
+double now()
+{
+#ifndef WIN32
+   timeval t;
+   gettimeofday(&t, 0);
+   return t.tv_sec + t.tv_usec / 1000000.0;
+#else
+   return GetTickCount() / 1000.0;
+#endif
+}
+
+// offsets of the lost packets in a window
+vector<int> pattern(int kind, int window)
+{
+   vector<int> lost;
+   srand(1);
+
+   for (int i = 0; i < window; ++ i)
+   {
+      if (((0 == kind) && (rand() % 100 < 5)) ||       // random, 5%
+         ((1 == kind) && (i % 1000 < 50)) ||           // bursts of 50 in every 1000
+         ((2 == kind) && (i >= window - window / 20))) // the last 5%
+         lost.push_back(i);
+   }
+
+   return lost;
+}
+
+// milliseconds per round
+double run(int kind, int window, int rounds)
+{
+   vector<int> lost = pattern(kind, window);
+   int32_t nak[400];
+   int len;
+   long sink = 0;
+
+   double start = now();
+
+   for (int r = 0; r < rounds; ++ r)
+   {
+      CRcvLossList rcvlist(window);
+      CSndLossList sndlist(window * 2);
+      int32_t base = 1000;
+
+      for (size_t i = 0; i < lost.size();)
+      {
+         size_t j = i;
+         while ((j + 1 < lost.size()) && (lost[j + 1] == lost[j] + 1))
+            ++ j;
+         rcvlist.insert(base + lost[i], base + lost[j]);
+         i = j + 1;
+      }
+
+      for (int n = 0; n < 20; ++ n)
+      {
+         rcvlist.getLossArray(nak, len, 360);
+         for (int i = 0; i < len; ++ i)
+         {
+            if (nak[i] & 0x80000000)
+            {
+               sndlist.insert(nak[i] & 0x7FFFFFFF, nak[i + 1]);
+               ++ i;
+            }
+            else
+               sndlist.insert(nak[i], nak[i]);
+         }
+         sink += len;
+      }
+
+      for (size_t i = 0; i < lost.size(); ++ i)
+      {
+         size_t k = (i * 7919) % lost.size();
+         rcvlist.remove(base + lost[k]);
+         if (0 == (i & 63))
+            sink += rcvlist.find(base, base + window - 1);
+         sink += rcvlist.getFirstLostSeq();
+      }
+
+      while (sndlist.getLostSeq() >= 0)
+         ++ sink;
+   }
+
+   double ms = (now() - start) * 1000 / rounds;
+
+   // keep the work from being optimized away
+   if (42 == sink)
+      cout << " ";
+
+   return ms;
+}
+
+int main(int argc, char* argv[])
+{
+   int window = (argc > 1) ? atoi(argv[1]) : 100000;
+   int rounds = (argc > 2) ? atoi(argv[2]) : 20;
+
+   if ((window <= 1000) || (rounds <= 0))
+   {
+      cout << "usage: losslist [window > 1000] [rounds]" << endl;
+      return 0;
+   }
+
+   const char* names[] = {"random 5%", "bursty 50/1000", "tail 5%"};
+
+   for (int k = 0; k < 3; ++ k)
+      cout << names[k] << ": " << run(k, window, rounds) << " ms per round" << endl;
+
+   return 0;
+}
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Transfers over an impaired loopback link with and without selective acknowledgement.
+#
+# usage: ./sack.sh [port] [loss ...]
+#
+# Any impair.so setting can be given in the environment as well, e.g. DELAY_US=20000 ./sack.sh
+
+PORT=${1:-9100}
+[ $# -gt 0 ] && shift
+LOSSES=${*:-"0.01 0.03"}
+
+for LOSS in $LOSSES
+do
+   for SACK in 0 1
+   do
+      echo "loss $LOSS, sack $SACK"
+      LOSS=$LOSS LD_PRELOAD=./impair.so ./transfer server $PORT sack=$SACK &
+      sleep 1
+      LOSS=$LOSS LD_PRELOAD=./impair.so ./transfer client $PORT sack=$SACK
+      wait
+   done
+done
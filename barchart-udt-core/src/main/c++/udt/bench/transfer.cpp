@@ -0,0 +1,193 @@
+// Bulk transfer benchmark: the client sends a byte pattern, the server checks it.
+//
+// usage: transfer server port [option=value ...]
+//        transfer client port [option=value ...]
+//
+// Both sides take the same options, each applies them to its own socket:
+//    size=MB        data to send, in megabytes (default 20)
+//    mss=bytes      UDT_MSS
+//    sack=0|1       UDT_SACK
+//    reorder=pkts   UDT_REORDER
+//    fec=group      UDT_FEC
+//    pmtud=0|1      UDT_PMTUD
+//    ccalgo=n       UDT_CCALGO, see UDTCCAlgo
+//
+// The client prints the time until the server has acknowledged everything and its counters,
+// the server prints what it received. Run it over loopback under impair.so to measure a
+// lossy, slow or reordering link, see sack.sh.
+
+#ifndef WIN32
+   #include <unistd.h>
+   #include <sys/time.h>
+   #include <arpa/inet.h>
+#else
+   #include <winsock2.h>
+   #include <ws2tcpip.h>
+#endif
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <udt.h>
+
+using namespace std;
+
+int setOption(UDTSOCKET u, const char* option)
+{
+   const char* eq = strchr(option, '=');
+   if (NULL == eq)
+      return -1;
+
+   string name(option, eq - option);
+   int value = atoi(eq + 1);
+   bool flag = (0 != value);
+
+   if ("mss" == name)
+      return UDT::setsockopt(u, 0, UDT_MSS, &value, sizeof(int));
+   if ("sack" == name)
+      return UDT::setsockopt(u, 0, UDT_SACK, &flag, sizeof(bool));
+   if ("reorder" == name)
+      return UDT::setsockopt(u, 0, UDT_REORDER, &value, sizeof(int));
+   if ("fec" == name)
+      return UDT::setsockopt(u, 0, UDT_FEC, &value, sizeof(int));
+   if ("pmtud" == name)
+      return UDT::setsockopt(u, 0, UDT_PMTUD, &flag, sizeof(bool));
+   if ("ccalgo" == name)
+      return UDT::setsockopt(u, 0, UDT_CCALGO, &value, sizeof(int));
+   if ("size" == name)
+      return 0;
+
+   return -1;
+}
+
+double now()
+{
+   timeval t;
+   gettimeofday(&t, 0);
+   return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+int main(int argc, char* argv[])
+{
+   if ((argc < 3) || ((0 != strcmp(argv[1], "server")) && (0 != strcmp(argv[1], "client"))) || (0 == atoi(argv[2])))
+   {
+      cout << "usage: transfer server|client port [option=value ...]" << endl;
+      return 0;
+   }
+
+   bool server = (0 == strcmp(argv[1], "server"));
+   int64_t total = 20;
+
+   UDT::startup();
+
+   UDTSOCKET u = UDT::socket(AF_INET, SOCK_STREAM, 0);
+   for (int i = 3; i < argc; ++ i)
+   {
+      if (0 == strncmp(argv[i], "size=", 5))
+         total = atoi(argv[i] + 5);
+      if (UDT::ERROR == setOption(u, argv[i]))
+      {
+         cout << "option " << argv[i] << ": " << UDT::getlasterror().getErrorMessage() << endl;
+         return 1;
+      }
+   }
+   total *= 1000000;
+
+   sockaddr_in addr;
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_port = htons(atoi(argv[2]));
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+   const int size = 1000000;
+   char* data = new char[size];
+   UDT::TRACEINFO perf;
+   unsigned char pattern = 0;
+
+   if (server)
+   {
+      if ((UDT::ERROR == UDT::bind(u, (sockaddr*)&addr, sizeof(addr))) || (UDT::ERROR == UDT::listen(u, 1)))
+      {
+         cout << "listen: " << UDT::getlasterror().getErrorMessage() << endl;
+         return 1;
+      }
+
+      UDTSOCKET c = UDT::accept(u, NULL, NULL);
+      if (UDT::INVALID_SOCK == c)
+      {
+         cout << "accept: " << UDT::getlasterror().getErrorMessage() << endl;
+         return 1;
+      }
+
+      int64_t received = 0;
+      bool intact = true;
+      while (received < total)
+      {
+         int rs = UDT::recv(c, data, size, 0);
+         if (UDT::ERROR == rs)
+         {
+            cout << "recv: " << UDT::getlasterror().getErrorMessage() << endl;
+            break;
+         }
+         for (int i = 0; i < rs; ++ i)
+            intact = intact && ((unsigned char)data[i] == pattern ++);
+         received += rs;
+      }
+
+      UDT::perfmon(c, &perf, false);
+
+      // the client reads its counters before it closes the connection
+      while (UDT::ERROR != UDT::recv(c, data, size, 0)) {}
+
+      cout << "server: received " << received << (intact ? " intact" : " CORRUPTED")
+           << ", loss " << perf.pktRcvLossTotal << ", duplicates " << perf.pktRcvSpuriousTotal
+           << ", NAK " << perf.pktSentNAKTotal << ", recovered " << perf.pktRcvRecoveredTotal << endl;
+
+      UDT::close(c);
+   }
+   else
+   {
+      if (UDT::ERROR == UDT::connect(u, (sockaddr*)&addr, sizeof(addr)))
+      {
+         cout << "connect: " << UDT::getlasterror().getErrorMessage() << endl;
+         return 1;
+      }
+
+      double start = now();
+      for (int64_t sent = 0; sent < total; sent += size)
+      {
+         for (int i = 0; i < size; ++ i)
+            data[i] = pattern ++;
+
+         int ssize = 0;
+         while (ssize < size)
+         {
+            int ss = UDT::send(u, data + ssize, size - ssize, 0);
+            if (UDT::ERROR == ss)
+            {
+               cout << "send: " << UDT::getlasterror().getErrorMessage() << endl;
+               return 1;
+            }
+            ssize += ss;
+         }
+      }
+
+      // the transfer is over when the peer has acknowledged everything
+      int pending = 1;
+      int len = sizeof(int);
+      while ((UDT::ERROR != UDT::getsockopt(u, 0, UDT_SNDDATA, &pending, &len)) && (pending > 0))
+         usleep(1000);
+      double elapsed = now() - start;
+
+      UDT::perfmon(u, &perf, false);
+      cout << "client: " << elapsed << " s, " << total * 8 / elapsed / 1000000 << " Mb/s"
+           << ", sent " << perf.pktSentTotal << ", retransmitted " << perf.pktRetransTotal
+           << ", loss " << perf.pktSndLossTotal << ", ACK " << perf.pktRecvACKTotal
+           << ", NAK " << perf.pktRecvNAKTotal << ", RTT " << perf.msRTT << " ms" << endl;
+   }
+
+   delete [] data;
+   UDT::close(u);
+   UDT::cleanup();
+
+   return 0;
+}
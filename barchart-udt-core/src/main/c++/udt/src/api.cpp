@@ -46,10 +46,14 @@ written by
    #endif
 #else
    #include <unistd.h>
+   #include <fcntl.h>
+   #include <cerrno>
 #endif
 #include <cstring>
+#include <algorithm>
 #include "api.h"
 #include "core.h"
+#include "stripe.h"
 
 using namespace std;
 
@@ -112,8 +116,43 @@ CUDTSocket::~CUDTSocket()
    #endif
 }
 
+void CUDTSocket::reset()
+{
+   if (AF_INET == m_iIPversion)
+   {
+      delete (sockaddr_in*)m_pSelfAddr;
+      delete (sockaddr_in*)m_pPeerAddr;
+   }
+   else
+   {
+      delete (sockaddr_in6*)m_pSelfAddr;
+      delete (sockaddr_in6*)m_pPeerAddr;
+   }
+   m_pSelfAddr = NULL;
+   m_pPeerAddr = NULL;
+
+   delete m_pQueuedSockets;
+   delete m_pAcceptSockets;
+   m_pQueuedSockets = NULL;
+   m_pAcceptSockets = NULL;
+
+   m_Status = INIT;
+   m_TimeStamp = 0;
+   m_iIPversion = 0;
+   m_SocketID = 0;
+   m_ListenSocket = 0;
+   m_PeerID = 0;
+   m_iISN = 0;
+   m_uiBackLog = 0;
+   m_iMuxID = -1;
+
+   m_pUDT->reset();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
+const int CUDTUnited::m_iMaxFreeSockets = 4096;
+
 CUDTUnited::CUDTUnited():
 m_Sockets(),
 m_ControlLock(),
@@ -122,7 +161,11 @@ m_SocketID(0),
 m_TLSError(),
 m_mMultiplexer(),
 m_MultiplexerLock(),
+#ifdef LINUX
+m_pWorkerPool(NULL),
+#endif
 m_pCache(NULL),
+m_pTokenCache(NULL),
 m_bClosing(false),
 m_GCStopLock(),
 m_GCStopCond(),
@@ -130,7 +173,9 @@ m_InitLock(),
 m_iInstanceCount(0),
 m_bGCStatus(false),
 m_GCThread(),
-m_ClosedSockets()
+m_ClosedSockets(),
+m_vFreeSockets(),
+m_FreeLock()
 {
    // Socket ID MUST start from a random value
    srand((unsigned int)CTimer::getTime());
@@ -140,10 +185,12 @@ m_ClosedSockets()
       pthread_mutex_init(&m_ControlLock, NULL);
       pthread_mutex_init(&m_IDLock, NULL);
       pthread_mutex_init(&m_InitLock, NULL);
+      pthread_mutex_init(&m_FreeLock, NULL);
    #else
       m_ControlLock = CreateMutex(NULL, false, NULL);
       m_IDLock = CreateMutex(NULL, false, NULL);
       m_InitLock = CreateMutex(NULL, false, NULL);
+      m_FreeLock = CreateMutex(NULL, false, NULL);
    #endif
 
    #ifndef WIN32
@@ -154,6 +201,7 @@ m_ClosedSockets()
    #endif
 
    m_pCache = new CCache<CInfoBlock>;
+   m_pTokenCache = new CCache<CTokenBlock>;
 }
 
 CUDTUnited::~CUDTUnited()
@@ -162,10 +210,12 @@ CUDTUnited::~CUDTUnited()
       pthread_mutex_destroy(&m_ControlLock);
       pthread_mutex_destroy(&m_IDLock);
       pthread_mutex_destroy(&m_InitLock);
+      pthread_mutex_destroy(&m_FreeLock);
    #else
       CloseHandle(m_ControlLock);
       CloseHandle(m_IDLock);
       CloseHandle(m_InitLock);
+      CloseHandle(m_FreeLock);
    #endif
 
    #ifndef WIN32
@@ -176,6 +226,7 @@ CUDTUnited::~CUDTUnited()
    #endif
 
    delete m_pCache;
+   delete m_pTokenCache;
 }
 
 int CUDTUnited::startup()
@@ -245,6 +296,18 @@ int CUDTUnited::cleanup()
 
    m_bGCStatus = false;
 
+   #ifdef LINUX
+      delete m_pWorkerPool;
+      m_pWorkerPool = NULL;
+   #endif
+
+   // all sockets have been removed by the GC thread, drop the ones kept for reuse
+   CGuard::enterCS(m_FreeLock);
+   for (vector<CUDTSocket*>::iterator i = m_vFreeSockets.begin(); i != m_vFreeSockets.end(); ++ i)
+      delete *i;
+   m_vFreeSockets.clear();
+   CGuard::leaveCS(m_FreeLock);
+
    // Global destruction code
    #ifdef WIN32
       WSACleanup();
@@ -262,8 +325,7 @@ UDTSOCKET CUDTUnited::newSocket(int af, int type)
 
    try
    {
-      ns = new CUDTSocket;
-      ns->m_pUDT = new CUDT;
+      ns = allocSocket();
       if (AF_INET == af)
       {
          ns->m_pSelfAddr = (sockaddr*)(new sockaddr_in);
@@ -291,6 +353,7 @@ UDTSOCKET CUDTUnited::newSocket(int af, int type)
    ns->m_pUDT->m_iSockType = (SOCK_STREAM == type) ? UDT_STREAM : UDT_DGRAM;
    ns->m_pUDT->m_iIPversion = ns->m_iIPversion = af;
    ns->m_pUDT->m_pCache = m_pCache;
+   ns->m_pUDT->m_pTokenCache = m_pTokenCache;
 
    // protect the m_Sockets structure.
    CGuard::enterCS(m_ControlLock);
@@ -331,7 +394,7 @@ int CUDTUnited::newConnection(const UDTSOCKET listen, const sockaddr* peer, CHan
          ns->m_TimeStamp = CTimer::getTime();
 
          CGuard::enterCS(ls->m_AcceptLock);
-         ls->m_pQueuedSockets->erase(ns->m_SocketID);
+         ls->m_pQueuedSockets->erase(std::remove(ls->m_pQueuedSockets->begin(), ls->m_pQueuedSockets->end(), ns->m_SocketID), ls->m_pQueuedSockets->end());
          ls->m_pAcceptSockets->erase(ns->m_SocketID);
          CGuard::leaveCS(ls->m_AcceptLock);
       }
@@ -342,6 +405,12 @@ int CUDTUnited::newConnection(const UDTSOCKET listen, const sockaddr* peer, CHan
 
          hs->m_iISN = ns->m_pUDT->m_iISN;
          hs->m_iMSS = ns->m_pUDT->m_iMSS;
+         // the same extensions as the first response; m_iExtension keeps m_iExtAware if the peer sent it
+         hs->m_iExtension = ns->m_pUDT->m_iExtension;
+         if (hs->m_iExtension & CHandShake::m_iExtFEC)
+            hs->m_iExtension |= ns->m_pUDT->m_iFECGroup << 8;
+         if ((hs->m_iExtension & CHandShake::m_iExtCoalesce) && (ns->m_pUDT->m_iCoalesce >= 0))
+            hs->m_iExtension |= CHandShake::m_iExtCoalescing;
          hs->m_iFlightFlagSize = ns->m_pUDT->m_iFlightFlagSize;
          hs->m_iReqType = -1;
          hs->m_iID = ns->m_SocketID;
@@ -358,8 +427,7 @@ int CUDTUnited::newConnection(const UDTSOCKET listen, const sockaddr* peer, CHan
 
    try
    {
-      ns = new CUDTSocket;
-      ns->m_pUDT = new CUDT(*(ls->m_pUDT));
+      ns = allocSocket(ls);
       if (AF_INET == ls->m_iIPversion)
       {
          ns->m_pSelfAddr = (sockaddr*)(new sockaddr_in);
@@ -428,7 +496,7 @@ int CUDTUnited::newConnection(const UDTSOCKET listen, const sockaddr* peer, CHan
    CGuard::enterCS(ls->m_AcceptLock);
    try
    {
-      ls->m_pQueuedSockets->insert(ns->m_SocketID);
+      ls->m_pQueuedSockets->push_back(ns->m_SocketID);
    }
    catch (...)
    {
@@ -599,7 +667,7 @@ int CUDTUnited::listen(const UDTSOCKET u, int backlog)
 
    try
    {
-      s->m_pQueuedSockets = new set<UDTSOCKET>;
+      s->m_pQueuedSockets = new deque<UDTSOCKET>;
       s->m_pAcceptSockets = new set<UDTSOCKET>;
    }
    catch (...)
@@ -621,6 +689,32 @@ UDTSOCKET CUDTUnited::accept(const UDTSOCKET listen, sockaddr* addr, int* addrle
    if ((NULL != addr) && (NULL == addrlen))
       throw CUDTException(5, 3, 0);
 
+   UDTSOCKET u = CUDT::INVALID_SOCK;
+   acceptmany(listen, &u, 1);
+
+   if ((addr != NULL) && (addrlen != NULL))
+   {
+      CUDTSocket* s = locate(u);
+      if (NULL == s)
+         throw CUDTException(5, 4, 0);
+
+      if (AF_INET == s->m_iIPversion)
+         *addrlen = sizeof(sockaddr_in);
+      else
+         *addrlen = sizeof(sockaddr_in6);
+
+      // copy address information of peer node
+      memcpy(addr, s->m_pPeerAddr, *addrlen);
+   }
+
+   return u;
+}
+
+int CUDTUnited::acceptmany(const UDTSOCKET listen, UDTSOCKET* socks, int num)
+{
+   if ((NULL == socks) || (num <= 0))
+      throw CUDTException(5, 3, 0);
+
    CUDTSocket* ls = locate(listen);
 
    if (ls == NULL)
@@ -634,10 +728,10 @@ UDTSOCKET CUDTUnited::accept(const UDTSOCKET listen, sockaddr* addr, int* addrle
    if (ls->m_pUDT->m_bRendezvous)
       throw CUDTException(5, 7, 0);
 
-   UDTSOCKET u = CUDT::INVALID_SOCK;
+   int count = 0;
    bool accepted = false;
 
-   // !!only one conection can be set up each time!!
+   // wait for the first connection only, then take whatever else is queued, oldest first
    #ifndef WIN32
       while (!accepted)
       {
@@ -648,11 +742,14 @@ UDTSOCKET CUDTUnited::accept(const UDTSOCKET listen, sockaddr* addr, int* addrle
             // This socket has been closed.
             accepted = true;
          }
-         else if (ls->m_pQueuedSockets->size() > 0)
+         else if (!ls->m_pQueuedSockets->empty())
          {
-            u = *(ls->m_pQueuedSockets->begin());
-            ls->m_pAcceptSockets->insert(ls->m_pAcceptSockets->end(), u);
-            ls->m_pQueuedSockets->erase(ls->m_pQueuedSockets->begin());
+            for (; (count < num) && !ls->m_pQueuedSockets->empty(); ++ count)
+            {
+               socks[count] = ls->m_pQueuedSockets->front();
+               ls->m_pAcceptSockets->insert(socks[count]);
+               ls->m_pQueuedSockets->pop_front();
+            }
             accepted = true;
          }
          else if (!ls->m_pUDT->m_bSynRecving)
@@ -673,11 +770,14 @@ UDTSOCKET CUDTUnited::accept(const UDTSOCKET listen, sockaddr* addr, int* addrle
       {
          WaitForSingleObject(ls->m_AcceptLock, INFINITE);
 
-         if (ls->m_pQueuedSockets->size() > 0)
+         if (!ls->m_pQueuedSockets->empty())
          {
-            u = *(ls->m_pQueuedSockets->begin());
-            ls->m_pAcceptSockets->insert(ls->m_pAcceptSockets->end(), u);
-            ls->m_pQueuedSockets->erase(ls->m_pQueuedSockets->begin());
+            for (; (count < num) && !ls->m_pQueuedSockets->empty(); ++ count)
+            {
+               socks[count] = ls->m_pQueuedSockets->front();
+               ls->m_pAcceptSockets->insert(socks[count]);
+               ls->m_pQueuedSockets->pop_front();
+            }
 
             accepted = true;
          }
@@ -701,7 +801,7 @@ UDTSOCKET CUDTUnited::accept(const UDTSOCKET listen, sockaddr* addr, int* addrle
       }
    #endif
 
-   if (u == CUDT::INVALID_SOCK)
+   if (0 == count)
    {
       // non-blocking receiving, no connection available
       if (!ls->m_pUDT->m_bSynRecving)
@@ -711,21 +811,10 @@ UDTSOCKET CUDTUnited::accept(const UDTSOCKET listen, sockaddr* addr, int* addrle
       throw CUDTException(5, 6, 0);
    }
 
-   if ((addr != NULL) && (addrlen != NULL))
-   {
-      if (AF_INET == locate(u)->m_iIPversion)
-         *addrlen = sizeof(sockaddr_in);
-      else
-         *addrlen = sizeof(sockaddr_in6);
-
-      // copy address information of peer node
-      memcpy(addr, locate(u)->m_pPeerAddr, *addrlen);
-   }
-
-   return u;
+   return count;
 }
 
-int CUDTUnited::connect(const UDTSOCKET u, const sockaddr* name, int namelen)
+int CUDTUnited::connect(const UDTSOCKET u, const sockaddr* name, int namelen, const char* data, int len)
 {
    CUDTSocket* s = locate(u);
    if (NULL == s)
@@ -733,6 +822,65 @@ int CUDTUnited::connect(const UDTSOCKET u, const sockaddr* name, int namelen)
 
    CGuard cg(s->m_ControlLock);
 
+   return connect(s, name, namelen, data, len, NULL);
+}
+
+int CUDTUnited::connectmany(const UDTSOCKET* socks, const sockaddr* names, int namelen, int num)
+{
+   if ((NULL == socks) || (NULL == names) || (num <= 0))
+      throw CUDTException(5, 3, 0);
+
+   // look all sockets up at once
+   vector<CUDTSocket*> sv(num);
+   {
+      CGuard cg(m_ControlLock);
+
+      for (int k = 0; k < num; ++ k)
+      {
+         map<UDTSOCKET, CUDTSocket*>::iterator i = m_Sockets.find(socks[k]);
+         if ((i == m_Sockets.end()) || (i->second->m_Status == CLOSED))
+            throw CUDTException(5, 4, 0);
+         sv[k] = i->second;
+      }
+   }
+
+   // the sockets not bound yet share the multiplexer of the first of them
+   const CUDTSocket* mux = NULL;
+   int count = 0;
+
+   for (; count < num; ++ count)
+   {
+      CUDTSocket* s = sv[count];
+      const sockaddr* name = (const sockaddr*)((const char*)names + count * namelen);
+
+      try
+      {
+         CGuard cg(s->m_ControlLock);
+
+         // the connections are set up in the background, no socket may wait for its own
+         if (s->m_pUDT->m_bSynRecving)
+            throw CUDTException(5, 3, 0);
+
+         const bool bound = (INIT != s->m_Status);
+         connect(s, name, namelen, NULL, 0, mux);
+
+         if ((NULL == mux) && !bound)
+            mux = s;
+      }
+      catch (CUDTException& e)
+      {
+         // report the sockets already connecting, the caller learns of the error on the next call
+         if (count > 0)
+            break;
+         throw e;
+      }
+   }
+
+   return count;
+}
+
+int CUDTUnited::connect(CUDTSocket* s, const sockaddr* name, int namelen, const char* data, int len, const CUDTSocket* mux)
+{
    // check the size of SOCKADDR structure
    if (AF_INET == s->m_iIPversion)
    {
@@ -751,7 +899,15 @@ int CUDTUnited::connect(const UDTSOCKET u, const sockaddr* name, int namelen)
       if (!s->m_pUDT->m_bRendezvous)
       {
          s->m_pUDT->open();
-         updateMux(s);
+
+         // a socket can join another one's multiplexer only if it takes the same packets
+         if ((NULL != mux) && (mux->m_iIPversion == s->m_iIPversion) && (mux->m_pUDT->m_iMSS == s->m_pUDT->m_iMSS))
+            updateMux(s, mux);
+         else
+         {
+            updateMux(s);
+            s->m_pUDT->m_pSndQueue->m_pChannel->getSockAddr(s->m_pSelfAddr);
+         }
          s->m_Status = OPENED;
       }
       else
@@ -764,9 +920,10 @@ int CUDTUnited::connect(const UDTSOCKET u, const sockaddr* name, int namelen)
    // So we need to update the status before connect() is called,
    // otherwise the status may be overwritten with wrong value (CONNECTED vs. CONNECTING).
    s->m_Status = CONNECTING;
+   int taken = 0;
    try
    {
-      s->m_pUDT->connect(name);
+      taken = s->m_pUDT->connect(name, data, len);
    }
    catch (CUDTException e)
    {
@@ -787,7 +944,7 @@ int CUDTUnited::connect(const UDTSOCKET u, const sockaddr* name, int namelen)
       memcpy(s->m_pPeerAddr, name, sizeof(sockaddr_in6));
    }
 
-   return 0;
+   return (NULL != data) ? taken : 0;
 }
 
 void CUDTUnited::connect_complete(const UDTSOCKET u)
@@ -973,7 +1130,7 @@ int CUDTUnited::select(ud_set* readfds, ud_set* writefds, ud_set* exceptfds, con
 
          if ((s->m_pUDT->m_bConnected && (s->m_pUDT->m_pRcvBuffer->getRcvDataSize() > 0) && ((s->m_pUDT->m_iSockType == UDT_STREAM) || (s->m_pUDT->m_pRcvBuffer->getRcvMsgNum() > 0)))
             || (!s->m_pUDT->m_bListening && (s->m_pUDT->m_bBroken || !s->m_pUDT->m_bConnected))
-            || (s->m_pUDT->m_bListening && (s->m_pQueuedSockets->size() > 0))
+            || (s->m_pUDT->m_bListening && !s->m_pQueuedSockets->empty())
             || (s->m_Status == CLOSED))
          {
             rs.insert(s->m_SocketID);
@@ -1056,7 +1213,7 @@ int CUDTUnited::selectEx(const vector<UDTSOCKET>& fds, vector<UDTSOCKET>* readfd
          if (NULL != readfds)
          {
             if ((s->m_pUDT->m_bConnected && (s->m_pUDT->m_pRcvBuffer->getRcvDataSize() > 0) && ((s->m_pUDT->m_iSockType == UDT_STREAM) || (s->m_pUDT->m_pRcvBuffer->getRcvMsgNum() > 0)))
-               || (s->m_pUDT->m_bListening && (s->m_pQueuedSockets->size() > 0)))
+               || (s->m_pUDT->m_bListening && !s->m_pQueuedSockets->empty()))
             {
                readfds->push_back(s->m_SocketID);
                ++ count;
@@ -1216,7 +1373,7 @@ void CUDTUnited::checkBrokenSockets()
          }
 
          CGuard::enterCS(ls->second->m_AcceptLock);
-         ls->second->m_pQueuedSockets->erase(i->second->m_SocketID);
+         ls->second->m_pQueuedSockets->erase(std::remove(ls->second->m_pQueuedSockets->begin(), ls->second->m_pQueuedSockets->end(), i->second->m_SocketID), ls->second->m_pQueuedSockets->end());
          ls->second->m_pAcceptSockets->erase(i->second->m_SocketID);
          CGuard::leaveCS(ls->second->m_AcceptLock);
       }
@@ -1267,7 +1424,7 @@ void CUDTUnited::removeSocket(const UDTSOCKET u)
       CGuard::enterCS(i->second->m_AcceptLock);
 
       // if it is a listener, close all un-accepted sockets in its queue and remove them later
-      for (set<UDTSOCKET>::iterator q = i->second->m_pQueuedSockets->begin(); q != i->second->m_pQueuedSockets->end(); ++ q)
+      for (deque<UDTSOCKET>::iterator q = i->second->m_pQueuedSockets->begin(); q != i->second->m_pQueuedSockets->end(); ++ q)
       {
          m_Sockets[*q]->m_pUDT->m_bBroken = true;
          m_Sockets[*q]->m_pUDT->close();
@@ -1289,9 +1446,9 @@ void CUDTUnited::removeSocket(const UDTSOCKET u)
          m_PeerRec.erase(j);
    }
 
-   // delete this one
+   // delete this one, or keep it for a new socket
    i->second->m_pUDT->close();
-   delete i->second;
+   freeSocket(i->second);
    m_ClosedSockets.erase(i);
 
    map<int, CMultiplexer>::iterator m;
@@ -1305,6 +1462,16 @@ void CUDTUnited::removeSocket(const UDTSOCKET u)
    m->second.m_iRefCount --;
    if (0 == m->second.m_iRefCount)
    {
+      #ifdef LINUX
+         if (m->second.m_bPooled)
+         {
+            // the pool thread may be using them right now, it deletes them itself
+            m_pWorkerPool->remove(m->second.m_pSndQueue, m->second.m_pRcvQueue, m->second.m_pChannel, m->second.m_pTimer);
+            m_mMultiplexer.erase(m);
+            return;
+         }
+      #endif
+
       m->second.m_pChannel->close();
       delete m->second.m_pSndQueue;
       delete m->second.m_pRcvQueue;
@@ -1314,6 +1481,58 @@ void CUDTUnited::removeSocket(const UDTSOCKET u)
    }
 }
 
+CUDTSocket* CUDTUnited::allocSocket(const CUDTSocket* ls)
+{
+   CUDTSocket* s = NULL;
+
+   CGuard::enterCS(m_FreeLock);
+   if (!m_vFreeSockets.empty())
+   {
+      s = m_vFreeSockets.back();
+      m_vFreeSockets.pop_back();
+   }
+   CGuard::leaveCS(m_FreeLock);
+
+   if (NULL != s)
+   {
+      // a recycled socket already has its locks and queue nodes, only the configurations are reloaded
+      if (NULL == ls)
+         s->m_pUDT->defaultOpt();
+      else
+         s->m_pUDT->copyOpt(*(ls->m_pUDT));
+
+      return s;
+   }
+
+   s = new CUDTSocket;
+   try
+   {
+      s->m_pUDT = (NULL == ls) ? new CUDT : new CUDT(*(ls->m_pUDT));
+   }
+   catch (...)
+   {
+      delete s;
+      throw;
+   }
+
+   return s;
+}
+
+void CUDTUnited::freeSocket(CUDTSocket* s)
+{
+   s->reset();
+
+   CGuard::enterCS(m_FreeLock);
+   if ((int)m_vFreeSockets.size() < m_iMaxFreeSockets)
+   {
+      m_vFreeSockets.push_back(s);
+      s = NULL;
+   }
+   CGuard::leaveCS(m_FreeLock);
+
+   delete s;
+}
+
 void CUDTUnited::setError(CUDTException* e)
 {
    #ifndef WIN32
@@ -1375,6 +1594,12 @@ void CUDTUnited::updateMux(CUDTSocket* s, const sockaddr* addr, const UDPSOCKET*
 {
    CGuard cg(m_ControlLock);
 
+   // a busy polling channel needs a thread of its own
+   bool pooled = false;
+   #ifdef LINUX
+      pooled = (s->m_pUDT->m_iWorkerPool > 0) && (0 == s->m_pUDT->m_iBusyPoll);
+   #endif
+
    if ((s->m_pUDT->m_bReuseAddr) && (NULL != addr))
    {
       int port = (AF_INET == s->m_pUDT->m_iIPversion) ? ntohs(((sockaddr_in*)addr)->sin_port) : ntohs(((sockaddr_in6*)addr)->sin6_port);
@@ -1382,7 +1607,7 @@ void CUDTUnited::updateMux(CUDTSocket* s, const sockaddr* addr, const UDPSOCKET*
       // find a reusable address
       for (map<int, CMultiplexer>::iterator i = m_mMultiplexer.begin(); i != m_mMultiplexer.end(); ++ i)
       {
-         if ((i->second.m_iIPversion == s->m_pUDT->m_iIPversion) && (i->second.m_iMSS == s->m_pUDT->m_iMSS) && i->second.m_bReusable)
+         if ((i->second.m_iIPversion == s->m_pUDT->m_iIPversion) && (i->second.m_iMSS == s->m_pUDT->m_iMSS) && (i->second.m_iBusyPoll == s->m_pUDT->m_iBusyPoll) && (i->second.m_llCPUMask == s->m_pUDT->m_llCPUMask) && (i->second.m_iNode == s->m_pUDT->m_iNUMANode) && (i->second.m_bPooled == pooled) && i->second.m_bReusable)
          {
             if (i->second.m_iPort == port)
             {
@@ -1400,6 +1625,10 @@ void CUDTUnited::updateMux(CUDTSocket* s, const sockaddr* addr, const UDPSOCKET*
    // a new multiplexer is needed
    CMultiplexer m;
    m.m_iMSS = s->m_pUDT->m_iMSS;
+   m.m_iBusyPoll = s->m_pUDT->m_iBusyPoll;
+   m.m_llCPUMask = s->m_pUDT->m_llCPUMask;
+   m.m_iNode = s->m_pUDT->m_iNUMANode;
+   m.m_bPooled = pooled;
    m.m_iIPversion = s->m_pUDT->m_iIPversion;
    m.m_iRefCount = 1;
    m.m_bReusable = s->m_pUDT->m_bReuseAddr;
@@ -1408,6 +1637,8 @@ void CUDTUnited::updateMux(CUDTSocket* s, const sockaddr* addr, const UDPSOCKET*
    m.m_pChannel = new CChannel(s->m_pUDT->m_iIPversion);
    m.m_pChannel->setSndBufSize(s->m_pUDT->m_iUDPSndBufSize);
    m.m_pChannel->setRcvBufSize(s->m_pUDT->m_iUDPRcvBufSize);
+   m.m_pChannel->setBusyPoll(m.m_iBusyPoll);
+   m.m_pChannel->setNonBlocking(pooled);
 
    try
    {
@@ -1431,9 +1662,46 @@ void CUDTUnited::updateMux(CUDTSocket* s, const sockaddr* addr, const UDPSOCKET*
    m.m_pTimer = new CTimer;
 
    m.m_pSndQueue = new CSndQueue;
-   m.m_pSndQueue->init(m.m_pChannel, m.m_pTimer);
+   m.m_pSndQueue->init(m.m_pChannel, m.m_pTimer, !pooled);
    m.m_pRcvQueue = new CRcvQueue;
-   m.m_pRcvQueue->init(32, s->m_pUDT->m_iPayloadSize, m.m_iIPversion, 1024, m.m_pChannel, m.m_pTimer);
+   m.m_pRcvQueue->init(32, s->m_pUDT->m_iPayloadSize, m.m_iIPversion, 1024, m.m_pChannel, m.m_pTimer, m.m_iNode, !pooled);
+
+   #ifdef LINUX
+      if (pooled)
+      {
+         // the first socket to need the pool decides its size
+         if (NULL == m_pWorkerPool)
+         {
+            CWorkerPool* pool = new CWorkerPool;
+            try
+            {
+               pool->init(s->m_pUDT->m_iWorkerPool);
+            }
+            catch (CUDTException& e)
+            {
+               delete pool;
+               delete m.m_pSndQueue;
+               delete m.m_pRcvQueue;
+               delete m.m_pTimer;
+               m.m_pChannel->close();
+               delete m.m_pChannel;
+               throw e;
+            }
+            m_pWorkerPool = pool;
+         }
+
+         m_pWorkerPool->add(m.m_pSndQueue, m.m_pRcvQueue, m.m_pChannel, m.m_pTimer);
+      }
+   #endif
+
+   // keep the threads near the buffers; a busy polling receiver may have a CPU of its own
+   if (!pooled && (0 != m.m_llCPUMask))
+   {
+      m.m_pSndQueue->setCPU(m.m_llCPUMask);
+      m.m_pRcvQueue->setCPU(m.m_llCPUMask);
+   }
+   if (s->m_pUDT->m_iPollCPU >= 0)
+      m.m_pRcvQueue->setCPU(1ULL << s->m_pUDT->m_iPollCPU);
 
    m_mMultiplexer[m.m_iID] = m;
 
@@ -1514,7 +1782,7 @@ void CUDTUnited::updateMux(CUDTSocket* s, const CUDTSocket* ls)
       }
 
       CGuard::enterCS(ls->second->m_AcceptLock);
-      ls->second->m_pQueuedSockets->erase(i->second->m_SocketID);
+      ls->second->m_pQueuedSockets->erase(std::remove(ls->second->m_pQueuedSockets->begin(), ls->second->m_pQueuedSockets->end(), i->second->m_SocketID), ls->second->m_pQueuedSockets->end());
       ls->second->m_pAcceptSockets->erase(i->second->m_SocketID);
       CGuard::leaveCS(ls->second->m_AcceptLock);
    }
@@ -1672,6 +1940,42 @@ UDTSOCKET CUDT::accept(UDTSOCKET u, sockaddr* addr, int* addrlen)
    }
 }
 
+int CUDT::acceptmany(UDTSOCKET u, UDTSOCKET* socks, int num)
+{
+   try
+   {
+      return s_UDTUnited.acceptmany(u, socks, num);
+   }
+   catch (CUDTException& e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::connectmany(const UDTSOCKET* socks, const sockaddr* names, int namelen, int num)
+{
+   try
+   {
+      return s_UDTUnited.connectmany(socks, names, namelen, num);
+   }
+   catch (CUDTException& e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
 int CUDT::connect(UDTSOCKET u, const sockaddr* name, int namelen)
 {
    try
@@ -1695,6 +1999,29 @@ int CUDT::connect(UDTSOCKET u, const sockaddr* name, int namelen)
    }
 }
 
+int CUDT::connect(UDTSOCKET u, const sockaddr* name, int namelen, const char* data, int len)
+{
+   try
+   {
+      return s_UDTUnited.connect(u, name, namelen, data, len);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
 int CUDT::close(UDTSOCKET u)
 {
    try
@@ -1837,6 +2164,9 @@ int CUDT::sendmsg(UDTSOCKET u, const char* buf, int len, int ttl, bool inorder)
    try
    {
       CUDT* udt = s_UDTUnited.lookup(u);
+      // the messages of a connection carrying streams are their frames
+      if (NULL != udt->m_pStreamMux)
+         throw CUDTException(5, 14, 0);
       return udt->sendmsg(buf, len, ttl, inorder);
    }
    catch (CUDTException e)
@@ -1861,6 +2191,8 @@ int CUDT::recvmsg(UDTSOCKET u, char* buf, int len)
    try
    {
       CUDT* udt = s_UDTUnited.lookup(u);
+      if (NULL != udt->m_pStreamMux)
+         throw CUDTException(5, 14, 0);
       return udt->recvmsg(buf, len);
    }
    catch (CUDTException e)
@@ -1875,12 +2207,12 @@ int CUDT::recvmsg(UDTSOCKET u, char* buf, int len)
    }
 }
 
-int64_t CUDT::sendfile(UDTSOCKET u, fstream& ifs, int64_t& offset, int64_t size, int block)
+int CUDT::sendv(UDTSOCKET u, const CIOVec* iov, int num, int)
 {
    try
    {
       CUDT* udt = s_UDTUnited.lookup(u);
-      return udt->sendfile(ifs, offset, size, block);
+      return udt->sendv(iov, num);
    }
    catch (CUDTException e)
    {
@@ -1899,12 +2231,12 @@ int64_t CUDT::sendfile(UDTSOCKET u, fstream& ifs, int64_t& offset, int64_t size,
    }
 }
 
-int64_t CUDT::recvfile(UDTSOCKET u, fstream& ofs, int64_t& offset, int64_t size, int block)
+int CUDT::recvv(UDTSOCKET u, const CIOVec* iov, int num, int)
 {
    try
    {
       CUDT* udt = s_UDTUnited.lookup(u);
-      return udt->recvfile(ofs, offset, size, block);
+      return udt->recvv(iov, num);
    }
    catch (CUDTException e)
    {
@@ -1918,17 +2250,14 @@ int64_t CUDT::recvfile(UDTSOCKET u, fstream& ofs, int64_t& offset, int64_t size,
    }
 }
 
-int CUDT::select(int, ud_set* readfds, ud_set* writefds, ud_set* exceptfds, const timeval* timeout)
+int CUDT::sendmsgv(UDTSOCKET u, const CIOVec* iov, int num, int ttl, bool inorder)
 {
-   if ((NULL == readfds) && (NULL == writefds) && (NULL == exceptfds))
-   {
-      s_UDTUnited.setError(new CUDTException(5, 3, 0));
-      return ERROR;
-   }
-
    try
    {
-      return s_UDTUnited.select(readfds, writefds, exceptfds, timeout);
+      CUDT* udt = s_UDTUnited.lookup(u);
+      if (NULL != udt->m_pStreamMux)
+         throw CUDTException(5, 14, 0);
+      return udt->sendmsgv(iov, num, ttl, inorder);
    }
    catch (CUDTException e)
    {
@@ -1947,28 +2276,20 @@ int CUDT::select(int, ud_set* readfds, ud_set* writefds, ud_set* exceptfds, cons
    }
 }
 
-int CUDT::selectEx(const vector<UDTSOCKET>& fds, vector<UDTSOCKET>* readfds, vector<UDTSOCKET>* writefds, vector<UDTSOCKET>* exceptfds, int64_t msTimeOut)
+int CUDT::recvmsgv(UDTSOCKET u, const CIOVec* iov, int num)
 {
-   if ((NULL == readfds) && (NULL == writefds) && (NULL == exceptfds))
-   {
-      s_UDTUnited.setError(new CUDTException(5, 3, 0));
-      return ERROR;
-   }
-
    try
    {
-      return s_UDTUnited.selectEx(fds, readfds, writefds, exceptfds, msTimeOut);
+      CUDT* udt = s_UDTUnited.lookup(u);
+      if (NULL != udt->m_pStreamMux)
+         throw CUDTException(5, 14, 0);
+      return udt->recvmsgv(iov, num);
    }
    catch (CUDTException e)
    {
       s_UDTUnited.setError(new CUDTException(e));
       return ERROR;
    }
-   catch (bad_alloc&)
-   {
-      s_UDTUnited.setError(new CUDTException(3, 2, 0));
-      return ERROR;
-   }
    catch (...)
    {
       s_UDTUnited.setError(new CUDTException(-1, 0, 0));
@@ -1976,11 +2297,14 @@ int CUDT::selectEx(const vector<UDTSOCKET>& fds, vector<UDTSOCKET>* readfds, vec
    }
 }
 
-int CUDT::epoll_create()
+int CUDT::recvlend(UDTSOCKET u, CRcvSlice* slices, int num)
 {
    try
    {
-      return s_UDTUnited.epoll_create();
+      CUDT* udt = s_UDTUnited.lookup(u);
+      if (NULL != udt->m_pStreamMux)
+         throw CUDTException(5, 14, 0);
+      return udt->recvlend(slices, num);
    }
    catch (CUDTException e)
    {
@@ -1994,11 +2318,12 @@ int CUDT::epoll_create()
    }
 }
 
-int CUDT::epoll_add_usock(const int eid, const UDTSOCKET u, const int* events)
+int CUDT::recvrelease(UDTSOCKET u, const CRcvSlice* slices, int num)
 {
    try
    {
-      return s_UDTUnited.epoll_add_usock(eid, u, events);
+      CUDT* udt = s_UDTUnited.lookup(u);
+      return udt->recvrelease(slices, num);
    }
    catch (CUDTException e)
    {
@@ -2012,17 +2337,23 @@ int CUDT::epoll_add_usock(const int eid, const UDTSOCKET u, const int* events)
    }
 }
 
-int CUDT::epoll_add_ssock(const int eid, const SYSSOCKET s, const int* events)
+int64_t CUDT::sendfile(UDTSOCKET u, fstream& ifs, int64_t& offset, int64_t size, int block)
 {
    try
    {
-      return s_UDTUnited.epoll_add_ssock(eid, s, events);
+      CUDT* udt = s_UDTUnited.lookup(u);
+      return udt->sendfile(ifs, offset, size, block);
    }
    catch (CUDTException e)
    {
       s_UDTUnited.setError(new CUDTException(e));
       return ERROR;
    }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
    catch (...)
    {
       s_UDTUnited.setError(new CUDTException(-1, 0, 0));
@@ -2030,11 +2361,12 @@ int CUDT::epoll_add_ssock(const int eid, const SYSSOCKET s, const int* events)
    }
 }
 
-int CUDT::epoll_remove_usock(const int eid, const UDTSOCKET u)
+int64_t CUDT::recvfile(UDTSOCKET u, fstream& ofs, int64_t& offset, int64_t size, int block)
 {
    try
    {
-      return s_UDTUnited.epoll_remove_usock(eid, u);
+      CUDT* udt = s_UDTUnited.lookup(u);
+      return udt->recvfile(ofs, offset, size, block);
    }
    catch (CUDTException e)
    {
@@ -2048,17 +2380,24 @@ int CUDT::epoll_remove_usock(const int eid, const UDTSOCKET u)
    }
 }
 
-int CUDT::epoll_remove_ssock(const int eid, const SYSSOCKET s)
+#ifndef WIN32
+int64_t CUDT::sendfile(UDTSOCKET u, int fd, int64_t& offset, int64_t size, int block)
 {
    try
    {
-      return s_UDTUnited.epoll_remove_ssock(eid, s);
+      CUDT* udt = s_UDTUnited.lookup(u);
+      return udt->sendfile(fd, offset, size, block);
    }
    catch (CUDTException e)
    {
       s_UDTUnited.setError(new CUDTException(e));
       return ERROR;
    }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
    catch (...)
    {
       s_UDTUnited.setError(new CUDTException(-1, 0, 0));
@@ -2066,11 +2405,12 @@ int CUDT::epoll_remove_ssock(const int eid, const SYSSOCKET s)
    }
 }
 
-int CUDT::epoll_wait(const int eid, set<UDTSOCKET>* readfds, set<UDTSOCKET>* writefds, int64_t msTimeOut, set<SYSSOCKET>* lrfds, set<SYSSOCKET>* lwfds)
+int64_t CUDT::recvfile(UDTSOCKET u, int fd, int64_t& offset, int64_t size, int block)
 {
    try
    {
-      return s_UDTUnited.epoll_wait(eid, readfds, writefds, msTimeOut, lrfds, lwfds);
+      CUDT* udt = s_UDTUnited.lookup(u);
+      return udt->recvfile(fd, offset, size, block);
    }
    catch (CUDTException e)
    {
@@ -2084,11 +2424,383 @@ int CUDT::epoll_wait(const int eid, set<UDTSOCKET>* readfds, set<UDTSOCKET>* wri
    }
 }
 
-int CUDT::epoll_release(const int eid)
+int64_t CUDT::sendfile(UDTSOCKET u, const char* path, int64_t& offset, int64_t size, int block)
 {
-   try
+   int fd = ::open(path, O_RDONLY);
+   if (fd < 0)
    {
-      return s_UDTUnited.epoll_release(eid);
+      s_UDTUnited.setError(new CUDTException(4, 1, errno));
+      return ERROR;
+   }
+
+   int64_t ret = sendfile(u, fd, offset, size, block);
+   ::close(fd);
+   return ret;
+}
+
+int64_t CUDT::recvfile(UDTSOCKET u, const char* path, int64_t& offset, int64_t size, int block)
+{
+   // a transfer from the start replaces the file, a later range goes into the existing file
+   int flags = O_WRONLY | O_CREAT;
+   if (0 == offset)
+      flags |= O_TRUNC;
+
+   #ifdef O_DIRECT
+      try
+      {
+         if (s_UDTUnited.lookup(u)->m_bDirectIO)
+            flags |= O_DIRECT;
+      }
+      catch (CUDTException e)
+      {
+         s_UDTUnited.setError(new CUDTException(e));
+         return ERROR;
+      }
+   #endif
+
+   int fd = ::open(path, flags, 0644);
+
+   // not every file system supports direct I/O
+   #ifdef O_DIRECT
+      if ((fd < 0) && (EINVAL == errno) && (flags & O_DIRECT))
+         fd = ::open(path, flags & ~O_DIRECT, 0644);
+   #endif
+
+   if (fd < 0)
+   {
+      s_UDTUnited.setError(new CUDTException(4, 3, errno));
+      return ERROR;
+   }
+
+   int64_t ret = recvfile(u, fd, offset, size, block);
+   ::close(fd);
+   return ret;
+}
+#endif
+
+int64_t CUDT::sendfilestriped(const UDTSOCKET* socks, int num, const char* path, int block)
+{
+   try
+   {
+      return CStripedFile::send(socks, num, path, block);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int64_t CUDT::recvfilestriped(const UDTSOCKET* socks, int num, const char* path, int64_t size, const char* manifest, int64_t stripe, int block)
+{
+   try
+   {
+      return CStripedFile::recv(socks, num, path, size, manifest, stripe, block);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::openstream(UDTSOCKET u)
+{
+   try
+   {
+      return s_UDTUnited.lookup(u)->getStreamMux()->open();
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::acceptstream(UDTSOCKET u)
+{
+   try
+   {
+      return s_UDTUnited.lookup(u)->getStreamMux()->accept();
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::sendstream(UDTSOCKET u, int stream, const char* buf, int len)
+{
+   try
+   {
+      return s_UDTUnited.lookup(u)->getStreamMux()->send(stream, buf, len);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::recvstream(UDTSOCKET u, int stream, char* buf, int len)
+{
+   try
+   {
+      return s_UDTUnited.lookup(u)->getStreamMux()->recv(stream, buf, len);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::closestream(UDTSOCKET u, int stream)
+{
+   try
+   {
+      s_UDTUnited.lookup(u)->getStreamMux()->close(stream);
+      return 0;
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::select(int, ud_set* readfds, ud_set* writefds, ud_set* exceptfds, const timeval* timeout)
+{
+   if ((NULL == readfds) && (NULL == writefds) && (NULL == exceptfds))
+   {
+      s_UDTUnited.setError(new CUDTException(5, 3, 0));
+      return ERROR;
+   }
+
+   try
+   {
+      return s_UDTUnited.select(readfds, writefds, exceptfds, timeout);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::selectEx(const vector<UDTSOCKET>& fds, vector<UDTSOCKET>* readfds, vector<UDTSOCKET>* writefds, vector<UDTSOCKET>* exceptfds, int64_t msTimeOut)
+{
+   if ((NULL == readfds) && (NULL == writefds) && (NULL == exceptfds))
+   {
+      s_UDTUnited.setError(new CUDTException(5, 3, 0));
+      return ERROR;
+   }
+
+   try
+   {
+      return s_UDTUnited.selectEx(fds, readfds, writefds, exceptfds, msTimeOut);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (bad_alloc&)
+   {
+      s_UDTUnited.setError(new CUDTException(3, 2, 0));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::epoll_create()
+{
+   try
+   {
+      return s_UDTUnited.epoll_create();
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::epoll_add_usock(const int eid, const UDTSOCKET u, const int* events)
+{
+   try
+   {
+      return s_UDTUnited.epoll_add_usock(eid, u, events);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::epoll_add_ssock(const int eid, const SYSSOCKET s, const int* events)
+{
+   try
+   {
+      return s_UDTUnited.epoll_add_ssock(eid, s, events);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::epoll_remove_usock(const int eid, const UDTSOCKET u)
+{
+   try
+   {
+      return s_UDTUnited.epoll_remove_usock(eid, u);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::epoll_remove_ssock(const int eid, const SYSSOCKET s)
+{
+   try
+   {
+      return s_UDTUnited.epoll_remove_ssock(eid, s);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::epoll_wait(const int eid, set<UDTSOCKET>* readfds, set<UDTSOCKET>* writefds, int64_t msTimeOut, set<SYSSOCKET>* lrfds, set<SYSSOCKET>* lwfds)
+{
+   try
+   {
+      return s_UDTUnited.epoll_wait(eid, readfds, writefds, msTimeOut, lrfds, lwfds);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::epoll_release(const int eid)
+{
+   try
+   {
+      return s_UDTUnited.epoll_release(eid);
    }
    catch (CUDTException e)
    {
@@ -2152,6 +2864,42 @@ UDTSTATUS CUDT::getsockstate(UDTSOCKET u)
    }
 }
 
+int CUDT::savecache(const char* path)
+{
+   try
+   {
+      return s_UDTUnited.m_pCache->snapshot(path);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
+int CUDT::loadcache(const char* path)
+{
+   try
+   {
+      return s_UDTUnited.m_pCache->restore(path);
+   }
+   catch (CUDTException e)
+   {
+      s_UDTUnited.setError(new CUDTException(e));
+      return ERROR;
+   }
+   catch (...)
+   {
+      s_UDTUnited.setError(new CUDTException(-1, 0, 0));
+      return ERROR;
+   }
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -2193,11 +2941,26 @@ UDTSOCKET accept(UDTSOCKET u, struct sockaddr* addr, int* addrlen)
    return CUDT::accept(u, addr, addrlen);
 }
 
+int acceptmany(UDTSOCKET u, UDTSOCKET* socks, int num)
+{
+   return CUDT::acceptmany(u, socks, num);
+}
+
 int connect(UDTSOCKET u, const struct sockaddr* name, int namelen)
 {
    return CUDT::connect(u, name, namelen);
 }
 
+int connect(UDTSOCKET u, const struct sockaddr* name, int namelen, const char* buf, int len)
+{
+   return CUDT::connect(u, name, namelen, buf, len);
+}
+
+int connectmany(const UDTSOCKET* socks, const struct sockaddr* names, int namelen, int num)
+{
+   return CUDT::connectmany(socks, names, namelen, num);
+}
+
 int close(UDTSOCKET u)
 {
    return CUDT::close(u);
@@ -2243,6 +3006,36 @@ int recvmsg(UDTSOCKET u, char* buf, int len)
    return CUDT::recvmsg(u, buf, len);
 }
 
+int sendv(UDTSOCKET u, const IOVEC* iov, int num, int flags)
+{
+   return CUDT::sendv(u, iov, num, flags);
+}
+
+int recvv(UDTSOCKET u, const IOVEC* iov, int num, int flags)
+{
+   return CUDT::recvv(u, iov, num, flags);
+}
+
+int sendmsgv(UDTSOCKET u, const IOVEC* iov, int num, int ttl, bool inorder)
+{
+   return CUDT::sendmsgv(u, iov, num, ttl, inorder);
+}
+
+int recvmsgv(UDTSOCKET u, const IOVEC* iov, int num)
+{
+   return CUDT::recvmsgv(u, iov, num);
+}
+
+int recvlend(UDTSOCKET u, RCVSLICE* slices, int num)
+{
+   return CUDT::recvlend(u, slices, num);
+}
+
+int recvrelease(UDTSOCKET u, const RCVSLICE* slices, int num)
+{
+   return CUDT::recvrelease(u, slices, num);
+}
+
 int64_t sendfile(UDTSOCKET u, fstream& ifs, int64_t& offset, int64_t size, int block)
 {
    return CUDT::sendfile(u, ifs, offset, size, block);
@@ -2255,18 +3048,73 @@ int64_t recvfile(UDTSOCKET u, fstream& ofs, int64_t& offset, int64_t size, int b
 
 int64_t sendfile2(UDTSOCKET u, const char* path, int64_t* offset, int64_t size, int block)
 {
+#ifndef WIN32
+   return CUDT::sendfile(u, path, *offset, size, block);
+#else
    fstream ifs(path, ios::binary | ios::in);
    int64_t ret = CUDT::sendfile(u, ifs, *offset, size, block);
    ifs.close();
    return ret;
+#endif
 }
 
 int64_t recvfile2(UDTSOCKET u, const char* path, int64_t* offset, int64_t size, int block)
 {
+#ifndef WIN32
+   return CUDT::recvfile(u, path, *offset, size, block);
+#else
    fstream ofs(path, ios::binary | ios::out);
    int64_t ret = CUDT::recvfile(u, ofs, *offset, size, block);
    ofs.close();
    return ret;
+#endif
+}
+
+#ifndef WIN32
+int64_t sendfilefd(UDTSOCKET u, int fd, int64_t* offset, int64_t size, int block)
+{
+   return CUDT::sendfile(u, fd, *offset, size, block);
+}
+
+int64_t recvfilefd(UDTSOCKET u, int fd, int64_t* offset, int64_t size, int block)
+{
+   return CUDT::recvfile(u, fd, *offset, size, block);
+}
+#endif
+
+int64_t sendfilestriped(const UDTSOCKET* socks, int num, const char* path, int block)
+{
+   return CUDT::sendfilestriped(socks, num, path, block);
+}
+
+int64_t recvfilestriped(const UDTSOCKET* socks, int num, const char* path, int64_t size, const char* manifest, int64_t stripe, int block)
+{
+   return CUDT::recvfilestriped(socks, num, path, size, manifest, stripe, block);
+}
+
+int openstream(UDTSOCKET u)
+{
+   return CUDT::openstream(u);
+}
+
+int acceptstream(UDTSOCKET u)
+{
+   return CUDT::acceptstream(u);
+}
+
+int sendstream(UDTSOCKET u, int stream, const char* buf, int len)
+{
+   return CUDT::sendstream(u, stream, buf, len);
+}
+
+int recvstream(UDTSOCKET u, int stream, char* buf, int len)
+{
+   return CUDT::recvstream(u, stream, buf, len);
+}
+
+int closestream(UDTSOCKET u, int stream)
+{
+   return CUDT::closestream(u, stream);
 }
 
 int select(int nfds, UDSET* readfds, UDSET* writefds, UDSET* exceptfds, const struct timeval* timeout)
@@ -2389,4 +3237,14 @@ UDTSTATUS getsockstate(UDTSOCKET u)
    return CUDT::getsockstate(u);
 }
 
+int savecache(const char* path)
+{
+   return CUDT::savecache(path);
+}
+
+int loadcache(const char* path)
+{
+   return CUDT::loadcache(path);
+}
+
 }  // namespace UDT
@@ -44,6 +44,7 @@ written by
 
 #include <map>
 #include <vector>
+#include <deque>
 #include "udt.h"
 #include "packet.h"
 #include "queue.h"
@@ -58,6 +59,15 @@ public:
    CUDTSocket();
    ~CUDTSocket();
 
+      // Functionality:
+      //    release the addresses and connection state of a removed socket so that it can be reused.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void reset();
+
    UDTSTATUS m_Status;                       // current socket state
 
    uint64_t m_TimeStamp;                     // time when the socket is closed
@@ -74,7 +84,7 @@ public:
 
    CUDT* m_pUDT;                             // pointer to the UDT entity
 
-   std::set<UDTSOCKET>* m_pQueuedSockets;    // set of connections waiting for accept()
+   std::deque<UDTSOCKET>* m_pQueuedSockets;  // connections waiting for accept(), in order of arrival
    std::set<UDTSOCKET>* m_pAcceptSockets;    // set of accept()ed connections
 
    pthread_cond_t m_AcceptCond;              // used to block "accept" call
@@ -167,7 +177,9 @@ public:
    int bind(const UDTSOCKET u, UDPSOCKET udpsock);
    int listen(const UDTSOCKET u, int backlog);
    UDTSOCKET accept(const UDTSOCKET listen, sockaddr* addr, int* addrlen);
-   int connect(const UDTSOCKET u, const sockaddr* name, int namelen);
+   int acceptmany(const UDTSOCKET listen, UDTSOCKET* socks, int num);
+   int connect(const UDTSOCKET u, const sockaddr* name, int namelen, const char* data = NULL, int len = 0);
+   int connectmany(const UDTSOCKET* socks, const sockaddr* names, int namelen, int num);
    int close(const UDTSOCKET u);
    int getpeername(const UDTSOCKET u, sockaddr* name, int* namelen);
    int getsockname(const UDTSOCKET u, sockaddr* name, int* namelen);
@@ -229,12 +241,31 @@ private:
    void updateMux(CUDTSocket* s, const sockaddr* addr = NULL, const UDPSOCKET* = NULL);
    void updateMux(CUDTSocket* s, const CUDTSocket* ls);
 
+      // Functionality:
+      //    Start the connection of a located socket, whose control lock the caller holds.
+      // Parameters:
+      //    0) [in] s: the socket.
+      //    1) [in] name: peer address.
+      //    2) [in] namelen: size of the address.
+      //    3) [in] data: first bytes of the stream, or NULL.
+      //    4) [in] len: size of the data.
+      //    5) [in] mux: a socket whose multiplexer an unbound socket joins, or NULL for a new one.
+      // Returned value:
+      //    size of the data taken along with the handshake.
+
+   int connect(CUDTSocket* s, const sockaddr* name, int namelen, const char* data, int len, const CUDTSocket* mux);
+
 private:
    std::map<int, CMultiplexer> m_mMultiplexer;		// UDP multiplexer
    pthread_mutex_t m_MultiplexerLock;
 
+#ifdef LINUX
+   CWorkerPool* m_pWorkerPool;				// threads shared by the multiplexers, created on first use
+#endif
+
 private:
    CCache<CInfoBlock>* m_pCache;			// UDT network information cache
+   CCache<CTokenBlock>* m_pTokenCache;			// resumption tokens issued to this host by listeners
 
 private:
    volatile bool m_bClosing;
@@ -257,6 +288,14 @@ private:
    void checkBrokenSockets();
    void removeSocket(const UDTSOCKET u);
 
+private:
+   std::vector<CUDTSocket*> m_vFreeSockets;            // removed sockets kept for reuse by new sockets and connections
+   pthread_mutex_t m_FreeLock;
+   static const int m_iMaxFreeSockets;                 // maximum number of sockets kept for reuse
+
+   CUDTSocket* allocSocket(const CUDTSocket* ls = NULL);
+   void freeSocket(CUDTSocket* s);
+
 private:
    CEPoll m_EPoll;                                     // handling epoll data structures and events
 
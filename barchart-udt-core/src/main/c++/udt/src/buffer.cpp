@@ -38,13 +38,60 @@ written by
    Yunhong Gu, last updated 03/12/2011
 *****************************************************************************/
 
+#ifndef WIN32
+   #include <sys/uio.h>
+   #include <unistd.h>
+   #include <cerrno>
+#endif
 #include <cstring>
 #include <cmath>
 #include "buffer.h"
 
 using namespace std;
 
-CSndBuffer::CSndBuffer(int size, int mss):
+// copy len bytes out of a segment list into dst; iov and pos are where the copy stopped
+static void gather(char* dst, int len, const CIOVec*& iov, int& pos)
+{
+   while (len > 0)
+   {
+      int n = iov->len - pos;
+      if (n > len)
+         n = len;
+
+      memcpy(dst, iov->data + pos, n);
+      dst += n;
+      len -= n;
+
+      if ((pos += n) == iov->len)
+      {
+         ++ iov;
+         pos = 0;
+      }
+   }
+}
+
+// the reverse of gather(), copy len bytes from src into a segment list
+static void scatter(const char* src, int len, const CIOVec*& iov, int& pos)
+{
+   while (len > 0)
+   {
+      int n = iov->len - pos;
+      if (n > len)
+         n = len;
+
+      memcpy(iov->data + pos, src, n);
+      src += n;
+      len -= n;
+
+      if ((pos += n) == iov->len)
+      {
+         ++ iov;
+         pos = 0;
+      }
+   }
+}
+
+CSndBuffer::CSndBuffer(int size, int mss, int node):
 m_BufLock(),
 m_pBlock(NULL),
 m_pFirstBlock(NULL),
@@ -53,34 +100,29 @@ m_pLastBlock(NULL),
 m_pBuffer(NULL),
 m_iNextMsgNo(1),
 m_iSize(size),
+m_iInitSize(size),
 m_iMSS(mss),
-m_iCount(0)
+m_iNode(node),
+m_iPktSize(mss),
+m_iCount(0),
+m_iCoalesceDelay(-1),
+m_bOpen(false),
+m_OpenDeadline(0),
+m_iOpenSize(0)
 {
-   // initial physical buffer of "size"
-   m_pBuffer = new Buffer;
-   m_pBuffer->m_pcData = new char [m_iSize * m_iMSS];
-   m_pBuffer->m_iSize = m_iSize;
-   m_pBuffer->m_pNext = NULL;
-
-   // circular linked list for out bound packets
+   // circular linked list for out bound packets; the packet memory is allocated by the first write
    m_pBlock = new Block;
    Block* pb = m_pBlock;
    for (int i = 1; i < m_iSize; ++ i)
    {
       pb->m_pNext = new Block;
       pb->m_iMsgNo = 0;
+      pb->m_pcData = NULL;
       pb = pb->m_pNext;
    }
    pb->m_pNext = m_pBlock;
-
-   pb = m_pBlock;
-   char* pc = m_pBuffer->m_pcData;
-   for (int i = 0; i < m_iSize; ++ i)
-   {
-      pb->m_pcData = pc;
-      pb = pb->m_pNext;
-      pc += m_iMSS;
-   }
+   m_pBlock->m_iMsgNo = 0;
+   m_pBlock->m_pcData = NULL;
 
    m_pFirstBlock = m_pCurrBlock = m_pLastBlock = m_pBlock;
 
@@ -117,28 +159,59 @@ CSndBuffer::~CSndBuffer()
    #endif
 }
 
-void CSndBuffer::addBuffer(const char* data, int len, int ttl, bool order)
+bool CSndBuffer::addBuffer(const char* data, int len, int ttl, bool order)
 {
-   int size = len / m_iMSS;
-   if ((len % m_iMSS) != 0)
+   CIOVec iov;
+   iov.data = (char*)data;
+   iov.len = len;
+
+   return addBuffer(&iov, len, ttl, order);
+}
+
+bool CSndBuffer::addBuffer(const CIOVec* iov, int len, int ttl, bool order)
+{
+   // the packet size may be changed by path MTU discovery, use one value for the whole block
+   int pktsize = m_iPktSize;
+
+   int32_t inorder = order;
+   inorder <<= 29;
+
+   int chunk = pktsize;
+   if (m_iCoalesceDelay >= 0)
+   {
+      if (len + 2 <= pktsize)
+         return addPacked(iov, len, ttl, inorder, pktsize);
+
+      // a larger message starts after the open packet; the sending thread leaves m_pLastBlock alone from here
+      CGuard::enterCS(m_BufLock);
+      if (m_bOpen)
+         closePacket();
+      CGuard::leaveCS(m_BufLock);
+
+      // solo packets are all packed, so a message short of room only for its prefix takes two packets
+      if (len <= pktsize)
+         chunk = (len + 1) / 2;
+   }
+
+   int size = len / chunk;
+   if ((len % chunk) != 0)
       size ++;
 
    // dynamically increase sender buffer
-   while (size + m_iCount >= m_iSize)
+   while ((NULL == m_pBuffer) || (size + m_iCount >= m_iSize))
       increase();
 
    uint64_t time = CTimer::getTime();
-   int32_t inorder = order;
-   inorder <<= 29;
 
+   int pos = 0;
    Block* s = m_pLastBlock;
    for (int i = 0; i < size; ++ i)
    {
-      int pktlen = len - i * m_iMSS;
-      if (pktlen > m_iMSS)
-         pktlen = m_iMSS;
+      int pktlen = len - i * chunk;
+      if (pktlen > chunk)
+         pktlen = chunk;
 
-      memcpy(s->m_pcData, data + i * m_iMSS, pktlen);
+      gather(s->m_pcData, pktlen, iov, pos);
       s->m_iLength = pktlen;
 
       s->m_iMsgNo = m_iNextMsgNo | inorder;
@@ -161,16 +234,79 @@ void CSndBuffer::addBuffer(const char* data, int len, int ttl, bool order)
    m_iNextMsgNo ++;
    if (m_iNextMsgNo == CMsgNo::m_iMaxMsgNo)
       m_iNextMsgNo = 1;
+
+   return true;
+}
+
+bool CSndBuffer::addPacked(const CIOVec* iov, int len, int ttl, int32_t inorder, int pktsize)
+{
+   CGuard bufferguard(m_BufLock);
+
+   bool ready = false;
+   Block* s = m_pLastBlock;
+
+   // messages share a packet only if they share the delivery options, the packet is dropped or delivered as one
+   if (m_bOpen && (((s->m_iMsgNo & 0x20000000) != inorder) || (s->m_iTTL != ttl) || (s->m_iLength + 2 + len > m_iOpenSize)))
+   {
+      closePacket();
+      ready = true;
+      s = m_pLastBlock;
+   }
+
+   if (!m_bOpen)
+   {
+      while ((NULL == m_pBuffer) || (1 + m_iCount >= m_iSize))
+         increase();
+
+      // the first message sets the origin time, so no message outlives its TTL
+      s->m_iLength = 0;
+      s->m_iMsgNo = m_iNextMsgNo | inorder | 0xC0000000;
+      s->m_OriginTime = CTimer::getTime();
+      s->m_iTTL = ttl;
+
+      m_iOpenSize = pktsize;
+      m_OpenDeadline = s->m_OriginTime + m_iCoalesceDelay;
+      m_bOpen = true;
+      ++ m_iCount;
+
+      m_iNextMsgNo ++;
+      if (m_iNextMsgNo == CMsgNo::m_iMaxMsgNo)
+         m_iNextMsgNo = 1;
+   }
+
+   char* p = s->m_pcData + s->m_iLength;
+   p[0] = char(len >> 8);
+   p[1] = char(len & 0xFF);
+   int pos = 0;
+   gather(p + 2, len, iov, pos);
+   s->m_iLength += 2 + len;
+
+   // no room left even for a one byte message
+   if (s->m_iLength + 3 > m_iOpenSize)
+   {
+      closePacket();
+      ready = true;
+   }
+
+   return ready;
+}
+
+void CSndBuffer::closePacket()
+{
+   m_pLastBlock = m_pLastBlock->m_pNext;
+   m_bOpen = false;
 }
 
 int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
 {
-   int size = len / m_iMSS;
-   if ((len % m_iMSS) != 0)
+   int pktsize = m_iPktSize;
+
+   int size = len / pktsize;
+   if ((len % pktsize) != 0)
       size ++;
 
    // dynamically increase sender buffer
-   while (size + m_iCount >= m_iSize)
+   while ((NULL == m_pBuffer) || (size + m_iCount >= m_iSize))
       increase();
 
    Block* s = m_pLastBlock;
@@ -180,9 +316,9 @@ int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
       if (ifs.bad() || ifs.fail() || ifs.eof())
          break;
 
-      int pktlen = len - i * m_iMSS;
-      if (pktlen > m_iMSS)
-         pktlen = m_iMSS;
+      int pktlen = len - i * pktsize;
+      if (pktlen > pktsize)
+         pktlen = pktsize;
 
       ifs.read(s->m_pcData, pktlen);
       if ((pktlen = ifs.gcount()) <= 0)
@@ -214,11 +350,116 @@ int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
    return total;
 }
 
+#ifndef WIN32
+// packets per positional read or write; a default sendfile() block takes one call
+static const int s_iFileIOV = 256;
+
+int CSndBuffer::addBufferFromFile(int fd, int64_t offset, int len)
+{
+   int pktsize = m_iPktSize;
+
+   int size = len / pktsize;
+   if ((len % pktsize) != 0)
+      size ++;
+
+   // dynamically increase sender buffer
+   while ((NULL == m_pBuffer) || (size + m_iCount >= m_iSize))
+      increase();
+
+   // the file is read into the packet memory of the blocks, with one call per batch of packets
+   iovec iov[s_iFileIOV];
+   Block* s = m_pLastBlock;
+   Block* last = NULL;
+   int count = 0;
+   int total = 0;
+   while (count < size)
+   {
+      int n = 0;
+      int want = 0;
+      Block* b = s;
+      for (; (n < s_iFileIOV) && (count + n < size); ++ n)
+      {
+         int pktlen = len - (count + n) * pktsize;
+         if (pktlen > pktsize)
+            pktlen = pktsize;
+
+         iov[n].iov_base = b->m_pcData;
+         iov[n].iov_len = pktlen;
+         want += pktlen;
+         b = b->m_pNext;
+      }
+
+      ssize_t rs = ::preadv(fd, iov, n, offset + total);
+      if ((rs < 0) && (EINTR == errno))
+         continue;
+      if (rs < 0)
+      {
+         if (0 == count)
+            return -1;
+         break;
+      }
+
+      for (int got = 0, i = 0; got < rs; ++ i)
+      {
+         int pktlen = (int)iov[i].iov_len;
+         if (pktlen > rs - got)
+            pktlen = int(rs - got);
+
+         // currently file transfer is only available in streaming mode, message is always in order, ttl = infinite
+         s->m_iMsgNo = m_iNextMsgNo | 0x20000000;
+         if (0 == count)
+            s->m_iMsgNo |= 0x80000000;
+         s->m_iLength = pktlen;
+         s->m_iTTL = -1;
+         last = s;
+         s = s->m_pNext;
+
+         got += pktlen;
+         ++ count;
+      }
+      total += int(rs);
+
+      // a short read, normally the end of the file, ends the block with the last packet it filled
+      if (rs < want)
+         break;
+   }
+
+   if (NULL == last)
+      return 0;
+
+   last->m_iMsgNo |= 0x40000000;
+   m_pLastBlock = s;
+
+   CGuard::enterCS(m_BufLock);
+   m_iCount += count;
+   CGuard::leaveCS(m_BufLock);
+
+   m_iNextMsgNo ++;
+   if (m_iNextMsgNo == CMsgNo::m_iMaxMsgNo)
+      m_iNextMsgNo = 1;
+
+   return total;
+}
+#endif
+
 int CSndBuffer::readData(char** data, int32_t& msgno)
 {
    // No data to read
    if (m_pCurrBlock == m_pLastBlock)
-      return 0;
+   {
+      if (!m_bOpen)
+         return 0;
+
+      // nothing else to send, the open packet goes out once it is due
+      CGuard bufferguard(m_BufLock);
+      if (m_pCurrBlock == m_pLastBlock)
+      {
+         if (!m_bOpen || (CTimer::getTime() < m_OpenDeadline))
+            return 0;
+
+         closePacket();
+      }
+   }
 
    *data = m_pCurrBlock->m_pcData;
    int readlen = m_pCurrBlock->m_iLength;
@@ -282,8 +523,103 @@ int CSndBuffer::getCurrBufSize() const
    return m_iCount;
 }
 
+void CSndBuffer::setPacketSize(int size)
+{
+   m_iPktSize = ((size > 0) && (size < m_iMSS)) ? size : m_iMSS;
+}
+
+void CSndBuffer::setCoalesce(int delay)
+{
+   CGuard bufferguard(m_BufLock);
+
+   m_iCoalesceDelay = delay;
+}
+
+uint64_t CSndBuffer::getFlushTime()
+{
+   CGuard bufferguard(m_BufLock);
+
+   return m_bOpen ? m_OpenDeadline : 0;
+}
+
+void CSndBuffer::release()
+{
+   CGuard bufferguard(m_BufLock);
+
+   if ((NULL == m_pBuffer) || (m_iCount > 0) || m_bOpen)
+      return;
+
+   // all blocks are free and first == current == last; keep that block, so that the sending thread sees no change
+   Block* pb = m_pLastBlock;
+   for (int i = 1; i < m_iInitSize; ++ i)
+   {
+      pb->m_pcData = NULL;
+      pb = pb->m_pNext;
+   }
+   pb->m_pcData = NULL;
+
+   Block* extra = pb->m_pNext;
+   pb->m_pNext = m_pLastBlock;
+   while (extra != m_pLastBlock)
+   {
+      Block* temp = extra;
+      extra = extra->m_pNext;
+      delete temp;
+   }
+   m_pBlock = m_pLastBlock;
+   m_iSize = m_iInitSize;
+
+   while (m_pBuffer != NULL)
+   {
+      Buffer* temp = m_pBuffer;
+      m_pBuffer = m_pBuffer->m_pNext;
+      delete [] temp->m_pcData;
+      delete temp;
+   }
+}
+
+int CSndBuffer::getMemSize() const
+{
+   int size = m_iSize * sizeof(Block);
+   for (Buffer* p = m_pBuffer; NULL != p; p = p->m_pNext)
+      size += p->m_iSize * m_iMSS;
+
+   return size;
+}
+
 void CSndBuffer::increase()
 {
+   // the first write after construction or release(): packet memory for the blocks already in the list
+   if (NULL == m_pBuffer)
+   {
+      Buffer* nbuf = NULL;
+      try
+      {
+         nbuf = new Buffer;
+         nbuf->m_pcData = new char [m_iSize * m_iMSS];
+      }
+      catch (...)
+      {
+         delete nbuf;
+         throw CUDTException(3, 2, 0);
+      }
+      nbuf->m_iSize = m_iSize;
+      nbuf->m_pNext = NULL;
+      CAffinity::setMemNode(nbuf->m_pcData, m_iSize * m_iMSS, m_iNode);
+
+      Block* pb = m_pLastBlock;
+      char* pc = nbuf->m_pcData;
+      for (int i = 0; i < m_iSize; ++ i)
+      {
+         pb->m_pcData = pc;
+         pb = pb->m_pNext;
+         pc += m_iMSS;
+      }
+
+      m_pBuffer = nbuf;
+      return;
+   }
+
    int unitsize = m_pBuffer->m_iSize;
 
    // new physical buffer
@@ -300,6 +636,7 @@ void CSndBuffer::increase()
    }
    nbuf->m_iSize = unitsize;
    nbuf->m_pNext = NULL;
+   CAffinity::setMemNode(nbuf->m_pcData, unitsize * m_iMSS, m_iNode);
 
    // insert the buffer at the end of the buffer list
    Buffer* p = m_pBuffer;
@@ -343,36 +680,107 @@ void CSndBuffer::increase()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-CRcvBuffer::CRcvBuffer(CUnitQueue* queue, int bufsize):
+CRcvBuffer::CRcvBuffer(CUnitQueue* queue, int bufsize, bool msgindex):
 m_pUnit(NULL),
 m_iSize(bufsize),
 m_pUnitQueue(queue),
 m_iStartPos(0),
 m_iLastAckPos(0),
 m_iMaxPos(0),
-m_iNotch(0)
+m_iNotch(0),
+m_iLentUnits(0),
+m_bCoalesce(false),
+m_bMsgIndex(msgindex),
+m_pMsgIndex(NULL),
+m_piReadyMsg(NULL),
+m_iMsgIndexMask(0),
+m_iReadyHead(0),
+m_iReadyTail(0),
+m_MsgIndexLock()
 {
-   m_pUnit = new CUnit* [m_iSize];
-   for (int i = 0; i < m_iSize; ++ i)
-      m_pUnit[i] = NULL;
+   // message numbers skip 0 and the maximum at wraparound, so the messages in the buffer
+   // are spread over up to bufsize + 2 consecutive slots
+   int slots = 1;
+   while (slots < bufsize + 2)
+      slots <<= 1;
+   m_iMsgIndexMask = slots - 1;
+
+   CGuard::createMutex(m_MsgIndexLock);
 }
 
 CRcvBuffer::~CRcvBuffer()
 {
-   for (int i = 0; i < m_iSize; ++ i)
+   for (int i = 0; (NULL != m_pUnit) && (i < m_iSize); ++ i)
    {
       if (NULL != m_pUnit[i])
       {
          m_pUnit[i]->m_iFlag = 0;
+         m_pUnit[i]->m_iLent = 0;
+         m_pUnit[i]->m_pLender = NULL;
          -- m_pUnitQueue->m_iCount;
       }
    }
 
+   // reclaim units the application did not release before the socket was closed;
+   // they are out of the ring, so the shared queue is searched for them
+   for (CUnitQueue::CQEntry* q = m_pUnitQueue->m_pQEntry; (m_iLentUnits > 0) && (NULL != q); q = (q == m_pUnitQueue->m_pLastQueue) ? NULL : q->m_pNext)
+   {
+      for (CUnit* u = q->m_pUnit, * end = q->m_pUnit + q->m_iSize; u != end; ++ u)
+      {
+         if ((this != u->m_pLender) || (4 != u->m_iFlag))
+            continue;
+
+         u->m_iFlag = 0;
+         u->m_iLent = 0;
+         u->m_pLender = NULL;
+         -- m_pUnitQueue->m_iCount;
+         -- m_iLentUnits;
+      }
+   }
+
    delete [] m_pUnit;
+   delete [] m_pMsgIndex;
+   delete [] m_piReadyMsg;
+
+   CGuard::releaseMutex(m_MsgIndexLock);
 }
 
 int CRcvBuffer::addData(CUnit* unit, int offset)
 {
+   // the ring is allocated by the first packet, an idle connection does not hold it
+   if (NULL == m_pUnit)
+   {
+      CUnit** units = NULL;
+      CMsgInfo* index = NULL;
+      int32_t* ready = NULL;
+
+      try
+      {
+         units = new CUnit* [m_iSize];
+         if (m_bMsgIndex)
+         {
+            index = new CMsgInfo [m_iMsgIndexMask + 1];
+            ready = new int32_t [m_iMsgIndexMask + 1];
+         }
+      }
+      catch (...)
+      {
+         delete [] units;
+         delete [] index;
+         return -1;
+      }
+
+      for (int i = 0; i < m_iSize; ++ i)
+         units[i] = NULL;
+      for (int i = 0; (NULL != index) && (i <= m_iMsgIndexMask); ++ i)
+         index[i].m_iMsgNo = -1;
+
+      m_pMsgIndex = index;
+      m_piReadyMsg = ready;
+      m_iReadyHead = m_iReadyTail = 0;
+      m_pUnit = units;
+   }
+
    int pos = (m_iLastAckPos + offset) % m_iSize;
    if (offset > m_iMaxPos)
       m_iMaxPos = offset;
@@ -383,13 +791,29 @@ int CRcvBuffer::addData(CUnit* unit, int offset)
    m_pUnit[pos] = unit;
 
    unit->m_iFlag = 1;
+   unit->m_iMsgOffset = 0;
+   unit->m_iLent = 0;
+   unit->m_pLender = NULL;
    ++ m_pUnitQueue->m_iCount;
 
+   if (m_bMsgIndex)
+      indexMsg(unit, pos);
+
    return 0;
 }
 
 int CRcvBuffer::readBuffer(char* data, int len)
 {
+   CIOVec iov;
+   iov.data = data;
+   iov.len = len;
+
+   return readBuffer(&iov, len);
+}
+
+int CRcvBuffer::readBuffer(const CIOVec* iov, int len)
+{
+   int pos = 0;
    int p = m_iStartPos;
    int lastack = m_iLastAckPos;
    int rs = len;
@@ -400,8 +824,7 @@ int CRcvBuffer::readBuffer(char* data, int len)
       if (unitsize > rs)
          unitsize = rs;
 
-      memcpy(data, m_pUnit[p]->m_Packet.m_pcData + m_iNotch, unitsize);
-      data += unitsize;
+      scatter(m_pUnit[p]->m_Packet.m_pcData + m_iNotch, unitsize, iov, pos);
 
       if ((rs > unitsize) || (rs == m_pUnit[p]->m_Packet.getLength() - m_iNotch))
       {
@@ -464,6 +887,71 @@ int CRcvBuffer::readBufferToFile(fstream& ofs, int len)
    return len - rs;
 }
 
+#ifndef WIN32
+int CRcvBuffer::readBufferToFile(int fd, int64_t offset, int len)
+{
+   int lastack = m_iLastAckPos;
+   int total = 0;
+
+   // gather the acknowledged units into one positional write per batch, without copying them
+   iovec iov[s_iFileIOV];
+   while ((m_iStartPos != lastack) && (total < len))
+   {
+      int n = 0;
+      int want = 0;
+      for (int p = m_iStartPos, notch = m_iNotch; (p != lastack) && (n < s_iFileIOV) && (total + want < len); ++ n)
+      {
+         int unitsize = m_pUnit[p]->m_Packet.getLength() - notch;
+         if (unitsize > len - total - want)
+            unitsize = len - total - want;
+
+         iov[n].iov_base = m_pUnit[p]->m_Packet.m_pcData + notch;
+         iov[n].iov_len = unitsize;
+         want += unitsize;
+
+         notch = 0;
+         if (++ p == m_iSize)
+            p = 0;
+      }
+
+      ssize_t ws = ::pwritev(fd, iov, n, offset + total);
+      if ((ws < 0) && (EINTR == errno))
+         continue;
+      if (ws <= 0)
+         return (total > 0) ? total : -1;
+
+      // release what has been written; a unit written in part keeps the rest for the next call
+      int rs = int(ws);
+      while (rs > 0)
+      {
+         int unitsize = m_pUnit[m_iStartPos]->m_Packet.getLength() - m_iNotch;
+         if (unitsize > rs)
+         {
+            m_iNotch += rs;
+            break;
+         }
+
+         CUnit* tmp = m_pUnit[m_iStartPos];
+         m_pUnit[m_iStartPos] = NULL;
+         tmp->m_iFlag = 0;
+         -- m_pUnitQueue->m_iCount;
+
+         if (++ m_iStartPos == m_iSize)
+            m_iStartPos = 0;
+
+         m_iNotch = 0;
+         rs -= unitsize;
+      }
+      total += int(ws);
+
+      if (ws < want)
+         break;
+   }
+
+   return total;
+}
+#endif
+
 void CRcvBuffer::ackData(int len)
 {
    m_iLastAckPos = (m_iLastAckPos + len) % m_iSize;
@@ -477,7 +965,8 @@ void CRcvBuffer::ackData(int len)
 int CRcvBuffer::getAvailBufSize() const
 {
    // One slot must be empty in order to tell the difference between "empty buffer" and "full buffer"
-   return m_iSize - getRcvDataSize() - 1;
+   // Lent units have left the ring but still hold queue memory, so they are not advertised as free space
+   return m_iSize - getRcvDataSize() - m_iLentUnits - 1;
 }
 
 int CRcvBuffer::getRcvDataSize() const
@@ -488,20 +977,95 @@ int CRcvBuffer::getRcvDataSize() const
    return m_iSize + m_iLastAckPos - m_iStartPos;
 }
 
+void CRcvBuffer::release()
+{
+   CGuard indexguard(m_MsgIndexLock);
+
+   // an empty ring leaves nothing in the message index either
+   if ((m_iStartPos != m_iLastAckPos) || (m_iMaxPos > 0) || (m_iLentUnits > 0))
+      return;
+
+   delete [] m_pUnit;
+   m_pUnit = NULL;
+   delete [] m_pMsgIndex;
+   m_pMsgIndex = NULL;
+   delete [] m_piReadyMsg;
+   m_piReadyMsg = NULL;
+}
+
+int CRcvBuffer::getMemSize() const
+{
+   return (NULL == m_pUnit) ? 0 : m_iSize * sizeof(CUnit*);
+}
+
 void CRcvBuffer::dropMsg(int32_t msgno)
 {
+   CGuard indexguard(m_MsgIndexLock);
+
    for (int i = m_iStartPos, n = (m_iLastAckPos + m_iMaxPos) % m_iSize; i != n; i = (i + 1) % m_iSize)
-      if ((NULL != m_pUnit[i]) && (msgno == m_pUnit[i]->m_Packet.m_iMsgNo))
+      if ((NULL != m_pUnit[i]) && (msgno == m_pUnit[i]->m_Packet.getMsgSeq()))
          m_pUnit[i]->m_iFlag = 3;
+
+   CMsgInfo* info = getMsgInfo(msgno);
+   if (NULL != info)
+      info->m_bDropped = true;
 }
 
 int CRcvBuffer::readMsg(char* data, int len)
 {
+   CIOVec iov;
+   iov.data = data;
+   iov.len = len;
+
+   return readMsg(&iov, len);
+}
+
+int CRcvBuffer::readMsg(const CIOVec* iov, int len)
+{
+   CGuard indexguard(m_MsgIndexLock);
+
    int p, q;
    bool passack;
    if (!scanMsg(p, q, passack))
       return 0;
 
+   // a packed packet is read one message per call and stays in place until its last message is read
+   if (m_bCoalesce && (p == q) && (3 == m_pUnit[p]->m_Packet.getMsgBoundary()))
+   {
+      char* msg;
+      int size;
+      bool last = unpackMsg(m_pUnit[p], msg, size);
+
+      // the rest of a message larger than the user buffer is discarded, as for a normal message
+      if (size > len)
+         size = len;
+      int pos = 0;
+      scatter(msg, size, iov, pos);
+
+      if (last)
+      {
+         if (m_bMsgIndex)
+            unindexMsg(m_pUnit[p]);
+
+         if (!passack)
+         {
+            CUnit* tmp = m_pUnit[p];
+            m_pUnit[p] = NULL;
+            freeUnit(tmp);
+
+            m_iStartPos = (p + 1) % m_iSize;
+         }
+         else
+            m_pUnit[p]->m_iFlag = 2;
+      }
+
+      return size;
+   }
+
+   if (m_bMsgIndex)
+      unindexMsg(m_pUnit[p]);
+
+   int pos = 0;
    int rs = len;
    while (p != (q + 1) % m_iSize)
    {
@@ -511,8 +1075,7 @@ int CRcvBuffer::readMsg(char* data, int len)
 
       if (unitsize > 0)
       {
-         memcpy(data, m_pUnit[p]->m_Packet.m_pcData, unitsize);
-         data += unitsize;
+         scatter(m_pUnit[p]->m_Packet.m_pcData, unitsize, iov, pos);
          rs -= unitsize;
       }
 
@@ -538,6 +1101,8 @@ int CRcvBuffer::readMsg(char* data, int len)
 
 int CRcvBuffer::getRcvMsgNum()
 {
+   CGuard indexguard(m_MsgIndexLock);
+
    int p, q;
    bool passack;
    return scanMsg(p, q, passack) ? 1 : 0;
@@ -549,6 +1114,17 @@ bool CRcvBuffer::scanMsg(int& p, int& q, bool& passack)
    if ((m_iStartPos == m_iLastAckPos) && (m_iMaxPos <= 0))
       return false;
 
+   if (m_bMsgIndex)
+   {
+      if (findMsg(p, q, passack))
+         return true;
+
+      // only a message larger than the free space can be incomplete with the buffer full;
+      // fall back to the full scan below to read it partially
+      if (m_iMaxPos + 1 < getAvailBufSize())
+         return false;
+   }
+
    //skip all bad msgs at the beginning
    while (m_iStartPos != m_iLastAckPos)
    {
@@ -584,9 +1160,10 @@ bool CRcvBuffer::scanMsg(int& p, int& q, bool& passack)
       }
 
       CUnit* tmp = m_pUnit[m_iStartPos];
+      if (m_bMsgIndex)
+         unindexMsg(tmp);
       m_pUnit[m_iStartPos] = NULL;
-      tmp->m_iFlag = 0;
-      -- m_pUnitQueue->m_iCount;
+      freeUnit(tmp);
 
       if (++ m_iStartPos == m_iSize)
          m_iStartPos = 0;
@@ -650,3 +1227,304 @@ bool CRcvBuffer::scanMsg(int& p, int& q, bool& passack)
 
    return found;
 }
+
+CRcvBuffer::CMsgInfo* CRcvBuffer::getMsgInfo(int32_t msgno)
+{
+   if ((NULL == m_pMsgIndex) || (msgno != m_pMsgIndex[msgno & m_iMsgIndexMask].m_iMsgNo))
+      return NULL;
+
+   return m_pMsgIndex + (msgno & m_iMsgIndexMask);
+}
+
+void CRcvBuffer::indexMsg(const CUnit* unit, int pos)
+{
+   int32_t msgno = unit->m_Packet.getMsgSeq();
+
+   // a slot held by another number belongs to a message that has left the buffer
+   CMsgInfo& info = m_pMsgIndex[msgno & m_iMsgIndexMask];
+   if (msgno != info.m_iMsgNo)
+   {
+      info.m_iMsgNo = -1;
+      info.m_iFirstPos = -1;
+      info.m_iLastPos = -1;
+      info.m_iPktCount = 0;
+      info.m_bInOrder = unit->m_Packet.getMsgOrderFlag();
+      info.m_bDropped = false;
+      info.m_iMsgNo = msgno;
+   }
+
+   // positions before the count, a reader that sees the message complete sees where it is
+   int boundary = unit->m_Packet.getMsgBoundary();
+   if (boundary & 2)
+      info.m_iFirstPos = pos;
+   if (boundary & 1)
+      info.m_iLastPos = pos;
+   ++ info.m_iPktCount;
+
+   // the last missing packet has arrived; a message that can skip the ACK point is queued for early delivery.
+   // The ring has room for every message the buffer can hold, a full ring only delays delivery to the ACK.
+   if (!info.m_bInOrder && isMsgComplete(info))
+   {
+      int next = (m_iReadyTail + 1) & m_iMsgIndexMask;
+      if (next != m_iReadyHead)
+      {
+         m_piReadyMsg[m_iReadyTail] = msgno;
+         m_iReadyTail = next;
+      }
+   }
+}
+
+void CRcvBuffer::unindexMsg(const CUnit* unit)
+{
+   CMsgInfo* info = getMsgInfo(unit->m_Packet.getMsgSeq());
+   if (NULL != info)
+      info->m_iMsgNo = -1;
+}
+
+bool CRcvBuffer::isMsgComplete(const CMsgInfo& info) const
+{
+   if ((info.m_iFirstPos < 0) || (info.m_iLastPos < 0) || info.m_bDropped)
+      return false;
+
+   return info.m_iPktCount == (info.m_iLastPos - info.m_iFirstPos + m_iSize) % m_iSize + 1;
+}
+
+bool CRcvBuffer::findMsg(int& p, int& q, bool& passack)
+{
+   CMsgInfo* info = NULL;
+
+   // skip all bad msgs at the beginning, the index tells if the head message is still valid
+   while (m_iStartPos != m_iLastAckPos)
+   {
+      CUnit* u = m_pUnit[m_iStartPos];
+      if (NULL != u)
+      {
+         if ((1 == u->m_iFlag) && (u->m_Packet.getMsgBoundary() > 1))
+         {
+            info = getMsgInfo(u->m_Packet.getMsgSeq());
+            if ((NULL != info) && !info->m_bDropped)
+               break;
+         }
+
+         unindexMsg(u);
+         m_pUnit[m_iStartPos] = NULL;
+         freeUnit(u);
+      }
+
+      if (++ m_iStartPos == m_iSize)
+         m_iStartPos = 0;
+   }
+
+   int acked = getRcvDataSize();
+
+   // in-order delivery: the message at the head of the buffer
+   if ((m_iStartPos != m_iLastAckPos) && isMsgComplete(*info))
+   {
+      p = m_iStartPos;
+      q = info->m_iLastPos;
+      passack = (q - p + m_iSize) % m_iSize >= acked;
+
+      if (!passack || !info->m_bInOrder)
+         return true;
+   }
+
+   // out-of-order delivery: complete messages beyond the ACK point, in order of completion
+   while (m_iReadyHead != m_iReadyTail)
+   {
+      info = getMsgInfo(m_piReadyMsg[m_iReadyHead]);
+
+      // already read, dropped, or acknowledged meanwhile and thus to be read from the head in order
+      if ((NULL == info) || !isMsgComplete(*info) || ((info->m_iLastPos - m_iStartPos + m_iSize) % m_iSize < acked))
+      {
+         m_iReadyHead = (m_iReadyHead + 1) & m_iMsgIndexMask;
+         continue;
+      }
+
+      p = info->m_iFirstPos;
+      q = info->m_iLastPos;
+      passack = true;
+
+      return true;
+   }
+
+   return false;
+}
+
+int CRcvBuffer::lendBuffer(CRcvSlice* slices, int num)
+{
+   int p = m_iStartPos;
+   int lastack = m_iLastAckPos;
+   int n = 0;
+
+   while ((p != lastack) && (n < num))
+   {
+      CUnit* tmp = m_pUnit[p];
+      m_pUnit[p] = NULL;
+      tmp->m_iFlag = 4;
+      lendUnit(tmp, slices[n]);
+      ++ m_iLentUnits;
+
+      slices[n].data = tmp->m_Packet.m_pcData + m_iNotch;
+      slices[n].len = tmp->m_Packet.getLength() - m_iNotch;
+      ++ n;
+
+      m_iNotch = 0;
+
+      if (++ p == m_iSize)
+         p = 0;
+   }
+
+   m_iStartPos = p;
+
+   return n;
+}
+
+int CRcvBuffer::lendMsg(CRcvSlice* slices, int num)
+{
+   CGuard indexguard(m_MsgIndexLock);
+
+   int p, q;
+   bool passack;
+   if (!scanMsg(p, q, passack))
+      return 0;
+
+   // an out-of-order message has to stay in place until the ACK point passes it,
+   // because its slots are still needed to detect the message as already read
+   if (passack)
+      return 0;
+
+   // one message of a packed packet per call, all its messages share the unit as handle
+   if (m_bCoalesce && (p == q) && (3 == m_pUnit[p]->m_Packet.getMsgBoundary()))
+   {
+      if (num < 1)
+         return -1;
+
+      CUnit* tmp = m_pUnit[p];
+      bool last = unpackMsg(tmp, slices[0].data, slices[0].len);
+      lendUnit(tmp, slices[0]);
+
+      if (last)
+      {
+         if (m_bMsgIndex)
+            unindexMsg(tmp);
+
+         m_pUnit[p] = NULL;
+         tmp->m_iFlag = 4;
+         ++ m_iLentUnits;
+
+         m_iStartPos = (p + 1) % m_iSize;
+      }
+
+      return 1;
+   }
+
+   int n = (q - p + m_iSize) % m_iSize + 1;
+   if (n > num)
+      return -1;
+
+   if (m_bMsgIndex)
+      unindexMsg(m_pUnit[p]);
+
+   for (int i = 0; i < n; ++ i)
+   {
+      CUnit* tmp = m_pUnit[p];
+      m_pUnit[p] = NULL;
+      tmp->m_iFlag = 4;
+      lendUnit(tmp, slices[i]);
+      ++ m_iLentUnits;
+
+      slices[i].data = tmp->m_Packet.m_pcData;
+      slices[i].len = tmp->m_Packet.getLength();
+
+      if (++ p == m_iSize)
+         p = 0;
+   }
+
+   m_iStartPos = p;
+
+   return n;
+}
+
+int CRcvBuffer::releaseUnits(const CRcvSlice* slices, int num)
+{
+   int released = 0;
+
+   for (int i = 0; i < num; ++ i)
+   {
+      CUnit* tmp = (CUnit*)slices[i].handle;
+
+      // ignore foreign handles and handles of an earlier loan, the unit may already be lent again
+      if ((NULL == tmp) || (this != tmp->m_pLender) || (tmp->m_iLent <= 0) || (slices[i].loan != tmp->m_iLoan))
+         continue;
+
+      // other messages packed in the same unit are still out
+      if (-- tmp->m_iLent > 0)
+         continue;
+
+      tmp->m_pLender = NULL;
+
+      // the unit is still in the ring while it has messages to lend
+      if (4 != tmp->m_iFlag)
+         continue;
+
+      tmp->m_iFlag = 0;
+      -- m_pUnitQueue->m_iCount;
+      -- m_iLentUnits;
+      ++ released;
+   }
+
+   return released;
+}
+
+void CRcvBuffer::lendUnit(CUnit* unit, CRcvSlice& slice)
+{
+   // the count lives in the unit itself, lending allocates nothing
+   if (0 == unit->m_iLent ++)
+   {
+      unit->m_pLender = this;
+      unit->m_iLoan = (unit->m_iLoan + 1) & 0x7FFFFFFF;
+   }
+
+   slice.handle = unit;
+   slice.loan = unit->m_iLoan;
+}
+
+void CRcvBuffer::freeUnit(CUnit* unit)
+{
+   // releaseUnits returns the unit once the last slice comes back
+   if (unit->m_iLent > 0)
+   {
+      unit->m_iFlag = 4;
+      ++ m_iLentUnits;
+      return;
+   }
+
+   unit->m_iFlag = 0;
+   -- m_pUnitQueue->m_iCount;
+}
+
+void CRcvBuffer::setCoalesce(bool packed)
+{
+   m_bCoalesce = packed;
+}
+
+bool CRcvBuffer::unpackMsg(CUnit* unit, char*& msg, int& len)
+{
+   const char* payload = unit->m_Packet.m_pcData;
+   int size = unit->m_Packet.getLength();
+   int pos = unit->m_iMsgOffset;
+
+   len = 0;
+   if (pos + 2 <= size)
+      len = ((unsigned char)payload[pos] << 8) | (unsigned char)payload[pos + 1];
+   pos += 2;
+
+   // a bad prefix must not lead the read beyond the packet
+   if (len > size - pos)
+      len = (size > pos) ? size - pos : 0;
+
+   msg = unit->m_Packet.m_pcData + pos;
+   unit->m_iMsgOffset = pos + len;
+
+   return size - unit->m_iMsgOffset < 3;
+}
@@ -50,7 +50,7 @@ written by
 class CSndBuffer
 {
 public:
-   CSndBuffer(int size = 32, int mss = 1500);
+   CSndBuffer(int size = 32, int mss = 1500, int node = -1);
    ~CSndBuffer();
 
       // Functionality:
@@ -61,9 +61,21 @@ public:
       //    2) [in] ttl: time to live in milliseconds
       //    3) [in] order: if the block should be delivered in order, for DGRAM only
       // Returned value:
-      //    None.
+      //    true if new packets are ready to send, false if the data waits in a packet open for more messages.
+
+   bool addBuffer(const char* data, int len, int ttl = -1, bool order = false);
+
+      // Functionality:
+      //    Insert a user buffer made of several segments into the sending list, as one block.
+      // Parameters:
+      //    0) [in] iov: the segments, in order.
+      //    1) [in] len: size of the block, taken from the front of the segments; no more than their total size.
+      //    2) [in] ttl: time to live in milliseconds
+      //    3) [in] order: if the block should be delivered in order, for DGRAM only
+      // Returned value:
+      //    true if new packets are ready to send, false if the data waits in a packet open for more messages.
 
-   void addBuffer(const char* data, int len, int ttl = -1, bool order = false);
+   bool addBuffer(const CIOVec* iov, int len, int ttl = -1, bool order = false);
 
       // Functionality:
       //    Read a block of data from file and insert it into the sending list.
@@ -75,6 +87,19 @@ public:
 
    int addBufferFromFile(std::fstream& ifs, int len);
 
+#ifndef WIN32
+      // Functionality:
+      //    Read a block of data from a file descriptor straight into the packet memory and insert it into the sending list.
+      // Parameters:
+      //    0) [in] fd: file descriptor open for reading.
+      //    1) [in] offset: file position of the block; the descriptor's own position is not used.
+      //    2) [in] len: size of the block.
+      // Returned value:
+      //    actual size of data added from the file, 0 at the end of the file, -1 on read failure.
+
+   int addBufferFromFile(int fd, int64_t offset, int len);
+#endif
+
       // Functionality:
       //    Find data position to pack a DATA packet from the furthest reading point.
       // Parameters:
@@ -115,9 +140,70 @@ public:
 
    int getCurrBufSize() const;
 
+      // Functionality:
+      //    Change the size that new data is cut into; blocks already in the list keep their size.
+      // Parameters:
+      //    0) [in] size: new packet payload size, no larger than the block size given at construction.
+      // Returned value:
+      //    None.
+
+   void setPacketSize(int size);
+
+      // Functionality:
+      //    Pack messages that fit in one packet together, each preceded by its 16-bit length.
+      // Parameters:
+      //    0) [in] delay: longest time in microseconds a packet waits for more messages, negative to disable.
+      // Returned value:
+      //    None.
+
+   void setCoalesce(int delay);
+
+      // Functionality:
+      //    Query when the packet still open for more messages is due.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    deadline in microseconds (CTimer::getTime), 0 if no packet is open.
+
+   uint64_t getFlushTime();
+
+      // Functionality:
+      //    Free the packet memory of an empty buffer and shrink it back to its initial size; it is allocated again by the next write.
+      //    The caller must keep writers out, readers may still run.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void release();
+
+      // Functionality:
+      //    Query the memory held by the buffer.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    size of the blocks and packet memory, in bytes.
+
+   int getMemSize() const;
+
 private:
    void increase();
 
+      // Functionality:
+      //    Append a small message to the open packet, opening a new one if it does not fit; m_BufLock is taken.
+      // Parameters:
+      //    0) [in] iov: the segments holding the message.
+      //    1) [in] len: size of the message, no more than the packet size minus the length prefix.
+      //    2) [in] ttl: time to live in milliseconds.
+      //    3) [in] inorder: in-order flag, already in its message number bit.
+      //    4) [in] pktsize: current packet size.
+      // Returned value:
+      //    true if a packet has been closed and is ready to send.
+
+   bool addPacked(const CIOVec* iov, int len, int ttl, int32_t inorder, int pktsize);
+
+   void closePacket();
+
 private:
    pthread_mutex_t m_BufLock;           // used to synchronize buffer operation
 
@@ -148,9 +234,17 @@ private:
    int32_t m_iNextMsgNo;                // next message number
 
    int m_iSize;				// buffer size (number of packets)
+   int m_iInitSize;			// number of blocks kept by release()
    int m_iMSS;                          // maximum seqment/packet size
+   int m_iNode;                         // NUMA node of the data blocks, -1: any
+   volatile int m_iPktSize;             // size that new data is cut into, no larger than m_iMSS
 
-   int m_iCount;			// number of used blocks
+   int m_iCount;			// number of used blocks, including the open packet
+
+   int m_iCoalesceDelay;                // longest wait of a packet for more messages in microseconds, negative if not packing
+   volatile bool m_bOpen;               // if m_pLastBlock is a packet still taking messages, not yet readable
+   uint64_t m_OpenDeadline;             // time the open packet must be sent
+   int m_iOpenSize;                     // packet size when the open packet was started
 
 private:
    CSndBuffer(const CSndBuffer&);
@@ -162,7 +256,7 @@ private:
 class CRcvBuffer
 {
 public:
-   CRcvBuffer(CUnitQueue* queue, int bufsize = 65536);
+   CRcvBuffer(CUnitQueue* queue, int bufsize = 65536, bool msgindex = false);
    ~CRcvBuffer();
 
       // Functionality:
@@ -185,6 +279,16 @@ public:
 
    int readBuffer(char* data, int len);
 
+      // Functionality:
+      //    Read data into several user buffers, filling each before the next.
+      // Parameters:
+      //    0) [in] iov: the user buffers, in order.
+      //    1) [in] len: total size of the user buffers.
+      // Returned value:
+      //    size of data read.
+
+   int readBuffer(const CIOVec* iov, int len);
+
       // Functionality:
       //    Read data directly into file.
       // Parameters:
@@ -195,6 +299,19 @@ public:
 
    int readBufferToFile(std::fstream& ofs, int len);
 
+#ifndef WIN32
+      // Functionality:
+      //    Write data into a file descriptor at a given position, straight from the receiving units.
+      // Parameters:
+      //    0) [in] fd: file descriptor open for writing.
+      //    1) [in] offset: file position to write at; the descriptor's own position is not used.
+      //    2) [in] len: maximum size of data to write.
+      // Returned value:
+      //    size of data written, -1 on write failure.
+
+   int readBufferToFile(int fd, int64_t offset, int len);
+#endif
+
       // Functionality:
       //    Update the ACK point of the buffer.
       // Parameters:
@@ -241,6 +358,16 @@ public:
 
    int readMsg(char* data, int len);
 
+      // Functionality:
+      //    read a message into several buffers, filling each before the next.
+      // Parameters:
+      //    0) [in] iov: the buffers to write the message into.
+      //    1) [in] len: total size of the buffers.
+      // Returned value:
+      //    actuall size of data read.
+
+   int readMsg(const CIOVec* iov, int len);
+
       // Functionality:
       //    Query how many messages are available now.
       // Parameters:
@@ -250,11 +377,152 @@ public:
 
    int getRcvMsgNum();
 
+      // Functionality:
+      //    Lend acknowledged data to the application without copying it out of the protocol buffer.
+      // Parameters:
+      //    0) [out] slices: array to store the payload views.
+      //    1) [in] num: size of the array.
+      // Returned value:
+      //    number of slices lent.
+
+   int lendBuffer(CRcvSlice* slices, int num);
+
+      // Functionality:
+      //    Lend the next complete message to the application without copying it.
+      // Parameters:
+      //    0) [out] slices: array to store the payload views, one per packet of the message.
+      //    1) [in] num: size of the array.
+      // Returned value:
+      //    number of slices lent, 0 if no message is ready, -1 if the array is too small for the message.
+
+   int lendMsg(CRcvSlice* slices, int num);
+
+      // Functionality:
+      //    Return lent units to the shared unit queue.
+      // Parameters:
+      //    0) [in] slices: payload views previously returned by lendBuffer/lendMsg.
+      //    1) [in] num: number of slices.
+      // Returned value:
+      //    number of units released; slices not lent by this buffer, or from an earlier loan of the unit, are ignored.
+      //    Releasing a slice twice while other messages packed in the same unit are still out is undefined.
+
+   int releaseUnits(const CRcvSlice* slices, int num);
+
+      // Functionality:
+      //    Tell if the peer packs several messages into one solo packet.
+      // Parameters:
+      //    0) [in] packed: true if solo packets carry length prefixed messages.
+      // Returned value:
+      //    None.
+
+   void setCoalesce(bool packed);
+
+      // Functionality:
+      //    Free the unit array of an empty buffer; it is allocated again by the next addData().
+      //    The caller must keep readers out, and call it from the thread that adds data.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void release();
+
+      // Functionality:
+      //    Query the memory held by the buffer, not counting the shared units.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    size of the unit array, in bytes.
+
+   int getMemSize() const;
+
 private:
    bool scanMsg(int& start, int& end, bool& passack);
 
+      // Functionality:
+      //    Locate the next message packed in a unit and move the unit's read offset past it.
+      // Parameters:
+      //    0) [in] unit: a solo packet unit of a packing peer.
+      //    1) [out] msg: pointer to the message.
+      //    2) [out] len: size of the message.
+      // Returned value:
+      //    true if it is the last message of the unit.
+
+   bool unpackMsg(CUnit* unit, char*& msg, int& len);
+
+      // Functionality:
+      //    Count one more slice of a unit as held by the application and tag the slice with the unit's loan.
+      // Parameters:
+      //    0) [in] unit: the unit a slice is lent from.
+      //    1) [out] slice: the slice, its handle and loan are filled in.
+      // Returned value:
+      //    None.
+
+   void lendUnit(CUnit* unit, CRcvSlice& slice);
+
+      // Functionality:
+      //    Give back a unit taken out of the ring; a packed unit with messages still lent stays on loan instead.
+      // Parameters:
+      //    0) [in] unit: the unit, no longer in the ring.
+      // Returned value:
+      //    None.
+
+   void freeUnit(CUnit* unit);
+
 private:
-   CUnit** m_pUnit;                     // pointer to the protocol buffer
+   struct CMsgInfo
+   {
+      int32_t m_iMsgNo;                 // message number the slot belongs to, -1 if the slot is free
+      int m_iFirstPos;                  // position of the first packet, -1 if not received yet
+      int m_iLastPos;                   // position of the last packet, -1 if not received yet
+      int m_iPktCount;                  // number of packets of the message in the buffer
+      bool m_bInOrder;                  // if the message must be delivered in order
+      bool m_bDropped;                  // if the message has been dropped by the sender
+   };
+
+      // Functionality:
+      //    Look up the index slot of a message.
+      // Parameters:
+      //    0) [in] msgno: message number.
+      // Returned value:
+      //    the slot of the message, NULL if the message is not indexed.
+
+   CMsgInfo* getMsgInfo(int32_t msgno);
+
+      // Functionality:
+      //    Record a newly arrived unit in the message index.
+      // Parameters:
+      //    0) [in] unit: the new data unit.
+      //    1) [in] pos: position of the unit in the protocol buffer.
+      // Returned value:
+      //    None.
+
+   void indexMsg(const CUnit* unit, int pos);
+
+      // Functionality:
+      //    Remove the message that a unit belongs to from the message index.
+      // Parameters:
+      //    0) [in] unit: a data unit leaving the protocol buffer.
+      // Returned value:
+      //    None.
+
+   void unindexMsg(const CUnit* unit);
+
+      // Functionality:
+      //    Locate the next deliverable message using the message index.
+      // Parameters:
+      //    0) [out] start: position of the first packet of the message.
+      //    1) [out] end: position of the last packet of the message.
+      //    2) [out] passack: if the message is beyond the ACK point (read out of order).
+      // Returned value:
+      //    true if a message is found, otherwise false.
+
+   bool findMsg(int& start, int& end, bool& passack);
+
+   bool isMsgComplete(const CMsgInfo& info) const;
+
+private:
+   CUnit** m_pUnit;                     // pointer to the protocol buffer, NULL until the first packet arrives
    int m_iSize;                         // size of the protocol buffer
    CUnitQueue* m_pUnitQueue;		// the shared unit queue
 
@@ -265,6 +533,18 @@ private:
 
    int m_iNotch;			// the starting read point of the first unit
 
+   int m_iLentUnits;                    // number of lent units out of the buffer, readable without locking
+
+   bool m_bCoalesce;                    // if solo packets carry several length prefixed messages
+
+   bool m_bMsgIndex;                    // if the message index is maintained (message mode only)
+   CMsgInfo* m_pMsgIndex;               // messages with units in the buffer, one slot per message number modulo the slot count
+   int32_t* m_piReadyMsg;               // ring of complete messages that may be read before the ACK point reaches them
+   int m_iMsgIndexMask;                 // slot count - 1, for both rings above
+   volatile int m_iReadyHead;           // next ready message to look at, moved by readers only
+   volatile int m_iReadyTail;           // next free entry of the ready ring, moved by the receiving thread only
+   pthread_mutex_t m_MsgIndexLock;      // serializes readers; the receiving thread adds to the index without it
+
 private:
    CRcvBuffer();
    CRcvBuffer(const CRcvBuffer&);
@@ -44,6 +44,11 @@ written by
    #ifdef LEGACY_WIN32
       #include <wspiapi.h>
    #endif
+#else
+   #include <fcntl.h>
+   #include <unistd.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
 #endif
 
 #include <cstring>
@@ -52,9 +57,14 @@ written by
 
 using namespace std;
 
+CInfoBlock::CInfoBlock(const CInfoBlock& obj)
+{
+   *this = obj;
+}
+
 CInfoBlock& CInfoBlock::operator=(const CInfoBlock& obj)
 {
-   std::copy(obj.m_piIP, obj.m_piIP + 3, m_piIP);
+   std::copy(obj.m_piIP, obj.m_piIP + 4, m_piIP);
    m_iIPversion = obj.m_iIPversion;
    m_ullTimeStamp = obj.m_ullTimeStamp;
    m_iRTT = obj.m_iRTT;
@@ -88,7 +98,7 @@ CInfoBlock* CInfoBlock::clone()
 {
    CInfoBlock* obj = new CInfoBlock;
 
-   std::copy(m_piIP, m_piIP + 3, obj->m_piIP);
+   std::copy(m_piIP, m_piIP + 4, obj->m_piIP);
    obj->m_iIPversion = m_iIPversion;
    obj->m_ullTimeStamp = m_ullTimeStamp;
    obj->m_iRTT = m_iRTT;
@@ -109,6 +119,39 @@ int CInfoBlock::getKey()
    return m_piIP[0] + m_piIP[1] + m_piIP[2] + m_piIP[3];
 }
 
+void CInfoBlock::save(char* record) const
+{
+   int32_t fields[6] = {m_iIPversion, m_iRTT, m_iBandwidth, m_iLossRate, m_iReorderDistance, 0};
+
+   memcpy(record, m_piIP, 16);
+   memcpy(record + 16, fields, 24);
+   memcpy(record + 40, &m_ullTimeStamp, 8);
+   memcpy(record + 48, &m_dInterval, 8);
+   memcpy(record + 56, &m_dCWnd, 8);
+}
+
+bool CInfoBlock::load(const char* record, int64_t shift)
+{
+   int32_t fields[6];
+
+   memcpy(m_piIP, record, 16);
+   memcpy(fields, record + 16, 24);
+   memcpy(&m_ullTimeStamp, record + 40, 8);
+   memcpy(&m_dInterval, record + 48, 8);
+   memcpy(&m_dCWnd, record + 56, 8);
+
+   m_iIPversion = fields[0];
+   m_iRTT = fields[1];
+   m_iBandwidth = fields[2];
+   m_iLossRate = fields[3];
+   m_iReorderDistance = fields[4];
+
+   // entries from before the local clock started are kept, but stamped as the oldest possible
+   m_ullTimeStamp = ((int64_t)m_ullTimeStamp + shift > 0) ? m_ullTimeStamp + shift : 1;
+
+   return ((AF_INET == m_iIPversion) || (AF_INET6 == m_iIPversion)) && (m_iRTT > 0) && (m_iBandwidth > 0) && (m_dInterval >= 0) && (m_dCWnd >= 0);
+}
+
 void CInfoBlock::convert(const sockaddr* addr, int ver, uint32_t ip[])
 {
    if (ver == AF_INET)
@@ -121,3 +164,180 @@ void CInfoBlock::convert(const sockaddr* addr, int ver, uint32_t ip[])
       memcpy((char*)ip, (char*)((sockaddr_in6*)addr)->sin6_addr.s6_addr, 16);
    }
 }
+
+CTokenBlock::CTokenBlock():
+m_iIPversion(0),
+m_iPort(0),
+m_ullTimeStamp(0)
+{
+   for (int i = 0; i < 4; ++ i)
+      m_piIP[i] = 0;
+   for (int i = 0; i < 6; ++ i)
+      m_piToken[i] = 0;
+}
+
+CTokenBlock& CTokenBlock::operator=(const CTokenBlock& obj)
+{
+   std::copy(obj.m_piIP, obj.m_piIP + 4, m_piIP);
+   m_iIPversion = obj.m_iIPversion;
+   m_iPort = obj.m_iPort;
+   m_ullTimeStamp = obj.m_ullTimeStamp;
+   std::copy(obj.m_piToken, obj.m_piToken + 6, m_piToken);
+
+   return *this;
+}
+
+bool CTokenBlock::operator==(const CTokenBlock& obj)
+{
+   if ((m_iIPversion != obj.m_iIPversion) || (m_iPort != obj.m_iPort))
+      return false;
+
+   for (int i = 0; i < 4; ++ i)
+   {
+      if (m_piIP[i] != obj.m_piIP[i])
+         return false;
+   }
+
+   return true;
+}
+
+int CTokenBlock::getKey()
+{
+   return m_piIP[0] + m_piIP[1] + m_piIP[2] + m_piIP[3] + m_iPort * 2654435761U;
+}
+
+void CTokenBlock::setAddr(const sockaddr* addr, int ver)
+{
+   CInfoBlock::convert(addr, ver, m_piIP);
+   m_iIPversion = ver;
+   m_iPort = (AF_INET == ver) ? ntohs(((sockaddr_in*)addr)->sin_port) : ntohs(((sockaddr_in6*)addr)->sin6_port);
+}
+
+CMappedFile::CMappedFile():
+m_pcData(NULL),
+m_iSize(0),
+m_bWrite(false),
+m_iError(0)
+{
+   #ifndef WIN32
+      m_iFile = -1;
+   #else
+      m_hFile = INVALID_HANDLE_VALUE;
+      m_hMapping = NULL;
+   #endif
+}
+
+CMappedFile::~CMappedFile()
+{
+   unmap();
+}
+
+char* CMappedFile::map(const char* path, int size)
+{
+   unmap();
+
+   m_bWrite = (size > 0);
+
+   #ifndef WIN32
+      m_iFile = ::open(path, m_bWrite ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY, 0644);
+      if (m_iFile < 0)
+      {
+         m_iError = errno;
+         return NULL;
+      }
+
+      if (m_bWrite)
+      {
+         if (::ftruncate(m_iFile, size) < 0)
+         {
+            m_iError = errno;
+            unmap();
+            return NULL;
+         }
+      }
+      else
+      {
+         struct stat st;
+         if ((::fstat(m_iFile, &st) < 0) || (st.st_size <= 0) || (st.st_size > 0x7FFFFFFF))
+         {
+            m_iError = errno;
+            unmap();
+            return NULL;
+         }
+         size = (int)st.st_size;
+      }
+
+      void* p = ::mmap(NULL, size, m_bWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, m_bWrite ? MAP_SHARED : MAP_PRIVATE, m_iFile, 0);
+      if (MAP_FAILED == p)
+      {
+         m_iError = errno;
+         unmap();
+         return NULL;
+      }
+   #else
+      m_hFile = CreateFileA(path, m_bWrite ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ, NULL, m_bWrite ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+      if (INVALID_HANDLE_VALUE == m_hFile)
+      {
+         m_iError = GetLastError();
+         return NULL;
+      }
+
+      if (!m_bWrite)
+      {
+         DWORD high = 0;
+         DWORD low = GetFileSize(m_hFile, &high);
+         if ((0 != high) || (0 == low) || (low > 0x7FFFFFFF))
+         {
+            m_iError = GetLastError();
+            unmap();
+            return NULL;
+         }
+         size = (int)low;
+      }
+
+      m_hMapping = CreateFileMapping(m_hFile, NULL, m_bWrite ? PAGE_READWRITE : PAGE_READONLY, 0, size, NULL);
+      void* p = (NULL == m_hMapping) ? NULL : MapViewOfFile(m_hMapping, m_bWrite ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+      if (NULL == p)
+      {
+         m_iError = GetLastError();
+         unmap();
+         return NULL;
+      }
+   #endif
+
+   m_pcData = (char*)p;
+   m_iSize = size;
+
+   return m_pcData;
+}
+
+void CMappedFile::unmap()
+{
+   #ifndef WIN32
+      if (NULL != m_pcData)
+      {
+         if (m_bWrite)
+            ::msync(m_pcData, m_iSize, MS_SYNC);
+         ::munmap(m_pcData, m_iSize);
+      }
+      if (m_iFile >= 0)
+         ::close(m_iFile);
+      m_iFile = -1;
+   #else
+      if (NULL != m_pcData)
+      {
+         if (m_bWrite)
+            FlushViewOfFile(m_pcData, 0);
+         UnmapViewOfFile(m_pcData);
+      }
+      if (NULL != m_hMapping)
+         CloseHandle(m_hMapping);
+      if (INVALID_HANDLE_VALUE != m_hFile)
+         CloseHandle(m_hFile);
+      m_hMapping = NULL;
+      m_hFile = INVALID_HANDLE_VALUE;
+   #endif
+
+   m_pcData = NULL;
+   m_iSize = 0;
+}
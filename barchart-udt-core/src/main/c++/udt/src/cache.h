@@ -41,8 +41,12 @@ written by
 #ifndef __UDT_CACHE_H__
 #define __UDT_CACHE_H__
 
-#include <list>
+#include <string>
 #include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 
 #include "common.h"
 #include "udt.h"
@@ -81,22 +85,72 @@ public:
    virtual void release() {}
 };
 
+class CMappedFile
+{
+public:
+   CMappedFile();
+   ~CMappedFile();
+
+public:
+
+      // Functionality:
+      //    map a file into memory, creating or truncating it to "size" bytes for writing.
+      // Parameters:
+      //    0) [in] path: file name.
+      //    1) [in] size: size of the new file, or 0 to map an existing file read only.
+      // Returned value:
+      //    Pointer to the mapped memory, or NULL if failed.
+
+   char* map(const char* path, int size = 0);
+
+      // Functionality:
+      //    unmap the file, writing the changes back first.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void unmap();
+
+   int getSize() const {return m_iSize;}
+   int getError() const {return m_iError;}
+
+private:
+   char* m_pcData;
+   int m_iSize;
+   bool m_bWrite;
+   int m_iError;                // system error of the last failure
+
+   #ifndef WIN32
+      int m_iFile;
+   #else
+      HANDLE m_hFile;
+      HANDLE m_hMapping;
+   #endif
+
+private:
+   CMappedFile(const CMappedFile&);
+   CMappedFile& operator=(const CMappedFile&);
+};
+
+// The cache is split into shards, each with its own lock, so that connections to
+// different peers do not contend. Each shard keeps its items in a slot array allocated
+// up front; the LRU order, the hash chains and the free list are indexes into that array.
 template<typename T> class CCache
 {
 public:
    CCache(int size = 1024):
-   m_iMaxSize(size),
-   m_iHashSize(size * 3),
-   m_iCurrSize(0)
+   m_iMaxSize(0)
    {
-      m_vHashPtr.resize(m_iHashSize);
-      CGuard::createMutex(m_Lock);
+      for (int i = 0; i < m_iShards; ++ i)
+         CGuard::createMutex(m_pShard[i].m_Lock);
+      setSizeLimit(size);
    }
 
    ~CCache()
    {
-      clear();
-      CGuard::releaseMutex(m_Lock);
+      for (int i = 0; i < m_iShards; ++ i)
+         CGuard::releaseMutex(m_pShard[i].m_Lock);
    }
 
 public:
@@ -109,26 +163,17 @@ public:
 
    int lookup(T* data)
    {
-      CGuard cacheguard(m_Lock);
+      unsigned int key = (unsigned int)data->getKey();
+      CShard& sh = m_pShard[key % m_iShards];
+      CGuard cacheguard(sh.m_Lock);
 
-      int key = data->getKey();
-      if (key < 0)
+      int i = find(sh, data, key);
+      if (i < 0)
          return -1;
-      if (key >= m_iMaxSize)
-         key %= m_iHashSize;
-
-      const ItemPtrList& item_list = m_vHashPtr[key];
-      for (typename ItemPtrList::const_iterator i = item_list.begin(); i != item_list.end(); ++ i)
-      {
-         if (*data == ***i)
-         {
-            // copy the cached info
-            *data = ***i;
-            return 0;
-         }
-      }
 
-      return -1;
+      // copy the cached info
+      *data = sh.m_vSlot[i].m_Item;
+      return 0;
    }
 
       // Functionality:
@@ -140,70 +185,49 @@ public:
 
    int update(T* data)
    {
-      CGuard cacheguard(m_Lock);
+      unsigned int key = (unsigned int)data->getKey();
+      CShard& sh = m_pShard[key % m_iShards];
+      CGuard cacheguard(sh.m_Lock);
 
-      int key = data->getKey();
-      if (key < 0)
+      if (sh.m_vSlot.empty())
          return -1;
-      if (key >= m_iMaxSize)
-         key %= m_iHashSize;
 
-      T* curr = NULL;
-
-      ItemPtrList& item_list = m_vHashPtr[key];
-      for (typename ItemPtrList::iterator i = item_list.begin(); i != item_list.end(); ++ i)
+      int i = find(sh, data, key);
+      if (i >= 0)
       {
-         if (*data == ***i)
-         {
-            // update the existing entry with the new value
-            ***i = *data;
-            curr = **i;
-
-            // remove the current entry
-            m_StorageList.erase(*i);
-            item_list.erase(i);
-
-            // re-insert to the front
-            m_StorageList.push_front(curr);
-            item_list.push_front(m_StorageList.begin());
-
-            return 0;
-         }
+         // update the existing entry with the new value, and move it to the front
+         sh.m_vSlot[i].m_Item = *data;
+         unlink(sh, i);
+         pushFront(sh, i);
+         return 0;
       }
 
-      // create new entry and insert to front
-      curr = data->clone();
-      m_StorageList.push_front(curr);
-      item_list.push_front(m_StorageList.begin());
-
-      ++ m_iCurrSize;
-      if (m_iCurrSize >= m_iMaxSize)
+      if (sh.m_iFree >= 0)
       {
-         // Cache overflow, remove oldest entry.
-         T* last_data = m_StorageList.back();
-         int last_key = last_data->getKey() % m_iHashSize;
-
-         item_list = m_vHashPtr[last_key];
-         for (typename ItemPtrList::iterator i = item_list.begin(); i != item_list.end(); ++ i)
-         {
-            if (*last_data == ***i)
-            {
-               item_list.erase(i);
-               break;
-            }
-         }
-
-         last_data->release();
-         delete last_data;
-         m_StorageList.pop_back();
-         -- m_iCurrSize;
+         i = sh.m_iFree;
+         sh.m_iFree = sh.m_vSlot[i].m_iNext;
       }
+      else
+      {
+         // Cache overflow, reuse the oldest entry.
+         i = sh.m_iTail;
+         unlink(sh, i);
+         unhash(sh, i);
+      }
+
+      CSlot& slot = sh.m_vSlot[i];
+      slot.m_Item = *data;
+      slot.m_iKey = key;
+      int& bucket = sh.m_viHash[(key / m_iShards) % sh.m_viHash.size()];
+      slot.m_iHashNext = bucket;
+      bucket = i;
+      pushFront(sh, i);
 
       return 0;
    }
 
       // Functionality:
-      //    Specify the cache size (i.e., max number of items).
+      //    Specify the cache size (i.e., max number of items). Existing items are dropped.
       // Parameters:
       //    0) [in] size: max cache size.
       // Returned value:
@@ -212,8 +236,17 @@ public:
    void setSizeLimit(int size)
    {
       m_iMaxSize = size;
-      m_iHashSize = size * 3;
-      m_vHashPtr.resize(m_iHashSize);
+      int slots = (size + m_iShards - 1) / m_iShards;
+
+      for (int s = 0; s < m_iShards; ++ s)
+      {
+         CShard& sh = m_pShard[s];
+         CGuard cacheguard(sh.m_Lock);
+         sh.m_vSlot.clear();
+         sh.m_vSlot.resize(slots);
+         sh.m_viHash.assign(slots * 2 + 1, -1);
+         reset(sh);
+      }
    }
 
       // Functionality:
@@ -225,28 +258,187 @@ public:
 
    void clear()
    {
-      for (typename std::list<T*>::iterator i = m_StorageList.begin(); i != m_StorageList.end(); ++ i)
+      for (int s = 0; s < m_iShards; ++ s)
       {
-         (*i)->release();
-         delete *i;
+         CShard& sh = m_pShard[s];
+         CGuard cacheguard(sh.m_Lock);
+         sh.m_viHash.assign(sh.m_viHash.size(), -1);
+         reset(sh);
       }
-      m_StorageList.clear();
-      for (typename std::vector<ItemPtrList>::iterator i = m_vHashPtr.begin(); i != m_vHashPtr.end(); ++ i)
-         i->clear();
-      m_iCurrSize = 0;
    }
 
-private:
-   std::list<T*> m_StorageList;
-   typedef typename std::list<T*>::iterator ItemPtr;
-   typedef std::list<ItemPtr> ItemPtrList;
-   std::vector<ItemPtrList> m_vHashPtr;
+      // Functionality:
+      //    Write all entries to a file, oldest first, through a memory mapping.
+      //    T must provide m_iRecordSize and save(char* record).
+      // Parameters:
+      //    0) [in] path: file name; the file is written under a temporary name and then renamed.
+      // Returned value:
+      //    Number of entries written; throws CUDTException if failed.
+
+   int snapshot(const char* path)
+   {
+      std::vector<T> items;
+      for (int s = 0; s < m_iShards; ++ s)
+      {
+         CShard& sh = m_pShard[s];
+         CGuard cacheguard(sh.m_Lock);
+         for (int i = sh.m_iTail; i >= 0; i = sh.m_vSlot[i].m_iPrev)
+            items.push_back(sh.m_vSlot[i].m_Item);
+      }
+
+      std::string tmp = std::string(path) + ".tmp";
+      CMappedFile file;
+      char* p = file.map(tmp.c_str(), m_iHeaderSize + (int)items.size() * T::m_iRecordSize);
+      if (NULL == p)
+         throw CUDTException(4, 4, file.getError());
+
+      int32_t header[4] = {m_iMagic, T::m_iRecordSize, (int32_t)items.size(), 0};
+      uint64_t now = CTimer::getTime();
+      int64_t wall = (int64_t)time(NULL);
+      memcpy(p, header, 16);
+      memcpy(p + 16, &now, 8);
+      memcpy(p + 24, &wall, 8);
+      for (int i = 0; i < (int)items.size(); ++ i)
+         items[i].save(p + m_iHeaderSize + i * T::m_iRecordSize);
+      file.unmap();
+
+      #ifndef WIN32
+         if (::rename(tmp.c_str(), path) < 0)
+            throw CUDTException(4, 4, errno);
+      #else
+         if (!MoveFileExA(tmp.c_str(), path, MOVEFILE_REPLACE_EXISTING))
+            throw CUDTException(4, 4, GetLastError());
+      #endif
+
+      return (int)items.size();
+   }
+
+      // Functionality:
+      //    Load the entries of a file written by snapshot(); the existing entries are kept unless replaced.
+      //    T must provide m_iRecordSize and load(const char* record, int64_t shift).
+      // Parameters:
+      //    0) [in] path: file name.
+      // Returned value:
+      //    Number of entries loaded; throws CUDTException if failed.
+
+   int restore(const char* path)
+   {
+      CMappedFile file;
+      char* p = file.map(path);
+      if (NULL == p)
+         throw CUDTException(4, 2, file.getError());
+
+      int32_t header[4];
+      uint64_t then;
+      int64_t wall;
+      if (file.getSize() >= m_iHeaderSize)
+      {
+         memcpy(header, p, 16);
+         memcpy(&then, p + 16, 8);
+         memcpy(&wall, p + 24, 8);
+      }
+      if ((file.getSize() < m_iHeaderSize) || (m_iMagic != header[0]) || (T::m_iRecordSize != header[1]) || (header[2] < 0) || ((file.getSize() - m_iHeaderSize) / T::m_iRecordSize < header[2]))
+         throw CUDTException(4, 2, 0);
 
+      // the local clock may have restarted, move the time stamps by the wall clock time elapsed since the snapshot
+      int64_t elapsed = (int64_t)time(NULL) - wall;
+      if (elapsed < 0)
+         elapsed = 0;
+      int64_t shift = (int64_t)CTimer::getTime() - (int64_t)then - elapsed * 1000000;
+
+      int count = 0;
+      for (int i = 0; i < header[2]; ++ i)
+      {
+         T item;
+         if (item.load(p + m_iHeaderSize + i * T::m_iRecordSize, shift) && (0 == update(&item)))
+            ++ count;
+      }
+
+      return count;
+   }
+
+private:
+   struct CSlot
+   {
+      T m_Item;
+      unsigned int m_iKey;
+      int m_iPrev;                 // LRU neighbours, toward the newest and the oldest
+      int m_iNext;                 // also links the free slots
+      int m_iHashNext;             // next slot in the same hash bucket
+   };
+
+   struct CShard
+   {
+      std::vector<CSlot> m_vSlot;
+      std::vector<int> m_viHash;   // first slot of each hash bucket
+      int m_iHead;                 // newest item
+      int m_iTail;                 // oldest item
+      int m_iFree;                 // first free slot
+      pthread_mutex_t m_Lock;
+   };
+
+   static const int m_iShards = 16;
+   static const int m_iHeaderSize = 32;
+   static const int32_t m_iMagic = 0x43544455;   // "UDTC"
+
+   CShard m_pShard[m_iShards];
    int m_iMaxSize;
-   int m_iHashSize;
-   int m_iCurrSize;
 
-   pthread_mutex_t m_Lock;
+private:
+   int find(CShard& sh, T* data, unsigned int key)
+   {
+      if (sh.m_viHash.empty())
+         return -1;
+
+      for (int i = sh.m_viHash[(key / m_iShards) % sh.m_viHash.size()]; i >= 0; i = sh.m_vSlot[i].m_iHashNext)
+      {
+         if ((sh.m_vSlot[i].m_iKey == key) && (*data == sh.m_vSlot[i].m_Item))
+            return i;
+      }
+
+      return -1;
+   }
+
+   void unhash(CShard& sh, int i)
+   {
+      int* p = &sh.m_viHash[(sh.m_vSlot[i].m_iKey / m_iShards) % sh.m_viHash.size()];
+      while (*p != i)
+         p = &sh.m_vSlot[*p].m_iHashNext;
+      *p = sh.m_vSlot[i].m_iHashNext;
+   }
+
+   void unlink(CShard& sh, int i)
+   {
+      CSlot& slot = sh.m_vSlot[i];
+      if (slot.m_iPrev >= 0)
+         sh.m_vSlot[slot.m_iPrev].m_iNext = slot.m_iNext;
+      else
+         sh.m_iHead = slot.m_iNext;
+      if (slot.m_iNext >= 0)
+         sh.m_vSlot[slot.m_iNext].m_iPrev = slot.m_iPrev;
+      else
+         sh.m_iTail = slot.m_iPrev;
+   }
+
+   void pushFront(CShard& sh, int i)
+   {
+      CSlot& slot = sh.m_vSlot[i];
+      slot.m_iPrev = -1;
+      slot.m_iNext = sh.m_iHead;
+      if (sh.m_iHead >= 0)
+         sh.m_vSlot[sh.m_iHead].m_iPrev = i;
+      else
+         sh.m_iTail = i;
+      sh.m_iHead = i;
+   }
+
+   void reset(CShard& sh)
+   {
+      sh.m_iHead = sh.m_iTail = -1;
+      sh.m_iFree = sh.m_vSlot.empty() ? -1 : 0;
+      for (int i = 0; i < (int)sh.m_vSlot.size(); ++ i)
+         sh.m_vSlot[i].m_iNext = (i + 1 < (int)sh.m_vSlot.size()) ? i + 1 : -1;
+   }
 
 private:
    CCache(const CCache&);
@@ -268,6 +460,8 @@ public:
    double m_dCWnd;		// congestion window size, congestion control
 
 public:
+   CInfoBlock() {}
+   CInfoBlock(const CInfoBlock& obj);
    virtual ~CInfoBlock() {}
    virtual CInfoBlock& operator=(const CInfoBlock& obj);
    virtual bool operator==(const CInfoBlock& obj);
@@ -276,6 +470,18 @@ public:
    virtual void release() {}
 
 public:
+   static const int m_iRecordSize = 64;	// size of an entry in a cache snapshot file
+
+      // Functionality:
+      //    write the entry to, or read it from, a record of a cache snapshot file.
+      // Parameters:
+      //    0) [in/out] record: m_iRecordSize bytes.
+      //    1) [in] shift: amount added to the time stamp, microseconds.
+      // Returned value:
+      //    load returns false if the record is not valid.
+
+   void save(char* record) const;
+   bool load(const char* record, int64_t shift);
 
       // Functionality:
       //    convert sockaddr structure to an integer array
@@ -290,4 +496,32 @@ public:
 };
 
 
+// A resumption token a listener has issued, kept by the client for the next connection to the same address.
+class CTokenBlock
+{
+public:
+   uint32_t m_piIP[4];		// IP address of the listener, machine read only
+   int m_iIPversion;		// IP version
+   int m_iPort;			// UDP port of the listener
+   uint64_t m_ullTimeStamp;	// when the token was received; 0 if the listener has stopped issuing them
+   int32_t m_piToken[6];	// the token, see CHandShake::m_piToken
+
+public:
+   CTokenBlock();
+   CTokenBlock& operator=(const CTokenBlock& obj);
+   bool operator==(const CTokenBlock& obj);
+   int getKey();
+
+      // Functionality:
+      //    set the address the token belongs to.
+      // Parameters:
+      //    0) [in] addr: network address of the listener
+      //    1) [in] ver: IP version
+      // Returned value:
+      //    None.
+
+   void setAddr(const sockaddr* addr, int ver);
+};
+
+
 #endif
@@ -61,7 +61,16 @@ m_iACKPeriod(0),
 m_iACKInterval(0),
 m_bUserDefinedRTO(false),
 m_iRTO(-1),
-m_PerfInfo()
+m_PerfInfo(),
+m_iOWD(),
+m_bOWD(false),
+m_iPhase(),
+m_dSSThresh(),
+m_dMaxWindow(),
+m_iQueuingDelay(),
+m_dModelBW(),
+m_iMinLightACKInterval(64),
+m_iMaxLightACKInterval(1024)
 {
 }
 
@@ -80,6 +89,12 @@ void CCC::setACKInterval(int pktINT)
    m_iACKInterval = pktINT;
 }
 
+void CCC::setLightACKRange(int minPktINT, int maxPktINT)
+{
+   m_iMinLightACKInterval = minPktINT < 1 ? 1 : minPktINT;
+   m_iMaxLightACKInterval = maxPktINT < m_iMinLightACKInterval ? m_iMinLightACKInterval : maxPktINT;
+}
+
 void CCC::setRTO(int usRTO)
 {
    m_bUserDefinedRTO = true;
@@ -143,6 +158,12 @@ void CCC::setRTT(int rtt)
    m_iRTT = rtt;
 }
 
+void CCC::setOWD(int owd)
+{
+   m_iOWD = owd;
+   m_bOWD = true;
+}
+
 void CCC::setUserParam(const char* param, int size)
 {
    delete [] m_pcParam;
@@ -174,6 +195,7 @@ void CUDTCC::init()
    setACKTimer(m_iRCInterval);
 
    m_bSlowStart = true;
+   m_iPhase = 0;
    m_iLastAck = m_iSndCurrSeqNo;
    m_bLoss = false;
    m_iLastDecSeq = CSeqNo::decseq(m_iLastAck);
@@ -186,6 +208,16 @@ void CUDTCC::init()
    m_dPktSndPeriod = 1;
 }
 
+void CUDTCC::onWarmStart(double period, double cwnd)
+{
+   // skip slow start, the rate control goes on from where the last connection left off
+   m_bSlowStart = false;
+   m_iPhase = 1;
+   m_dPktSndPeriod = period;
+   m_dLastDecPeriod = period;
+   m_dCWndSize = cwnd;
+}
+
 void CUDTCC::onACK(int32_t ack)
 {
    int64_t B = 0;
@@ -210,6 +242,7 @@ void CUDTCC::onACK(int32_t ack)
       if (m_dCWndSize > m_dMaxCWndSize)
       {
          m_bSlowStart = false;
+         m_iPhase = 1;
          if (m_iRcvRate > 0)
             m_dPktSndPeriod = 1000000.0 / m_iRcvRate;
          else
@@ -254,6 +287,7 @@ void CUDTCC::onLoss(const int32_t* losslist, int)
    if (m_bSlowStart)
    {
       m_bSlowStart = false;
+      m_iPhase = 1;
       if (m_iRcvRate > 0)
       {
          // Set the sending rate to the receiving rate.
@@ -298,6 +332,7 @@ void CUDTCC::onTimeout()
    if (m_bSlowStart)
    {
       m_bSlowStart = false;
+      m_iPhase = 1;
       if (m_iRcvRate > 0)
          m_dPktSndPeriod = 1000000.0 / m_iRcvRate;
       else
@@ -312,3 +347,679 @@ void CUDTCC::onTimeout()
       */
    }
 }
+
+//
+// gains from the BBR design: 2/ln2 doubles the delivery rate every round in startup,
+// and the cycle probes for more bandwidth in one phase and drains the queue it built in the next
+static const double g_dBBRHighGain = 2.885;
+static const double g_adBBRPacingGain[8] = {1.25, 0.75, 1, 1, 1, 1, 1, 1};
+
+CBBRCC::CBBRCC():
+m_State(STARTUP),
+m_dPacingGain(),
+m_dCWndGain(),
+m_iLastAck(),
+m_iDelivered(),
+m_iDeliveredCount(),
+m_iDeliveredTime(),
+m_iFirstSentTime(),
+m_iLossSeq(),
+m_bRecovery(false),
+m_dPriorCWnd(),
+m_iRecoveryEndCount(),
+m_iRoundLost(),
+m_iRoundDelivered(),
+m_pSndInfo(NULL),
+m_iSndInfoMask(0),
+m_dBtlBW(),
+m_iRound(),
+m_iRoundEndSeq(),
+m_bRoundStart(),
+m_bRoundSampled(),
+m_iMinRTT(),
+m_MinRTTTime(),
+m_dFullBW(),
+m_iFullBWRounds(),
+m_bFullBW(),
+m_iCycleIndex(),
+m_CycleStart(),
+m_ProbeRTTDone()
+{
+   for (int i = 0; i < m_iBWRounds; ++ i)
+      m_adRoundBW[i] = 0;
+}
+
+CBBRCC::~CBBRCC()
+{
+   delete [] m_pSndInfo;
+}
+
+void CBBRCC::init()
+{
+   setACKTimer(m_iSYNInterval);
+
+   // the flow window bounds the packets in flight
+   int size = 1024;
+   while (size < m_dMaxCWndSize)
+      size <<= 1;
+   delete [] m_pSndInfo;
+   m_pSndInfo = new SndInfo[size];
+   memset(m_pSndInfo, 0, size * sizeof(SndInfo));
+   m_iSndInfoMask = size - 1;
+
+   uint64_t currtime = CTimer::getTime();
+
+   m_State = STARTUP;
+   m_dPacingGain = g_dBBRHighGain;
+   m_dCWndGain = g_dBBRHighGain;
+
+   m_iLastAck = CSeqNo::incseq(m_iSndCurrSeqNo);
+   m_iDelivered = 0;
+   m_iDeliveredCount = 0;
+   m_iDeliveredTime = (uint32_t)currtime;
+   m_iFirstSentTime = (uint32_t)currtime;
+   m_iLossSeq = m_iSndCurrSeqNo;
+
+   m_bRecovery = false;
+   m_dPriorCWnd = 0;
+   m_iRecoveryEndCount = 0;
+   m_iRoundLost = 0;
+   m_iRoundDelivered = 0;
+
+   for (int i = 0; i < m_iBWRounds; ++ i)
+      m_adRoundBW[i] = 0;
+   m_dBtlBW = 0;
+   m_iRound = 0;
+   m_iRoundEndSeq = m_iSndCurrSeqNo;
+   m_bRoundStart = false;
+   m_bRoundSampled = false;
+
+   m_iMinRTT = m_iRTT;
+   m_MinRTTTime = currtime;
+
+   m_dFullBW = 0;
+   m_iFullBWRounds = 0;
+   m_bFullBW = false;
+
+   m_iCycleIndex = 0;
+   m_CycleStart = currtime;
+   m_ProbeRTTDone = 0;
+
+   // no bandwidth sample yet, pace the initial window over one RTT
+   m_dCWndSize = 16;
+   m_dPktSndPeriod = m_iRTT / (m_dPacingGain * m_dCWndSize);
+}
+
+void CBBRCC::onWarmStart(double period, double cwnd)
+{
+   // the last rate counts as the sample of the first round, so the pipe is taken as full and
+   // probing starts at once; the sample ages out of the filter like any other
+   m_adRoundBW[0] = 1000000.0 / period;
+   m_dBtlBW = m_dFullBW = m_adRoundBW[0];
+   m_bFullBW = true;
+   enterProbeBW(CTimer::getTime());
+   m_iPhase = m_State;
+
+   m_dCWndSize = cwnd;
+   m_dPktSndPeriod = 1000000.0 / (m_dPacingGain * m_dBtlBW);
+}
+
+void CBBRCC::onACK(int32_t ack)
+{
+   uint64_t currtime = CTimer::getTime();
+
+   updateModel(ack, currtime);
+   updateState(ack, currtime);
+   updateControl();
+
+   m_iPhase = m_State;
+   m_dModelBW = m_dBtlBW;
+   m_iQueuingDelay = (m_iRTT > m_iMinRTT) ? m_iRTT - m_iMinRTT : 0;
+}
+
+void CBBRCC::onLoss(const int32_t* losslist, int size)
+{
+   for (int i = 0; i < size; ++ i)
+   {
+      int32_t seqno = losslist[i] & 0x7FFFFFFF;
+      if ((losslist[i] & 0x80000000) && (i + 1 < size))
+      {
+         m_iRoundLost += CSeqNo::seqlen(seqno, losslist[i + 1]);
+         seqno = losslist[++ i];
+      }
+      else
+         ++ m_iRoundLost;
+
+      if (CSeqNo::seqcmp(seqno, m_iLossSeq) > 0)
+         m_iLossSeq = seqno;
+   }
+
+   // the model does not back off on loss, but while the holes are repaired no more is sent
+   // than what leaves the network (packet conservation)
+   if (!m_bRecovery)
+   {
+      m_bRecovery = true;
+      m_dPriorCWnd = m_dCWndSize;
+      int flight = CSeqNo::seqlen(m_iLastAck, m_iSndCurrSeqNo);
+      m_dCWndSize = (flight > 16) ? flight : 16;
+   }
+
+   // loss while probing for more bandwidth means the probe has already filled the queue, drain it now
+   if ((PROBE_BW == m_State) && (m_dPacingGain > 1.0) && (m_dBtlBW > 0))
+   {
+      m_iCycleIndex = 1;
+      m_dPacingGain = g_adBBRPacingGain[m_iCycleIndex];
+      m_CycleStart = CTimer::getTime();
+      m_dPktSndPeriod = 1000000.0 / (m_dPacingGain * m_dBtlBW);
+   }
+}
+
+void CBBRCC::onTimeout()
+{
+   // everything in flight is sent again
+   m_iLossSeq = m_iSndCurrSeqNo;
+
+   if (!m_bRecovery)
+   {
+      m_bRecovery = true;
+      m_dPriorCWnd = m_dCWndSize;
+   }
+   m_dCWndSize = 16;
+}
+
+void CBBRCC::onPktSent(const CPacket* pkt)
+{
+   uint32_t currtime = (uint32_t)CTimer::getTime();
+
+   // nothing was in flight, the sampling interval starts now
+   if ((pkt->m_iSeqNo == m_iLastAck) && (pkt->m_iSeqNo == m_iSndCurrSeqNo))
+   {
+      m_iDeliveredTime = currtime;
+      m_iFirstSentTime = currtime;
+   }
+
+   SndInfo& info = m_pSndInfo[pkt->m_iSeqNo & m_iSndInfoMask];
+   info.m_iSentTime = currtime;
+   info.m_iFirstSentTime = m_iFirstSentTime;
+   info.m_iDeliveredTime = m_iDeliveredTime;
+   info.m_iDeliveredCount = m_iDeliveredCount;
+}
+
+void CBBRCC::updateModel(int32_t ack, uint64_t currtime)
+{
+   // a round ends when the packets sent at its start are acknowledged
+   m_bRoundStart = false;
+   if (CSeqNo::seqcmp(ack, m_iRoundEndSeq) > 0)
+   {
+      ++ m_iRound;
+      m_iRoundEndSeq = m_iSndCurrSeqNo;
+      m_bRoundStart = true;
+      m_bRoundSampled = false;
+   }
+
+   m_iDelivered = CSeqNo::seqoff(m_iLastAck, ack);
+   if (m_iDelivered > 0)
+   {
+      m_iDeliveredCount += m_iDelivered;
+      m_iRoundDelivered += m_iDelivered;
+      m_iDeliveredTime = (uint32_t)currtime;
+
+      // delivery rate over the packets acknowledged since the newest acknowledged packet was sent,
+      // taking the longer of the sending and the acknowledging intervals so that a sending burst
+      // does not pass for bandwidth; while a loss hole is open the ACK point stands still and then
+      // jumps over packets that arrived long before, and without SACK the ACK cannot tell which,
+      // so packets sent before the last recovery ended give no sample
+      const SndInfo& info = m_pSndInfo[CSeqNo::decseq(ack) & m_iSndInfoMask];
+      uint32_t sndinterval = info.m_iSentTime - info.m_iFirstSentTime;
+      uint32_t ackinterval = m_iDeliveredTime - info.m_iDeliveredTime;
+      uint32_t interval = (sndinterval > ackinterval) ? sndinterval : ackinterval;
+      uint32_t count = m_iDeliveredCount - info.m_iDeliveredCount;
+
+      if ((interval > 0) && (count > 0) && !m_bRecovery && ((int32_t)(info.m_iDeliveredCount - m_iRecoveryEndCount) >= 0))
+      {
+         // a round without samples keeps the value of its slot from m_iBWRounds rounds ago
+         double rate = count * 1000000.0 / interval;
+         double& slot = m_adRoundBW[m_iRound % m_iBWRounds];
+         if (!m_bRoundSampled || (rate > slot))
+            slot = rate;
+         m_bRoundSampled = true;
+      }
+
+      m_iFirstSentTime = info.m_iSentTime;
+      m_iLastAck = ack;
+
+      // all holes are repaired, return to the window used before the loss
+      if (m_bRecovery && (CSeqNo::seqcmp(m_iLastAck, m_iLossSeq) > 0))
+      {
+         m_bRecovery = false;
+         m_iRecoveryEndCount = m_iDeliveredCount;
+         if (m_dCWndSize < m_dPriorCWnd)
+            m_dCWndSize = m_dPriorCWnd;
+      }
+   }
+   else
+      m_iDelivered = 0;
+
+   m_dBtlBW = 0;
+   for (int i = 0; i < m_iBWRounds; ++ i)
+   {
+      if (m_adRoundBW[i] > m_dBtlBW)
+         m_dBtlBW = m_adRoundBW[i];
+   }
+
+   if ((m_iRTT > 0) && (m_iRTT <= m_iMinRTT))
+   {
+      m_iMinRTT = m_iRTT;
+      m_MinRTTTime = currtime;
+   }
+}
+
+void CBBRCC::updateState(int32_t ack, uint64_t currtime)
+{
+   int flight = (CSeqNo::seqcmp(m_iSndCurrSeqNo, ack) >= 0) ? CSeqNo::seqlen(ack, m_iSndCurrSeqNo) : 0;
+
+   // ACKs are sent every SYN, so the pipe holds that much more than the bandwidth-delay product
+   double bdp = m_dBtlBW * (m_iMinRTT + m_iSYNInterval) / 1000000.0;
+
+   switch (m_State)
+   {
+   case STARTUP:
+      // the pipe is full when the bandwidth has not grown by 25% for three rounds; a round losing
+      // more than 2% means the bottleneck queue is too short to reach that point
+      if (m_bRoundStart)
+      {
+         if (m_iRoundLost * 50 > m_iRoundDelivered)
+         {
+            m_bFullBW = true;
+            m_State = DRAIN;
+            m_dPacingGain = 1.0 / g_dBBRHighGain;
+            m_dCWndGain = g_dBBRHighGain;
+         }
+         else if (m_dBtlBW >= m_dFullBW * 1.25)
+         {
+            m_dFullBW = m_dBtlBW;
+            m_iFullBWRounds = 0;
+         }
+         else if (++ m_iFullBWRounds >= 3)
+         {
+            m_bFullBW = true;
+            m_State = DRAIN;
+            m_dPacingGain = 1.0 / g_dBBRHighGain;
+            m_dCWndGain = g_dBBRHighGain;
+         }
+      }
+
+      break;
+
+   case DRAIN:
+      // drain the queue built in startup
+      if (flight <= bdp)
+         enterProbeBW(currtime);
+
+      break;
+
+   case PROBE_BW:
+      // each gain phase lasts one minimum RTT, the draining phase ends as soon as the queue is gone
+      if ((currtime - m_CycleStart > (uint64_t)m_iMinRTT) || ((m_dPacingGain < 1.0) && (flight <= bdp)))
+      {
+         m_iCycleIndex = (m_iCycleIndex + 1) % 8;
+         m_dPacingGain = g_adBBRPacingGain[m_iCycleIndex];
+         m_CycleStart = currtime;
+      }
+
+      break;
+
+   case PROBE_RTT:
+      // hold the flight at 4 packets for at least 200ms and one round, then take the RTT as the new minimum
+      if (0 == m_ProbeRTTDone)
+      {
+         if (flight <= 4)
+            m_ProbeRTTDone = currtime + ((m_iMinRTT > 200000) ? m_iMinRTT : 200000);
+      }
+      else if (currtime > m_ProbeRTTDone)
+      {
+         m_MinRTTTime = currtime;
+
+         if (m_bFullBW)
+            enterProbeBW(currtime);
+         else
+         {
+            m_State = STARTUP;
+            m_dPacingGain = g_dBBRHighGain;
+            m_dCWndGain = g_dBBRHighGain;
+         }
+      }
+
+      break;
+   }
+
+   if (m_bRoundStart)
+   {
+      m_iRoundLost = 0;
+      m_iRoundDelivered = 0;
+   }
+
+   // a minimum RTT older than 10 seconds may hide a route change, measure it again
+   if ((PROBE_RTT != m_State) && (currtime - m_MinRTTTime > 10000000))
+   {
+      m_State = PROBE_RTT;
+      m_dPacingGain = 1;
+      m_dCWndGain = 1;
+      m_ProbeRTTDone = 0;
+      m_iMinRTT = m_iRTT;
+   }
+}
+
+void CBBRCC::updateControl()
+{
+   // no bandwidth sample yet, keep the initial pacing
+   if (m_dBtlBW <= 0)
+      return;
+
+   m_dPktSndPeriod = 1000000.0 / (m_dPacingGain * m_dBtlBW);
+
+   if (PROBE_RTT == m_State)
+   {
+      m_dCWndSize = 4;
+      return;
+   }
+
+   // grow with the delivered packets; once the pipe is full, never beyond the target
+   double target = m_dCWndGain * m_dBtlBW * (m_iMinRTT + m_iSYNInterval) / 1000000.0;
+   if (m_bFullBW)
+   {
+      m_dCWndSize += m_iDelivered;
+      if (m_dCWndSize > target)
+         m_dCWndSize = target;
+   }
+   else if (m_dCWndSize < target)
+      m_dCWndSize += m_iDelivered;
+
+   if (m_dCWndSize < 16)
+      m_dCWndSize = 16;
+   if (m_dCWndSize > m_dMaxCWndSize)
+      m_dCWndSize = m_dMaxCWndSize;
+}
+
+void CBBRCC::enterProbeBW(uint64_t currtime)
+{
+   m_State = PROBE_BW;
+   m_dCWndGain = 2;
+
+   // start the cycle at a random phase other than the draining one, so that flows do not probe in step
+   m_iCycleIndex = rand() % 7;
+   if (m_iCycleIndex > 0)
+      ++ m_iCycleIndex;
+   m_dPacingGain = g_adBBRPacingGain[m_iCycleIndex];
+   m_CycleStart = currtime;
+}
+
+//
+// CUBIC constants: the scaling of the cubic and the multiplicative decrease, as in RFC 8312
+static const double g_dCUBICC = 0.4;
+static const double g_dCUBICBeta = 0.7;
+
+CCUBICCC::CCUBICCC():
+m_iLastAck(),
+m_iLastDecSeq(),
+m_EpochStart(),
+m_dK(),
+m_dOriginPoint(),
+m_dTCPWindow()
+{
+}
+
+void CCUBICCC::init()
+{
+   setACKTimer(m_iSYNInterval);
+
+   m_iLastAck = CSeqNo::incseq(m_iSndCurrSeqNo);
+   m_iLastDecSeq = m_iSndCurrSeqNo;
+   m_EpochStart = 0;
+
+   m_iPhase = 0;
+   m_dSSThresh = m_dMaxCWndSize;
+   m_dMaxWindow = 0;
+
+   m_dCWndSize = 16;
+   setPacing();
+}
+
+void CCUBICCC::onWarmStart(double, double cwnd)
+{
+   // resume in congestion avoidance, with the last window as the plateau of the cubic
+   m_dCWndSize = cwnd;
+   m_dSSThresh = cwnd;
+   m_dMaxWindow = cwnd;
+   m_iPhase = 1;
+   m_EpochStart = 0;
+   setPacing();
+}
+
+void CCUBICCC::onACK(int32_t ack)
+{
+   int delivered = CSeqNo::seqoff(m_iLastAck, ack);
+   if (delivered <= 0)
+      return;
+   m_iLastAck = ack;
+
+   if (0 == m_iPhase)
+   {
+      m_dCWndSize += delivered;
+      if (m_dCWndSize >= m_dSSThresh)
+         m_iPhase = 1;
+   }
+   else
+   {
+      uint64_t currtime = CTimer::getTime();
+
+      if (0 == m_EpochStart)
+      {
+         m_EpochStart = currtime;
+         if (m_dCWndSize < m_dMaxWindow)
+         {
+            m_dK = pow((m_dMaxWindow - m_dCWndSize) / g_dCUBICC, 1.0 / 3.0);
+            m_dOriginPoint = m_dMaxWindow;
+         }
+         else
+         {
+            m_dK = 0;
+            m_dOriginPoint = m_dCWndSize;
+         }
+         m_dTCPWindow = m_dCWndSize;
+      }
+
+      // the window the cubic reaches one RTT from now
+      double t = (currtime - m_EpochStart + m_iRTT) / 1000000.0;
+      double target = m_dOriginPoint + g_dCUBICC * (t - m_dK) * (t - m_dK) * (t - m_dK);
+      if (target > m_dCWndSize)
+         m_dCWndSize += (target - m_dCWndSize) / m_dCWndSize * delivered;
+      else
+         m_dCWndSize += 0.01 * delivered / m_dCWndSize;
+
+      // never slower than standard TCP with the same decrease factor
+      m_dTCPWindow += 3 * (1 - g_dCUBICBeta) / (1 + g_dCUBICBeta) * delivered / m_dCWndSize;
+      if (m_dTCPWindow > m_dCWndSize)
+         m_dCWndSize = m_dTCPWindow;
+   }
+
+   if (m_dCWndSize > m_dMaxCWndSize)
+      m_dCWndSize = m_dMaxCWndSize;
+
+   setPacing();
+}
+
+void CCUBICCC::onLoss(const int32_t* losslist, int)
+{
+   // one reduction per window of data
+   if (CSeqNo::seqcmp(losslist[0] & 0x7FFFFFFF, m_iLastDecSeq) <= 0)
+      return;
+   m_iLastDecSeq = m_iSndCurrSeqNo;
+
+   // fast convergence: a flow that lost before reaching its last maximum releases bandwidth for new flows
+   if (m_dCWndSize < m_dMaxWindow)
+      m_dMaxWindow = m_dCWndSize * (1 + g_dCUBICBeta) / 2;
+   else
+      m_dMaxWindow = m_dCWndSize;
+
+   m_dCWndSize *= g_dCUBICBeta;
+   if (m_dCWndSize < 2)
+      m_dCWndSize = 2;
+   m_dSSThresh = m_dCWndSize;
+   m_iPhase = 1;
+   m_EpochStart = 0;
+
+   setPacing();
+}
+
+void CCUBICCC::onTimeout()
+{
+   m_iLastDecSeq = m_iSndCurrSeqNo;
+
+   m_dMaxWindow = m_dCWndSize;
+   m_dSSThresh = m_dCWndSize * g_dCUBICBeta;
+   if (m_dSSThresh < 2)
+      m_dSSThresh = 2;
+   m_dCWndSize = 2;
+   m_iPhase = 0;
+   m_EpochStart = 0;
+
+   setPacing();
+}
+
+void CCUBICCC::setPacing()
+{
+   // spread the window over one RTT, a little faster so that pacing does not limit the window
+   m_dPktSndPeriod = m_iRTT / (m_dCWndSize * ((0 == m_iPhase) ? 2.0 : 1.2));
+}
+
+//
+CLEDBATCC::CLEDBATCC():
+m_iLastAck(),
+m_iLastDecSeq(),
+m_iBaseIndex(),
+m_BaseTime(),
+m_bBaseDelay(false),
+m_bBaseOWD(false)
+{
+   for (int i = 0; i < m_iBaseHistory; ++ i)
+      m_aiBaseDelay[i] = 0;
+}
+
+void CLEDBATCC::init()
+{
+   setACKTimer(m_iSYNInterval);
+
+   m_iLastAck = CSeqNo::incseq(m_iSndCurrSeqNo);
+   m_iLastDecSeq = m_iSndCurrSeqNo;
+   m_bBaseDelay = false;
+
+   m_iPhase = 0;
+   m_dSSThresh = m_dMaxCWndSize;
+   m_dMaxWindow = 0;
+
+   m_dCWndSize = 16;
+   m_dPktSndPeriod = m_iRTT / (m_dCWndSize * 2.0);
+}
+
+void CLEDBATCC::onWarmStart(double, double cwnd)
+{
+   // the base delay is not known yet, but the target keeps the window in check once it is
+   m_dCWndSize = cwnd;
+   m_dSSThresh = cwnd;
+   m_iPhase = 1;
+   m_dPktSndPeriod = m_iRTT / (m_dCWndSize * 1.2);
+}
+
+void CLEDBATCC::onACK(int32_t ack)
+{
+   int delivered = CSeqNo::seqoff(m_iLastAck, ack);
+   if (delivered <= 0)
+      return;
+   m_iLastAck = ack;
+
+   uint64_t currtime = CTimer::getTime();
+
+   // the one-way delay from the peer has a constant clock offset that the base delay cancels;
+   // without it, the RTT stands in for the delay and the reverse path counts too
+   int delay = m_bOWD ? m_iOWD : m_iRTT;
+   if (!m_bBaseDelay || (m_bBaseOWD != m_bOWD))
+   {
+      for (int i = 0; i < m_iBaseHistory; ++ i)
+         m_aiBaseDelay[i] = delay;
+      m_iBaseIndex = 0;
+      m_BaseTime = currtime;
+      m_bBaseDelay = true;
+      m_bBaseOWD = m_bOWD;
+   }
+   else if (currtime - m_BaseTime > 60000000)
+   {
+      // a new minute, the oldest one is forgotten so that a route change is picked up
+      m_iBaseIndex = (m_iBaseIndex + 1) % m_iBaseHistory;
+      m_aiBaseDelay[m_iBaseIndex] = delay;
+      m_BaseTime = currtime;
+   }
+   else if (delay < m_aiBaseDelay[m_iBaseIndex])
+      m_aiBaseDelay[m_iBaseIndex] = delay;
+
+   int base = m_aiBaseDelay[0];
+   for (int i = 1; i < m_iBaseHistory; ++ i)
+   {
+      if (m_aiBaseDelay[i] < base)
+         base = m_aiBaseDelay[i];
+   }
+   m_iQueuingDelay = delay - base;
+
+   // slow start until the queue reaches half the target
+   if ((0 == m_iPhase) && ((m_iQueuingDelay > m_iTarget / 2) || (m_dCWndSize >= m_dSSThresh)))
+      m_iPhase = 1;
+
+   if (0 == m_iPhase)
+      m_dCWndSize += delivered;
+   else
+   {
+      // grow below the target and shrink above it, in proportion to the distance, by at most one packet per RTT
+      double offtarget = double(m_iTarget - m_iQueuingDelay) / m_iTarget;
+      if (offtarget < -1)
+         offtarget = -1;
+      m_dCWndSize += offtarget * delivered / m_dCWndSize;
+   }
+
+   if (m_dCWndSize < 2)
+      m_dCWndSize = 2;
+   if (m_dCWndSize > m_dMaxCWndSize)
+      m_dCWndSize = m_dMaxCWndSize;
+
+   m_dPktSndPeriod = m_iRTT / (m_dCWndSize * ((0 == m_iPhase) ? 2.0 : 1.2));
+}
+
+void CLEDBATCC::onLoss(const int32_t* losslist, int)
+{
+   // one reduction per window of data
+   if (CSeqNo::seqcmp(losslist[0] & 0x7FFFFFFF, m_iLastDecSeq) <= 0)
+      return;
+   m_iLastDecSeq = m_iSndCurrSeqNo;
+
+   m_dMaxWindow = m_dCWndSize;
+   m_dCWndSize /= 2;
+   if (m_dCWndSize < 2)
+      m_dCWndSize = 2;
+   m_dSSThresh = m_dCWndSize;
+   m_iPhase = 1;
+
+   m_dPktSndPeriod = m_iRTT / (m_dCWndSize * 1.2);
+}
+
+void CLEDBATCC::onTimeout()
+{
+   m_iLastDecSeq = m_iSndCurrSeqNo;
+
+   m_dMaxWindow = m_dCWndSize;
+   m_dSSThresh = m_dCWndSize / 2;
+   if (m_dSSThresh < 2)
+      m_dSSThresh = 2;
+   m_dCWndSize = 2;
+   m_iPhase = 0;
+
+   m_dPktSndPeriod = m_iRTT / (m_dCWndSize * 2.0);
+}
@@ -137,6 +137,17 @@ public:
 
    virtual void processCustomMsg(const CPacket*) {}
 
+      // Functionality:
+      //    Callback function to be called right after init() when the network information cache
+      //    holds the sending rate that the last connection to the same peer ended with.
+      // Parameters:
+      //    0) [in] period: packet sending period, in microseconds.
+      //    1) [in] cwnd: congestion window size, in packets.
+      // Returned value:
+      //    None.
+
+   virtual void onWarmStart(double, double) {}
+
 protected:
 
       // Functionality:
@@ -157,6 +168,16 @@ protected:
 
    void setACKInterval(int pktINT);
 
+      // Functionality:
+      //    Set the range of the light ACK interval, which adapts to the arrival rate and RTT.
+      // Parameters:
+      //    0) [in] minPktINT: smallest number of packets between two light ACKs.
+      //    1) [in] maxPktINT: largest number of packets between two light ACKs.
+      // Returned value:
+      //    None.
+
+   void setLightACKRange(int minPktINT, int maxPktINT);
+
       // Functionality:
       //    Set RTO value.
       // Parameters:
@@ -201,6 +222,7 @@ private:
    void setSndCurrSeqNo(int32_t seqno);
    void setRcvRate(int rcvrate);
    void setRTT(int rtt);
+   void setOWD(int owd);
 
 protected:
    const int32_t& m_iSYNInterval;	// UDT constant parameter, SYN
@@ -229,6 +251,23 @@ private:
    int m_iRTO;                          // RTO value, microseconds
 
    CPerfMon m_PerfInfo;                 // protocol statistics information
+
+   // later additions, kept after the fields above so that their offsets do not change
+
+protected:
+   int m_iOWD;				// one-way delay of the data reported by the last ACK, microseconds, plus an unknown constant clock offset
+   bool m_bOWD;				// if the peer reports the one-way delay
+
+   // state of the algorithm, reported by perfmon
+   int m_iPhase;			// algorithm specific phase, 0 is slow start
+   double m_dSSThresh;			// window at which slow start ends, in packets
+   double m_dMaxWindow;			// window before the last reduction, in packets
+   int m_iQueuingDelay;			// queuing delay seen by the algorithm, microseconds
+   double m_dModelBW;			// bottleneck bandwidth in the model of the algorithm, packets per second
+
+private:
+   int m_iMinLightACKInterval;          // Lower bound of the light ACK interval, in packets
+   int m_iMaxLightACKInterval;          // Upper bound of the light ACK interval, in packets
 };
 
 class CCCVirtualFactory
@@ -257,6 +296,7 @@ public:
 
 public:
    virtual void init();
+   virtual void onWarmStart(double period, double cwnd);
    virtual void onACK(int32_t);
    virtual void onLoss(const int32_t*, int);
    virtual void onTimeout();
@@ -275,4 +315,127 @@ private:
    int m_iDecCount;			// number of decreases in a congestion epoch
 };
 
+class CBBRCC: public CCC
+{
+public:
+   CBBRCC();
+   virtual ~CBBRCC();
+
+public:
+   virtual void init();
+   virtual void onWarmStart(double period, double cwnd);
+   virtual void onACK(int32_t);
+   virtual void onLoss(const int32_t*, int);
+   virtual void onTimeout();
+   virtual void onPktSent(const CPacket*);
+
+private:
+   void updateModel(int32_t ack, uint64_t currtime);
+   void updateState(int32_t ack, uint64_t currtime);
+   void updateControl();
+   void enterProbeBW(uint64_t currtime);
+
+private:
+   enum State {STARTUP, DRAIN, PROBE_BW, PROBE_RTT};
+   static const int m_iBWRounds = 10;	// number of rounds the bandwidth filter remembers
+
+   State m_State;			// current phase of the model
+   double m_dPacingGain;		// sending rate relative to the estimated bandwidth
+   double m_dCWndGain;			// congestion window relative to the estimated BDP
+
+   int32_t m_iLastAck;			// last ACKed seq no
+   int m_iDelivered;			// packets acknowledged by the last ACK
+
+   // delivery rate sampling: times are in microseconds and counts in packets, both kept in 32 bits
+   // as only differences over a few RTTs are used
+   uint32_t m_iDeliveredCount;		// packets acknowledged so far
+   uint32_t m_iDeliveredTime;		// time when the ACK point last moved
+   uint32_t m_iFirstSentTime;		// sending time of the newest acknowledged packet
+   int32_t m_iLossSeq;			// largest seq no reported lost
+
+   bool m_bRecovery;			// if loss recovery is in progress, it ends when m_iLossSeq is acknowledged
+   double m_dPriorCWnd;			// congestion window before the recovery, restored at its end
+   uint32_t m_iRecoveryEndCount;	// m_iDeliveredCount when the last recovery ended
+   int m_iRoundLost;			// packets reported lost in the current round
+   int m_iRoundDelivered;		// packets acknowledged in the current round
+
+   struct SndInfo
+   {
+      uint32_t m_iSentTime;		// time when the packet was last sent
+      uint32_t m_iFirstSentTime;	// m_iFirstSentTime at that moment
+      uint32_t m_iDeliveredTime;	// m_iDeliveredTime at that moment
+      uint32_t m_iDeliveredCount;	// m_iDeliveredCount at that moment
+   } *m_pSndInfo;			// state at the last sending of each packet in flight, indexed by seq no
+   int m_iSndInfoMask;			// size of m_pSndInfo minus 1, a power of 2 minus 1
+
+   double m_adRoundBW[m_iBWRounds];	// largest delivery rate in each of the recent rounds, packets per second
+   double m_dBtlBW;			// bottleneck bandwidth estimate, the maximum of m_adRoundBW
+   int m_iRound;			// number of round trips so far
+   int32_t m_iRoundEndSeq;		// the current round ends when this seq no is acknowledged
+   bool m_bRoundStart;			// if the last ACK started a new round
+   bool m_bRoundSampled;		// if the current round has a delivery rate sample yet
+
+   int m_iMinRTT;			// smallest RTT seen in the last 10 seconds, microseconds
+   uint64_t m_MinRTTTime;		// time when m_iMinRTT was taken
+
+   double m_dFullBW;			// bandwidth at the last 25% growth during startup
+   int m_iFullBWRounds;			// rounds since the last 25% growth
+   bool m_bFullBW;			// if startup has filled the pipe, or has lost too much to go on
+
+   int m_iCycleIndex;			// position in the pacing gain cycle
+   uint64_t m_CycleStart;		// start time of the current gain phase
+   uint64_t m_ProbeRTTDone;		// time to leave PROBE_RTT, 0 until the flight has drained
+};
+
+class CCUBICCC: public CCC
+{
+public:
+   CCUBICCC();
+
+public:
+   virtual void init();
+   virtual void onWarmStart(double period, double cwnd);
+   virtual void onACK(int32_t);
+   virtual void onLoss(const int32_t*, int);
+   virtual void onTimeout();
+
+private:
+   void setPacing();
+
+private:
+   int32_t m_iLastAck;			// last ACKed seq no
+   int32_t m_iLastDecSeq;		// largest seq no sent at the last reduction, losses up to it belong to the same event
+
+   uint64_t m_EpochStart;		// start of the current growth epoch, 0 if a new one starts with the next ACK
+   double m_dK;				// time for the cubic to grow back to m_dMaxWindow, in seconds
+   double m_dOriginPoint;		// window at the plateau of the cubic, in packets
+   double m_dTCPWindow;			// window a standard TCP flow would have in the same epoch, in packets
+};
+
+class CLEDBATCC: public CCC
+{
+public:
+   CLEDBATCC();
+
+public:
+   virtual void init();
+   virtual void onWarmStart(double period, double cwnd);
+   virtual void onACK(int32_t);
+   virtual void onLoss(const int32_t*, int);
+   virtual void onTimeout();
+
+private:
+   static const int m_iTarget = 25000;		// queuing delay the flow aims at, microseconds
+   static const int m_iBaseHistory = 10;	// number of minutes the base delay is remembered
+
+   int32_t m_iLastAck;			// last ACKed seq no
+   int32_t m_iLastDecSeq;		// largest seq no sent at the last reduction, losses up to it belong to the same event
+
+   int m_aiBaseDelay[m_iBaseHistory];	// smallest delay in each of the recent minutes, microseconds plus the clock offset
+   int m_iBaseIndex;			// slot of the current minute in m_aiBaseDelay
+   uint64_t m_BaseTime;			// start time of the current minute
+   bool m_bBaseDelay;			// if any delay has been measured yet
+   bool m_bBaseOWD;			// if m_aiBaseDelay holds one-way delays rather than RTTs
+};
+
 #endif
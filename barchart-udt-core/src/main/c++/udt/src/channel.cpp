@@ -72,7 +72,9 @@ m_iIPversion(AF_INET),
 m_iSockAddrSize(sizeof(sockaddr_in)),
 m_iSocket(),
 m_iSndBufSize(65536),
-m_iRcvBufSize(65536)
+m_iRcvBufSize(65536),
+m_iBusyPoll(0),
+m_bNonBlocking(false)
 {
 }
 
@@ -80,7 +82,9 @@ CChannel::CChannel(int version):
 m_iIPversion(version),
 m_iSocket(),
 m_iSndBufSize(65536),
-m_iRcvBufSize(65536)
+m_iRcvBufSize(65536),
+m_iBusyPoll(0),
+m_bNonBlocking(false)
 {
    m_iSockAddrSize = (AF_INET == m_iIPversion) ? sizeof(sockaddr_in) : sizeof(sockaddr_in6);
 }
@@ -154,6 +158,12 @@ void CChannel::setUDPSockOpt()
          throw CUDTException(1, 3, NET_ERROR);
    #endif
 
+   #ifdef SO_BUSY_POLL
+      // let the driver poll the device queue too; this may need privileges, spinning in recvfrom() works without it
+      if (m_iBusyPoll > 0)
+         ::setsockopt(m_iSocket, SOL_SOCKET, SO_BUSY_POLL, (char*)&m_iBusyPoll, sizeof(int));
+   #endif
+
    timeval tv;
    tv.tv_sec = 0;
    #if defined (BSD) || defined (OSX)
@@ -214,6 +224,26 @@ void CChannel::setRcvBufSize(int size)
    m_iRcvBufSize = size;
 }
 
+void CChannel::setBusyPoll(int usec)
+{
+   m_iBusyPoll = usec;
+}
+
+int CChannel::getBusyPoll() const
+{
+   return m_iBusyPoll;
+}
+
+void CChannel::setNonBlocking(bool nonblocking)
+{
+   m_bNonBlocking = nonblocking;
+}
+
+UDPSOCKET CChannel::getSocket() const
+{
+   return m_iSocket;
+}
+
 void CChannel::getSockAddr(sockaddr* addr) const
 {
    socklen_t namelen = m_iSockAddrSize;
@@ -226,7 +256,7 @@ void CChannel::getPeerAddr(sockaddr* addr) const
    ::getpeername(m_iSocket, addr, &namelen);
 }
 
-int CChannel::sendto(const sockaddr* addr, CPacket& packet) const
+int CChannel::sendto(const sockaddr* addr, CPacket& packet, bool fragment) const
 {
    // convert control information into network order
    if (packet.getFlag())
@@ -253,7 +283,25 @@ int CChannel::sendto(const sockaddr* addr, CPacket& packet) const
       mh.msg_controllen = 0;
       mh.msg_flags = 0;
 
+      #ifdef IP_MTU_DISCOVER
+         // Linux sets DF on UDP packets; without it the routers split the packet instead of dropping it.
+         // IPv6 routers never fragment, so only IPv4 gets through this way.
+         int pmtudisc = IP_PMTUDISC_WANT;
+         if (fragment && (AF_INET == m_iIPversion))
+         {
+            socklen_t optlen = sizeof(int);
+            ::getsockopt(m_iSocket, IPPROTO_IP, IP_MTU_DISCOVER, (char*)&pmtudisc, &optlen);
+            int dont = IP_PMTUDISC_DONT;
+            ::setsockopt(m_iSocket, IPPROTO_IP, IP_MTU_DISCOVER, (char*)&dont, sizeof(int));
+         }
+      #endif
+
       int res = ::sendmsg(m_iSocket, &mh, 0);
+
+      #ifdef IP_MTU_DISCOVER
+         if (fragment && (AF_INET == m_iIPversion))
+            ::setsockopt(m_iSocket, IPPROTO_IP, IP_MTU_DISCOVER, (char*)&pmtudisc, sizeof(int));
+      #endif
    #else
       DWORD size = CPacket::m_iPktHdrSize + packet.getLength();
       int addrsize = m_iSockAddrSize;
@@ -292,17 +340,22 @@ int CChannel::recvfrom(sockaddr* addr, CPacket& packet) const
       mh.msg_controllen = 0;
       mh.msg_flags = 0;
 
+      bool nowait = (m_iBusyPoll > 0) || m_bNonBlocking;
+
       #ifdef UNIX
-         fd_set set;
-         timeval tv;
-         FD_ZERO(&set);
-         FD_SET(m_iSocket, &set);
-         tv.tv_sec = 0;
-         tv.tv_usec = 10000;
-         ::select(m_iSocket+1, &set, NULL, &set, &tv);
+         if (!nowait)
+         {
+            fd_set set;
+            timeval tv;
+            FD_ZERO(&set);
+            FD_SET(m_iSocket, &set);
+            tv.tv_sec = 0;
+            tv.tv_usec = 10000;
+            ::select(m_iSocket+1, &set, NULL, &set, &tv);
+         }
       #endif
 
-      int res = ::recvmsg(m_iSocket, &mh, 0);
+      int res = ::recvmsg(m_iSocket, &mh, nowait ? MSG_DONTWAIT : 0);
    #else
       DWORD size = CPacket::m_iPktHdrSize + packet.getLength();
       DWORD flag = 0;
@@ -116,6 +116,42 @@ public:
 
    void setRcvBufSize(int size);
 
+      // Functionality:
+      //    Make recvfrom() return at once when no packet is waiting, for a caller that spins on it.
+      // Parameters:
+      //    0) [in] usec: busy polling time of the kernel (SO_BUSY_POLL) in microseconds; 0 for blocking receives.
+      // Returned value:
+      //    None.
+
+   void setBusyPoll(int usec);
+
+      // Functionality:
+      //    Query the busy polling time.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    busy polling time in microseconds, 0 if recvfrom() waits for a packet.
+
+   int getBusyPoll() const;
+
+      // Functionality:
+      //    Make recvfrom() return at once when no packet is waiting, for a caller that waits on the socket itself.
+      // Parameters:
+      //    0) [in] nonblocking: true to return at once.
+      // Returned value:
+      //    None.
+
+   void setNonBlocking(bool nonblocking);
+
+      // Functionality:
+      //    Query the UDP socket of the channel.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    the UDP socket descriptor.
+
+   UDPSOCKET getSocket() const;
+
       // Functionality:
       //    Query the socket address that the channel is using.
       // Parameters:
@@ -139,10 +175,11 @@ public:
       // Parameters:
       //    0) [in] addr: pointer to the destination address.
       //    1) [in] packet: reference to a CPacket entity.
+      //    2) [in] fragment: let the IP layer split the packet, for one cut at a size the path no longer carries.
       // Returned value:
       //    Actual size of data sent.
 
-   int sendto(const sockaddr* addr, CPacket& packet) const;
+   int sendto(const sockaddr* addr, CPacket& packet, bool fragment = false) const;
 
       // Functionality:
       //    Receive a packet from the channel and record the source address.
@@ -165,6 +202,8 @@ private:
 
    int m_iSndBufSize;                   // UDP sending buffer size
    int m_iRcvBufSize;                   // UDP receiving buffer size
+   int m_iBusyPoll;                     // busy polling time in microseconds, 0: recvfrom() waits for a packet
+   bool m_bNonBlocking;                 // recvfrom() returns at once, the owner waits for the socket to be readable
 };
 
 
@@ -43,15 +43,23 @@ written by
    #include <cstring>
    #include <cerrno>
    #include <unistd.h>
+   #include <sched.h>
+   #ifdef LINUX
+      #include <sys/syscall.h>
+      #include <sys/eventfd.h>
+   #endif
    #ifdef OSX
       #include <mach/mach_time.h>
    #endif
+   #include <fcntl.h>
 #else
    #include <winsock2.h>
    #include <ws2tcpip.h>
    #ifdef LEGACY_WIN32
       #include <wspiapi.h>
    #endif
+   #include <wincrypt.h>
+   #pragma comment(lib, "advapi32.lib")
 #endif
 
 #include <cmath>
@@ -70,6 +78,7 @@ uint64_t CTimer::s_ullCPUFrequency = CTimer::readCPUFrequency();
 
 CTimer::CTimer():
 m_ullSchedTime(),
+m_iWakeFD(-1),
 m_TickCond(),
 m_TickLock()
 {
@@ -200,19 +209,18 @@ void CTimer::sleepto(uint64_t nexttime)
          #endif
       #else
          #ifndef WIN32
+            // wake up at the scheduled time if it comes before the next tick; shorter waits
+            // are left to the ticks of the receiving thread, a timed wait that short overshoots
+            uint64_t wait = 10000;
+            uint64_t remain = (m_ullSchedTime - t) / s_ullCPUFrequency;
+            if ((remain >= 500) && (remain < wait))
+               wait = remain + 1;
+
             timeval now;
             timespec timeout;
             gettimeofday(&now, 0);
-            if (now.tv_usec < 990000)
-            {
-               timeout.tv_sec = now.tv_sec;
-               timeout.tv_nsec = (now.tv_usec + 10000) * 1000;
-            }
-            else
-            {
-               timeout.tv_sec = now.tv_sec + 1;
-               timeout.tv_nsec = (now.tv_usec + 10000 - 1000000) * 1000;
-            }
+            timeout.tv_sec = now.tv_sec + (now.tv_usec + wait) / 1000000;
+            timeout.tv_nsec = ((now.tv_usec + wait) % 1000000) * 1000;
             pthread_mutex_lock(&m_TickLock);
             pthread_cond_timedwait(&m_TickCond, &m_TickLock, &timeout);
             pthread_mutex_unlock(&m_TickLock);
@@ -239,6 +247,16 @@ void CTimer::tick()
    #else
       SetEvent(m_TickCond);
    #endif
+
+   #ifdef LINUX
+      if (m_iWakeFD >= 0)
+         eventfd_write(m_iWakeFD, 1);
+   #endif
+}
+
+void CTimer::setWakeFD(int fd)
+{
+   m_iWakeFD = fd;
 }
 
 uint64_t CTimer::getTime()
@@ -314,6 +332,48 @@ void CTimer::sleep()
    #endif
 }
 
+void CAffinity::setThreadCPU(pthread_t thread, uint64_t mask)
+{
+   #ifdef LINUX
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (int i = 0; i < 64; ++ i)
+         if (0 != (mask & (1ULL << i)))
+            CPU_SET(i, &set);
+      pthread_setaffinity_np(thread, sizeof(cpu_set_t), &set);
+   #elif WIN32
+      SetThreadAffinityMask(thread, DWORD_PTR(mask));
+   #endif
+}
+
+void CAffinity::setMemNode(void* addr, int len, int node)
+{
+   #ifdef LINUX
+      if ((node < 0) || (node >= 63))
+         return;
+
+      // only the pages wholly inside the range are placed, the ones at the edges may hold other data
+      uint64_t pagesize = sysconf(_SC_PAGESIZE);
+      uint64_t start = ((uint64_t)addr + pagesize - 1) & ~(pagesize - 1);
+      uint64_t end = ((uint64_t)addr + len) & ~(pagesize - 1);
+      if (end <= start)
+         return;
+
+      // MPOL_PREFERRED (1) with MPOL_MF_MOVE (2), see <linux/mempolicy.h>; the system call needs no libnuma
+      unsigned long nodemask = 1UL << node;
+      syscall(SYS_mbind, start, end - start, 1, &nodemask, sizeof(nodemask) * 8, 2);
+   #endif
+}
+
+void CTimer::yield()
+{
+   #ifndef WIN32
+      sched_yield();
+   #else
+      SwitchToThread();
+   #endif
+}
+
 
 //
 // Automatically lock in constructor
@@ -418,6 +478,16 @@ m_strMsg()
 {
 }
 
+CUDTException& CUDTException::operator=(const CUDTException& e)
+{
+   m_iMajor = e.m_iMajor;
+   m_iMinor = e.m_iMinor;
+   m_iErrno = e.m_iErrno;
+   m_strMsg.clear();
+
+   return *this;
+}
+
 CUDTException::~CUDTException()
 {
 }
@@ -470,6 +540,10 @@ const char* CUDTException::getErrorMessage()
            m_strMsg = "Connection does not exist";
            break;
 
+        case 3:
+           m_strMsg = "The peer stopped reading the stream";
+           break;
+
         default:
            break;
         }
@@ -579,6 +653,14 @@ const char* CUDTException::getErrorMessage()
            m_strMsg += ": Invalid epoll ID";
            break;
 
+        case 14:
+           m_strMsg += ": This operation is not supported on a socket carrying streams";
+           break;
+
+        case 15:
+           m_strMsg += ": Invalid stream ID";
+           break;
+
         default:
            break;
         }
@@ -658,6 +740,7 @@ const int CUDTException::ESECFAIL = 1004;
 const int CUDTException::ECONNFAIL = 2000;
 const int CUDTException::ECONNLOST = 2001;
 const int CUDTException::ENOCONN = 2002;
+const int CUDTException::ESTREAMRESET = 2003;
 const int CUDTException::ERESOURCE = 3000;
 const int CUDTException::ETHREAD = 3001;
 const int CUDTException::ENOBUF = 3002;
@@ -680,6 +763,8 @@ const int CUDTException::EDGRAMILL = 5010;
 const int CUDTException::EDUPLISTEN = 5011;
 const int CUDTException::ELARGEMSG = 5012;
 const int CUDTException::EINVPOLLID = 5013;
+const int CUDTException::EMUXSOCK = 5014;
+const int CUDTException::EINVSTREAM = 5015;
 const int CUDTException::EASYNCFAIL = 6000;
 const int CUDTException::EASYNCSND = 6001;
 const int CUDTException::EASYNCRCV = 6002;
@@ -763,3 +848,74 @@ void CMD5::compute(const char* input, unsigned char result[16])
    md5_append(&state, (const md5_byte_t *)input, strlen(input));
    md5_finish(&state, result);
 }
+
+void CMD5::compute(const char* input, int len, unsigned char result[16])
+{
+   md5_state_t state;
+
+   md5_init(&state);
+   md5_append(&state, (const md5_byte_t *)input, len);
+   md5_finish(&state, result);
+}
+
+void CMD5::hmac(const unsigned char* key, int keylen, const char* input, int len, unsigned char result[16])
+{
+   // the key is padded with zeros to the 64-byte block of MD5
+   md5_byte_t ipad[64];
+   md5_byte_t opad[64];
+   memset(ipad, 0, sizeof(ipad));
+   memcpy(ipad, key, (keylen < 64) ? keylen : 64);
+   memcpy(opad, ipad, sizeof(opad));
+   for (int i = 0; i < 64; ++ i)
+   {
+      ipad[i] ^= 0x36;
+      opad[i] ^= 0x5C;
+   }
+
+   md5_state_t state;
+   md5_byte_t inner[16];
+
+   md5_init(&state);
+   md5_append(&state, ipad, 64);
+   md5_append(&state, (const md5_byte_t *)input, len);
+   md5_finish(&state, inner);
+
+   md5_init(&state);
+   md5_append(&state, opad, 64);
+   md5_append(&state, inner, 16);
+   md5_finish(&state, result);
+}
+
+//
+bool CRandom::fill(unsigned char* buf, int len)
+{
+   #ifndef WIN32
+      int fd = ::open("/dev/urandom", O_RDONLY);
+      if (fd < 0)
+         return false;
+
+      int got = 0;
+      while (got < len)
+      {
+         ssize_t r = ::read(fd, buf + got, len - got);
+         if (r > 0)
+            got += r;
+         else if ((r < 0) && (EINTR == errno))
+            continue;
+         else
+            break;
+      }
+      ::close(fd);
+
+      return got == len;
+   #else
+      HCRYPTPROV prov;
+      if (!CryptAcquireContext(&prov, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT | CRYPT_SILENT))
+         return false;
+
+      bool res = (TRUE == CryptGenRandom(prov, len, buf));
+      CryptReleaseContext(prov, 0);
+
+      return res;
+   #endif
+}
@@ -108,6 +108,15 @@ public:
 
    void tick();
 
+      // Functionality:
+      //    Also deliver the ticks to a thread that waits in epoll instead of sleepto().
+      // Parameters:
+      //    0) [in] fd: eventfd written on every tick, -1 for none.
+      // Returned value:
+      //    None.
+
+   void setWakeFD(int fd);
+
 public:
 
       // Functionality:
@@ -164,11 +173,21 @@ public:
 
    static void sleep();
 
+      // Functionality:
+      //    give the rest of the time slice to other ready threads, for loops that spin on a condition
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   static void yield();
+
 private:
    uint64_t getTimeInMicroSec();
 
 private:
    uint64_t m_ullSchedTime;             // next schedulled time
+   int m_iWakeFD;                       // eventfd of a thread that waits for the ticks in epoll instead of sleepto(), -1: none
 
    pthread_cond_t m_TickCond;
    pthread_mutex_t m_TickLock;
@@ -184,6 +203,34 @@ private:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+class CAffinity
+{
+public:
+
+      // Functionality:
+      //    Restrict a thread to a set of CPUs.
+      // Parameters:
+      //    0) [in] thread: the thread to be placed.
+      //    1) [in] mask: bit i allows CPU i.
+      // Returned value:
+      //    None.
+
+   static void setThreadCPU(pthread_t thread, uint64_t mask);
+
+      // Functionality:
+      //    Prefer a NUMA node for the pages of a memory range, moving those already in use.
+      // Parameters:
+      //    0) [in] addr: start of the range.
+      //    1) [in] len: length of the range.
+      //    2) [in] node: NUMA node, -1 to leave the range where it is.
+      // Returned value:
+      //    None.
+
+   static void setMemNode(void* addr, int len, int node);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 class CGuard
 {
 public:
@@ -314,6 +361,35 @@ struct CIPAddress
 struct CMD5
 {
    static void compute(const char* input, unsigned char result[16]);
+   static void compute(const char* input, int len, unsigned char result[16]);
+
+      // Functionality:
+      //    HMAC-MD5 (RFC 2104) of the input under a key.
+      // Parameters:
+      //    0) [in] key: the key, at most 64 bytes.
+      //    1) [in] keylen: size of the key.
+      //    2) [in] input: the data to sign.
+      //    3) [in] len: size of the data.
+      //    4) [out] result: the 16-byte signature.
+      // Returned value:
+      //    None.
+
+   static void hmac(const unsigned char* key, int keylen, const char* input, int len, unsigned char result[16]);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct CRandom
+{
+      // Functionality:
+      //    Fill a buffer from the random number generator of the operating system, for secrets.
+      // Parameters:
+      //    0) [out] buf: the buffer.
+      //    1) [in] len: size of the buffer.
+      // Returned value:
+      //    true if the buffer was filled.
+
+   static bool fill(unsigned char* buf, int len);
 };
 
 
@@ -40,6 +40,7 @@ written by
 
 #ifndef WIN32
    #include <unistd.h>
+   #include <fcntl.h>
    #include <netdb.h>
    #include <arpa/inet.h>
    #include <cerrno>
@@ -77,6 +78,12 @@ const int32_t CMsgNo::m_iMaxMsgNo = 0x1FFFFFFF;
 const int CUDT::m_iVersion = 4;
 const int CUDT::m_iSYNInterval = 10000;
 const int CUDT::m_iSelfClockInterval = 64;
+const int CUDT::m_iMaxSACKBlocks = 16;
+const int CUDT::m_iIdleRelease = 5000000;
+const int CUDT::m_iWarmStartTTL = 600000000;
+const int CUDT::m_iResumeTokenTTL = 600;
+const int CUDT::m_iMaxUsedTokens = 16384;
+const int CUDT::m_iMaxReorderGaps = 1024;
 
 
 CUDT::CUDT()
@@ -85,9 +92,16 @@ CUDT::CUDT()
    m_pRcvBuffer = NULL;
    m_pSndLossList = NULL;
    m_pRcvLossList = NULL;
+   m_pSACKMap = NULL;
+   m_pFECEncoder = NULL;
+   m_pFECDecoder = NULL;
    m_pACKWindow = NULL;
    m_pSndTimeWindow = NULL;
    m_pRcvTimeWindow = NULL;
+   m_pCCFactory = NULL;
+   m_pCC = NULL;
+   m_pcResumeData = NULL;
+   m_pStreamMux = NULL;
 
    m_pSndQueue = NULL;
    m_pRcvQueue = NULL;
@@ -99,38 +113,10 @@ CUDT::CUDT()
    initSynch();
 
    // Default UDT configurations
-   m_iMSS = 1500;
-   m_bSynSending = true;
-   m_bSynRecving = true;
-   m_iFlightFlagSize = 25600;
-   m_iSndBufSize = 8192;
-   m_iRcvBufSize = 8192; //Rcv buffer MUST NOT be bigger than Flight Flag size
-   m_Linger.l_onoff = 1;
-   m_Linger.l_linger = 180;
-   m_iUDPSndBufSize = 65536;
-   m_iUDPRcvBufSize = m_iRcvBufSize * m_iMSS;
-   m_iSockType = UDT_STREAM;
-   m_iIPversion = AF_INET;
-   m_bRendezvous = false;
-   m_iSndTimeOut = -1;
-   m_iRcvTimeOut = -1;
-   m_bReuseAddr = true;
-   m_llMaxBW = -1;
-
-   m_pCCFactory = new CCCFactory<CUDTCC>;
-   m_pCC = NULL;
-   m_pCache = NULL;
+   defaultOpt();
 
    // Initial status
-   m_bOpened = false;
-   m_bListening = false;
-   m_bConnecting = false;
-   m_bConnected = false;
-   m_bClosing = false;
-   m_bShutdown = false;
-   m_bBroken = false;
-   m_bPeerHealth = true;
-   m_ullLingerExpiration = 0;
+   reset();
 }
 
 CUDT::CUDT(const CUDT& ancestor)
@@ -139,9 +125,16 @@ CUDT::CUDT(const CUDT& ancestor)
    m_pRcvBuffer = NULL;
    m_pSndLossList = NULL;
    m_pRcvLossList = NULL;
+   m_pSACKMap = NULL;
+   m_pFECEncoder = NULL;
+   m_pFECDecoder = NULL;
    m_pACKWindow = NULL;
    m_pSndTimeWindow = NULL;
    m_pRcvTimeWindow = NULL;
+   m_pCCFactory = NULL;
+   m_pCC = NULL;
+   m_pcResumeData = NULL;
+   m_pStreamMux = NULL;
 
    m_pSndQueue = NULL;
    m_pRcvQueue = NULL;
@@ -152,7 +145,83 @@ CUDT::CUDT(const CUDT& ancestor)
    // Initilize mutex and condition variables
    initSynch();
 
-   // Default UDT configurations
+   // Configurations inherited from the listener
+   copyOpt(ancestor);
+
+   // Initial status
+   reset();
+}
+
+CUDT::~CUDT()
+{
+   // the stream threads wait on the synchronization objects
+   delete m_pStreamMux;
+
+   // release mutex/condtion variables
+   destroySynch();
+
+   // destroy the data structures
+   delete m_pSndBuffer;
+   delete m_pRcvBuffer;
+   delete m_pSndLossList;
+   delete m_pRcvLossList;
+   delete m_pSACKMap;
+   delete m_pFECEncoder;
+   delete m_pFECDecoder;
+   delete m_pACKWindow;
+   delete m_pSndTimeWindow;
+   delete m_pRcvTimeWindow;
+   delete m_pCCFactory;
+   delete m_pCC;
+   delete m_pPeerAddr;
+   delete [] m_pcResumeData;
+   delete m_pSNode;
+   delete m_pRNode;
+}
+
+void CUDT::defaultOpt()
+{
+   m_iMSS = 1500;
+   m_bSynSending = true;
+   m_bSynRecving = true;
+   m_iFlightFlagSize = 25600;
+   m_iSndBufSize = 8192;
+   m_iRcvBufSize = 8192; //Rcv buffer MUST NOT be bigger than Flight Flag size
+   m_Linger.l_onoff = 1;
+   m_Linger.l_linger = 180;
+   m_iUDPSndBufSize = 65536;
+   m_iUDPRcvBufSize = m_iRcvBufSize * m_iMSS;
+   m_iSockType = UDT_STREAM;
+   m_iIPversion = AF_INET;
+   m_bRendezvous = false;
+   m_iSndTimeOut = -1;
+   m_iRcvTimeOut = -1;
+   m_bReuseAddr = true;
+   m_llMaxBW = -1;
+   m_bSACK = false;
+   m_iMaxReorderTolerance = 0;
+   m_iFECGroup = 0;
+   m_bPMTUD = false;
+   m_iCoalesce = -1;
+   m_bLowLatency = false;
+   m_iBusyPoll = 0;
+   m_iPollCPU = -1;
+   m_llCPUMask = 0;
+   m_iNUMANode = -1;
+   m_iWorkerPool = 0;
+   m_bResume = false;
+   m_bDirectIO = false;
+   m_iStreamWindow = 1048576;
+
+   delete m_pCCFactory;
+   m_pCCFactory = new CCCFactory<CUDTCC>;
+   m_iCCAlgo = UDT_CCALGO_DAIMD;
+   m_pCache = NULL;
+   m_pTokenCache = NULL;
+}
+
+void CUDT::copyOpt(const CUDT& ancestor)
+{
    m_iMSS = ancestor.m_iMSS;
    m_bSynSending = ancestor.m_bSynSending;
    m_bSynRecving = ancestor.m_bSynRecving;
@@ -169,41 +238,82 @@ CUDT::CUDT(const CUDT& ancestor)
    m_iRcvTimeOut = ancestor.m_iRcvTimeOut;
    m_bReuseAddr = true;	// this must be true, because all accepted sockets shared the same port with the listener
    m_llMaxBW = ancestor.m_llMaxBW;
+   m_bSACK = ancestor.m_bSACK;
+   m_iMaxReorderTolerance = ancestor.m_iMaxReorderTolerance;
+   m_iFECGroup = ancestor.m_iFECGroup;
+   m_bPMTUD = ancestor.m_bPMTUD;
+   m_iCoalesce = ancestor.m_iCoalesce;
+   m_bLowLatency = ancestor.m_bLowLatency;
+   m_iBusyPoll = ancestor.m_iBusyPoll;
+   m_iPollCPU = ancestor.m_iPollCPU;
+   m_llCPUMask = ancestor.m_llCPUMask;
+   m_iNUMANode = ancestor.m_iNUMANode;
+   m_iWorkerPool = ancestor.m_iWorkerPool;
+   m_bResume = ancestor.m_bResume;
+   m_bDirectIO = ancestor.m_bDirectIO;
+   m_iStreamWindow = ancestor.m_iStreamWindow;
 
+   delete m_pCCFactory;
    m_pCCFactory = ancestor.m_pCCFactory->clone();
-   m_pCC = NULL;
+   m_iCCAlgo = ancestor.m_iCCAlgo;
    m_pCache = ancestor.m_pCache;
-
-   // Initial status
-   m_bOpened = false;
-   m_bListening = false;
-   m_bConnecting = false;
-   m_bConnected = false;
-   m_bClosing = false;
-   m_bShutdown = false;
-   m_bBroken = false;
-   m_bPeerHealth = true;
-   m_ullLingerExpiration = 0;
+   m_pTokenCache = ancestor.m_pTokenCache;
 }
 
-CUDT::~CUDT()
+void CUDT::reset()
 {
-   // release mutex/condtion variables
-   destroySynch();
-
-   // destroy the data structures
+   // the data structures are rebuilt by the next connect(), the queue nodes and the synchronization objects are kept
    delete m_pSndBuffer;
    delete m_pRcvBuffer;
    delete m_pSndLossList;
    delete m_pRcvLossList;
+   delete m_pSACKMap;
+   delete m_pFECEncoder;
+   delete m_pFECDecoder;
    delete m_pACKWindow;
    delete m_pSndTimeWindow;
    delete m_pRcvTimeWindow;
-   delete m_pCCFactory;
    delete m_pCC;
    delete m_pPeerAddr;
-   delete m_pSNode;
-   delete m_pRNode;
+   delete [] m_pcResumeData;
+   delete m_pStreamMux;
+   m_pSndBuffer = NULL;
+   m_pRcvBuffer = NULL;
+   m_pSndLossList = NULL;
+   m_pRcvLossList = NULL;
+   m_pSACKMap = NULL;
+   m_pFECEncoder = NULL;
+   m_pFECDecoder = NULL;
+   m_pACKWindow = NULL;
+   m_pSndTimeWindow = NULL;
+   m_pRcvTimeWindow = NULL;
+   m_pCC = NULL;
+   m_pPeerAddr = NULL;
+   m_pcResumeData = NULL;
+   m_pStreamMux = NULL;
+   m_iResumeDataSize = 0;
+   m_bResumeDataSent = false;
+
+   m_pSndQueue = NULL;
+   m_pRcvQueue = NULL;
+   m_sPollID.clear();
+   m_sUsedTokens.clear();
+   m_lUsedTokens.clear();
+
+   m_bOpened = false;
+   m_bListening = false;
+   m_bConnecting = false;
+   m_bConnected = false;
+   m_bClosing = false;
+   m_bShutdown = false;
+   m_bBroken = false;
+   m_bPeerHealth = true;
+   m_ullLingerExpiration = 0;
+   m_iExtension = 0;
+   m_iReqExtension = 0;
+   m_iPeerFECGroup = 0;
+   m_bPeerCoalesce = false;
+   m_bFlushWait = false;
 }
 
 void CUDT::setOpt(UDTOpt optName, const void* optval, int)
@@ -212,6 +322,11 @@ void CUDT::setOpt(UDTOpt optName, const void* optval, int)
       throw CUDTException(2, 1, 0);
 
    CGuard cg(m_ConnectionLock);
+
+   // the blocking options of a socket carrying streams belong to the stream calls
+   if ((NULL != m_pStreamMux) && m_pStreamMux->setOpt(optName, optval))
+      return;
+
    CGuard sendguard(m_SendLock);
    CGuard recvguard(m_RecvLock);
 
@@ -221,7 +336,8 @@ void CUDT::setOpt(UDTOpt optName, const void* optval, int)
       if (m_bOpened)
          throw CUDTException(5, 1, 0);
 
-      if (*(int*)optval < int(28 + CHandShake::m_iContentSize))
+      // the MSS is carried in the lower 16 bits of the handshake field
+      if ((*(int*)optval < int(28 + CHandShake::m_iContentSize)) || (*(int*)optval > 0xFFFF))
          throw CUDTException(5, 3, 0);
 
       m_iMSS = *(int*)optval;
@@ -248,6 +364,37 @@ void CUDT::setOpt(UDTOpt optName, const void* optval, int)
       if (NULL != m_pCCFactory)
          delete m_pCCFactory;
       m_pCCFactory = ((CCCVirtualFactory *)optval)->clone();
+      m_iCCAlgo = UDT_CCALGO_CUSTOM;
+
+      break;
+
+   case UDT_CCALGO:
+      if (m_bConnecting || m_bConnected)
+         throw CUDTException(5, 1, 0);
+
+      if (UDT_CCALGO_DAIMD == *(int*)optval)
+      {
+         delete m_pCCFactory;
+         m_pCCFactory = new CCCFactory<CUDTCC>;
+      }
+      else if (UDT_CCALGO_BBR == *(int*)optval)
+      {
+         delete m_pCCFactory;
+         m_pCCFactory = new CCCFactory<CBBRCC>;
+      }
+      else if (UDT_CCALGO_CUBIC == *(int*)optval)
+      {
+         delete m_pCCFactory;
+         m_pCCFactory = new CCCFactory<CCUBICCC>;
+      }
+      else if (UDT_CCALGO_LEDBAT == *(int*)optval)
+      {
+         delete m_pCCFactory;
+         m_pCCFactory = new CCCFactory<CLEDBATCC>;
+      }
+      else
+         throw CUDTException(5, 3, 0);
+      m_iCCAlgo = *(int*)optval;
 
       break;
 
@@ -345,6 +492,116 @@ void CUDT::setOpt(UDTOpt optName, const void* optval, int)
    case UDT_MAXBW:
       m_llMaxBW = *(int64_t*)optval;
       break;
+
+   case UDT_SACK:
+      if (m_bConnecting || m_bConnected)
+         throw CUDTException(5, 2, 0);
+      m_bSACK = *(bool*)optval;
+      break;
+
+   case UDT_REORDER:
+      if (m_bConnecting || m_bConnected)
+         throw CUDTException(5, 2, 0);
+
+      if (*(int*)optval < 0)
+         throw CUDTException(5, 3, 0);
+
+      m_iMaxReorderTolerance = *(int*)optval;
+      break;
+
+   case UDT_FEC:
+      if (m_bConnecting || m_bConnected)
+         throw CUDTException(5, 2, 0);
+
+      // a parity group is tracked in a 64-bit mask, and its size travels in 7 bits of the handshake
+      if ((*(int*)optval < 0) || (*(int*)optval > 64))
+         throw CUDTException(5, 3, 0);
+
+      m_iFECGroup = *(int*)optval;
+      break;
+
+   case UDT_PMTUD:
+      if (m_bConnecting || m_bConnected)
+         throw CUDTException(5, 2, 0);
+      m_bPMTUD = *(bool*)optval;
+      break;
+
+   case UDT_COALESCE:
+      if (m_bConnecting || m_bConnected)
+         throw CUDTException(5, 2, 0);
+
+      // the wait is added to the latency of every small message, keep it below a second
+      if ((*(int*)optval < -1) || (*(int*)optval > 1000000))
+         throw CUDTException(5, 3, 0);
+
+      m_iCoalesce = *(int*)optval;
+      break;
+
+   case UDT_LOWLATENCY:
+      m_bLowLatency = *(bool*)optval;
+      break;
+
+   case UDT_BUSYPOLL:
+      if (m_bOpened)
+         throw CUDTException(5, 1, 0);
+
+      if ((*(int*)optval < 0) || (*(int*)optval > 1000000))
+         throw CUDTException(5, 3, 0);
+
+      m_iBusyPoll = *(int*)optval;
+      break;
+
+   case UDT_POLLCPU:
+      if (m_bOpened)
+         throw CUDTException(5, 1, 0);
+
+      if ((*(int*)optval < -1) || (*(int*)optval >= 64))
+         throw CUDTException(5, 3, 0);
+
+      m_iPollCPU = *(int*)optval;
+      break;
+
+   case UDT_CPUMASK:
+      if (m_bOpened)
+         throw CUDTException(5, 1, 0);
+      m_llCPUMask = *(int64_t*)optval;
+      break;
+
+   case UDT_NUMANODE:
+      if (m_bOpened)
+         throw CUDTException(5, 1, 0);
+
+      // the node goes into a 64-bit node mask
+      if ((*(int*)optval < -1) || (*(int*)optval >= 63))
+         throw CUDTException(5, 3, 0);
+
+      m_iNUMANode = *(int*)optval;
+      break;
+
+   case UDT_WORKERPOOL:
+      if (m_bOpened)
+         throw CUDTException(5, 1, 0);
+
+      if ((*(int*)optval < 0) || (*(int*)optval > 256))
+         throw CUDTException(5, 3, 0);
+
+      m_iWorkerPool = *(int*)optval;
+      break;
+
+   case UDT_RESUME:
+      m_bResume = *(bool*)optval;
+      break;
+
+   case UDT_DIRECTIO:
+      m_bDirectIO = *(bool*)optval;
+      break;
+
+   case UDT_STREAMWND:
+      if (*(int*)optval < 65536)
+         throw CUDTException(5, 3, 0);
+
+      m_iStreamWindow = *(int*)optval;
+      break;
     
    default:
       throw CUDTException(5, 0, 0);
@@ -355,6 +612,9 @@ void CUDT::getOpt(UDTOpt optName, void* optval, int& optlen)
 {
    CGuard cg(m_ConnectionLock);
 
+   if ((NULL != m_pStreamMux) && m_pStreamMux->getOpt(optName, optval, optlen))
+      return;
+
    switch (optName)
    {
    case UDT_MSS:
@@ -438,6 +698,81 @@ void CUDT::getOpt(UDTOpt optName, void* optval, int& optlen)
       optlen = sizeof(int64_t);
       break;
 
+   case UDT_SACK:
+      *(bool*)optval = m_bSACK;
+      optlen = sizeof(bool);
+      break;
+
+   case UDT_REORDER:
+      *(int*)optval = m_iMaxReorderTolerance;
+      optlen = sizeof(int);
+      break;
+
+   case UDT_FEC:
+      *(int*)optval = m_iFECGroup;
+      optlen = sizeof(int);
+      break;
+
+   case UDT_PMTUD:
+      *(bool*)optval = m_bPMTUD;
+      optlen = sizeof(bool);
+      break;
+
+   case UDT_CCALGO:
+      *(int*)optval = m_iCCAlgo;
+      optlen = sizeof(int);
+      break;
+
+   case UDT_COALESCE:
+      *(int*)optval = m_iCoalesce;
+      optlen = sizeof(int);
+      break;
+
+   case UDT_LOWLATENCY:
+      *(bool*)optval = m_bLowLatency;
+      optlen = sizeof(bool);
+      break;
+
+   case UDT_BUSYPOLL:
+      *(int*)optval = m_iBusyPoll;
+      optlen = sizeof(int);
+      break;
+
+   case UDT_POLLCPU:
+      *(int*)optval = m_iPollCPU;
+      optlen = sizeof(int);
+      break;
+
+   case UDT_CPUMASK:
+      *(int64_t*)optval = m_llCPUMask;
+      optlen = sizeof(int64_t);
+      break;
+
+   case UDT_NUMANODE:
+      *(int*)optval = m_iNUMANode;
+      optlen = sizeof(int);
+      break;
+
+   case UDT_WORKERPOOL:
+      *(int*)optval = m_iWorkerPool;
+      optlen = sizeof(int);
+      break;
+
+   case UDT_RESUME:
+      *(bool*)optval = m_bResume;
+      optlen = sizeof(bool);
+      break;
+
+   case UDT_DIRECTIO:
+      *(bool*)optval = m_bDirectIO;
+      optlen = sizeof(bool);
+      break;
+
+   case UDT_STREAMWND:
+      *(int*)optval = m_iStreamWindow;
+      optlen = sizeof(int);
+      break;
+
    case UDT_STATE:
       *(int32_t*)optval = s_UDTUnited.getStatus(m_SocketID);
       optlen = sizeof(int32_t);
@@ -497,10 +832,22 @@ void CUDT::open()
 
    // trace information
    m_StartTime = CTimer::getTime();
-   m_llSentTotal = m_llRecvTotal = m_iSndLossTotal = m_iRcvLossTotal = m_iRetransTotal = m_iSentACKTotal = m_iRecvACKTotal = m_iSentNAKTotal = m_iRecvNAKTotal = 0;
+   m_llSentTotal = m_llRecvTotal = m_iSndLossTotal = m_iRcvLossTotal = m_iRetransTotal = m_iSentACKTotal = m_iRecvACKTotal = m_iSentNAKTotal = m_iRecvNAKTotal = m_iRcvSpuriousTotal = 0;
+   m_iSentParityTotal = m_iRecvParityTotal = m_iRcvRecoveredTotal = 0;
+   m_llSentCtrlTotal = m_llRecvCtrlTotal = 0;
+   m_llSentMsgTotal = m_llRecvMsgTotal = 0;
    m_LastSampleTime = CTimer::getTime();
-   m_llTraceSent = m_llTraceRecv = m_iTraceSndLoss = m_iTraceRcvLoss = m_iTraceRetrans = m_iSentACK = m_iRecvACK = m_iSentNAK = m_iRecvNAK = 0;
+   m_llTraceSent = m_llTraceRecv = m_iTraceSndLoss = m_iTraceRcvLoss = m_iTraceRetrans = m_iSentACK = m_iRecvACK = m_iSentNAK = m_iRecvNAK = m_iRcvSpurious = 0;
+   m_iSentParity = m_iRecvParity = m_iRcvRecovered = 0;
+   m_llSentCtrl = m_llRecvCtrl = 0;
+   m_llTraceSentMsg = m_llTraceRecvMsg = m_llTraceSentBytes = 0;
    m_llSndDuration = m_llSndDurationTotal = 0;
+   m_iReorderTolerance = 0;
+   m_ReorderGaps.clear();
+   m_iReportedGaps = 0;
+
+   CTimer::rdtsc(m_ullLastDataTime);
+   m_llIdleSentTotal = m_llIdleRecvTotal = 0;
 
    // structures for queue
    if (NULL == m_pSNode)
@@ -538,6 +885,7 @@ void CUDT::open()
 
    m_iPktCount = 0;
    m_iLightACKCount = 1;
+   m_iLightACKInterval = m_iSelfClockInterval;
 
    m_ullTargetTime = 0;
    m_ullTimeDiff = 0;
@@ -560,6 +908,13 @@ void CUDT::listen()
    if (m_bListening)
       return;
 
+   // the SYN cookies and the resumption tokens are signed with a secret of this listener
+   if (!CRandom::fill(m_pcSecret, sizeof(m_pcSecret)))
+      throw CUDTException(3, 0);
+   m_iTokenSerial = 0;
+   m_sUsedTokens.clear();
+   m_lUsedTokens.clear();
+
    // if there is already another socket listening on the same port
    if (m_pRcvQueue->setListener(this) < 0)
       throw CUDTException(5, 11, 0);
@@ -567,7 +922,7 @@ void CUDT::listen()
    m_bListening = true;
 }
 
-void CUDT::connect(const sockaddr* serv_addr)
+int CUDT::connect(const sockaddr* serv_addr, const char* data, int len)
 {
    CGuard cg(m_ConnectionLock);
 
@@ -580,6 +935,10 @@ void CUDT::connect(const sockaddr* serv_addr)
    if (m_bConnecting || m_bConnected)
       throw CUDTException(5, 2, 0);
 
+   // data can only lead a stream
+   if ((len > 0) && (UDT_STREAM != m_iSockType))
+      throw CUDTException(5, 10, 0);
+
    m_bConnecting = true;
 
    // record peer/server address
@@ -599,11 +958,67 @@ void CUDT::connect(const sockaddr* serv_addr)
    m_ConnReq.m_iVersion = m_iVersion;
    m_ConnReq.m_iType = m_iSockType;
    m_ConnReq.m_iMSS = m_iMSS;
+   m_ConnReq.m_iExtension = 0;
+   m_iReqExtension = 0;
+   if (!m_bRendezvous)
+   {
+      m_iReqExtension = CHandShake::m_iExtAware | CHandShake::m_iExtOWD;
+      if (m_bSACK)
+         m_iReqExtension |= CHandShake::m_iExtSACK;
+      if (m_iFECGroup > 0)
+         m_iReqExtension |= CHandShake::m_iExtFEC | (m_iFECGroup << 8);
+      if (m_bPMTUD)
+         m_iReqExtension |= CHandShake::m_iExtPMTUD;
+
+      // any message socket can read packed messages, packing itself is up to each side
+      if (UDT_DGRAM == m_iSockType)
+         m_iReqExtension |= CHandShake::m_iExtCoalesce;
+      if ((UDT_DGRAM == m_iSockType) && (m_iCoalesce >= 0))
+         m_iReqExtension |= CHandShake::m_iExtCoalescing;
+
+      // ask for a token to resume the next connection with
+      m_iReqExtension |= CHandShake::m_iExtResume;
+   }
    m_ConnReq.m_iFlightFlagSize = (m_iRcvBufSize < m_iFlightFlagSize)? m_iRcvBufSize : m_iFlightFlagSize;
    m_ConnReq.m_iReqType = (!m_bRendezvous) ? 1 : 0;
    m_ConnReq.m_iID = m_SocketID;
+   m_ConnReq.m_iCookie = 0;
+   m_ConnReq.m_bToken = false;
    CIPAddress::ntop(serv_addr, m_ConnReq.m_piPeerIP, m_iIPversion);
 
+   // keep the first packet of data until the connection is set up
+   delete [] m_pcResumeData;
+   m_pcResumeData = NULL;
+   m_iResumeDataSize = 0;
+   m_bResumeDataSent = false;
+   if ((len > 0) && (NULL != data))
+   {
+      m_iResumeDataSize = m_iPayloadSize - CHandShake::m_iContentSize - CHandShake::m_iTokenSize;
+      if (m_iResumeDataSize > len)
+         m_iResumeDataSize = len;
+      if (m_iResumeDataSize < 0)
+         m_iResumeDataSize = 0;
+      m_pcResumeData = new char[m_iResumeDataSize + 1];
+      memcpy(m_pcResumeData, data, m_iResumeDataSize);
+   }
+
+   // a token from the last connection to this listener saves the cookie round trip, and carries the data along
+   CTokenBlock tb;
+   tb.setAddr(serv_addr, m_iIPversion);
+   if (!m_bRendezvous && (m_pTokenCache->lookup(&tb) >= 0) && (tb.m_ullTimeStamp > 0) && (CTimer::getTime() - tb.m_ullTimeStamp < m_iResumeTokenTTL * 1000000ULL))
+   {
+      // the token comes from a listener that knows the extensions
+      m_ConnReq.m_iReqType = 2;
+      m_ConnReq.m_iExtension = m_iReqExtension;
+      m_ConnReq.m_bToken = true;
+      memcpy(m_ConnReq.m_piToken, tb.m_piToken, sizeof(tb.m_piToken));
+
+      // the listener takes the data as the first packet of the peer, parity groups would not cover it
+      m_bResumeDataSent = (m_iResumeDataSize > 0) && (0 == m_iFECGroup);
+      if (m_bResumeDataSent)
+         m_ConnReq.m_iCookie = m_iResumeDataSize;
+   }
+
    // Random Initial Sequence Number
    srand((unsigned int)CTimer::getTime());
    m_iISN = m_ConnReq.m_iISN = (int32_t)(CSeqNo::m_iMaxSeqNo * (double(rand()) / RAND_MAX));
@@ -614,6 +1029,11 @@ void CUDT::connect(const sockaddr* serv_addr)
    m_iSndCurrSeqNo = m_iISN - 1;
    m_iSndLastAck2 = m_iISN;
    m_ullSndLastAck2Time = CTimer::getTime();
+   m_iSACKLastAck = m_iISN;
+
+   // start from a small reorder window and let the observed reordering widen it
+   m_iReorderTolerance = (m_iMaxReorderTolerance < 3) ? m_iMaxReorderTolerance : 3;
+   m_iReorderDecay = 0;
 
    // Inform the server my configurations.
    CPacket request;
@@ -624,7 +1044,24 @@ void CUDT::connect(const sockaddr* serv_addr)
 
    int hs_size = m_iPayloadSize;
    m_ConnReq.serialize(reqdata, hs_size);
+   if (m_bResumeDataSent)
+   {
+      memcpy(reqdata + hs_size, m_pcResumeData, m_iResumeDataSize);
+      hs_size += m_iResumeDataSize;
+      request.m_iTimeStamp = int(CTimer::getTime() - m_StartTime);
+   }
    request.setLength(hs_size);
+
+   // only the first request resumes, the listener answers the retries as regular requests;
+   // they go without flags, as the listener may have been replaced since it issued the token
+   if (2 == m_ConnReq.m_iReqType)
+   {
+      m_ConnReq.m_iReqType = 1;
+      m_ConnReq.m_iExtension = 0;
+      m_ConnReq.m_iCookie = 0;
+      m_ConnReq.m_bToken = false;
+   }
+
    m_pSndQueue->sendto(serv_addr, request);
    m_llLastReqTime = CTimer::getTime();
 
@@ -632,7 +1069,7 @@ void CUDT::connect(const sockaddr* serv_addr)
    if (!m_bSynRecving)
    {
       delete [] reqdata;
-      return;
+      return m_iResumeDataSize;
    }
 
    // Wait for the negotiated configurations from the peer side.
@@ -678,7 +1115,7 @@ void CUDT::connect(const sockaddr* serv_addr)
 
    if (e.getErrorCode() == 0)
    {
-      if (m_bClosing)                                                 // if the socket is closed before connection...
+      if (m_bClosing && !m_bConnected)                                // if the socket is closed before connection...
          e = CUDTException(1);
       else if (1002 == m_ConnRes.m_iReqType)                          // connection request rejected
          e = CUDTException(1, 2, 0);
@@ -688,6 +1125,8 @@ void CUDT::connect(const sockaddr* serv_addr)
 
    if (e.getErrorCode() != 0)
       throw e;
+
+   return m_iResumeDataSize;
 }
 
 int CUDT::connect(const CPacket& response) throw ()
@@ -731,6 +1170,8 @@ int CUDT::connect(const CPacket& response) throw ()
       // set cookie
       if (1 == m_ConnRes.m_iReqType)
       {
+         // a listener that does not know the extensions echoes the request, which carries no flags
+         m_ConnReq.m_iExtension = (m_ConnRes.m_iExtension & CHandShake::m_iExtAware) ? m_iReqExtension : 0;
          m_ConnReq.m_iReqType = -1;
          m_ConnReq.m_iCookie = m_ConnRes.m_iCookie;
          m_llLastReqTime = 0;
@@ -739,29 +1180,52 @@ int CUDT::connect(const CPacket& response) throw ()
    }
 
 POST_CONNECT:
-   // Remove from rendezvous queue
-   m_pRcvQueue->removeConnector(m_SocketID);
-
-   // Re-configure according to the negotiated values.
-   m_iMSS = m_ConnRes.m_iMSS;
+   // Re-configure according to the negotiated values; the units of the queues hold no more than the local MSS
+   if (m_ConnRes.m_iMSS < m_iMSS)
+      m_iMSS = m_ConnRes.m_iMSS;
+   // a listener that does not know the flags never answers with any; the request may have gone
+   // without them (a retry of a resumption request) while an earlier one is answered here
+   m_iExtension = m_iReqExtension & m_ConnRes.m_iExtension & 0xFF;
+   m_iPeerFECGroup = (m_ConnRes.m_iExtension >> 8) & 0x7F;
+   if ((m_iPeerFECGroup < 1) || (m_iPeerFECGroup > 64))
+      m_iExtension &= ~CHandShake::m_iExtFEC;
+   m_bPeerCoalesce = (m_iExtension & CHandShake::m_iExtCoalesce) && (m_ConnRes.m_iExtension & CHandShake::m_iExtCoalescing);
    m_iFlowWindowSize = m_ConnRes.m_iFlightFlagSize;
    m_iPktSize = m_iMSS - 28;
    m_iPayloadSize = m_iPktSize - CPacket::m_iPktHdrSize;
+
+   // leave room for the parity header, so that a parity packet fits in a receiving unit
+   if (m_iExtension & CHandShake::m_iExtFEC)
+      m_iPayloadSize = (m_iPayloadSize - 8) & ~3;
    m_iPeerISN = m_ConnRes.m_iISN;
    m_iRcvLastAck = m_ConnRes.m_iISN;
    m_iRcvLastAckAck = m_ConnRes.m_iISN;
    m_iRcvCurrSeqNo = m_ConnRes.m_iISN - 1;
+   m_iRcvOWD = 0;
+   m_bRcvOWDReset = true;
    m_PeerID = m_ConnRes.m_iID;
    memcpy(m_piSelfIP, m_ConnRes.m_piPeerIP, 16);
 
    // Prepare all data structures
    try
    {
-      m_pSndBuffer = new CSndBuffer(32, m_iPayloadSize);
-      m_pRcvBuffer = new CRcvBuffer(&(m_pRcvQueue->m_UnitQueue), m_iRcvBufSize);
+      m_pSndBuffer = new CSndBuffer(32, m_iPayloadSize, m_iNUMANode);
+      m_pRcvBuffer = new CRcvBuffer(&(m_pRcvQueue->m_UnitQueue), m_iRcvBufSize, UDT_DGRAM == m_iSockType);
+      if (m_iExtension & CHandShake::m_iExtCoalesce)
+      {
+         m_pSndBuffer->setCoalesce(m_iCoalesce);
+         m_pRcvBuffer->setCoalesce(m_bPeerCoalesce);
+      }
       // after introducing lite ACK, the sndlosslist may not be cleared in time, so it requires twice space.
       m_pSndLossList = new CSndLossList(m_iFlowWindowSize * 2);
       m_pRcvLossList = new CRcvLossList(m_iFlightFlagSize);
+      if (m_iExtension & CHandShake::m_iExtSACK)
+         m_pSACKMap = new CSeqBitmap(m_iFlowWindowSize * 2);
+      if (m_iExtension & CHandShake::m_iExtFEC)
+      {
+         m_pFECEncoder = new CFECEncoder(m_iFECGroup, m_iPayloadSize);
+         m_pFECDecoder = new CFECDecoder(m_iPeerFECGroup, m_iPayloadSize);
+      }
       m_pACKWindow = new CACKWindow(1024);
       m_pRcvTimeWindow = new CPktTimeWindow(16, 64);
       m_pSndTimeWindow = new CPktTimeWindow();
@@ -771,28 +1235,37 @@ POST_CONNECT:
       throw CUDTException(3, 2, 0);
    }
 
-   CInfoBlock ib;
-   ib.m_iIPversion = m_iIPversion;
-   CInfoBlock::convert(m_pPeerAddr, m_iIPversion, ib.m_piIP);
-   if (m_pCache->lookup(&ib) >= 0)
-   {
-      m_iRTT = ib.m_iRTT;
-      m_iBandwidth = ib.m_iBandwidth;
-   }
+   initCC(m_pPeerAddr);
 
-   m_pCC = m_pCCFactory->create();
-   m_pCC->m_UDT = m_SocketID;
-   m_pCC->setMSS(m_iMSS);
-   m_pCC->setMaxCWndSize(m_iFlowWindowSize);
-   m_pCC->setSndCurrSeqNo(m_iSndCurrSeqNo);
-   m_pCC->setRcvRate(m_iDeliveryRate);
-   m_pCC->setRTT(m_iRTT);
-   m_pCC->setBandwidth(m_iBandwidth);
-   m_pCC->init();
+   initPMTU();
 
    m_ullInterval = (uint64_t)(m_pCC->m_dPktSndPeriod * m_ullCPUFrequency);
    m_dCongestionWindow = m_pCC->m_dCWndSize;
 
+   // the data given to connect() leads the stream; if the listener has taken it with the handshake,
+   // the first packet counts as sent and goes out again only if it is reported lost. This is settled
+   // before the socket is registered, since the peer's acknowledgement may be waiting for it already.
+   if (m_iResumeDataSize > 0)
+   {
+      m_pSndBuffer->addBuffer(m_pcResumeData, m_iResumeDataSize);
+
+      m_bResumeDataSent = m_bResumeDataSent && (m_iExtension & CHandShake::m_iExtResume) && m_ConnRes.m_bToken;
+      if (m_bResumeDataSent)
+      {
+         char* payload;
+         int32_t msgno;
+         m_pSndBuffer->readData(&payload, msgno);
+         m_iSndCurrSeqNo = CSeqNo::incseq(m_iSndCurrSeqNo);
+
+         uint64_t currtime;
+         CTimer::rdtsc(currtime);
+         m_ullLastRspTime = currtime;
+      }
+
+      delete [] m_pcResumeData;
+      m_pcResumeData = NULL;
+   }
+
    // And, I am connected too.
    m_bConnecting = false;
    m_bConnected = true;
@@ -801,6 +1274,20 @@ POST_CONNECT:
    m_pRNode->m_bOnList = true;
    m_pRcvQueue->setNewEntry(this);
 
+   // Remove from rendezvous queue only now, so that no packet finds the socket in neither queue;
+   // what the receiving worker stored meanwhile is passed on when it registers the socket
+   m_pRcvQueue->removeConnector(m_SocketID, true);
+
+   if (!m_bRendezvous)
+      saveToken();
+
+   if ((m_iResumeDataSize > 0) && !m_bResumeDataSent)
+      m_pSndQueue->m_pSndUList->update(this, false);
+
+   // a rendezvous peer whose request completed the connection here waits for the answer to it
+   if (m_bRendezvous && (-1 == m_ConnRes.m_iReqType))
+      sendHandshake();
+
    // acknowledge the management module.
    s_UDTUnited.connect_complete(m_SocketID);
 
@@ -820,6 +1307,28 @@ void CUDT::connect(const sockaddr* peer, CHandShake* hs)
    else
       m_iMSS = hs->m_iMSS;
 
+   // accept only the extensions that are enabled on this side, and tell the peer
+   m_iExtension = hs->m_iExtension & 0xFF;
+   if (!m_bSACK)
+      m_iExtension &= ~CHandShake::m_iExtSACK;
+   if (0 == m_iFECGroup)
+      m_iExtension &= ~CHandShake::m_iExtFEC;
+   if (!m_bPMTUD)
+      m_iExtension &= ~CHandShake::m_iExtPMTUD;
+   if (UDT_DGRAM != m_iSockType)
+      m_iExtension &= ~CHandShake::m_iExtCoalesce;
+   // the decoder tracks a group in a 64-bit mask, a peer that asks for more gets no FEC
+   m_iPeerFECGroup = (hs->m_iExtension >> 8) & 0x7F;
+   if ((m_iPeerFECGroup < 1) || (m_iPeerFECGroup > 64))
+      m_iExtension &= ~CHandShake::m_iExtFEC;
+   m_bPeerCoalesce = (m_iExtension & CHandShake::m_iExtCoalesce) && (m_iExtension & CHandShake::m_iExtCoalescing);
+   m_iExtension &= ~CHandShake::m_iExtCoalescing;
+   hs->m_iExtension = m_iExtension;
+   if (m_iExtension & CHandShake::m_iExtFEC)
+      hs->m_iExtension |= m_iFECGroup << 8;
+   if ((m_iExtension & CHandShake::m_iExtCoalesce) && (m_iCoalesce >= 0))
+      hs->m_iExtension |= CHandShake::m_iExtCoalescing;
+
    // exchange info for maximum flow window size
    m_iFlowWindowSize = hs->m_iFlightFlagSize;
    hs->m_iFlightFlagSize = (m_iRcvBufSize < m_iFlightFlagSize)? m_iRcvBufSize : m_iFlightFlagSize;
@@ -829,6 +1338,8 @@ void CUDT::connect(const sockaddr* peer, CHandShake* hs)
    m_iRcvLastAck = hs->m_iISN;
    m_iRcvLastAckAck = hs->m_iISN;
    m_iRcvCurrSeqNo = hs->m_iISN - 1;
+   m_iRcvOWD = 0;
+   m_bRcvOWDReset = true;
 
    m_PeerID = hs->m_iID;
    hs->m_iID = m_SocketID;
@@ -842,6 +1353,11 @@ void CUDT::connect(const sockaddr* peer, CHandShake* hs)
    m_iSndCurrSeqNo = m_iISN - 1;
    m_iSndLastAck2 = m_iISN;
    m_ullSndLastAck2Time = CTimer::getTime();
+   m_iSACKLastAck = m_iISN;
+
+   // start from a small reorder window and let the observed reordering widen it
+   m_iReorderTolerance = (m_iMaxReorderTolerance < 3) ? m_iMaxReorderTolerance : 3;
+   m_iReorderDecay = 0;
 
    // this is a reponse handshake
    hs->m_iReqType = -1;
@@ -853,13 +1369,29 @@ void CUDT::connect(const sockaddr* peer, CHandShake* hs)
    m_iPktSize = m_iMSS - 28;
    m_iPayloadSize = m_iPktSize - CPacket::m_iPktHdrSize;
 
+   // leave room for the parity header, so that a parity packet fits in a receiving unit
+   if (m_iExtension & CHandShake::m_iExtFEC)
+      m_iPayloadSize = (m_iPayloadSize - 8) & ~3;
+
    // Prepare all structures
    try
    {
-      m_pSndBuffer = new CSndBuffer(32, m_iPayloadSize);
-      m_pRcvBuffer = new CRcvBuffer(&(m_pRcvQueue->m_UnitQueue), m_iRcvBufSize);
+      m_pSndBuffer = new CSndBuffer(32, m_iPayloadSize, m_iNUMANode);
+      m_pRcvBuffer = new CRcvBuffer(&(m_pRcvQueue->m_UnitQueue), m_iRcvBufSize, UDT_DGRAM == m_iSockType);
+      if (m_iExtension & CHandShake::m_iExtCoalesce)
+      {
+         m_pSndBuffer->setCoalesce(m_iCoalesce);
+         m_pRcvBuffer->setCoalesce(m_bPeerCoalesce);
+      }
       m_pSndLossList = new CSndLossList(m_iFlowWindowSize * 2);
       m_pRcvLossList = new CRcvLossList(m_iFlightFlagSize);
+      if (m_iExtension & CHandShake::m_iExtSACK)
+         m_pSACKMap = new CSeqBitmap(m_iFlowWindowSize * 2);
+      if (m_iExtension & CHandShake::m_iExtFEC)
+      {
+         m_pFECEncoder = new CFECEncoder(m_iFECGroup, m_iPayloadSize);
+         m_pFECDecoder = new CFECDecoder(m_iPeerFECGroup, m_iPayloadSize);
+      }
       m_pACKWindow = new CACKWindow(1024);
       m_pRcvTimeWindow = new CPktTimeWindow(16, 64);
       m_pSndTimeWindow = new CPktTimeWindow();
@@ -869,24 +1401,9 @@ void CUDT::connect(const sockaddr* peer, CHandShake* hs)
       throw CUDTException(3, 2, 0);
    }
 
-   CInfoBlock ib;
-   ib.m_iIPversion = m_iIPversion;
-   CInfoBlock::convert(peer, m_iIPversion, ib.m_piIP);
-   if (m_pCache->lookup(&ib) >= 0)
-   {
-      m_iRTT = ib.m_iRTT;
-      m_iBandwidth = ib.m_iBandwidth;
-   }
+   initCC(peer);
 
-   m_pCC = m_pCCFactory->create();
-   m_pCC->m_UDT = m_SocketID;
-   m_pCC->setMSS(m_iMSS);
-   m_pCC->setMaxCWndSize(m_iFlowWindowSize);
-   m_pCC->setSndCurrSeqNo(m_iSndCurrSeqNo);
-   m_pCC->setRcvRate(m_iDeliveryRate);
-   m_pCC->setRTT(m_iRTT);
-   m_pCC->setBandwidth(m_iBandwidth);
-   m_pCC->init();
+   initPMTU();
 
    m_ullInterval = (uint64_t)(m_pCC->m_dPktSndPeriod * m_ullCPUFrequency);
    m_dCongestionWindow = m_pCC->m_dCWndSize;
@@ -903,7 +1420,7 @@ void CUDT::connect(const sockaddr* peer, CHandShake* hs)
 
    //send the response to the peer, see listen() for more discussions about this
    CPacket response;
-   int size = CHandShake::m_iContentSize;
+   int size = CHandShake::m_iContentSize + CHandShake::m_iTokenSize;
    char* buffer = new char[size];
    hs->serialize(buffer, size);
    response.pack(0, NULL, buffer, size);
@@ -936,13 +1453,19 @@ void CUDT::close()
             return;
          }
 
+         // every ACK signals the send condition, so wake up as soon as the data is acknowledged instead of sleeping it out
          #ifndef WIN32
-            timespec ts;
-            ts.tv_sec = 0;
-            ts.tv_nsec = 1000000;
-            nanosleep(&ts, NULL);
+            uint64_t exptime = CTimer::getTime() + 1000;
+            timespec locktime;
+            locktime.tv_sec = exptime / 1000000;
+            locktime.tv_nsec = (exptime % 1000000) * 1000;
+
+            pthread_mutex_lock(&m_SendBlockLock);
+            if (m_pSndBuffer->getCurrBufSize() > 0)
+               pthread_cond_timedwait(&m_SendBlockCond, &m_SendBlockLock, &locktime);
+            pthread_mutex_unlock(&m_SendBlockLock);
          #else
-            Sleep(1);
+            WaitForSingleObject(m_SendBlockCond, 1);
          #endif
       }
    }
@@ -974,6 +1497,10 @@ void CUDT::close()
    // Signal the sender and recver if they are waiting for data.
    releaseSynch();
 
+   // the stream threads leave their calls on the connection before it goes
+   if (NULL != m_pStreamMux)
+      m_pStreamMux->stop();
+
    if (m_bListening)
    {
       m_bListening = false;
@@ -989,28 +1516,76 @@ void CUDT::close()
       if (!m_bShutdown)
          sendCtrl(5);
 
-      m_pCC->close();
+      m_pCC->close();
+
+      // Store current connection information.
+      saveCC();
+
+      m_bConnected = false;
+   }
+
+   // waiting all send and recv calls to stop
+   CGuard sendguard(m_SendLock);
+   CGuard recvguard(m_RecvLock);
+
+   // CLOSED.
+   m_bOpened = false;
+}
+
+CStreamMux* CUDT::getStreamMux()
+{
+   CGuard cg(m_ConnectionLock);
+
+   if (NULL == m_pStreamMux)
+   {
+      if (UDT_STREAM == m_iSockType)
+         throw CUDTException(5, 9, 0);
+
+      if (m_bBroken || m_bClosing)
+         throw CUDTException(2, 1, 0);
+      else if (!m_bConnected)
+         throw CUDTException(2, 2, 0);
+
+      // epoll cannot tell which stream is ready, so the stream calls only block
+      if (!m_bSynSending || !m_bSynRecving)
+         throw CUDTException(5, 14, 0);
 
-      // Store current connection information.
-      CInfoBlock ib;
-      ib.m_iIPversion = m_iIPversion;
-      CInfoBlock::convert(m_pPeerAddr, m_iIPversion, ib.m_piIP);
-      ib.m_iRTT = m_iRTT;
-      ib.m_iBandwidth = m_iBandwidth;
-      m_pCache->update(&ib);
+      m_pStreamMux = new CStreamMux(this, m_iStreamWindow);
+      m_pStreamMux->start();
+   }
 
-      m_bConnected = false;
+   return m_pStreamMux;
+}
+
+int CUDT::iovLength(const CIOVec* iov, int num)
+{
+   if ((num < 0) || ((num > 0) && (NULL == iov)))
+      throw CUDTException(5, 3, 0);
+
+   int64_t len = 0;
+   for (int i = 0; i < num; ++ i)
+   {
+      if ((iov[i].len < 0) || ((iov[i].len > 0) && (NULL == iov[i].data)))
+         throw CUDTException(5, 3, 0);
+      len += iov[i].len;
    }
 
-   // waiting all send and recv calls to stop
-   CGuard sendguard(m_SendLock);
-   CGuard recvguard(m_RecvLock);
+   if (len > 0x7FFFFFFF)
+      throw CUDTException(5, 3, 0);
 
-   // CLOSED.
-   m_bOpened = false;
+   return int(len);
 }
 
 int CUDT::send(const char* data, int len)
+{
+   CIOVec iov;
+   iov.data = (char*)data;
+   iov.len = (len > 0) ? len : 0;
+
+   return sendv(&iov, 1);
+}
+
+int CUDT::sendv(const CIOVec* iov, int num)
 {
    if (UDT_DGRAM == m_iSockType)
       throw CUDTException(5, 10, 0);
@@ -1021,6 +1596,7 @@ int CUDT::send(const char* data, int len)
    else if (!m_bConnected)
       throw CUDTException(2, 2, 0);
 
+   int len = iovLength(iov, num);
    if (len <= 0)
       return 0;
 
@@ -1105,10 +1681,14 @@ int CUDT::send(const char* data, int len)
       m_llSndDurationCounter = CTimer::getTime();
 
    // insert the user buffer into the sening list
-   m_pSndBuffer->addBuffer(data, size);
+   m_pSndBuffer->addBuffer(iov, size);
 
-   // insert this socket to snd list if it is not on the list yet
-   m_pSndQueue->m_pSndUList->update(this, false);
+   // insert this socket to snd list if it is not on the list yet,
+   // or send the first packet right here if it is idle in low latency mode
+   if (m_bLowLatency)
+      m_pSndQueue->m_pSndUList->sendNow(this);
+   else
+      m_pSndQueue->m_pSndUList->update(this, false);
 
    if (m_iSndBufSize <= m_pSndBuffer->getCurrBufSize())
    {
@@ -1120,6 +1700,15 @@ int CUDT::send(const char* data, int len)
 }
 
 int CUDT::recv(char* data, int len)
+{
+   CIOVec iov;
+   iov.data = data;
+   iov.len = (len > 0) ? len : 0;
+
+   return recvv(&iov, 1);
+}
+
+int CUDT::recvv(const CIOVec* iov, int num)
 {
    if (UDT_DGRAM == m_iSockType)
       throw CUDTException(5, 10, 0);
@@ -1130,6 +1719,7 @@ int CUDT::recv(char* data, int len)
    else if ((m_bBroken || m_bClosing) && (0 == m_pRcvBuffer->getRcvDataSize()))
       throw CUDTException(2, 1, 0);
 
+   int len = iovLength(iov, num);
    if (len <= 0)
       return 0;
 
@@ -1141,6 +1731,14 @@ int CUDT::recv(char* data, int len)
          throw CUDTException(6, 2, 0);
       else
       {
+         // spin for the data first, a blocked reader takes longer to wake up than the packet takes to come
+         if (m_iBusyPoll > 0)
+         {
+            uint64_t spintime = CTimer::getTime() + m_iBusyPoll;
+            while (!m_bBroken && m_bConnected && !m_bClosing && (0 == m_pRcvBuffer->getRcvDataSize()) && (CTimer::getTime() < spintime))
+               CTimer::yield();
+         }
+
          #ifndef WIN32
             pthread_mutex_lock(&m_RecvDataLock);
             if (m_iRcvTimeOut < 0) 
@@ -1192,7 +1790,7 @@ int CUDT::recv(char* data, int len)
    else if ((m_bBroken || m_bClosing) && (0 == m_pRcvBuffer->getRcvDataSize()))
       throw CUDTException(2, 1, 0);
 
-   int res = m_pRcvBuffer->readBuffer(data, len);
+   int res = m_pRcvBuffer->readBuffer(iov, len);
 
    if (m_pRcvBuffer->getRcvDataSize() <= 0)
    {
@@ -1207,6 +1805,15 @@ int CUDT::recv(char* data, int len)
 }
 
 int CUDT::sendmsg(const char* data, int len, int msttl, bool inorder)
+{
+   CIOVec iov;
+   iov.data = (char*)data;
+   iov.len = (len > 0) ? len : 0;
+
+   return sendmsgv(&iov, 1, msttl, inorder);
+}
+
+int CUDT::sendmsgv(const CIOVec* iov, int num, int msttl, bool inorder)
 {
    if (UDT_STREAM == m_iSockType)
       throw CUDTException(5, 9, 0);
@@ -1217,6 +1824,7 @@ int CUDT::sendmsg(const char* data, int len, int msttl, bool inorder)
    else if (!m_bConnected)
       throw CUDTException(2, 2, 0);
 
+   int len = iovLength(iov, num);
    if (len <= 0)
       return 0;
 
@@ -1295,10 +1903,15 @@ int CUDT::sendmsg(const char* data, int len, int msttl, bool inorder)
       m_llSndDurationCounter = CTimer::getTime();
 
    // insert the user buffer into the sening list
-   m_pSndBuffer->addBuffer(data, len, msttl, inorder);
+   bool ready = m_pSndBuffer->addBuffer(iov, len, msttl, inorder);
+
+   ++ m_llTraceSentMsg;
+   ++ m_llSentMsgTotal;
 
-   // insert this socket to the snd list if it is not on the list yet
-   m_pSndQueue->m_pSndUList->update(this, false);
+   // insert this socket to the snd list if it is not on the list yet, or send right here if it is idle in low latency mode;
+   // if it is only waiting to flush packed messages, a packet just filled up is sent at once
+   if (!m_bLowLatency || (0 == m_pSndQueue->m_pSndUList->sendNow(this)))
+      m_pSndQueue->m_pSndUList->update(this, ready && m_bFlushWait);
 
    if (m_iSndBufSize <= m_pSndBuffer->getCurrBufSize())
    {
@@ -1310,6 +1923,15 @@ int CUDT::sendmsg(const char* data, int len, int msttl, bool inorder)
 }
 
 int CUDT::recvmsg(char* data, int len)
+{
+   CIOVec iov;
+   iov.data = data;
+   iov.len = (len > 0) ? len : 0;
+
+   return recvmsgv(&iov, 1);
+}
+
+int CUDT::recvmsgv(const CIOVec* iov, int num)
 {
    if (UDT_STREAM == m_iSockType)
       throw CUDTException(5, 9, 0);
@@ -1318,6 +1940,7 @@ int CUDT::recvmsg(char* data, int len)
    if (!m_bConnected)
       throw CUDTException(2, 2, 0);
 
+   int len = iovLength(iov, num);
    if (len <= 0)
       return 0;
 
@@ -1325,7 +1948,7 @@ int CUDT::recvmsg(char* data, int len)
 
    if (m_bBroken || m_bClosing)
    {
-      int res = m_pRcvBuffer->readMsg(data, len);
+      int res = m_pRcvBuffer->readMsg(iov, len);
 
       if (m_pRcvBuffer->getRcvMsgNum() <= 0)
       {
@@ -1335,30 +1958,42 @@ int CUDT::recvmsg(char* data, int len)
 
       if (0 == res)
          throw CUDTException(2, 1, 0);
-      else
-         return res;
+
+      ++ m_llTraceRecvMsg;
+      ++ m_llRecvMsgTotal;
+      return res;
    }
 
    if (!m_bSynRecving)
    {
-      int res = m_pRcvBuffer->readMsg(data, len);
+      int res = m_pRcvBuffer->readMsg(iov, len);
       if (0 == res)
          throw CUDTException(6, 2, 0);
-      else
-         return res;
+
+      ++ m_llTraceRecvMsg;
+      ++ m_llRecvMsgTotal;
+      return res;
    }
 
    int res = 0;
    bool timeout = false;
 
-   do
+   // spin for a message first, a blocked reader takes longer to wake up than the packet takes to come
+   if (m_iBusyPoll > 0)
+   {
+      uint64_t spintime = CTimer::getTime() + m_iBusyPoll;
+      while (!m_bBroken && m_bConnected && !m_bClosing && (0 == (res = m_pRcvBuffer->readMsg(iov, len))) && (CTimer::getTime() < spintime))
+         CTimer::yield();
+   }
+
+   while ((0 == res) && !timeout)
    {
       #ifndef WIN32
          pthread_mutex_lock(&m_RecvDataLock);
 
          if (m_iRcvTimeOut < 0)
          {
-            while (!m_bBroken && m_bConnected && !m_bClosing && (0 == (res = m_pRcvBuffer->readMsg(data, len))))
+            while (!m_bBroken && m_bConnected && !m_bClosing && (0 == (res = m_pRcvBuffer->readMsg(iov, len))))
                pthread_cond_wait(&m_RecvDataCond, &m_RecvDataLock);
          }
          else
@@ -1372,13 +2007,13 @@ int CUDT::recvmsg(char* data, int len)
             if (pthread_cond_timedwait(&m_RecvDataCond, &m_RecvDataLock, &locktime) == ETIMEDOUT)
                timeout = true;
 
-            res = m_pRcvBuffer->readMsg(data, len);           
+            res = m_pRcvBuffer->readMsg(iov, len);           
          }
          pthread_mutex_unlock(&m_RecvDataLock);
       #else
          if (m_iRcvTimeOut < 0)
          {
-            while (!m_bBroken && m_bConnected && !m_bClosing && (0 == (res = m_pRcvBuffer->readMsg(data, len))))
+            while (!m_bBroken && m_bConnected && !m_bClosing && (0 == (res = m_pRcvBuffer->readMsg(iov, len))))
                WaitForSingleObject(m_RecvDataCond, INFINITE);
          }
          else
@@ -1386,7 +2021,7 @@ int CUDT::recvmsg(char* data, int len)
             if (WaitForSingleObject(m_RecvDataCond, DWORD(m_iRcvTimeOut)) == WAIT_TIMEOUT)
                timeout = true;
 
-            res = m_pRcvBuffer->readMsg(data, len);
+            res = m_pRcvBuffer->readMsg(iov, len);
          }
       #endif
 
@@ -1394,7 +2029,7 @@ int CUDT::recvmsg(char* data, int len)
          throw CUDTException(2, 1, 0);
       else if (!m_bConnected)
          throw CUDTException(2, 2, 0);
-   } while ((0 == res) && !timeout);
+   }
 
    if (m_pRcvBuffer->getRcvMsgNum() <= 0)
    {
@@ -1405,9 +2040,78 @@ int CUDT::recvmsg(char* data, int len)
    if ((res <= 0) && (m_iRcvTimeOut >= 0))
       throw CUDTException(6, 3, 0);
 
+   if (res > 0)
+   {
+      ++ m_llTraceRecvMsg;
+      ++ m_llRecvMsgTotal;
+   }
+
+   return res;
+}
+
+int CUDT::recvlend(CRcvSlice* slices, int num)
+{
+   // throw an exception if not connected
+   if (!m_bConnected)
+      throw CUDTException(2, 2, 0);
+
+   if ((NULL == slices) || (num <= 0))
+      throw CUDTException(5, 3, 0);
+
+   CGuard recvguard(m_RecvLock);
+
+   // the socket has been closed and its buffers freed meanwhile
+   if (NULL == m_pRcvBuffer)
+      throw CUDTException(2, 1, 0);
+
+   int res;
+   if (UDT_STREAM == m_iSockType)
+      res = m_pRcvBuffer->lendBuffer(slices, num);
+   else
+      res = m_pRcvBuffer->lendMsg(slices, num);
+
+   // the next message does not fit in the slice array
+   if (res < 0)
+      throw CUDTException(5, 3, 0);
+
+   // a message read out of order cannot be lent before the ACK point passes it, and the
+   // ACK sets the read event again; keeping the event up would make epoll loops spin
+   if ((0 == res) || ((UDT_STREAM == m_iSockType) ? (m_pRcvBuffer->getRcvDataSize() <= 0) : (m_pRcvBuffer->getRcvMsgNum() <= 0)))
+   {
+      // read is not available any more
+      s_UDTUnited.m_EPoll.update_events(m_SocketID, m_sPollID, UDT_EPOLL_IN, false);
+   }
+
+   if (0 == res)
+   {
+      if (m_bBroken || m_bClosing)
+         throw CUDTException(2, 1, 0);
+
+      throw CUDTException(6, 2, 0);
+   }
+
+   if (UDT_DGRAM == m_iSockType)
+   {
+      ++ m_llTraceRecvMsg;
+      ++ m_llRecvMsgTotal;
+   }
+
    return res;
 }
 
+int CUDT::recvrelease(const CRcvSlice* slices, int num)
+{
+   if ((NULL == slices) || (num < 0))
+      throw CUDTException(5, 3, 0);
+
+   CGuard recvguard(m_RecvLock);
+
+   if (NULL == m_pRcvBuffer)
+      return 0;
+
+   return m_pRcvBuffer->releaseUnits(slices, num);
+}
+
 int64_t CUDT::sendfile(fstream& ifs, int64_t& offset, int64_t size, int block)
 {
    if (UDT_DGRAM == m_iSockType)
@@ -1492,16 +2196,227 @@ int64_t CUDT::sendfile(fstream& ifs, int64_t& offset, int64_t size, int block)
       m_pSndQueue->m_pSndUList->update(this, false);
    }
 
-   if (m_iSndBufSize <= m_pSndBuffer->getCurrBufSize())
+   if (m_iSndBufSize <= m_pSndBuffer->getCurrBufSize())
+   {
+      // write is not available any more
+      s_UDTUnited.m_EPoll.update_events(m_SocketID, m_sPollID, UDT_EPOLL_OUT, false);
+   }
+
+   return size - tosend;
+}
+
+int64_t CUDT::recvfile(fstream& ofs, int64_t& offset, int64_t size, int block)
+{
+   if (UDT_DGRAM == m_iSockType)
+      throw CUDTException(5, 10, 0);
+
+   if (!m_bConnected)
+      throw CUDTException(2, 2, 0);
+   else if ((m_bBroken || m_bClosing) && (0 == m_pRcvBuffer->getRcvDataSize()))
+      throw CUDTException(2, 1, 0);
+
+   if (size <= 0)
+      return 0;
+
+   CGuard recvguard(m_RecvLock);
+
+   int64_t torecv = size;
+   int unitsize = block;
+   int recvsize;
+
+   // positioning...
+   try
+   {
+      ofs.seekp((streamoff)offset);
+   }
+   catch (...)
+   {
+      throw CUDTException(4, 3);
+   }
+
+   // receiving... "recvfile" is always blocking
+   while (torecv > 0)
+   {
+      if (ofs.fail())
+      {
+         // send the sender a signal so it will not be blocked forever
+         int32_t err_code = CUDTException::EFILE;
+         sendCtrl(8, &err_code);
+
+         throw CUDTException(4, 4);
+      }
+
+      #ifndef WIN32
+         pthread_mutex_lock(&m_RecvDataLock);
+         while (!m_bBroken && m_bConnected && !m_bClosing && (0 == m_pRcvBuffer->getRcvDataSize()))
+            pthread_cond_wait(&m_RecvDataCond, &m_RecvDataLock);
+         pthread_mutex_unlock(&m_RecvDataLock);
+      #else
+         while (!m_bBroken && m_bConnected && !m_bClosing && (0 == m_pRcvBuffer->getRcvDataSize()))
+            WaitForSingleObject(m_RecvDataCond, INFINITE);
+      #endif
+
+      if (!m_bConnected)
+         throw CUDTException(2, 2, 0);
+      else if ((m_bBroken || m_bClosing) && (0 == m_pRcvBuffer->getRcvDataSize()))
+         throw CUDTException(2, 1, 0);
+
+      unitsize = int((torecv >= block) ? block : torecv);
+      recvsize = m_pRcvBuffer->readBufferToFile(ofs, unitsize);
+
+      if (recvsize > 0)
+      {
+         torecv -= recvsize;
+         offset += recvsize;
+      }
+   }
+
+   if (m_pRcvBuffer->getRcvDataSize() <= 0)
+   {
+      // read is not available any more
+      s_UDTUnited.m_EPoll.update_events(m_SocketID, m_sPollID, UDT_EPOLL_IN, false);
+   }
+
+   return size - torecv;
+}
+
+#ifndef WIN32
+int64_t CUDT::sendfile(int fd, int64_t& offset, int64_t size, int block)
+{
+   if (UDT_DGRAM == m_iSockType)
+      throw CUDTException(5, 10, 0);
+
+   if (m_bBroken || m_bClosing)
+      throw CUDTException(2, 1, 0);
+   else if (!m_bConnected)
+      throw CUDTException(2, 2, 0);
+
+   if (size <= 0)
+      return 0;
+
+   if (offset < 0)
+      throw CUDTException(4, 1);
+
+   CGuard sendguard(m_SendLock);
+
+   if (m_pSndBuffer->getCurrBufSize() == 0)
+   {
+      // delay the EXP timer to avoid mis-fired timeout
+      uint64_t currtime;
+      CTimer::rdtsc(currtime);
+      m_ullLastRspTime = currtime;
+   }
+
+   #ifdef POSIX_FADV_SEQUENTIAL
+      posix_fadvise(fd, offset, size, POSIX_FADV_SEQUENTIAL);
+   #endif
+
+   int64_t tosend = size;
+   int unitsize;
+
+   // sending block by block, each read at its own position
+   while (tosend > 0)
+   {
+      unitsize = int((tosend >= block) ? block : tosend);
+
+      pthread_mutex_lock(&m_SendBlockLock);
+      while (!m_bBroken && m_bConnected && !m_bClosing && (m_iSndBufSize <= m_pSndBuffer->getCurrBufSize()) && m_bPeerHealth)
+         pthread_cond_wait(&m_SendBlockCond, &m_SendBlockLock);
+      pthread_mutex_unlock(&m_SendBlockLock);
+
+      if (m_bBroken || m_bClosing)
+         throw CUDTException(2, 1, 0);
+      else if (!m_bConnected)
+         throw CUDTException(2, 2, 0);
+      else if (!m_bPeerHealth)
+      {
+         // reset peer health status, once this error returns, the app should handle the situation at the peer side
+         m_bPeerHealth = true;
+         throw CUDTException(7);
+      }
+
+      // record total time used for sending
+      if (0 == m_pSndBuffer->getCurrBufSize())
+         m_llSndDurationCounter = CTimer::getTime();
+
+      int sentsize = m_pSndBuffer->addBufferFromFile(fd, offset, unitsize);
+
+      if (sentsize < 0)
+         throw CUDTException(4, 2, errno);
+
+      // end of file
+      if (0 == sentsize)
+         break;
+
+      // the data is in the sending buffer now, the pages are not needed again
+      #ifdef POSIX_FADV_DONTNEED
+         if (m_bDirectIO)
+            posix_fadvise(fd, offset, sentsize, POSIX_FADV_DONTNEED);
+      #endif
+
+      tosend -= sentsize;
+      offset += sentsize;
+
+      // insert this socket to snd list if it is not on the list yet
+      m_pSndQueue->m_pSndUList->update(this, false);
+   }
+
+   if (m_iSndBufSize <= m_pSndBuffer->getCurrBufSize())
+   {
+      // write is not available any more
+      s_UDTUnited.m_EPoll.update_events(m_SocketID, m_sPollID, UDT_EPOLL_OUT, false);
+   }
+
+   return size - tosend;
+}
+
+// O_DIRECT transfers are aligned to the page size
+static const int s_iDirectIOAlign = 4096;
+
+#ifdef O_DIRECT
+// open a second descriptor of the file without O_DIRECT, for the parts of a transfer that are not whole pages;
+// the flags of the caller's descriptor are not changed, another thread may be writing through it
+static int openBuffered(int fd)
+{
+   char path[64];
+   #ifdef LINUX
+      snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+   #else
+      snprintf(path, sizeof(path), "/dev/fd/%d", fd);
+   #endif
+
+   return ::open(path, O_WRONLY);
+}
+#endif
+
+// write the staged data of an O_DIRECT transfer: whole pages only, unless this is the tail of the transfer,
+// which goes out through the buffered descriptor
+static bool writeStaged(int fd, int buffd, char* stage, int& fill, int64_t& offset, bool tail)
+{
+   int len = tail ? fill : (fill & ~(s_iDirectIOAlign - 1));
+   if (len & (s_iDirectIOAlign - 1))
+      fd = buffd;
+
+   int done = 0;
+   while (done < len)
    {
-      // write is not available any more
-      s_UDTUnited.m_EPoll.update_events(m_SocketID, m_sPollID, UDT_EPOLL_OUT, false);
+      ssize_t ws = ::pwrite(fd, stage + done, len - done, offset + done);
+      if ((ws < 0) && (EINTR == errno))
+         continue;
+      if (ws <= 0)
+         break;
+      done += int(ws);
    }
 
-   return size - tosend;
+   offset += done;
+   fill -= done;
+   if (fill > 0)
+      memmove(stage, stage + done, fill);
+
+   return done == len;
 }
 
-int64_t CUDT::recvfile(fstream& ofs, int64_t& offset, int64_t size, int block)
+int64_t CUDT::recvfile(int fd, int64_t& offset, int64_t size, int block)
 {
    if (UDT_DGRAM == m_iSockType)
       throw CUDTException(5, 10, 0);
@@ -1514,57 +2429,115 @@ int64_t CUDT::recvfile(fstream& ofs, int64_t& offset, int64_t size, int block)
    if (size <= 0)
       return 0;
 
+   if (offset < 0)
+      throw CUDTException(4, 3);
+
    CGuard recvguard(m_RecvLock);
 
-   int64_t torecv = size;
-   int unitsize = block;
-   int recvsize;
+   // reserve the disk space up front, so that the file does not fragment as it grows; the file size is not changed
+   #ifdef LINUX
+      fallocate(fd, FALLOC_FL_KEEP_SIZE, offset, size);
+   #endif
 
-   // positioning...
-   try
-   {
-      ofs.seekp((streamoff)offset);
-   }
-   catch (...)
+   // O_DIRECT needs page aligned memory, lengths and offsets: the units are staged in an aligned buffer then;
+   // a transfer that starts off a page boundary is written through a buffered descriptor instead
+   bool direct = false;
+   int buffd = -1;
+   #ifdef O_DIRECT
+      int flags = fcntl(fd, F_GETFL);
+      if ((flags > 0) && (flags & O_DIRECT))
+      {
+         buffd = openBuffered(fd);
+         if (buffd < 0)
+            throw CUDTException(4, 4);
+
+         if (0 == (offset & (s_iDirectIOAlign - 1)))
+            direct = true;
+         else
+            fd = buffd;
+      }
+   #endif
+
+   char* stage = NULL;
+   int stagesize = 0;
+   if (direct)
    {
-      throw CUDTException(4, 3);
+      stagesize = (block + s_iDirectIOAlign - 1) & ~(s_iDirectIOAlign - 1);
+      if (0 != posix_memalign((void**)&stage, s_iDirectIOAlign, stagesize))
+      {
+         ::close(buffd);
+         throw CUDTException(3, 2, 0);
+      }
    }
 
+   int64_t start = offset;
+   int64_t torecv = size;
+   int fill = 0;
+   CUDTException e(0, 0);
+
    // receiving... "recvfile" is always blocking
-   while (torecv > 0)
+   while (torecv > fill)
    {
-      if (ofs.fail())
-      {
-         // send the sender a signal so it will not be blocked forever
-         int32_t err_code = CUDTException::EFILE;
-         sendCtrl(8, &err_code);
+      pthread_mutex_lock(&m_RecvDataLock);
+      while (!m_bBroken && m_bConnected && !m_bClosing && (0 == m_pRcvBuffer->getRcvDataSize()))
+         pthread_cond_wait(&m_RecvDataCond, &m_RecvDataLock);
+      pthread_mutex_unlock(&m_RecvDataLock);
 
-         throw CUDTException(4, 4);
+      if (!m_bConnected)
+      {
+         e = CUDTException(2, 2, 0);
+         break;
+      }
+      else if ((m_bBroken || m_bClosing) && (0 == m_pRcvBuffer->getRcvDataSize()))
+      {
+         e = CUDTException(2, 1, 0);
+         break;
       }
 
-      #ifndef WIN32
-         pthread_mutex_lock(&m_RecvDataLock);
-         while (!m_bBroken && m_bConnected && !m_bClosing && (0 == m_pRcvBuffer->getRcvDataSize()))
-            pthread_cond_wait(&m_RecvDataCond, &m_RecvDataLock);
-         pthread_mutex_unlock(&m_RecvDataLock);
-      #else
-         while (!m_bBroken && m_bConnected && !m_bClosing && (0 == m_pRcvBuffer->getRcvDataSize()))
-            WaitForSingleObject(m_RecvDataCond, INFINITE);
-      #endif
+      if (direct)
+      {
+         int unitsize = int((torecv - fill >= stagesize - fill) ? stagesize - fill : torecv - fill);
+         fill += m_pRcvBuffer->readBuffer(stage + fill, unitsize);
 
-      if (!m_bConnected)
-         throw CUDTException(2, 2, 0);
-      else if ((m_bBroken || m_bClosing) && (0 == m_pRcvBuffer->getRcvDataSize()))
-         throw CUDTException(2, 1, 0);
+         if (((fill == stagesize) || (fill == torecv)) && !writeStaged(fd, buffd, stage, fill, offset, fill == torecv))
+         {
+            e = CUDTException(4, 4, errno);
+            break;
+         }
 
-      unitsize = int((torecv >= block) ? block : torecv);
-      recvsize = m_pRcvBuffer->readBufferToFile(ofs, unitsize);
+         torecv = size - (offset - start);
+         continue;
+      }
 
-      if (recvsize > 0)
+      int unitsize = int((torecv >= block) ? block : torecv);
+      int recvsize = m_pRcvBuffer->readBufferToFile(fd, offset, unitsize);
+
+      if (recvsize < 0)
       {
-         torecv -= recvsize;
-         offset += recvsize;
+         e = CUDTException(4, 4, errno);
+         break;
       }
+
+      torecv -= recvsize;
+      offset += recvsize;
+   }
+
+   if (direct)
+   {
+      // whatever has been taken from the receiver buffer must reach the file, also when the connection broke
+      if ((fill > 0) && !writeStaged(fd, buffd, stage, fill, offset, true) && (0 == e.getErrorCode()))
+         e = CUDTException(4, 4, errno);
+      free(stage);
+   }
+
+   if (buffd >= 0)
+      ::close(buffd);
+
+   if (4 == e.getErrorCode() / 1000)
+   {
+      // send the sender a signal so it will not be blocked forever
+      int32_t err_code = CUDTException::EFILE;
+      sendCtrl(8, &err_code);
    }
 
    if (m_pRcvBuffer->getRcvDataSize() <= 0)
@@ -1573,8 +2546,12 @@ int64_t CUDT::recvfile(fstream& ofs, int64_t& offset, int64_t size, int block)
       s_UDTUnited.m_EPoll.update_events(m_SocketID, m_sPollID, UDT_EPOLL_IN, false);
    }
 
+   if (0 != e.getErrorCode())
+      throw e;
+
    return size - torecv;
 }
+#endif
 
 void CUDT::sample(CPerfMon* perf, bool clear)
 {
@@ -1595,6 +2572,12 @@ void CUDT::sample(CPerfMon* perf, bool clear)
    perf->pktRecvACK = m_iRecvACK;
    perf->pktSentNAK = m_iSentNAK;
    perf->pktRecvNAK = m_iRecvNAK;
+   perf->pktRcvSpurious = m_iRcvSpurious;
+   perf->pktSentParity = m_iSentParity;
+   perf->pktRecvParity = m_iRecvParity;
+   perf->pktRcvRecovered = m_iRcvRecovered;
+   perf->pktSentCtrl = m_llSentCtrl;
+   perf->pktRecvCtrl = m_llRecvCtrl;
    perf->usSndDuration = m_llSndDuration;
 
    perf->pktSentTotal = m_llSentTotal;
@@ -1606,12 +2589,23 @@ void CUDT::sample(CPerfMon* perf, bool clear)
    perf->pktRecvACKTotal = m_iRecvACKTotal;
    perf->pktSentNAKTotal = m_iSentNAKTotal;
    perf->pktRecvNAKTotal = m_iRecvNAKTotal;
+   perf->pktRcvSpuriousTotal = m_iRcvSpuriousTotal;
+   perf->pktSentParityTotal = m_iSentParityTotal;
+   perf->pktRecvParityTotal = m_iRecvParityTotal;
+   perf->pktRcvRecoveredTotal = m_iRcvRecoveredTotal;
+   perf->pktSentCtrlTotal = m_llSentCtrlTotal;
+   perf->pktRecvCtrlTotal = m_llRecvCtrlTotal;
    perf->usSndDurationTotal = m_llSndDurationTotal;
+   perf->msgSentTotal = m_llSentMsgTotal;
+   perf->msgRecvTotal = m_llRecvMsgTotal;
 
    double interval = double(currtime - m_LastSampleTime);
 
    perf->mbpsSendRate = double(m_llTraceSent) * m_iPayloadSize * 8.0 / interval;
    perf->mbpsRecvRate = double(m_llTraceRecv) * m_iPayloadSize * 8.0 / interval;
+   perf->msgpsSendRate = double(m_llTraceSentMsg) * 1000000.0 / interval;
+   perf->msgpsRecvRate = double(m_llTraceRecvMsg) * 1000000.0 / interval;
+   perf->bytePktPayload = (m_llTraceSent > 0) ? double(m_llTraceSentBytes) / m_llTraceSent : 0;
 
    perf->usPktSndPeriod = m_ullInterval / double(m_ullCPUFrequency);
    perf->pktFlowWindow = m_iFlowWindowSize;
@@ -1619,6 +2613,14 @@ void CUDT::sample(CPerfMon* perf, bool clear)
    perf->pktFlightSize = CSeqNo::seqlen(m_iSndLastAck, CSeqNo::incseq(m_iSndCurrSeqNo)) - 1;
    perf->msRTT = m_iRTT/1000.0;
    perf->mbpsBandwidth = m_iBandwidth * m_iPayloadSize * 8.0 / 1000000.0;
+   perf->pktReorderTolerance = m_iReorderTolerance;
+   perf->pktLightACKInterval = m_iLightACKInterval;
+   perf->byteMSS = m_iPMTU;
+   perf->ccPhase = m_pCC->m_iPhase;
+   perf->pktSlowStartThreshold = (int)m_pCC->m_dSSThresh;
+   perf->pktMaxWindow = (int)m_pCC->m_dMaxWindow;
+   perf->msQueuingDelay = m_pCC->m_iQueuingDelay / 1000.0;
+   perf->mbpsModelBandwidth = m_pCC->m_dModelBW * m_iPayloadSize * 8.0 / 1000000.0;
 
    #ifndef WIN32
       if (0 == pthread_mutex_trylock(&m_ConnectionLock))
@@ -1628,6 +2630,7 @@ void CUDT::sample(CPerfMon* perf, bool clear)
    {
       perf->byteAvailSndBuf = (NULL == m_pSndBuffer) ? 0 : (m_iSndBufSize - m_pSndBuffer->getCurrBufSize()) * m_iMSS;
       perf->byteAvailRcvBuf = (NULL == m_pRcvBuffer) ? 0 : m_pRcvBuffer->getAvailBufSize() * m_iMSS;
+      perf->byteMemUsed = getMemSize();
 
       #ifndef WIN32
          pthread_mutex_unlock(&m_ConnectionLock);
@@ -1639,11 +2642,15 @@ void CUDT::sample(CPerfMon* perf, bool clear)
    {
       perf->byteAvailSndBuf = 0;
       perf->byteAvailRcvBuf = 0;
+      perf->byteMemUsed = 0;
    }
 
    if (clear)
    {
-      m_llTraceSent = m_llTraceRecv = m_iTraceSndLoss = m_iTraceRcvLoss = m_iTraceRetrans = m_iSentACK = m_iRecvACK = m_iSentNAK = m_iRecvNAK = 0;
+      m_llTraceSent = m_llTraceRecv = m_iTraceSndLoss = m_iTraceRcvLoss = m_iTraceRetrans = m_iSentACK = m_iRecvACK = m_iSentNAK = m_iRecvNAK = m_iRcvSpurious = 0;
+      m_iSentParity = m_iRecvParity = m_iRcvRecovered = 0;
+      m_llSentCtrl = m_llRecvCtrl = 0;
+      m_llTraceSentMsg = m_llTraceRecvMsg = m_llTraceSentBytes = 0;
       m_llSndDuration = 0;
       m_LastSampleTime = currtime;
    }
@@ -1661,6 +2668,160 @@ void CUDT::CCUpdate()
        m_ullInterval = minSP;
 }
 
+void CUDT::initCC(const sockaddr* peer)
+{
+   CInfoBlock ib;
+   ib.m_iIPversion = m_iIPversion;
+   CInfoBlock::convert(peer, m_iIPversion, ib.m_piIP);
+   bool warm = false;
+   if (m_pCache->lookup(&ib) >= 0)
+   {
+      m_iRTT = ib.m_iRTT;
+      m_iBandwidth = ib.m_iBandwidth;
+
+      // a recent sending rate is resumed, and the receiver is assumed to keep up with it until the first ACK tells
+      warm = (ib.m_dInterval > 0) && (CTimer::getTime() - ib.m_ullTimeStamp < (uint64_t)m_iWarmStartTTL);
+      if (warm)
+         m_iDeliveryRate = (int)(1000000.0 / ib.m_dInterval) + 1;
+   }
+
+   m_pCC = m_pCCFactory->create();
+   m_pCC->m_UDT = m_SocketID;
+   m_pCC->setMSS(m_iMSS);
+   m_pCC->setMaxCWndSize(m_iFlowWindowSize);
+   m_pCC->setSndCurrSeqNo(m_iSndCurrSeqNo);
+   m_pCC->setRcvRate(m_iDeliveryRate);
+   m_pCC->setRTT(m_iRTT);
+   m_pCC->setBandwidth(m_iBandwidth);
+   m_pCC->init();
+
+   if (warm)
+   {
+      double cwnd = ib.m_dCWnd;
+      if (cwnd > m_iFlowWindowSize)
+         cwnd = m_iFlowWindowSize;
+      if (cwnd < 16)
+         cwnd = 16;
+      m_pCC->onWarmStart(ib.m_dInterval, cwnd);
+   }
+}
+
+void CUDT::saveCC()
+{
+   CInfoBlock ib;
+   ib.m_iIPversion = m_iIPversion;
+   CInfoBlock::convert(m_pPeerAddr, m_iIPversion, ib.m_piIP);
+   if (m_pCache->lookup(&ib) < 0)
+   {
+      ib.m_ullTimeStamp = CTimer::getTime();
+      ib.m_iLossRate = 0;
+      ib.m_iReorderDistance = 0;
+      ib.m_dInterval = 0;
+      ib.m_dCWnd = 0;
+   }
+
+   ib.m_iRTT = m_iRTT;
+   ib.m_iBandwidth = m_iBandwidth;
+
+   // a connection still in the startup phase of its congestion control has not found the rate of
+   // the path, keep the one from an earlier connection
+   if (0 != m_pCC->m_iPhase)
+   {
+      ib.m_ullTimeStamp = CTimer::getTime();
+      ib.m_dInterval = m_pCC->m_dPktSndPeriod;
+      ib.m_dCWnd = m_pCC->m_dCWndSize;
+   }
+
+   m_pCache->update(&ib);
+}
+
+void CUDT::sign(const char* data, int len, unsigned char sig[16]) const
+{
+   CMD5::hmac(m_pcSecret, sizeof(m_pcSecret), data, len, sig);
+}
+
+void CUDT::signToken(const sockaddr* peer, const int32_t* token, int32_t sig[4]) const
+{
+   // the token holds for the client host, whatever port it connects from
+   uint32_t state[7];
+   CInfoBlock::convert(peer, m_iIPversion, state);
+   state[4] = m_iIPversion;
+   state[5] = token[0];
+   state[6] = token[1];
+
+   unsigned char digest[16];
+   sign((const char*)state, sizeof(state), digest);
+   memcpy(sig, digest, 16);
+}
+
+void CUDT::issueToken(const sockaddr* peer, CHandShake* hs)
+{
+   hs->m_piToken[0] = int32_t((CTimer::getTime() - m_StartTime) / 1000000);
+   hs->m_piToken[1] = ++ m_iTokenSerial;
+   signToken(peer, hs->m_piToken, hs->m_piToken + 2);
+   hs->m_bToken = true;
+}
+
+bool CUDT::checkToken(const sockaddr* peer, const CHandShake& hs, int size)
+{
+   if (!m_bResume || !hs.m_bToken)
+      return false;
+
+   // the data must fit in a packet of this side, and must have arrived whole
+   if ((hs.m_iCookie < 0) || (hs.m_iCookie > m_iPayloadSize) || (size != CHandShake::m_iContentSize + CHandShake::m_iTokenSize + hs.m_iCookie))
+      return false;
+
+   int32_t issued = hs.m_piToken[0];
+   int32_t now = int32_t((CTimer::getTime() - m_StartTime) / 1000000);
+   if ((issued > now) || (now - issued > m_iResumeTokenTTL))
+      return false;
+
+   int32_t sig[4];
+   signToken(peer, hs.m_piToken, sig);
+   if (0 != memcmp(sig, hs.m_piToken + 2, sizeof(sig)))
+      return false;
+
+   // a token resumes one connection; it is remembered as used until it expires, and if too many are
+   // remembered, no more connections are resumed until some expire
+   uint64_t currtime = CTimer::getTime();
+   while (!m_lUsedTokens.empty() && (m_lUsedTokens.front().first + m_iResumeTokenTTL * 1000000ULL < currtime))
+   {
+      m_sUsedTokens.erase(m_lUsedTokens.front().second);
+      m_lUsedTokens.pop_front();
+   }
+
+   int64_t key;
+   memcpy(&key, sig, sizeof(key));
+   if ((m_sUsedTokens.find(key) != m_sUsedTokens.end()) || ((int)m_sUsedTokens.size() >= m_iMaxUsedTokens))
+      return false;
+
+   m_sUsedTokens.insert(key);
+   m_lUsedTokens.push_back(make_pair(currtime, key));
+
+   return true;
+}
+
+void CUDT::saveToken()
+{
+   CTokenBlock tb;
+   tb.setAddr(m_pPeerAddr, m_iIPversion);
+
+   if (m_ConnRes.m_bToken)
+   {
+      memcpy(tb.m_piToken, m_ConnRes.m_piToken, sizeof(tb.m_piToken));
+      tb.m_ullTimeStamp = CTimer::getTime();
+   }
+   else if ((m_pTokenCache->lookup(&tb) < 0) || (0 == tb.m_ullTimeStamp))
+      return;
+   else
+   {
+      // the listener does not issue tokens any more
+      tb.m_ullTimeStamp = 0;
+   }
+
+   m_pTokenCache->update(&tb);
+}
+
 void CUDT::initSynch()
 {
    #ifndef WIN32
@@ -1802,7 +2963,7 @@ void CUDT::sendCtrl(int pkttype, void* lparam, void* rparam, int size)
       // Send out the ACK only if has not been received by the sender before
       if (CSeqNo::seqcmp(m_iRcvLastAck, m_iRcvLastAckAck) > 0)
       {
-         int32_t data[6];
+         int32_t data[7 + 2 * m_iMaxSACKBlocks];
 
          m_iAckSeqNo = CAckNo::incack(m_iAckSeqNo);
          data[0] = m_iRcvLastAck;
@@ -1817,7 +2978,20 @@ void CUDT::sendCtrl(int pkttype, void* lparam, void* rparam, int size)
          {
             data[4] = m_pRcvTimeWindow->getPktRcvSpeed();
             data[5] = m_pRcvTimeWindow->getBandwidth();
-            ctrlpkt.pack(pkttype, &m_iAckSeqNo, data, 24);
+
+            // report the one-way delay for delay-based congestion control, and the packets received
+            // above the ACK, if the peer understands them
+            int acksize = 24;
+            if (m_iExtension & CHandShake::m_iExtOWD)
+            {
+               data[6] = m_iRcvOWD;
+               m_bRcvOWDReset = true;
+               acksize += 4;
+            }
+            if ((m_iExtension & CHandShake::m_iExtSACK) && (m_pRcvLossList->getLossLength() > 0))
+               acksize += packSACK(data + acksize / 4) * 8;
+
+            ctrlpkt.pack(pkttype, &m_iAckSeqNo, data, acksize);
 
             CTimer::rdtsc(m_ullLastAckTime);
          }
@@ -1904,51 +3078,289 @@ void CUDT::sendCtrl(int pkttype, void* lparam, void* rparam, int size)
       ctrlpkt.m_iID = m_PeerID;
       m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
 
-      CTimer::rdtsc(m_ullLastWarningTime);
+      CTimer::rdtsc(m_ullLastWarningTime);
+
+      break;
+
+   case 1: //001 - Keep-alive
+      ctrlpkt.pack(pkttype);
+      ctrlpkt.m_iID = m_PeerID;
+      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+ 
+      break;
+
+   case 0: //000 - Handshake
+      ctrlpkt.pack(pkttype, NULL, rparam, sizeof(CHandShake));
+      ctrlpkt.m_iID = m_PeerID;
+      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+
+      break;
+
+   case 5: //101 - Shutdown
+      ctrlpkt.pack(pkttype);
+      ctrlpkt.m_iID = m_PeerID;
+      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+
+      break;
+
+   case 7: //111 - Msg drop request
+      ctrlpkt.pack(pkttype, lparam, rparam, 8);
+      ctrlpkt.m_iID = m_PeerID;
+      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+
+      break;
+
+   case 8: //1000 - acknowledge the peer side a special error
+      ctrlpkt.pack(pkttype, lparam);
+      ctrlpkt.m_iID = m_PeerID;
+      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+
+      break;
+
+   case 9: //1001 - FEC parity
+      {
+      int32_t seqno;
+      char* parity;
+      int size = m_pFECEncoder->getParity(seqno, parity);
+
+      ctrlpkt.pack(pkttype, &seqno, parity, size);
+      ctrlpkt.m_iID = m_PeerID;
+      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+
+      ++ m_iSentParity;
+      ++ m_iSentParityTotal;
+
+      break;
+      }
+
+   case 10: //1010 - Path MTU probe
+      {
+      // pad the packet to the probed size, headers included
+      int len = size - 28 - CPacket::m_iPktHdrSize;
+      char* padding = new char[len];
+      memset(padding, 0, len);
+
+      ctrlpkt.pack(pkttype, lparam, padding, len);
+      ctrlpkt.m_iID = m_PeerID;
+      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+
+      delete [] padding;
+
+      break;
+      }
+
+   case 11: //1011 - Path MTU probe acknowledgement
+      ctrlpkt.pack(pkttype, lparam, rparam, 4);
+      ctrlpkt.m_iID = m_PeerID;
+      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+
+      break;
+
+   case 32767: //0x7FFF - Resevered for future use
+      break;
+
+   default:
+      break;
+   }
+
+   // a packet has been built only if something was sent
+   if (ctrlpkt.getLength() > 0)
+   {
+      ++ m_llSentCtrl;
+      ++ m_llSentCtrlTotal;
+   }
+}
+
+int CUDT::packSACK(int32_t* blocks)
+{
+   int32_t loss[2 * m_iMaxSACKBlocks];
+   int len;
+   m_pRcvLossList->getLossArray(loss, len, 2 * m_iMaxSACKBlocks);
+
+   // every gap between two loss ranges has been received
+   int num = 0;
+   int count = 0;
+   int32_t start = -1;
+   for (int i = 0; i < len; ++ i)
+   {
+      int32_t seqno1 = loss[i] & 0x7FFFFFFF;
+      int32_t seqno2 = (loss[i] < 0) ? loss[++ i] : seqno1;
+
+      if (-1 != start)
+      {
+         blocks[num * 2] = start;
+         blocks[num * 2 + 1] = CSeqNo::decseq(seqno1);
+         ++ num;
+      }
+
+      count += CSeqNo::seqlen(seqno1, seqno2);
+      start = CSeqNo::incseq(seqno2);
+   }
+
+   // the range after the last loss is known only if the array covers the whole list
+   if ((-1 != start) && (count == m_pRcvLossList->getLossLength()) && (CSeqNo::seqcmp(start, m_iRcvCurrSeqNo) <= 0))
+   {
+      blocks[num * 2] = start;
+      blocks[num * 2 + 1] = m_iRcvCurrSeqNo;
+      ++ num;
+   }
+
+   return num;
+}
+
+void CUDT::processSACK(int32_t ack, const int32_t* blocks, int num)
+{
+   // everything below the ACK has left the sender buffer, forget it
+   if (CSeqNo::seqcmp(ack, m_iSACKLastAck) > 0)
+   {
+      if (CSeqNo::seqoff(m_iSACKLastAck, ack) < m_pSACKMap->getCapacity())
+         m_pSACKMap->clear(m_iSACKLastAck, CSeqNo::decseq(ack));
+      else
+         m_pSACKMap->clear(0, m_pSACKMap->getCapacity() - 1);
+      m_iSACKLastAck = ack;
+   }
+
+   int32_t limit = CSeqNo::incseq(ack, m_pSACKMap->getCapacity() - 1);
+   if (CSeqNo::seqcmp(limit, m_iSndCurrSeqNo) > 0)
+      limit = m_iSndCurrSeqNo;
+
+   for (int i = 0; i < num; ++ i)
+   {
+      int32_t seqno1 = blocks[i * 2];
+      int32_t seqno2 = blocks[i * 2 + 1];
+
+      // a block must lie above the ACK and within what has been sent, ignore it otherwise
+      if ((seqno1 < 0) || (seqno2 < 0) || (CSeqNo::seqcmp(seqno1, seqno2) > 0) || (CSeqNo::seqcmp(seqno1, ack) <= 0) || (CSeqNo::seqcmp(seqno2, limit) > 0))
+         continue;
+
+      m_pSACKMap->set(seqno1, seqno2);
+
+      // the receiver has these packets, no need to retransmit them
+      m_pSndLossList->remove(seqno1, seqno2);
+   }
+}
+
+void CUDT::initPMTU()
+{
+   m_iPMTU = m_iPMTUNext = m_iMSS;
+   if (0 == (m_iExtension & CHandShake::m_iExtPMTUD))
+      return;
 
-      break;
+   // start from the IPv6 minimum MTU, which any path should carry, and only send larger packets once a probe got through;
+   // packets are numbered when they are cut, so data sent at a size the path drops could never be delivered
+   m_iPMTUBase = (m_iMSS < 1280) ? m_iMSS : 1280;
+   m_iPMTUHigh = m_iMSS;
+   m_iProbeSize = 0;
+   m_iProbeCount = 0;
+   m_iProbeID = 0;
+   CTimer::rdtsc(m_ullNextProbeTime);
+   m_ullLastAckProgressTime = m_ullNextProbeTime;
+
+   // nothing has been sent yet, so the size can be applied at once
+   setPMTU(m_iPMTUBase);
+   applyPMTU();
+}
 
-   case 1: //001 - Keep-alive
-      ctrlpkt.pack(pkttype);
-      ctrlpkt.m_iID = m_PeerID;
-      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
- 
-      break;
+void CUDT::setPMTU(int size)
+{
+   // the sending thread cuts and numbers the packets, it switches to the new size between two of them
+   m_iPMTUNext = size;
+}
 
-   case 0: //000 - Handshake
-      ctrlpkt.pack(pkttype, NULL, rparam, sizeof(CHandShake));
-      ctrlpkt.m_iID = m_PeerID;
-      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+void CUDT::applyPMTU()
+{
+   int size = m_iPMTUNext;
 
-      break;
+   m_iPMTU = size;
+   m_iPktSize = size - 28;
+   m_iPayloadSize = m_iPktSize - CPacket::m_iPktHdrSize;
+   if (m_iExtension & CHandShake::m_iExtFEC)
+      m_iPayloadSize = (m_iPayloadSize - 8) & ~3;
 
-   case 5: //101 - Shutdown
-      ctrlpkt.pack(pkttype);
-      ctrlpkt.m_iID = m_PeerID;
-      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+   // the buffers were sized for m_iMSS; only new data is cut at the new size
+   m_pSndBuffer->setPacketSize(m_iPayloadSize);
+   m_pCC->setMSS(size);
+}
 
-      break;
+void CUDT::checkPMTU(uint64_t currtime)
+{
+   uint64_t rto = (m_iRTT + 4 * m_iRTTVar + m_iSYNInterval) * m_ullCPUFrequency;
 
-   case 7: //111 - Msg drop request
-      ctrlpkt.pack(pkttype, lparam, rparam, 8);
-      ctrlpkt.m_iID = m_PeerID;
-      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+   // data in flight without any ACK progress for a long time: the path may have stopped carrying the current size
+   if (CSeqNo::incseq(m_iSndCurrSeqNo) == m_iSndLastDataAck)
+      m_ullLastAckProgressTime = currtime;
+   else if (m_iPMTUNext > m_iPMTUBase)
+   {
+      uint64_t blackhole_int = 4 * rto;
+      if (blackhole_int < 1000000 * m_ullCPUFrequency)
+         blackhole_int = 1000000 * m_ullCPUFrequency;
 
-      break;
+      if (currtime - m_ullLastAckProgressTime > blackhole_int)
+      {
+         m_iPMTUHigh = m_iPMTUNext - 1;
+         setPMTU(m_iPMTUBase);
+         m_iProbeSize = 0;
+         m_ullLastAckProgressTime = currtime;
+         m_ullNextProbeTime = currtime + blackhole_int;
+      }
+   }
 
-   case 8: //1000 - acknowledge the peer side a special error
-      ctrlpkt.pack(pkttype, lparam);
-      ctrlpkt.m_iID = m_PeerID;
-      m_pSndQueue->sendto(m_pPeerAddr, ctrlpkt);
+   if (currtime < m_ullNextProbeTime)
+      return;
 
-      break;
+   if (m_iProbeSize > 0)
+   {
+      // a probe may be lost for other reasons, give it three chances
+      if (m_iProbeCount < 3)
+      {
+         sendCtrl(10, &m_iProbeID, NULL, m_iProbeSize);
+         ++ m_iProbeCount;
+         m_ullNextProbeTime = currtime + rto;
+         return;
+      }
 
-   case 32767: //0x7FFF - Resevered for future use
-      break;
+      m_iPMTUHigh = m_iProbeSize - 1;
+      m_iProbeSize = 0;
+   }
 
-   default:
-      break;
+   // try the configured MSS first, it is the likely answer on a jumbo frame path, then the Ethernet MTU,
+   // and otherwise search in between
+   int size;
+   if (m_iPMTUHigh == m_iMSS)
+      size = m_iMSS;
+   else if ((m_iPMTUNext < 1500) && (m_iPMTUHigh >= 1500))
+      size = 1500;
+   else
+      size = ((m_iPMTUNext + m_iPMTUHigh) / 2) & ~3;
+   if (size - m_iPMTUNext < 16)
+   {
+      // close enough; the route may change, so look for a larger size again in 10 minutes
+      m_iPMTUHigh = m_iMSS;
+      m_ullNextProbeTime = currtime + 600000000ULL * m_ullCPUFrequency;
+      return;
    }
+
+   m_iProbeSize = size;
+   m_iProbeCount = 1;
+   m_iProbeID = (m_iProbeID + 1) & 0x7FFFFFFF;
+   sendCtrl(10, &m_iProbeID, NULL, m_iProbeSize);
+   m_ullNextProbeTime = currtime + rto;
+}
+
+void CUDT::sendHandshake()
+{
+   CHandShake initdata;
+   initdata.m_iISN = m_iISN;
+   initdata.m_iMSS = m_iMSS;
+   initdata.m_iFlightFlagSize = m_iFlightFlagSize;
+   initdata.m_iReqType = (!m_bRendezvous) ? -1 : -2;
+   initdata.m_iID = m_SocketID;
+
+   char* hs = new char [m_iPayloadSize];
+   int hs_size = m_iPayloadSize;
+   initdata.serialize(hs, hs_size);
+   sendCtrl(0, NULL, hs, hs_size);
+   delete [] hs;
 }
 
 void CUDT::processCtrl(CPacket& ctrlpkt)
@@ -1959,6 +3371,9 @@ void CUDT::processCtrl(CPacket& ctrlpkt)
    CTimer::rdtsc(currtime);
    m_ullLastRspTime = currtime;
 
+   ++ m_llRecvCtrl;
+   ++ m_llRecvCtrlTotal;
+
    switch (ctrlpkt.getType())
    {
    case 2: //010 - Acknowledgement
@@ -2008,6 +3423,11 @@ void CUDT::processCtrl(CPacket& ctrlpkt)
          // Update Flow Window Size, must update before and together with m_iSndLastAck
          m_iFlowWindowSize = *((int32_t *)ctrlpkt.m_pcData + 3);
          m_iSndLastAck = ack;
+
+         // SACK blocks follow the rate and bandwidth fields and the one-way delay; a repeated ACK still carries new blocks
+         int sackpos = (m_iExtension & CHandShake::m_iExtOWD) ? 28 : 24;
+         if ((NULL != m_pSACKMap) && (ctrlpkt.getLength() > sackpos))
+            processSACK(ack, (int32_t *)(ctrlpkt.m_pcData + sackpos), (ctrlpkt.getLength() - sackpos) / 8);
       }
 
       // protect packet retransmission
@@ -2031,6 +3451,7 @@ void CUDT::processCtrl(CPacket& ctrlpkt)
 
       // update sending variables
       m_iSndLastDataAck = ack;
+      m_ullLastAckProgressTime = currtime;
       m_pSndLossList->remove(CSeqNo::decseq(m_iSndLastDataAck));
 
       CGuard::leaveCS(m_AckLock);
@@ -2071,6 +3492,9 @@ void CUDT::processCtrl(CPacket& ctrlpkt)
 
          m_pCC->setRcvRate(m_iDeliveryRate);
          m_pCC->setBandwidth(m_iBandwidth);
+
+         if ((m_iExtension & CHandShake::m_iExtOWD) && (ctrlpkt.getLength() >= 28))
+            m_pCC->setOWD(*((int32_t *)ctrlpkt.m_pcData + 6));
       }
 
       m_pCC->onACK(ack);
@@ -2194,19 +3618,7 @@ void CUDT::processCtrl(CPacket& ctrlpkt)
       {
          // The peer side has not received the handshake message, so it keeps querying
          // resend the handshake packet
-
-         CHandShake initdata;
-         initdata.m_iISN = m_iISN;
-         initdata.m_iMSS = m_iMSS;
-         initdata.m_iFlightFlagSize = m_iFlightFlagSize;
-         initdata.m_iReqType = (!m_bRendezvous) ? -1 : -2;
-         initdata.m_iID = m_SocketID;
-
-         char* hs = new char [m_iPayloadSize];
-         int hs_size = m_iPayloadSize;
-         initdata.serialize(hs, hs_size);
-         sendCtrl(0, NULL, hs, hs_size);
-         delete [] hs;
+         sendHandshake();
       }
 
       break;
@@ -2249,6 +3661,37 @@ void CUDT::processCtrl(CPacket& ctrlpkt)
 
       break;
 
+   case 9: //1001 - FEC parity
+      ++ m_iRecvParity;
+      ++ m_iRecvParityTotal;
+
+      if ((NULL != m_pFECDecoder) && m_pFECDecoder->addParity(ctrlpkt.m_iMsgNo, ctrlpkt.m_pcData, ctrlpkt.getLength()))
+         recoverData();
+
+      break;
+
+   case 10: //1010 - Path MTU probe
+      {
+      // tell the peer how large the probe was when it got here
+      int32_t size = ctrlpkt.getLength() + CPacket::m_iPktHdrSize + 28;
+      sendCtrl(11, &ctrlpkt.m_iMsgNo, &size);
+
+      break;
+      }
+
+   case 11: //1011 - Path MTU probe acknowledgement
+      // an old probe, or one cut down on the way, confirms nothing
+      if ((m_iProbeSize > 0) && (ctrlpkt.m_iMsgNo == m_iProbeID) && (*(int32_t *)ctrlpkt.m_pcData >= m_iProbeSize))
+      {
+         setPMTU(m_iProbeSize);
+         m_iProbeSize = 0;
+
+         // go on searching at once
+         m_ullNextProbeTime = currtime;
+      }
+
+      break;
+
    case 32767: //0x7FFF - reserved and user defined messages
       m_pCC->processCustomMsg(&ctrlpkt);
       CCUpdate();
@@ -2268,9 +3711,19 @@ int CUDT::packData(CPacket& packet, uint64_t& ts)
    uint64_t entertime;
    CTimer::rdtsc(entertime);
 
+   m_bFlushWait = false;
+
    if ((0 != m_ullTargetTime) && (entertime > m_ullTargetTime))
       m_ullTimeDiff += entertime - m_ullTargetTime;
 
+   // a probe was acknowledged or the path stopped carrying the current size
+   if (m_iPMTUNext != m_iPMTU)
+      applyPMTU();
+
+   // the parity of a completed group follows its last data packet
+   if ((NULL != m_pFECEncoder) && m_pFECEncoder->ready())
+      sendCtrl(9);
+
    // Loss retransmission always has higher priority.
    if ((packet.m_iSeqNo = m_pSndLossList->getLostSeq()) >= 0)
    {
@@ -2322,15 +3775,33 @@ int CUDT::packData(CPacket& packet, uint64_t& ts)
 
             packet.m_iSeqNo = m_iSndCurrSeqNo;
 
+            // only first transmissions are protected by parity, retransmissions are already late
+            if (NULL != m_pFECEncoder)
+               m_pFECEncoder->add(packet.m_iSeqNo, packet.m_iMsgNo, packet.m_pcData, payload);
+
             // every 16 (0xF) packets, a packet pair is sent
             if (0 == (packet.m_iSeqNo & 0xF))
                probe = true;
          }
          else
          {
+            // nothing more to send for now, do not leave the tail of the data unprotected
+            if ((NULL != m_pFECEncoder) && m_pFECEncoder->flush())
+               sendCtrl(9);
+
             m_ullTargetTime = 0;
             m_ullTimeDiff = 0;
             ts = 0;
+
+            // small messages wait in a packet for more, come back when it is due
+            uint64_t flushtime = m_pSndBuffer->getFlushTime();
+            if (flushtime > 0)
+            {
+               uint64_t currtime = CTimer::getTime();
+               ts = entertime + ((flushtime > currtime) ? flushtime - currtime : 1) * m_ullCPUFrequency;
+               m_bFlushWait = true;
+            }
+
             return 0;
          }
       }
@@ -2352,6 +3823,7 @@ int CUDT::packData(CPacket& packet, uint64_t& ts)
 
    ++ m_llTraceSent;
    ++ m_llSentTotal;
+   m_llTraceSentBytes += payload;
 
    if (probe)
    {
@@ -2394,6 +3866,15 @@ int CUDT::processData(CUnit* unit)
 
    m_pCC->onPktReceived(&packet);
    ++ m_iPktCount;
+
+   // each side stamps time from its own start, so this is the one-way delay plus a constant offset
+   int owd = int(uint32_t(CTimer::getTime() - m_StartTime) - uint32_t(packet.m_iTimeStamp));
+   if (m_bRcvOWDReset || (owd < m_iRcvOWD))
+   {
+      m_iRcvOWD = owd;
+      m_bRcvOWDReset = false;
+   }
+
    // update time information
    m_pRcvTimeWindow->onPktArrival();
 
@@ -2407,11 +3888,20 @@ int CUDT::processData(CUnit* unit)
    ++ m_llRecvTotal;
 
    int32_t offset = CSeqNo::seqoff(m_iRcvLastAck, packet.m_iSeqNo);
-   if ((offset < 0) || (offset >= m_pRcvBuffer->getAvailBufSize()))
+   if (offset >= m_pRcvBuffer->getAvailBufSize())
       return -1;
 
-   if (m_pRcvBuffer->addData(unit, offset) < 0)
+   // a packet that has been received already is a spurious retransmission
+   if ((offset < 0) || (m_pRcvBuffer->addData(unit, offset) < 0))
+   {
+      ++ m_iRcvSpurious;
+      ++ m_iRcvSpuriousTotal;
+
+      if (!m_ReorderGaps.empty())
+         fillReorderGap(packet.m_iSeqNo, true);
+
       return -1;
+   }
 
    // Loss detection.
    if (CSeqNo::seqcmp(packet.m_iSeqNo, CSeqNo::incseq(m_iRcvCurrSeqNo)) > 0)
@@ -2419,13 +3909,39 @@ int CUDT::processData(CUnit* unit)
       // If loss found, insert them to the receiver loss list
       m_pRcvLossList->insert(CSeqNo::incseq(m_iRcvCurrSeqNo), CSeqNo::decseq(packet.m_iSeqNo));
 
-      // pack loss list for NAK
-      int32_t lossdata[2];
-      lossdata[0] = CSeqNo::incseq(m_iRcvCurrSeqNo) | 0x80000000;
-      lossdata[1] = CSeqNo::decseq(packet.m_iSeqNo);
+      if ((0 == m_iMaxReorderTolerance) && (NULL == m_pFECDecoder))
+      {
+         // pack loss list for NAK
+         int32_t lossdata[2];
+         lossdata[0] = CSeqNo::incseq(m_iRcvCurrSeqNo) | 0x80000000;
+         lossdata[1] = CSeqNo::decseq(packet.m_iSeqNo);
 
-      // Generate loss report immediately.
-      sendCtrl(3, NULL, lossdata, (CSeqNo::incseq(m_iRcvCurrSeqNo) == CSeqNo::decseq(packet.m_iSeqNo)) ? 1 : 2);
+         // Generate loss report immediately.
+         sendCtrl(3, NULL, lossdata, (CSeqNo::incseq(m_iRcvCurrSeqNo) == CSeqNo::decseq(packet.m_iSeqNo)) ? 1 : 2);
+      }
+      else
+      {
+         // the missing packets may only be late or rebuilt from parity; hold the report until the reorder window has passed
+         CReorderGap gap;
+         gap.m_iSeqNo1 = CSeqNo::incseq(m_iRcvCurrSeqNo);
+         gap.m_iSeqNo2 = CSeqNo::decseq(packet.m_iSeqNo);
+         gap.m_ullTime = currtime;
+         gap.m_bReported = false;
+         gap.m_bReordered = false;
+         gap.m_iLateSeqNo = -1;
+         gap.m_iLateDepth = 0;
+
+         // a path that loses this much gets no more time for reordering on the oldest gap
+         if (int(m_ReorderGaps.size()) >= m_iMaxReorderGaps)
+         {
+            if (0 == m_iReportedGaps)
+               reportReorderGap(m_ReorderGaps.front(), currtime);
+            else
+               -- m_iReportedGaps;
+            m_ReorderGaps.pop_front();
+         }
+         m_ReorderGaps.push_back(gap);
+      }
 
       int loss = CSeqNo::seqlen(m_iRcvCurrSeqNo, packet.m_iSeqNo) - 2;
       m_iTraceRcvLoss += loss;
@@ -2434,30 +3950,224 @@ int CUDT::processData(CUnit* unit)
 
    // This is not a regular fixed size packet...   
    //an irregular sized packet usually indicates the end of a message, so send an ACK immediately   
-   if (packet.getLength() != m_iPayloadSize)   
+   //with path MTU probing the peer's packet size changes, so look at the message boundary instead
+   if (m_iExtension & CHandShake::m_iExtPMTUD)
+   {
+      if (packet.getMsgBoundary() & 1)
+         CTimer::rdtsc(m_ullNextACKTime);
+   }
+   else if (packet.getLength() != m_iPayloadSize)   
       CTimer::rdtsc(m_ullNextACKTime); 
 
    // Update the current largest sequence number that has been received.
    // Or it is a retransmitted packet, remove it from receiver loss list.
    if (CSeqNo::seqcmp(packet.m_iSeqNo, m_iRcvCurrSeqNo) > 0)
       m_iRcvCurrSeqNo = packet.m_iSeqNo;
-   else
-      m_pRcvLossList->remove(packet.m_iSeqNo);
+   else if (m_pRcvLossList->remove(packet.m_iSeqNo) && !m_ReorderGaps.empty())
+      fillReorderGap(packet.m_iSeqNo, false);
+
+   if ((NULL != m_pFECDecoder) && m_pFECDecoder->addData(packet.m_iSeqNo, packet.m_iMsgNo, packet.m_pcData, packet.getLength()))
+      recoverData();
+
+   if (!m_ReorderGaps.empty())
+      checkReorderGaps(currtime);
+
+   // a message that may be read out of order does not wait for the ACK to pass the hole before it
+   if ((UDT_DGRAM == m_iSockType) && !packet.getMsgOrderFlag() && (packet.getMsgBoundary() & 1) && (m_pRcvLossList->getLossLength() > 0) && (m_pRcvBuffer->getRcvMsgNum() > 0))
+   {
+      #ifndef WIN32
+         pthread_mutex_lock(&m_RecvDataLock);
+         if (m_bSynRecving)
+            pthread_cond_signal(&m_RecvDataCond);
+         pthread_mutex_unlock(&m_RecvDataLock);
+      #else
+         if (m_bSynRecving)
+            SetEvent(m_RecvDataCond);
+      #endif
+
+      s_UDTUnited.m_EPoll.update_events(m_SocketID, m_sPollID, UDT_EPOLL_IN, true);
+   }
 
    return 0;
 }
 
-int CUDT::listen(sockaddr* addr, CPacket& packet)
+void CUDT::recoverData()
+{
+   // when called for a parity packet this is the unit that carried it, which is no longer needed
+   CUnit* unit = m_pRcvQueue->m_UnitQueue.getNextAvailUnit();
+   if (NULL == unit)
+      return;
+
+   CPacket& packet = unit->m_Packet;
+   int32_t seqno;
+   int32_t msgno;
+   int len;
+   if (!m_pFECDecoder->recover(seqno, msgno, packet.m_pcData, len))
+      return;
+
+   int32_t offset = CSeqNo::seqoff(m_iRcvLastAck, seqno);
+   if ((offset < 0) || (offset >= m_pRcvBuffer->getAvailBufSize()))
+      return;
+
+   packet.m_iSeqNo = seqno;
+   packet.m_iMsgNo = msgno;
+   packet.m_iTimeStamp = int(CTimer::getTime() - m_StartTime);
+   packet.m_iID = m_SocketID;
+   packet.setLength(len);
+
+   if (m_pRcvBuffer->addData(unit, offset) < 0)
+      return;
+
+   ++ m_iRcvRecovered;
+   ++ m_iRcvRecoveredTotal;
+
+   if (CSeqNo::seqcmp(seqno, m_iRcvCurrSeqNo) > 0)
+   {
+      if (CSeqNo::seqcmp(seqno, CSeqNo::incseq(m_iRcvCurrSeqNo)) > 0)
+         m_pRcvLossList->insert(CSeqNo::incseq(m_iRcvCurrSeqNo), CSeqNo::decseq(seqno));
+      m_iRcvCurrSeqNo = seqno;
+   }
+   else
+      m_pRcvLossList->remove(seqno);
+}
+
+void CUDT::fillReorderGap(int32_t seqno, bool duplicate)
+{
+   // the gaps are disjoint and in sequence order, find the first one that does not end before seqno
+   int lo = 0;
+   int hi = int(m_ReorderGaps.size());
+   while (lo < hi)
+   {
+      int mid = (lo + hi) / 2;
+      if (CSeqNo::seqcmp(m_ReorderGaps[mid].m_iSeqNo2, seqno) < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   if ((lo == int(m_ReorderGaps.size())) || (CSeqNo::seqcmp(seqno, m_ReorderGaps[lo].m_iSeqNo1) < 0))
+      return;
+
+   CReorderGap& gap = m_ReorderGaps[lo];
+   int depth = 0;
+
+   if (duplicate)
+   {
+      // the retransmission of a reported packet arrives after the packet itself: the original was late
+      if (seqno == gap.m_iLateSeqNo)
+         depth = gap.m_iLateDepth;
+   }
+   else if (!gap.m_bReported)
+   {
+      // nothing has been asked for yet, so this cannot be a retransmission
+      depth = CSeqNo::seqoff(seqno, m_iRcvCurrSeqNo) + 1;
+   }
+   else
+   {
+      // either the retransmission or the late original, a following duplicate will tell
+      gap.m_iLateSeqNo = seqno;
+      gap.m_iLateDepth = CSeqNo::seqoff(seqno, m_iRcvCurrSeqNo) + 1;
+   }
+
+   if (depth > 0)
+   {
+      // the path reorders at least this deep
+      gap.m_bReordered = true;
+      m_iReorderDecay = 0;
+      if (depth > m_iReorderTolerance)
+         m_iReorderTolerance = (depth < m_iMaxReorderTolerance) ? depth : m_iMaxReorderTolerance;
+   }
+}
+
+void CUDT::checkReorderGaps(uint64_t currtime)
+{
+   // a gap is reported once enough packets have arrived after it, or one SYN after it was detected
+   uint64_t window = m_iSYNInterval * m_ullCPUFrequency;
+   uint64_t linger = (2 * m_iRTT + m_iSYNInterval) * m_ullCPUFrequency;
+
+   // with FEC, give the parity of the group a chance to arrive
+   int tolerance = m_iReorderTolerance;
+   if ((NULL != m_pFECDecoder) && (tolerance <= m_iPeerFECGroup))
+      tolerance = m_iPeerFECGroup + 1;
+
+   // gaps are detected and reported in sequence order, so the reported ones lead and
+   // each pass stops at the first gap that has to wait
+
+   // keep a reported gap until its retransmission is due, to recognize late originals, then retire it
+   while ((m_iReportedGaps > 0) && (currtime - m_ReorderGaps.front().m_ullTime >= linger))
+   {
+      // a real loss: let the window shrink slowly towards its starting size, one packet per 16 losses
+      if (!m_ReorderGaps.front().m_bReordered && (m_iReorderTolerance > 3) && (++ m_iReorderDecay >= 16))
+      {
+         -- m_iReorderTolerance;
+         m_iReorderDecay = 0;
+      }
+
+      m_ReorderGaps.pop_front();
+      -- m_iReportedGaps;
+   }
+
+   while (m_iReportedGaps < int(m_ReorderGaps.size()))
+   {
+      CReorderGap& gap = m_ReorderGaps[m_iReportedGaps];
+      if ((CSeqNo::seqoff(gap.m_iSeqNo2, m_iRcvCurrSeqNo) < tolerance) && (currtime - gap.m_ullTime < window))
+         break;
+
+      reportReorderGap(gap, currtime);
+      ++ m_iReportedGaps;
+   }
+}
+
+void CUDT::reportReorderGap(CReorderGap& gap, uint64_t currtime)
+{
+   // report what is still missing of the gap
+   int32_t lossdata[2];
+   int32_t array[64];
+   int len;
+   int32_t start = gap.m_iSeqNo1;
+   do
+   {
+      m_pRcvLossList->getLossArray(array, len, 64, start, gap.m_iSeqNo2);
+      for (int j = 0; j < len; ++ j)
+      {
+         if (array[j] < 0)
+         {
+            lossdata[0] = array[j];
+            lossdata[1] = array[++ j];
+            sendCtrl(3, NULL, lossdata, 2);
+         }
+         else
+         {
+            lossdata[1] = array[j];
+            sendCtrl(3, NULL, lossdata, 1);
+         }
+      }
+
+      if (len > 0)
+         start = CSeqNo::incseq(array[len - 1]);
+   } while ((len >= 63) && (CSeqNo::seqcmp(start, gap.m_iSeqNo2) <= 0));
+
+   gap.m_bReported = true;
+   gap.m_ullTime = currtime;
+}
+
+int CUDT::listen(sockaddr* addr, CUnit* unit)
 {
+   CPacket& packet = unit->m_Packet;
+
    if (m_bClosing)
       return 1002;
 
-   if (packet.getLength() != CHandShake::m_iContentSize)
+   if (packet.getLength() < CHandShake::m_iContentSize)
       return 1004;
 
    CHandShake hs;
    hs.deserialize(packet.m_pcData, packet.getLength());
 
+   // only a resumption request carries more than the hand shake
+   if ((packet.getLength() != CHandShake::m_iContentSize) && (2 != hs.m_iReqType))
+      return 1004;
+
    // SYN cookie
    char clienthost[NI_MAXHOST];
    char clientport[NI_MAXSERV];
@@ -2466,24 +4176,41 @@ int CUDT::listen(sockaddr* addr, CPacket& packet)
    stringstream cookiestr;
    cookiestr << clienthost << ":" << clientport << ":" << timestamp;
    unsigned char cookie[16];
-   CMD5::compute(cookiestr.str().c_str(), cookie);
+   sign(cookiestr.str().c_str(), int(cookiestr.str().size()), cookie);
+
+   // a valid token stands in for the cookie, otherwise the request is answered like a regular one
+   bool resumed = false;
+   int datalen = 0;
+   if (2 == hs.m_iReqType)
+   {
+      resumed = checkToken(addr, hs, packet.getLength());
+      if (resumed)
+         datalen = hs.m_iCookie;
+      else
+         hs.m_iReqType = 1;
+   }
 
    if (1 == hs.m_iReqType)
    {
+      // tell the client that the extension flags are understood, its next request may carry them
       hs.m_iCookie = *(int*)cookie;
+      hs.m_iExtension = CHandShake::m_iExtAware;
+      hs.m_bToken = false;
       packet.m_iID = hs.m_iID;
-      int size = packet.getLength();
+      int size = CHandShake::m_iContentSize;
       hs.serialize(packet.m_pcData, size);
+      packet.setLength(size);
       m_pSndQueue->sendto(addr, packet);
       return 0;
    }
-   else
+   else if (!resumed)
    {
       if (hs.m_iCookie != *(int*)cookie)
       {
          timestamp --;
+         cookiestr.str("");
          cookiestr << clienthost << ":" << clientport << ":" << timestamp;
-         CMD5::compute(cookiestr.str().c_str(), cookie);
+         sign(cookiestr.str().c_str(), int(cookiestr.str().size()), cookie);
 
          if (hs.m_iCookie != *(int*)cookie)
             return -1;
@@ -2492,6 +4219,14 @@ int CUDT::listen(sockaddr* addr, CPacket& packet)
 
    int32_t id = hs.m_iID;
 
+   // the response tells the client if the request was resumed, and brings a token for the next one
+   bool asked = (0 != (hs.m_iExtension & CHandShake::m_iExtResume));
+   if (!resumed)
+      hs.m_iExtension &= ~CHandShake::m_iExtResume;
+   hs.m_bToken = false;
+   if (m_bResume && asked)
+      issueToken(addr, &hs);
+
    // When a peer side connects in...
    if ((1 == packet.getFlag()) && (0 == packet.getType()))
    {
@@ -2499,8 +4234,10 @@ int CUDT::listen(sockaddr* addr, CPacket& packet)
       {
          // mismatch, reject the request
          hs.m_iReqType = 1002;
+         hs.m_bToken = false;
          int size = CHandShake::m_iContentSize;
          hs.serialize(packet.m_pcData, size);
+         packet.setLength(size);
          packet.m_iID = id;
          m_pSndQueue->sendto(addr, packet);
       }
@@ -2508,14 +4245,18 @@ int CUDT::listen(sockaddr* addr, CPacket& packet)
       {
          int result = s_UDTUnited.newConnection(m_SocketID, addr, &hs);
          if (result == -1)
+         {
             hs.m_iReqType = 1002;
+            hs.m_bToken = false;
+         }
 
          // send back a response if connection failed or connection already existed
          // new connection response should be sent in connect()
          if (result != 1)
          {
-            int size = CHandShake::m_iContentSize;
+            int size = m_iPayloadSize;
             hs.serialize(packet.m_pcData, size);
+            packet.setLength(size);
             packet.m_iID = id;
             m_pSndQueue->sendto(addr, packet);
          }
@@ -2523,6 +4264,20 @@ int CUDT::listen(sockaddr* addr, CPacket& packet)
          {
             // a new connection has been created, enable epoll for write 
             s_UDTUnited.m_EPoll.update_events(m_SocketID, m_sPollID, UDT_EPOLL_OUT, true);
+
+            // the data of a resumption request is the first packet of the client, hand it over as if it had come on its own
+            CUDTSocket* ns = (datalen > 0) ? s_UDTUnited.locate(hs.m_iID) : NULL;
+            if ((NULL != ns) && ns->m_pUDT->m_bConnected && !ns->m_pUDT->m_bBroken && !ns->m_pUDT->m_bClosing)
+            {
+               memmove(packet.m_pcData, packet.m_pcData + CHandShake::m_iContentSize + CHandShake::m_iTokenSize, datalen);
+               packet.setLength(datalen);
+               packet.m_iSeqNo = ns->m_pUDT->m_iPeerISN;
+               packet.m_iMsgNo = 1 | 0xC0000000;
+               packet.m_iID = hs.m_iID;
+
+               ns->m_pUDT->processData(unit);
+               ns->m_pUDT->checkTimers();
+            }
          }
       }
    }
@@ -2554,14 +4309,32 @@ void CUDT::checkTimers()
 
       m_iPktCount = 0;
       m_iLightACKCount = 1;
+
+      // aim at about 16 light ACKs for the data in flight, estimated as arrival rate x (RTT + SYN),
+      // so that fast flows do not flood the sender with ACKs; the CC may narrow the range
+      int64_t flight = int64_t(m_pRcvTimeWindow->getPktRcvSpeed()) * (m_iRTT + m_iSYNInterval) / 1000000;
+      m_iLightACKInterval = int(flight / 16);
+      if (m_iLightACKInterval < m_pCC->m_iMinLightACKInterval)
+         m_iLightACKInterval = m_pCC->m_iMinLightACKInterval;
+      else if (m_iLightACKInterval > m_pCC->m_iMaxLightACKInterval)
+         m_iLightACKInterval = m_pCC->m_iMaxLightACKInterval;
    }
-   else if (m_iSelfClockInterval * m_iLightACKCount <= m_iPktCount)
+   else if (m_iLightACKInterval * m_iLightACKCount <= m_iPktCount)
    {
       //send a "light" ACK
       sendCtrl(2, NULL, NULL, 4);
       ++ m_iLightACKCount;
    }
 
+   // report the gaps that have outlived the reorder window without new packets arriving
+   if (!m_ReorderGaps.empty())
+      checkReorderGaps(currtime);
+
+   if (m_iExtension & CHandShake::m_iExtPMTUD)
+      checkPMTU(currtime);
+
+   releaseIdle(currtime);
+
    // we are not sending back repeated NAK anymore and rely on the sender's EXP for retransmission
    //if ((m_pRcvLossList->getLossLength() > 0) && (currtime > m_ullNextNAKTime))
    //{
@@ -2620,6 +4393,28 @@ void CUDT::checkTimers()
             // resend all unacknowledged packets on timeout, but only if there is no packet in the loss list
             int32_t csn = m_iSndCurrSeqNo;
             int num = m_pSndLossList->insert(m_iSndLastAck, csn);
+
+            // skip the packets that the receiver has reported by SACK
+            if (NULL != m_pSACKMap)
+            {
+               processSACK(m_iSndLastAck, NULL, 0);
+
+               int32_t last = CSeqNo::incseq(m_iSndLastAck, m_pSACKMap->getCapacity() - 1);
+               if (CSeqNo::seqcmp(last, csn) > 0)
+                  last = csn;
+
+               int32_t seqno1 = m_pSACKMap->find(m_iSndLastAck, last, true);
+               while (-1 != seqno1)
+               {
+                  int32_t seqno2 = m_pSACKMap->find(seqno1, last, false);
+                  seqno2 = (-1 == seqno2) ? last : CSeqNo::decseq(seqno2);
+                  num -= m_pSndLossList->remove(seqno1, seqno2);
+                  if (seqno2 == last)
+                     break;
+                  seqno1 = m_pSACKMap->find(CSeqNo::incseq(seqno2), last, true);
+               }
+            }
+
             m_iTraceSndLoss += num;
             m_iSndLossTotal += num;
          }
@@ -2641,6 +4436,83 @@ void CUDT::checkTimers()
    }
 }
 
+void CUDT::releaseIdle(uint64_t currtime)
+{
+   // any data packet sent or received restarts the idle period
+   if ((m_llSentTotal != m_llIdleSentTotal) || (m_llRecvTotal != m_llIdleRecvTotal))
+   {
+      m_llIdleSentTotal = m_llSentTotal;
+      m_llIdleRecvTotal = m_llRecvTotal;
+      m_ullLastDataTime = currtime;
+      return;
+   }
+
+   if (currtime - m_ullLastDataTime < m_iIdleRelease * m_ullCPUFrequency)
+      return;
+
+   // everything below is allocated again by the next packet or write; each part is only freed if it is empty.
+   // An application thread blocked in send() or recv() keeps its buffer, the lock cannot be taken here.
+   #ifndef WIN32
+      if (0 == pthread_mutex_trylock(&m_SendLock))
+   #else
+      if (WAIT_OBJECT_0 == WaitForSingleObject(m_SendLock, 0))
+   #endif
+   {
+      m_pSndBuffer->release();
+
+      #ifndef WIN32
+         pthread_mutex_unlock(&m_SendLock);
+      #else
+         ReleaseMutex(m_SendLock);
+      #endif
+   }
+
+   #ifndef WIN32
+      if (0 == pthread_mutex_trylock(&m_RecvLock))
+   #else
+      if (WAIT_OBJECT_0 == WaitForSingleObject(m_RecvLock, 0))
+   #endif
+   {
+      m_pRcvBuffer->release();
+
+      #ifndef WIN32
+         pthread_mutex_unlock(&m_RecvLock);
+      #else
+         ReleaseMutex(m_RecvLock);
+      #endif
+   }
+
+   m_pSndLossList->release();
+   m_pRcvLossList->release();
+
+   // with nothing left to send, no SACK block matters any more
+   if ((NULL != m_pSACKMap) && (0 == m_pSndBuffer->getCurrBufSize()))
+      m_pSACKMap->release();
+
+   // the ACK-2 of the last ACK is long overdue
+   m_pACKWindow->release();
+}
+
+int64_t CUDT::getMemSize() const
+{
+   int64_t size = sizeof(CUDT);
+
+   if (NULL != m_pSndBuffer)
+      size += m_pSndBuffer->getMemSize();
+   if (NULL != m_pRcvBuffer)
+      size += m_pRcvBuffer->getMemSize();
+   if (NULL != m_pSndLossList)
+      size += m_pSndLossList->getMemSize();
+   if (NULL != m_pRcvLossList)
+      size += m_pRcvLossList->getMemSize();
+   if (NULL != m_pSACKMap)
+      size += m_pSACKMap->getMemSize();
+   if (NULL != m_pACKWindow)
+      size += m_pACKWindow->getMemSize();
+
+   return size;
+}
+
 void CUDT::addEPoll(const int eid)
 {
    CGuard::enterCS(s_UDTUnited.m_EPoll.m_EPollLock);
@@ -42,6 +42,8 @@ written by
 #define __UDT_CORE_H__
 
 
+#include <deque>
+#include <list>
 #include "udt.h"
 #include "common.h"
 #include "list.h"
@@ -53,6 +55,8 @@ written by
 #include "ccc.h"
 #include "cache.h"
 #include "queue.h"
+#include "fec.h"
+#include "stream.h"
 
 enum UDTSockType {UDT_STREAM = 1, UDT_DGRAM};
 
@@ -68,6 +72,7 @@ friend class CSndQueue;
 friend class CRcvQueue;
 friend class CSndUList;
 friend class CRcvUList;
+friend class CStreamMux;
 
 private: // constructor and desctructor
    CUDT();
@@ -75,6 +80,25 @@ private: // constructor and desctructor
    const CUDT& operator=(const CUDT&) {return *this;}
    ~CUDT();
 
+      // Functionality:
+      //    load the default configurations, or copy them from the listener of an accepted connection.
+      // Parameters:
+      //    0) [in] ancestor: the listening UDT entity.
+      // Returned value:
+      //    None.
+
+   void defaultOpt();
+   void copyOpt(const CUDT& ancestor);
+
+      // Functionality:
+      //    bring a closed entity back to its initial status so that it can be reused for a new connection.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void reset();
+
 public: //API
    static int startup();
    static int cleanup();
@@ -83,7 +107,10 @@ public: //API
    static int bind(UDTSOCKET u, UDPSOCKET udpsock);
    static int listen(UDTSOCKET u, int backlog);
    static UDTSOCKET accept(UDTSOCKET u, sockaddr* addr, int* addrlen);
+   static int acceptmany(UDTSOCKET u, UDTSOCKET* socks, int num);
    static int connect(UDTSOCKET u, const sockaddr* name, int namelen);
+   static int connect(UDTSOCKET u, const sockaddr* name, int namelen, const char* data, int len);
+   static int connectmany(const UDTSOCKET* socks, const sockaddr* names, int namelen, int num);
    static int close(UDTSOCKET u);
    static int getpeername(UDTSOCKET u, sockaddr* name, int* namelen);
    static int getsockname(UDTSOCKET u, sockaddr* name, int* namelen);
@@ -93,8 +120,27 @@ public: //API
    static int recv(UDTSOCKET u, char* buf, int len, int flags);
    static int sendmsg(UDTSOCKET u, const char* buf, int len, int ttl = -1, bool inorder = false);
    static int recvmsg(UDTSOCKET u, char* buf, int len);
+   static int sendv(UDTSOCKET u, const CIOVec* iov, int num, int flags);
+   static int recvv(UDTSOCKET u, const CIOVec* iov, int num, int flags);
+   static int sendmsgv(UDTSOCKET u, const CIOVec* iov, int num, int ttl = -1, bool inorder = false);
+   static int recvmsgv(UDTSOCKET u, const CIOVec* iov, int num);
+   static int recvlend(UDTSOCKET u, CRcvSlice* slices, int num);
+   static int recvrelease(UDTSOCKET u, const CRcvSlice* slices, int num);
    static int64_t sendfile(UDTSOCKET u, std::fstream& ifs, int64_t& offset, int64_t size, int block = 364000);
    static int64_t recvfile(UDTSOCKET u, std::fstream& ofs, int64_t& offset, int64_t size, int block = 7280000);
+#ifndef WIN32
+   static int64_t sendfile(UDTSOCKET u, int fd, int64_t& offset, int64_t size, int block = 364000);
+   static int64_t recvfile(UDTSOCKET u, int fd, int64_t& offset, int64_t size, int block = 7280000);
+   static int64_t sendfile(UDTSOCKET u, const char* path, int64_t& offset, int64_t size, int block = 364000);
+   static int64_t recvfile(UDTSOCKET u, const char* path, int64_t& offset, int64_t size, int block = 7280000);
+#endif
+   static int64_t sendfilestriped(const UDTSOCKET* socks, int num, const char* path, int block = 364000);
+   static int64_t recvfilestriped(const UDTSOCKET* socks, int num, const char* path, int64_t size, const char* manifest, int64_t stripe, int block = 7280000);
+   static int openstream(UDTSOCKET u);
+   static int acceptstream(UDTSOCKET u);
+   static int sendstream(UDTSOCKET u, int stream, const char* buf, int len);
+   static int recvstream(UDTSOCKET u, int stream, char* buf, int len);
+   static int closestream(UDTSOCKET u, int stream);
    static int select(int nfds, ud_set* readfds, ud_set* writefds, ud_set* exceptfds, const timeval* timeout);
    static int selectEx(const std::vector<UDTSOCKET>& fds, std::vector<UDTSOCKET>* readfds, std::vector<UDTSOCKET>* writefds, std::vector<UDTSOCKET>* exceptfds, int64_t msTimeOut);
    static int epoll_create();
@@ -107,6 +153,8 @@ public: //API
    static CUDTException& getlasterror();
    static int perfmon(UDTSOCKET u, CPerfMon* perf, bool clear = true);
    static UDTSTATUS getsockstate(UDTSOCKET u);
+   static int savecache(const char* path);
+   static int loadcache(const char* path);
 
 public: // internal API
    static CUDT* getUDTHandle(UDTSOCKET u);
@@ -134,10 +182,12 @@ private:
       //    Connect to a UDT entity listening at address "peer".
       // Parameters:
       //    0) [in] peer: The address of the listening UDT entity.
+      //    1) [in] data: first bytes of the stream, sent with the handshake if the listener has issued a resumption token.
+      //    2) [in] len: size of "data".
       // Returned value:
-      //    None.
+      //    Number of bytes of "data" taken, at most one packet.
 
-   void connect(const sockaddr* peer);
+   int connect(const sockaddr* peer, const char* data = NULL, int len = 0);
 
       // Functionality:
       //    Process the response handshake packet.
@@ -177,6 +227,16 @@ private:
 
    int send(const char* data, int len);
 
+      // Functionality:
+      //    Request UDT to send out the data of several segments, as if they were one block.
+      // Parameters:
+      //    0) [in] iov: the segments, in order.
+      //    1) [in] num: number of segments.
+      // Returned value:
+      //    Actual size of data sent, taken from the front of the segments.
+
+   int sendv(const CIOVec* iov, int num);
+
       // Functionality:
       //    Request UDT to receive data to a memory block "data" with size of "len".
       // Parameters:
@@ -187,6 +247,16 @@ private:
 
    int recv(char* data, int len);
 
+      // Functionality:
+      //    Request UDT to receive data into several segments, filling each before the next.
+      // Parameters:
+      //    0) [in] iov: the segments, in order.
+      //    1) [in] num: number of segments.
+      // Returned value:
+      //    Actual size of data received.
+
+   int recvv(const CIOVec* iov, int num);
+
       // Functionality:
       //    send a message of a memory block "data" with size of "len".
       // Parameters:
@@ -199,6 +269,18 @@ private:
 
    int sendmsg(const char* data, int len, int ttl, bool inorder);
 
+      // Functionality:
+      //    send one message made of several segments, e.g. a header and a body.
+      // Parameters:
+      //    0) [in] iov: the segments, in order.
+      //    1) [in] num: number of segments.
+      //    2) [in] ttl: the time-to-live of the message.
+      //    3) [in] inorder: if the message should be delivered in order.
+      // Returned value:
+      //    Actual size of data sent.
+
+   int sendmsgv(const CIOVec* iov, int num, int ttl, bool inorder);
+
       // Functionality:
       //    Receive a message to buffer "data".
       // Parameters:
@@ -209,6 +291,58 @@ private:
 
    int recvmsg(char* data, int len);
 
+      // Functionality:
+      //    Receive a message into several segments, filling each before the next.
+      // Parameters:
+      //    0) [in] iov: the segments, in order.
+      //    1) [in] num: number of segments.
+      // Returned value:
+      //    Actual size of data received.
+
+   int recvmsgv(const CIOVec* iov, int num);
+
+      // Functionality:
+      //    Total size of a segment list.
+      // Parameters:
+      //    0) [in] iov: the segments.
+      //    1) [in] num: number of segments.
+      // Returned value:
+      //    sum of the segment sizes; throws if a segment is invalid or the sum overflows.
+
+   static int iovLength(const CIOVec* iov, int num);
+
+      // Functionality:
+      //    Lend received data to the application as views into the protocol buffer, without copying.
+      //    In stream mode all acknowledged data that fits in "slices" is lent; in message mode one whole message.
+      //    The call never blocks; use epoll to wait for readable data.
+      // Parameters:
+      //    0) [out] slices: array to store the payload views.
+      //    1) [in] num: size of the array.
+      // Returned value:
+      //    Number of slices lent.
+
+   int recvlend(CRcvSlice* slices, int num);
+
+      // Functionality:
+      //    Return units lent by recvlend to the receiver buffer, making their space available to the sender again.
+      // Parameters:
+      //    0) [in] slices: payload views returned by recvlend.
+      //    1) [in] num: number of slices.
+      // Returned value:
+      //    Number of units released.
+
+   int recvrelease(const CRcvSlice* slices, int num);
+
+      // Functionality:
+      //    Get the streams of a message mode connection, starting them on the first call.
+      //    From then on the messages of the connection are frames of the streams.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    the stream multiplexer.
+
+   CStreamMux* getStreamMux();
+
       // Functionality:
       //    Request UDT to send out a file described as "fd", starting from "offset", with size of "size".
       // Parameters:
@@ -233,6 +367,33 @@ private:
 
    int64_t recvfile(std::fstream& ofs, int64_t& offset, int64_t size, int block = 7320000);
 
+#ifndef WIN32
+      // Functionality:
+      //    Request UDT to send out "size" bytes of the file open as "fd", reading them at "offset" straight into the sending buffer.
+      // Parameters:
+      //    0) [in] fd: file descriptor open for reading; its position is not used or changed.
+      //    1) [in, out] offset: From where to read and send data; output is the new offset when the call returns.
+      //    2) [in] size: How many data to be sent.
+      //    3) [in] block: size of block per read from disk
+      // Returned value:
+      //    Actual size of data sent.
+
+   int64_t sendfile(int fd, int64_t& offset, int64_t size, int block = 364000);
+
+      // Functionality:
+      //    Request UDT to receive "size" bytes into the file open as "fd" at "offset", written straight from the receiving buffer.
+      //    A descriptor opened with O_DIRECT is written through an aligned staging buffer.
+      // Parameters:
+      //    0) [in] fd: file descriptor open for writing; its position is not used or changed.
+      //    1) [in, out] offset: From where to write data; output is the new offset when the call returns.
+      //    2) [in] size: How many data to be received.
+      //    3) [in] block: size of block per write to disk
+      // Returned value:
+      //    Actual size of data received.
+
+   int64_t recvfile(int fd, int64_t& offset, int64_t size, int block = 7280000);
+#endif
+
       // Functionality:
       //    Configure UDT options.
       // Parameters:
@@ -298,11 +459,28 @@ private: // Options
    int m_iRcvTimeOut;                           // receiving timeout in milliseconds
    bool m_bReuseAddr;				// reuse an exiting port or not, for UDP multiplexer
    int64_t m_llMaxBW;				// maximum data transfer rate (threshold)
+   bool m_bSACK;				// offer selective acknowledgement during the handshake
+   int m_iMaxReorderTolerance;			// maximum reorder window before a gap is reported as loss, in packets; 0: report at once
+   int m_iFECGroup;				// number of data packets protected by one XOR parity packet; 0: no FEC
+   bool m_bPMTUD;				// probe the path for the largest packet size it carries, up to m_iMSS
+   int m_iCoalesce;				// longest wait of a small message for others to share its packet, in microseconds; -1: no packing
+   bool m_bLowLatency;				// an idle connection sends from the calling thread instead of waking the sending worker
+   int m_iBusyPoll;				// time a receive spins before sleeping, in microseconds; the receiving thread never sleeps; 0: no spinning
+   int m_iPollCPU;				// CPU the receiving thread of a new multiplexer is pinned to; -1: none
+   uint64_t m_llCPUMask;			// CPUs the threads of a new multiplexer run on; 0: any
+   int m_iNUMANode;				// NUMA node of the packet buffers of the multiplexer and the socket; -1: any
+   int m_iWorkerPool;				// size of the shared thread pool serving a new multiplexer; 0: dedicated threads
+   bool m_bResume;				// a listener issues resumption tokens and accepts the connections resumed with them
+   bool m_bDirectIO;				// file transfers by path bypass the page cache
+   int m_iStreamWindow;				// receiving window of each stream carried by the connection, in bytes
 
 private: // congestion control
    CCCVirtualFactory* m_pCCFactory;             // Factory class to create a specific CC instance
+   int m_iCCAlgo;                               // built-in algorithm made by m_pCCFactory, see UDTCCAlgo
    CCC* m_pCC;                                  // congestion control class
    CCache<CInfoBlock>* m_pCache;		// network information cache
+   CCache<CTokenBlock>* m_pTokenCache;		// resumption tokens issued to this host
+   static const int m_iWarmStartTTL;		// age after which a cached sending rate is not resumed, in microseconds
 
 private: // Status
    volatile bool m_bListening;                  // If the UDT entit is listening to connection
@@ -325,7 +503,13 @@ private: // Status
 
    CHandShake m_ConnReq;			// connection request
    CHandShake m_ConnRes;			// connection response
+   int32_t m_iExtension;			// protocol extensions negotiated with the peer, see CHandShake::m_iExt*
+   int32_t m_iReqExtension;			// extensions to request once the listener has shown it understands the flags
    int64_t m_llLastReqTime;			// last time when a connection request is sent
+   char* m_pcResumeData;			// data given to connect(), queued for sending once connected
+   int m_iResumeDataSize;			// size of m_pcResumeData
+   bool m_bResumeDataSent;			// if m_pcResumeData went out with a resumption request
+   CStreamMux* m_pStreamMux;			// streams carried by the connection, NULL until the first stream call
 
 private: // Sending related data
    CSndBuffer* m_pSndBuffer;                    // Sender buffer
@@ -347,7 +531,28 @@ private: // Sending related data
 
    int32_t m_iISN;                              // Initial Sequence Number
 
+   CSeqBitmap* m_pSACKMap;                      // packets above the last ACK reported received by SACK blocks
+   int32_t m_iSACKLastAck;                      // ACK up to which the SACK map has been cleaned
+
+   CFECEncoder* m_pFECEncoder;                  // parity generator for outgoing data, if FEC is negotiated
+
+   int m_iPMTU;                                 // packet size in use on the path, including the IP/UDP headers
+   volatile int m_iPMTUNext;                    // confirmed size for the next packets, applied by the sending thread
+   int m_iPMTUBase;                             // size to fall back to when the path stops carrying m_iPMTU
+   int m_iPMTUHigh;                             // largest size not yet ruled out by a lost probe
+   int m_iProbeSize;                            // size of the outstanding probe, 0 if none
+   int m_iProbeCount;                           // number of times the outstanding probe has been sent
+   int32_t m_iProbeID;                          // ID of the outstanding probe
+   uint64_t m_ullNextProbeTime;                 // time to send the next probe or to give up on the outstanding one
+   uint64_t m_ullLastAckProgressTime;           // last time the ACK moved forward or nothing was in flight
+
    void CCUpdate();
+   int packSACK(int32_t* blocks);
+   void processSACK(int32_t ack, const int32_t* blocks, int num);
+   void initPMTU();
+   void setPMTU(int size);
+   void applyPMTU();
+   void checkPMTU(uint64_t currtime);
 
 private: // Receiving related data
    CRcvBuffer* m_pRcvBuffer;                    // Receiver buffer
@@ -360,11 +565,41 @@ private: // Receiving related data
    int32_t m_iRcvLastAckAck;                    // Last sent ACK that has been acknowledged
    int32_t m_iAckSeqNo;                         // Last ACK sequence number
    int32_t m_iRcvCurrSeqNo;                     // Largest received sequence number
+   int m_iRcvOWD;                               // smallest one-way delay of the data since the last full ACK, microseconds, plus the clock offset of the peer
+   bool m_bRcvOWDReset;                         // if the next data packet starts a new m_iRcvOWD
 
    uint64_t m_ullLastWarningTime;               // Last time that a warning message is sent
 
    int32_t m_iPeerISN;                          // Initial Sequence Number of the peer side
 
+   struct CReorderGap
+   {
+      int32_t m_iSeqNo1;                        // first packet of the gap
+      int32_t m_iSeqNo2;                        // last packet of the gap
+      uint64_t m_ullTime;                       // time when the gap was detected, or reported after m_bReported is set
+      bool m_bReported;                         // if the gap has been sent in a NAK
+      bool m_bReordered;                        // if part of the gap turned out to be late rather than lost
+      int32_t m_iLateSeqNo;                     // last packet that filled the gap after it was reported
+      int m_iLateDepth;                         // number of packets received after m_iLateSeqNo was sent
+   };
+   std::deque<CReorderGap> m_ReorderGaps;       // gaps held back by the reorder window, and those recently reported, in sequence order
+   int m_iReportedGaps;                         // number of gaps at the front of m_ReorderGaps that have been reported
+   int m_iReorderTolerance;                     // current reorder window, in packets, adapted from the observed reordering depth
+   int m_iReorderDecay;                         // real losses since the reorder window last changed
+   static const int m_iMaxReorderGaps;          // most gaps tracked at a time; the oldest is reported and dropped beyond that
+
+   void checkReorderGaps(uint64_t currtime);
+   void fillReorderGap(int32_t seqno, bool duplicate);
+   void reportReorderGap(CReorderGap& gap, uint64_t currtime);
+
+   CFECDecoder* m_pFECDecoder;                  // rebuilds single losses from the peer's parity, if FEC is negotiated
+   int m_iPeerFECGroup;                         // parity group size used by the peer
+
+   void recoverData();
+
+   bool m_bPeerCoalesce;                        // if the peer packs small messages into shared packets
+   volatile bool m_bFlushWait;                  // if the socket is scheduled only to send a packet open for more messages
+
 private: // synchronization: mutexes and conditions
    pthread_mutex_t m_ConnectionLock;            // used to synchronize connection operation
 
@@ -383,12 +618,32 @@ private: // synchronization: mutexes and conditions
    void destroySynch();
    void releaseSynch();
 
+private: // network information cache
+   void initCC(const sockaddr* peer);
+   void saveCC();
+
+private: // resumption
+   static const int m_iResumeTokenTTL;		// time a resumption token is accepted after it is issued, in seconds
+   static const int m_iMaxUsedTokens;		// most tokens remembered as used; resumption is refused beyond that
+
+   unsigned char m_pcSecret[16];		// listener secret that signs the SYN cookies and the resumption tokens
+   int32_t m_iTokenSerial;			// serial number of the last token issued, so that no two tokens are the same
+   std::set<int64_t> m_sUsedTokens;		// signatures of the tokens that have resumed a connection
+   std::list<std::pair<uint64_t, int64_t> > m_lUsedTokens;	// the same signatures with the time they were used, oldest first
+
+   void sign(const char* data, int len, unsigned char sig[16]) const;
+   void signToken(const sockaddr* peer, const int32_t* token, int32_t sig[4]) const;
+   void issueToken(const sockaddr* peer, CHandShake* hs);
+   bool checkToken(const sockaddr* peer, const CHandShake& hs, int size);
+   void saveToken();
+
 private: // Generation and processing of packets
    void sendCtrl(int pkttype, void* lparam = NULL, void* rparam = NULL, int size = 0);
+   void sendHandshake();
    void processCtrl(CPacket& ctrlpkt);
    int packData(CPacket& packet, uint64_t& ts);
    int processData(CUnit* unit);
-   int listen(sockaddr* addr, CPacket& packet);
+   int listen(sockaddr* addr, CUnit* unit);
 
 private: // Trace
    uint64_t m_StartTime;                        // timestamp when the UDT entity is started
@@ -401,6 +656,14 @@ private: // Trace
    int m_iRecvACKTotal;                         // total number of received ACK packets
    int m_iSentNAKTotal;                         // total number of sent NAK packets
    int m_iRecvNAKTotal;                         // total number of received NAK packets
+   int m_iRcvSpuriousTotal;                     // total number of duplicate packets received, i.e., spurious retransmissions
+   int m_iSentParityTotal;                      // total number of sent FEC parity packets
+   int m_iRecvParityTotal;                      // total number of received FEC parity packets
+   int m_iRcvRecoveredTotal;                    // total number of data packets rebuilt from parity
+   int64_t m_llSentCtrlTotal;                   // total number of sent control packets
+   int64_t m_llRecvCtrlTotal;                   // total number of received control packets
+   int64_t m_llSentMsgTotal;                    // total number of messages sent
+   int64_t m_llRecvMsgTotal;                    // total number of messages delivered to the application
    int64_t m_llSndDurationTotal;		// total real time for sending
 
    uint64_t m_LastSampleTime;                   // last performance sample time
@@ -413,6 +676,15 @@ private: // Trace
    int m_iRecvACK;                              // number of ACKs received in the last trace interval
    int m_iSentNAK;                              // number of NAKs sent in the last trace interval
    int m_iRecvNAK;                              // number of NAKs received in the last trace interval
+   int m_iRcvSpurious;                          // number of duplicate packets received in the last trace interval
+   int m_iSentParity;                           // number of FEC parity packets sent in the last trace interval
+   int m_iRecvParity;                           // number of FEC parity packets received in the last trace interval
+   int m_iRcvRecovered;                         // number of data packets rebuilt from parity in the last trace interval
+   int64_t m_llSentCtrl;                        // number of control packets sent in the last trace interval
+   int64_t m_llRecvCtrl;                        // number of control packets received in the last trace interval
+   int64_t m_llTraceSentMsg;                    // number of messages sent in the last trace interval
+   int64_t m_llTraceRecvMsg;                    // number of messages delivered in the last trace interval
+   int64_t m_llTraceSentBytes;                  // payload bytes of the data packets sent in the last trace interval
    int64_t m_llSndDuration;			// real time for sending
    int64_t m_llSndDurationCounter;		// timers to record the sending duration
 
@@ -421,6 +693,7 @@ private: // Timers
 
    static const int m_iSYNInterval;             // Periodical Rate Control Interval, 10000 microsecond
    static const int m_iSelfClockInterval;       // ACK interval for self-clocking
+   static const int m_iMaxSACKBlocks;           // maximum number of SACK blocks carried by one ACK
 
    uint64_t m_ullNextACKTime;			// Next ACK time, in CPU clock cycles, same below
    uint64_t m_ullNextNAKTime;			// Next NAK time
@@ -435,10 +708,18 @@ private: // Timers
 
    int m_iPktCount;				// packet counter for ACK
    int m_iLightACKCount;			// light ACK counter
+   int m_iLightACKInterval;			// packets between two light ACKs, adapted to the arrival rate and RTT
 
    uint64_t m_ullTargetTime;			// scheduled time of next packet sending
 
+   static const int m_iIdleRelease;             // time without data after which the buffers are freed, in microseconds
+   uint64_t m_ullLastDataTime;                  // last time data packets were sent or received
+   int64_t m_llIdleSentTotal;                   // m_llSentTotal when data was last seen
+   int64_t m_llIdleRecvTotal;                   // m_llRecvTotal when data was last seen
+
    void checkTimers();
+   void releaseIdle(uint64_t currtime);
+   int64_t getMemSize() const;
 
 private: // for UDP multiplexer
    CSndQueue* m_pSndQueue;			// packet sending queue
@@ -0,0 +1,274 @@
+/*****************************************************************************
+Copyright (c) 2001 - 2011, The Board of Trustees of the University of Illinois.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the
+  above copyright notice, this list of conditions
+  and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the University of Illinois
+  nor the names of its contributors may be used to
+  endorse or promote products derived from this
+  software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************/
+
+#include <cstring>
+#include "common.h"
+#include "fec.h"
+
+using namespace std;
+
+// XOR "len" bytes of "src" into the word buffer "dst"; the tail of a short
+// payload is treated as zero padding.
+static void xorPayload(int32_t* dst, const char* src, int len)
+{
+   int words = len / 4;
+   for (int i = 0; i < words; ++ i)
+   {
+      int32_t w;
+      memcpy(&w, src + i * 4, 4);
+      dst[i] ^= w;
+   }
+
+   char* tail = (char*)(dst + words);
+   for (int j = words * 4; j < len; ++ j)
+      tail[j - words * 4] ^= src[j];
+}
+
+CFECEncoder::CFECEncoder(int group, int payload):
+m_iGroupSize(group),
+m_iPayloadSize(payload),
+m_piParity(NULL),
+m_iStart(-1),
+m_iCount(0),
+m_iMaxLen(0),
+m_bClosed(true),
+m_bReady(false)
+{
+   m_piParity = new int32_t[2 + (m_iPayloadSize + 3) / 4];
+   memset(m_piParity, 0, (2 + (m_iPayloadSize + 3) / 4) * 4);
+}
+
+CFECEncoder::~CFECEncoder()
+{
+   delete [] m_piParity;
+}
+
+void CFECEncoder::add(int32_t seqno, int32_t msgno, const char* data, int len)
+{
+   int32_t group = seqno - seqno % m_iGroupSize;
+
+   if ((m_iStart < 0) || (group != m_iStart - m_iStart % m_iGroupSize))
+   {
+      // first packet of a new group, which may begin in the middle of it
+      memset(m_piParity, 0, (2 + (m_iMaxLen + 3) / 4) * 4);
+      m_iStart = seqno;
+      m_iCount = 0;
+      m_iMaxLen = 0;
+      m_bClosed = false;
+   }
+
+   if (m_bClosed)
+      return;
+
+   if (seqno != CSeqNo::incseq(m_iStart, m_iCount))
+   {
+      // the sequence jumped inside the group (e.g., a dropped message), protect what we have
+      m_bClosed = true;
+      m_bReady = (m_iCount >= 2);
+      return;
+   }
+
+   m_piParity[0] ^= len;
+   m_piParity[1] ^= msgno;
+   xorPayload(m_piParity + 2, data, len);
+
+   ++ m_iCount;
+   if (len > m_iMaxLen)
+      m_iMaxLen = len;
+
+   if ((seqno - group == m_iGroupSize - 1) || (seqno == CSeqNo::m_iMaxSeqNo))
+   {
+      m_bClosed = true;
+      m_bReady = true;
+   }
+}
+
+bool CFECEncoder::flush()
+{
+   if (!m_bClosed && (m_iCount >= 2))
+   {
+      m_bClosed = true;
+      m_bReady = true;
+   }
+
+   return m_bReady;
+}
+
+int CFECEncoder::getParity(int32_t& seqno, char*& parity)
+{
+   m_bReady = false;
+
+   seqno = m_iStart;
+   m_piParity[0] = (m_iCount << 16) | (m_piParity[0] & 0xFFFF);
+   parity = (char*)m_piParity;
+
+   return 8 + (m_iMaxLen + 3) / 4 * 4;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CFECDecoder::CFECDecoder(int group, int payload, int blocks):
+m_iGroupSize(group),
+m_iPayloadSize(payload),
+m_iBlocks(blocks),
+m_pBlock(NULL),
+m_pLast(NULL)
+{
+   m_pBlock = new CBlock[m_iBlocks];
+   for (int i = 0; i < m_iBlocks; ++ i)
+   {
+      m_pBlock[i].m_iStart = -1;
+      m_pBlock[i].m_piData = new int32_t[(m_iPayloadSize + 3) / 4];
+   }
+}
+
+CFECDecoder::~CFECDecoder()
+{
+   for (int i = 0; i < m_iBlocks; ++ i)
+      delete [] m_pBlock[i].m_piData;
+   delete [] m_pBlock;
+}
+
+CFECDecoder::CBlock* CFECDecoder::locate(int32_t seqno)
+{
+   int32_t group = seqno - seqno % m_iGroupSize;
+   CBlock* b = m_pBlock + (group / m_iGroupSize) % m_iBlocks;
+
+   if (b->m_iStart == group)
+      return b;
+
+   // the slot still holds an older group, recycle it; a packet belonging to an even older group is ignored
+   if ((b->m_iStart >= 0) && (CSeqNo::seqcmp(group, b->m_iStart) < 0))
+      return NULL;
+
+   b->m_iStart = group;
+   b->m_iFirst = -1;
+   b->m_iCount = 0;
+   b->m_ullReceived = 0;
+   b->m_iXorLen = 0;
+   b->m_iXorMsgNo = 0;
+   memset(b->m_piData, 0, (m_iPayloadSize + 3) / 4 * 4);
+   b->m_bDone = false;
+
+   return b;
+}
+
+bool CFECDecoder::check(const CBlock* b) const
+{
+   if (b->m_bDone || (0 == b->m_iCount))
+      return false;
+
+   int first = b->m_iFirst - b->m_iStart;
+   uint64_t covered = ((64 == b->m_iCount) ? ~uint64_t(0) : ((uint64_t(1) << b->m_iCount) - 1)) << first;
+
+   // packets outside the parity range are folded in too and would corrupt the result
+   if (0 != (b->m_ullReceived & ~covered))
+      return false;
+
+   uint64_t missing = covered & ~b->m_ullReceived;
+   return (0 != missing) && (0 == (missing & (missing - 1)));
+}
+
+bool CFECDecoder::addData(int32_t seqno, int32_t msgno, const char* data, int len)
+{
+   CBlock* b = locate(seqno);
+   if ((NULL == b) || b->m_bDone)
+      return false;
+
+   uint64_t bit = uint64_t(1) << (seqno - b->m_iStart);
+   if (0 != (b->m_ullReceived & bit))
+      return false;
+
+   b->m_ullReceived |= bit;
+   b->m_iXorLen ^= len;
+   b->m_iXorMsgNo ^= msgno;
+   xorPayload(b->m_piData, data, (len < m_iPayloadSize) ? len : m_iPayloadSize);
+
+   m_pLast = b;
+   return check(b);
+}
+
+bool CFECDecoder::addParity(int32_t seqno, const char* parity, int len)
+{
+   if ((len < 8) || (seqno < 0))
+      return false;
+
+   CBlock* b = locate(seqno);
+   if ((NULL == b) || b->m_bDone || (b->m_iCount > 0))
+      return false;
+
+   int32_t head[2];
+   memcpy(head, parity, 8);
+
+   int count = (head[0] >> 16) & 0xFFFF;
+   if ((count < 1) || (seqno - b->m_iStart + count > m_iGroupSize))
+      return false;
+
+   b->m_iFirst = seqno;
+   b->m_iCount = count;
+   b->m_iXorLen ^= head[0] & 0xFFFF;
+   b->m_iXorMsgNo ^= head[1];
+   len -= 8;
+   xorPayload(b->m_piData, parity + 8, (len < m_iPayloadSize) ? len : m_iPayloadSize);
+
+   m_pLast = b;
+   return check(b);
+}
+
+bool CFECDecoder::recover(int32_t& seqno, int32_t& msgno, char* data, int& len)
+{
+   CBlock* b = m_pLast;
+   if ((NULL == b) || !check(b))
+      return false;
+
+   // the group is resolved either way
+   b->m_bDone = true;
+
+   int first = b->m_iFirst - b->m_iStart;
+   int offset = first;
+   while (0 != (b->m_ullReceived & (uint64_t(1) << offset)))
+      ++ offset;
+
+   len = b->m_iXorLen & 0xFFFF;
+   if ((len <= 0) || (len > m_iPayloadSize))
+      return false;
+
+   seqno = b->m_iStart + offset;
+   msgno = b->m_iXorMsgNo;
+   memcpy(data, b->m_piData, len);
+   b->m_ullReceived |= uint64_t(1) << offset;
+
+   return true;
+}
@@ -0,0 +1,178 @@
+/*****************************************************************************
+Copyright (c) 2001 - 2011, The Board of Trustees of the University of Illinois.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the
+  above copyright notice, this list of conditions
+  and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the University of Illinois
+  nor the names of its contributors may be used to
+  endorse or promote products derived from this
+  software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************/
+
+#ifndef __UDT_FEC_H__
+#define __UDT_FEC_H__
+
+
+#include "udt.h"
+
+
+class CFECEncoder
+{
+public:
+   CFECEncoder(int group, int payload);
+   ~CFECEncoder();
+
+      // Functionality:
+      //    Fold a newly sent data packet into the parity of its group.
+      // Parameters:
+      //    0) [in] seqno: sequence number of the data packet.
+      //    1) [in] msgno: message number field of the data packet.
+      //    2) [in] data: payload of the data packet.
+      //    3) [in] len: payload size.
+      // Returned value:
+      //    None.
+
+   void add(int32_t seqno, int32_t msgno, const char* data, int len);
+
+      // Functionality:
+      //    Close the current group early if it covers at least two packets.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    true if a parity packet is now ready, otherwise false.
+
+   bool flush();
+
+      // Functionality:
+      //    Check if a parity packet is waiting to be sent.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    true if a parity packet is ready, otherwise false.
+
+   bool ready() const {return m_bReady;}
+
+      // Functionality:
+      //    Hand out the pending parity packet and mark it as sent.
+      // Parameters:
+      //    0) [out] seqno: first sequence number covered by the parity.
+      //    1) [out] parity: pointer to the parity payload.
+      // Returned value:
+      //    Size of the parity payload in bytes.
+
+   int getParity(int32_t& seqno, char*& parity);
+
+private:
+   int m_iGroupSize;            // Number of data packets covered by one parity packet
+   int m_iPayloadSize;          // Maximum data payload size
+
+   int32_t* m_piParity;         // Parity payload: count/length word, msgno word, XOR of the data
+   int32_t m_iStart;            // First sequence number of the current group
+   int m_iCount;                // Number of consecutive packets folded into the current group
+   int m_iMaxLen;               // Largest payload folded into the current group
+   bool m_bClosed;              // No more packets are accepted for the current group
+   bool m_bReady;               // A parity packet is waiting to be sent
+
+private:
+   CFECEncoder(const CFECEncoder&);
+   CFECEncoder& operator=(const CFECEncoder&);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class CFECDecoder
+{
+public:
+   CFECDecoder(int group, int payload, int blocks = 32);
+   ~CFECDecoder();
+
+      // Functionality:
+      //    Fold a newly received data packet into the state of its group.
+      // Parameters:
+      //    0) [in] seqno: sequence number of the data packet.
+      //    1) [in] msgno: message number field of the data packet.
+      //    2) [in] data: payload of the data packet.
+      //    3) [in] len: payload size.
+      // Returned value:
+      //    true if a lost packet of the group can now be rebuilt, otherwise false.
+
+   bool addData(int32_t seqno, int32_t msgno, const char* data, int len);
+
+      // Functionality:
+      //    Fold a received parity packet into the state of its group.
+      // Parameters:
+      //    0) [in] seqno: first sequence number covered by the parity.
+      //    1) [in] parity: parity payload.
+      //    2) [in] len: parity payload size.
+      // Returned value:
+      //    true if a lost packet of the group can now be rebuilt, otherwise false.
+
+   bool addParity(int32_t seqno, const char* parity, int len);
+
+      // Functionality:
+      //    Rebuild the single missing packet of the group touched last.
+      // Parameters:
+      //    0) [out] seqno: sequence number of the rebuilt packet.
+      //    1) [out] msgno: message number field of the rebuilt packet.
+      //    2) [out] data: buffer for the rebuilt payload, at least "payload" bytes.
+      //    3) [out] len: size of the rebuilt payload.
+      // Returned value:
+      //    true if a packet was rebuilt, otherwise false.
+
+   bool recover(int32_t& seqno, int32_t& msgno, char* data, int& len);
+
+private:
+   struct CBlock
+   {
+      int32_t m_iStart;         // First sequence number of the group, -1 if unused
+      int32_t m_iFirst;         // First sequence number covered by the parity
+      int m_iCount;             // Number of packets covered by the parity, 0 until it arrives
+      uint64_t m_ullReceived;   // Packets of the group seen so far, one bit per offset
+      int32_t m_iXorLen;        // XOR of the payload sizes
+      int32_t m_iXorMsgNo;      // XOR of the message number fields
+      int32_t* m_piData;        // XOR of the payloads
+      bool m_bDone;             // The group has been recovered or can no longer be
+   };
+
+   CBlock* locate(int32_t seqno);
+   bool check(const CBlock* b) const;
+
+private:
+   int m_iGroupSize;            // Number of data packets covered by one parity packet
+   int m_iPayloadSize;          // Maximum data payload size
+   int m_iBlocks;               // Number of groups tracked at the same time
+
+   CBlock* m_pBlock;            // Group states, indexed by group number
+   CBlock* m_pLast;             // Group touched by the last call
+
+private:
+   CFECDecoder(const CFECDecoder&);
+   CFECDecoder& operator=(const CFECDecoder&);
+};
+
+
+#endif
@@ -40,330 +40,268 @@ written by
 
 #include "list.h"
 
-CSndLossList::CSndLossList(int size):
-m_piData1(NULL),
-m_piData2(NULL),
-m_piNext(NULL),
-m_iHead(-1),
-m_iLength(0),
-m_iSize(size),
-m_iLastInsertPos(-1),
-m_ListLock()
-{
-   m_piData1 = new int32_t [m_iSize];
-   m_piData2 = new int32_t [m_iSize];
-   m_piNext = new int [m_iSize];
+#ifdef __GNUC__
+   #define UDT_POPCOUNT64(x) __builtin_popcountll(x)
+   #define UDT_CTZ64(x) __builtin_ctzll(x)
+#else
+   static int UDT_POPCOUNT64(uint64_t x)
+   {
+      int n = 0;
+      for (; 0 != x; x &= x - 1)
+         ++ n;
+      return n;
+   }
 
-   // -1 means there is no data in the node
-   for (int i = 0; i < size; ++ i)
+   static int UDT_CTZ64(uint64_t x)
    {
-      m_piData1[i] = -1;
-      m_piData2[i] = -1;
+      int n = 0;
+      for (; 0 == (x & 1); x >>= 1)
+         ++ n;
+      return n;
    }
+#endif
 
-   // sender list needs mutex protection
-   #ifndef WIN32
-      pthread_mutex_init(&m_ListLock, 0);
-   #else
-      m_ListLock = CreateMutex(NULL, false, NULL);
-   #endif
+CSeqBitmap::CSeqBitmap(int size):
+m_pWords(NULL),
+m_iCapacity(64)
+{
+   while (m_iCapacity < size)
+      m_iCapacity <<= 1;
 }
 
-CSndLossList::~CSndLossList()
+CSeqBitmap::~CSeqBitmap()
 {
-   delete [] m_piData1;
-   delete [] m_piData2;
-   delete [] m_piNext;
-
-   #ifndef WIN32
-      pthread_mutex_destroy(&m_ListLock);
-   #else
-      CloseHandle(m_ListLock);
-   #endif
+   delete [] m_pWords;
 }
 
-int CSndLossList::insert(int32_t seqno1, int32_t seqno2)
+int CSeqBitmap::getCapacity() const
 {
-   CGuard listguard(m_ListLock);
+   return m_iCapacity;
+}
 
-   if (0 == m_iLength)
+int CSeqBitmap::set(int32_t seqno1, int32_t seqno2)
+{
+   // allocated by the first bit, most connections never lose a packet
+   if (NULL == m_pWords)
    {
-      // insert data into an empty list
+      try
+      {
+         uint64_t* words = new uint64_t [m_iCapacity >> 6];
+         for (int i = 0, n = m_iCapacity >> 6; i < n; ++ i)
+            words[i] = 0;
+         m_pWords = words;
+      }
+      catch (...)
+      {
+         return 0;
+      }
+   }
+
+   int len = CSeqNo::seqlen(seqno1, seqno2);
+   if (len > m_iCapacity)
+      len = m_iCapacity;
 
-      m_iHead = 0;
-      m_piData1[m_iHead] = seqno1;
-      if (seqno2 != seqno1)
-         m_piData2[m_iHead] = seqno2;
+   int pos = seqno1 & (m_iCapacity - 1);
+   int count = 0;
 
-      m_piNext[m_iHead] = -1;
-      m_iLastInsertPos = m_iHead;
+   // one word per round: bits from "pos" to the end of the range or of the word
+   while (len > 0)
+   {
+      int bit = pos & 63;
+      int n = (64 - bit < len) ? 64 - bit : len;
+      uint64_t mask = ((64 == n) ? ~0ULL : ((1ULL << n) - 1)) << bit;
 
-      m_iLength += CSeqNo::seqlen(seqno1, seqno2);
+      uint64_t& word = m_pWords[pos >> 6];
+      count += UDT_POPCOUNT64(~word & mask);
+      word |= mask;
 
-      return m_iLength;
+      pos = (pos + n) & (m_iCapacity - 1);
+      len -= n;
    }
 
-   // otherwise find the position where the data can be inserted
-   int origlen = m_iLength;
-   int offset = CSeqNo::seqoff(m_piData1[m_iHead], seqno1);
-   int loc = (m_iHead + offset + m_iSize) % m_iSize;
+   return count;
+}
 
-   if (offset < 0)
-   {
-      // Insert data prior to the head pointer
+int CSeqBitmap::clear(int32_t seqno1, int32_t seqno2)
+{
+   if (NULL == m_pWords)
+      return 0;
 
-      m_piData1[loc] = seqno1;
-      if (seqno2 != seqno1)
-         m_piData2[loc] = seqno2;
+   int len = CSeqNo::seqlen(seqno1, seqno2);
+   if (len > m_iCapacity)
+      len = m_iCapacity;
 
-      // new node becomes head
-      m_piNext[loc] = m_iHead;
-      m_iHead = loc;
-      m_iLastInsertPos = loc;
+   int pos = seqno1 & (m_iCapacity - 1);
+   int count = 0;
 
-      m_iLength += CSeqNo::seqlen(seqno1, seqno2);
-   }
-   else if (offset > 0)
-   {
-      if (seqno1 == m_piData1[loc])
-      {
-         m_iLastInsertPos = loc;
-
-         // first seqno is equivlent, compare the second
-         if (-1 == m_piData2[loc])
-         {
-            if (seqno2 != seqno1)
-            {
-               m_iLength += CSeqNo::seqlen(seqno1, seqno2) - 1;
-               m_piData2[loc] = seqno2;
-            }
-         }
-         else if (CSeqNo::seqcmp(seqno2, m_piData2[loc]) > 0)
-         {
-            // new seq pair is longer than old pair, e.g., insert [3, 7] to [3, 5], becomes [3, 7]
-            m_iLength += CSeqNo::seqlen(m_piData2[loc], seqno2) - 1;
-            m_piData2[loc] = seqno2;
-         }
-         else
-            // Do nothing if it is already there
-            return 0;
-      }
-      else
-      {
-         // searching the prior node
-         int i;
-         if ((-1 != m_iLastInsertPos) && (CSeqNo::seqcmp(m_piData1[m_iLastInsertPos], seqno1) < 0))
-            i = m_iLastInsertPos;
-         else
-            i = m_iHead;
-
-         while ((-1 != m_piNext[i]) && (CSeqNo::seqcmp(m_piData1[m_piNext[i]], seqno1) < 0))
-            i = m_piNext[i];
-
-         if ((-1 == m_piData2[i]) || (CSeqNo::seqcmp(m_piData2[i], seqno1) < 0))
-         {
-            m_iLastInsertPos = loc;
-
-            // no overlap, create new node
-            m_piData1[loc] = seqno1;
-            if (seqno2 != seqno1)
-               m_piData2[loc] = seqno2;
-
-            m_piNext[loc] = m_piNext[i];
-            m_piNext[i] = loc;
-
-            m_iLength += CSeqNo::seqlen(seqno1, seqno2);
-         }
-         else
-         {
-            m_iLastInsertPos = i;
-
-            // overlap, coalesce with prior node, insert(3, 7) to [2, 5], ... becomes [2, 7]
-            if (CSeqNo::seqcmp(m_piData2[i], seqno2) < 0)
-            {
-               m_iLength += CSeqNo::seqlen(m_piData2[i], seqno2) - 1;
-               m_piData2[i] = seqno2;
-
-               loc = i;
-            }
-            else
-               return 0;
-         }
-      }
-   }
-   else
+   while (len > 0)
    {
-      m_iLastInsertPos = m_iHead;
+      int bit = pos & 63;
+      int n = (64 - bit < len) ? 64 - bit : len;
+      uint64_t mask = ((64 == n) ? ~0ULL : ((1ULL << n) - 1)) << bit;
 
-      // insert to head node
-      if (seqno2 != seqno1)
-      {
-         if (-1 == m_piData2[loc])
-         {
-            m_iLength += CSeqNo::seqlen(seqno1, seqno2) - 1;
-            m_piData2[loc] = seqno2;
-         }
-         else if (CSeqNo::seqcmp(seqno2, m_piData2[loc]) > 0)
-         {
-            m_iLength += CSeqNo::seqlen(m_piData2[loc], seqno2) - 1;
-            m_piData2[loc] = seqno2;
-         }
-         else 
-            return 0;
-      }
-      else
-         return 0;
+      uint64_t& word = m_pWords[pos >> 6];
+      count += UDT_POPCOUNT64(word & mask);
+      word &= ~mask;
+
+      pos = (pos + n) & (m_iCapacity - 1);
+      len -= n;
    }
 
-   // coalesce with next node. E.g., [3, 7], ..., [6, 9] becomes [3, 9] 
-   while ((-1 != m_piNext[loc]) && (-1 != m_piData2[loc]))
+   return count;
+}
+
+bool CSeqBitmap::test(int32_t seqno) const
+{
+   if (NULL == m_pWords)
+      return false;
+
+   int pos = seqno & (m_iCapacity - 1);
+   return 0 != (m_pWords[pos >> 6] & (1ULL << (pos & 63)));
+}
+
+int32_t CSeqBitmap::find(int32_t seqno1, int32_t seqno2, bool value) const
+{
+   int len = CSeqNo::seqlen(seqno1, seqno2);
+   if (len > m_iCapacity)
+      len = m_iCapacity;
+
+   // no bit is set
+   if (NULL == m_pWords)
+      return value ? -1 : seqno1;
+
+   int pos = seqno1 & (m_iCapacity - 1);
+   int offset = 0;
+
+   while (offset < len)
    {
-      int i = m_piNext[loc];
+      int bit = pos & 63;
+      int n = (64 - bit < len - offset) ? 64 - bit : len - offset;
+      uint64_t mask = ((64 == n) ? ~0ULL : ((1ULL << n) - 1)) << bit;
 
-      if (CSeqNo::seqcmp(m_piData1[i], CSeqNo::incseq(m_piData2[loc])) <= 0)
-      {
-         // coalesce if there is overlap
-         if (-1 != m_piData2[i])
-         {
-            if (CSeqNo::seqcmp(m_piData2[i], m_piData2[loc]) > 0)
-            {
-               if (CSeqNo::seqcmp(m_piData2[loc], m_piData1[i]) >= 0)
-                  m_iLength -= CSeqNo::seqlen(m_piData1[i], m_piData2[loc]);
-
-               m_piData2[loc] = m_piData2[i];
-            }
-            else
-               m_iLength -= CSeqNo::seqlen(m_piData1[i], m_piData2[i]);
-         }
-         else
-         {
-            if (m_piData1[i] == CSeqNo::incseq(m_piData2[loc]))
-               m_piData2[loc] = m_piData1[i];
-            else
-               m_iLength --;
-         }
-
-         m_piData1[i] = -1;
-         m_piData2[i] = -1;
-         m_piNext[loc] = m_piNext[i];
-      }
-      else
-         break;
+      uint64_t word = value ? m_pWords[pos >> 6] : ~m_pWords[pos >> 6];
+      word &= mask;
+      if (0 != word)
+         return CSeqNo::incseq(seqno1, offset + UDT_CTZ64(word) - bit);
+
+      pos = (pos + n) & (m_iCapacity - 1);
+      offset += n;
    }
 
-   return m_iLength - origlen;
+   return -1;
 }
 
-void CSndLossList::remove(int32_t seqno)
+void CSeqBitmap::release()
 {
-   CGuard listguard(m_ListLock);
+   delete [] m_pWords;
+   m_pWords = NULL;
+}
 
-   if (0 == m_iLength)
-      return;
+int CSeqBitmap::getMemSize() const
+{
+   return (NULL == m_pWords) ? 0 : (m_iCapacity >> 3);
+}
 
-   // Remove all from the head pointer to a node with a larger seq. no. or the list is empty
-   int offset = CSeqNo::seqoff(m_piData1[m_iHead], seqno);
-   int loc = (m_iHead + offset + m_iSize) % m_iSize;
+////////////////////////////////////////////////////////////////////////////////
 
-   if (0 == offset)
-   {
-      // It is the head. Remove the head and point to the next node
-      loc = (loc + 1) % m_iSize;
+CSndLossList::CSndLossList(int size):
+m_Loss(size),
+m_iHead(-1),
+m_iTail(-1),
+m_iLength(0),
+m_ListLock()
+{
+   // sender list needs mutex protection
+   #ifndef WIN32
+      pthread_mutex_init(&m_ListLock, 0);
+   #else
+      m_ListLock = CreateMutex(NULL, false, NULL);
+   #endif
+}
 
-      if (-1 == m_piData2[m_iHead])
-         loc = m_piNext[m_iHead];
-      else
-      {
-         m_piData1[loc] = CSeqNo::incseq(seqno);
-         if (CSeqNo::seqcmp(m_piData2[m_iHead], CSeqNo::incseq(seqno)) > 0)
-            m_piData2[loc] = m_piData2[m_iHead];
+CSndLossList::~CSndLossList()
+{
+   #ifndef WIN32
+      pthread_mutex_destroy(&m_ListLock);
+   #else
+      CloseHandle(m_ListLock);
+   #endif
+}
 
-         m_piData2[m_iHead] = -1;
+int CSndLossList::insert(int32_t seqno1, int32_t seqno2)
+{
+   CGuard listguard(m_ListLock);
 
-         m_piNext[loc] = m_piNext[m_iHead];
-      }
+   if (CSeqNo::seqcmp(seqno1, seqno2) > 0)
+      return 0;
 
-      m_piData1[m_iHead] = -1;
+   int32_t head = seqno1;
+   if ((0 != m_iLength) && (CSeqNo::seqcmp(m_iHead, head) < 0))
+      head = m_iHead;
 
-      if (m_iLastInsertPos == m_iHead)
-         m_iLastInsertPos = -1;
+   // all losses must stay within one bitmap window from the head;
+   // the part beyond it is left to the next NAK or timeout
+   int32_t limit = CSeqNo::incseq(head, m_Loss.getCapacity() - 1);
+   if ((0 != m_iLength) && (CSeqNo::seqcmp(m_iTail, limit) > 0))
+      return 0;
+   if (CSeqNo::seqcmp(seqno1, limit) > 0)
+      return 0;
+   if (CSeqNo::seqcmp(seqno2, limit) > 0)
+      seqno2 = limit;
 
-      m_iHead = loc;
+   int num = m_Loss.set(seqno1, seqno2);
 
-      m_iLength --;
-   }
-   else if (offset > 0)
+   if ((0 == m_iLength) || (CSeqNo::seqcmp(seqno2, m_iTail) > 0))
+      m_iTail = seqno2;
+   m_iHead = head;
+   m_iLength += num;
+
+   return num;
+}
+
+void CSndLossList::remove(int32_t seqno)
+{
+   CGuard listguard(m_ListLock);
+
+   if ((0 == m_iLength) || (CSeqNo::seqcmp(seqno, m_iHead) < 0))
+      return;
+
+   if (CSeqNo::seqcmp(seqno, m_iTail) >= 0)
    {
-      int h = m_iHead;
+      m_Loss.clear(m_iHead, m_iTail);
+      m_iLength = 0;
+      return;
+   }
 
-      if (seqno == m_piData1[loc])
-      {
-         // target node is not empty, remove part/all of the seqno in the node.
-         int temp = loc;
-         loc = (loc + 1) % m_iSize;
-
-         if (-1 == m_piData2[temp])
-            m_iHead = m_piNext[temp];
-         else
-         {
-            // remove part, e.g., [3, 7] becomes [], [4, 7] after remove(3)
-            m_piData1[loc] = CSeqNo::incseq(seqno);
-            if (CSeqNo::seqcmp(m_piData2[temp], m_piData1[loc]) > 0)
-               m_piData2[loc] = m_piData2[temp];
-            m_iHead = loc;
-            m_piNext[loc] = m_piNext[temp];
-            m_piNext[temp] = loc;
-            m_piData2[temp] = -1;
-         }
-      }
-      else
-      {
-         // target node is empty, check prior node
-         int i = m_iHead;
-         while ((-1 != m_piNext[i]) && (CSeqNo::seqcmp(m_piData1[m_piNext[i]], seqno) < 0))
-            i = m_piNext[i];
-
-         loc = (loc + 1) % m_iSize;
-
-         if (-1 == m_piData2[i])
-            m_iHead = m_piNext[i];
-         else if (CSeqNo::seqcmp(m_piData2[i], seqno) > 0)
-         {
-            // remove part/all seqno in the prior node
-            m_piData1[loc] = CSeqNo::incseq(seqno);
-            if (CSeqNo::seqcmp(m_piData2[i], m_piData1[loc]) > 0)
-               m_piData2[loc] = m_piData2[i];
-
-            m_piData2[i] = seqno;
-
-            m_piNext[loc] = m_piNext[i];
-            m_piNext[i] = loc;
-
-            m_iHead = loc;
-         }
-         else
-            m_iHead = m_piNext[i];
-      }
+   m_iLength -= m_Loss.clear(m_iHead, seqno);
 
-      // Remove all nodes prior to the new head
-      while (h != m_iHead)
-      {
-         if (m_piData2[h] != -1)
-         {
-            m_iLength -= CSeqNo::seqlen(m_piData1[h], m_piData2[h]);
-            m_piData2[h] = -1;
-         }
-         else
-            m_iLength --;
+   // the next loss becomes the new head
+   if (m_iLength > 0)
+      m_iHead = m_Loss.find(CSeqNo::incseq(seqno), m_iTail, true);
+}
 
-         m_piData1[h] = -1;
+int CSndLossList::remove(int32_t seqno1, int32_t seqno2)
+{
+   CGuard listguard(m_ListLock);
 
-         if (m_iLastInsertPos == h)
-            m_iLastInsertPos = -1;
+   if (0 == m_iLength)
+      return 0;
 
-         h = m_piNext[h];
-      }
-   }
+   // only the part between head and tail can be in the list
+   if (CSeqNo::seqcmp(seqno1, m_iHead) < 0)
+      seqno1 = m_iHead;
+   if (CSeqNo::seqcmp(seqno2, m_iTail) > 0)
+      seqno2 = m_iTail;
+   if (CSeqNo::seqcmp(seqno1, seqno2) > 0)
+      return 0;
+
+   int num = m_Loss.clear(seqno1, seqno2);
+   m_iLength -= num;
+
+   if ((num > 0) && (m_iLength > 0) && (seqno1 == m_iHead))
+      m_iHead = m_Loss.find(CSeqNo::incseq(seqno2), m_iTail, true);
+
+   return num;
 }
 
 int CSndLossList::getLossLength()
@@ -383,71 +321,44 @@ int32_t CSndLossList::getLostSeq()
    if (0 == m_iLength)
      return -1;
 
-   if (m_iLastInsertPos == m_iHead)
-      m_iLastInsertPos = -1;
-
    // return the first loss seq. no.
-   int32_t seqno = m_piData1[m_iHead];
+   int32_t seqno = m_iHead;
 
-   // head moves to the next node
-   if (-1 == m_piData2[m_iHead])
-   {
-      //[3, -1] becomes [], and head moves to next node in the list
-      m_piData1[m_iHead] = -1;
-      m_iHead = m_piNext[m_iHead];
-   }
-   else
-   {
-      // shift to next node, e.g., [3, 7] becomes [], [4, 7]
-      int loc = (m_iHead + 1) % m_iSize;
+   m_Loss.clear(seqno, seqno);
+   m_iLength --;
 
-      m_piData1[loc] = CSeqNo::incseq(seqno);
-      if (CSeqNo::seqcmp(m_piData2[m_iHead], m_piData1[loc]) > 0)
-         m_piData2[loc] = m_piData2[m_iHead];
+   // head moves to the next loss
+   if (m_iLength > 0)
+      m_iHead = m_Loss.find(CSeqNo::incseq(seqno), m_iTail, true);
 
-      m_piData1[m_iHead] = -1;
-      m_piData2[m_iHead] = -1;
+   return seqno;
+}
 
-      m_piNext[loc] = m_piNext[m_iHead];
-      m_iHead = loc;
-   }
+void CSndLossList::release()
+{
+   CGuard listguard(m_ListLock);
 
-   m_iLength --;
+   if (0 == m_iLength)
+      m_Loss.release();
+}
 
-   return seqno;
+int CSndLossList::getMemSize() const
+{
+   return m_Loss.getMemSize();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 CRcvLossList::CRcvLossList(int size):
-m_piData1(NULL),
-m_piData2(NULL),
-m_piNext(NULL),
-m_piPrior(NULL),
+m_Loss(size),
 m_iHead(-1),
 m_iTail(-1),
-m_iLength(0),
-m_iSize(size)
+m_iLength(0)
 {
-   m_piData1 = new int32_t [m_iSize];
-   m_piData2 = new int32_t [m_iSize];
-   m_piNext = new int [m_iSize];
-   m_piPrior = new int [m_iSize];
-
-   // -1 means there is no data in the node
-   for (int i = 0; i < size; ++ i)
-   {
-      m_piData1[i] = -1;
-      m_piData2[i] = -1;
-   }
 }
 
 CRcvLossList::~CRcvLossList()
 {
-   delete [] m_piData1;
-   delete [] m_piData2;
-   delete [] m_piNext;
-   delete [] m_piPrior;
 }
 
 void CRcvLossList::insert(int32_t seqno1, int32_t seqno2)
@@ -456,46 +367,17 @@ void CRcvLossList::insert(int32_t seqno1, int32_t seqno2)
    // guaranteed by the UDT receiver
 
    if (0 == m_iLength)
-   {
-      // insert data into an empty list
-      m_iHead = 0;
-      m_iTail = 0;
-      m_piData1[m_iHead] = seqno1;
-      if (seqno2 != seqno1)
-         m_piData2[m_iHead] = seqno2;
-
-      m_piNext[m_iHead] = -1;
-      m_piPrior[m_iHead] = -1;
-      m_iLength += CSeqNo::seqlen(seqno1, seqno2);
+      m_iHead = seqno1;
 
+   // losses beyond one bitmap window from the head cannot be recorded
+   int32_t limit = CSeqNo::incseq(m_iHead, m_Loss.getCapacity() - 1);
+   if (CSeqNo::seqcmp(seqno1, limit) > 0)
       return;
-   }
+   if (CSeqNo::seqcmp(seqno2, limit) > 0)
+      seqno2 = limit;
 
-   // otherwise searching for the position where the node should be
-   int offset = CSeqNo::seqoff(m_piData1[m_iHead], seqno1);
-   int loc = (m_iHead + offset) % m_iSize;
-
-   if ((-1 != m_piData2[m_iTail]) && (CSeqNo::incseq(m_piData2[m_iTail]) == seqno1))
-   {
-      // coalesce with prior node, e.g., [2, 5], [6, 7] becomes [2, 7]
-      loc = m_iTail;
-      m_piData2[loc] = seqno2;
-   }
-   else
-   {
-      // create new node
-      m_piData1[loc] = seqno1;
-
-      if (seqno2 != seqno1)
-         m_piData2[loc] = seqno2;
-
-      m_piNext[m_iTail] = loc;
-      m_piPrior[loc] = m_iTail;
-      m_piNext[loc] = -1;
-      m_iTail = loc;
-   }
-
-   m_iLength += CSeqNo::seqlen(seqno1, seqno2);
+   m_iLength += m_Loss.set(seqno1, seqno2);
+   m_iTail = seqno2;
 }
 
 bool CRcvLossList::remove(int32_t seqno)
@@ -503,145 +385,39 @@ bool CRcvLossList::remove(int32_t seqno)
    if (0 == m_iLength)
       return false; 
 
-   // locate the position of "seqno" in the list
-   int offset = CSeqNo::seqoff(m_piData1[m_iHead], seqno);
-   if (offset < 0)
+   if ((CSeqNo::seqcmp(seqno, m_iHead) < 0) || (CSeqNo::seqcmp(seqno, m_iTail) > 0))
       return false;
 
-   int loc = (m_iHead + offset) % m_iSize;
-
-   if (seqno == m_piData1[loc])
-   {
-      // This is a seq. no. that starts the loss sequence
-
-      if (-1 == m_piData2[loc])
-      {
-         // there is only 1 loss in the sequence, delete it from the node
-         if (m_iHead == loc)
-         {
-            m_iHead = m_piNext[m_iHead];
-            if (-1 != m_iHead)
-               m_piPrior[m_iHead] = -1;
-         }
-         else
-         {
-            m_piNext[m_piPrior[loc]] = m_piNext[loc];
-            if (-1 != m_piNext[loc])
-               m_piPrior[m_piNext[loc]] = m_piPrior[loc];
-            else
-               m_iTail = m_piPrior[loc];
-         }
-
-         m_piData1[loc] = -1;
-      }
-      else
-      {
-         // there are more than 1 loss in the sequence
-         // move the node to the next and update the starter as the next loss inSeqNo(seqno)
-
-         // find next node
-         int i = (loc + 1) % m_iSize;
-
-         // remove the "seqno" and change the starter as next seq. no.
-         m_piData1[i] = CSeqNo::incseq(m_piData1[loc]);
-
-         // process the sequence end
-         if (CSeqNo::seqcmp(m_piData2[loc], CSeqNo::incseq(m_piData1[loc])) > 0)
-            m_piData2[i] = m_piData2[loc];
-
-         // remove the current node
-         m_piData1[loc] = -1;
-         m_piData2[loc] = -1;
- 
-         // update list pointer
-         m_piNext[i] = m_piNext[loc];
-         m_piPrior[i] = m_piPrior[loc];
-
-         if (m_iHead == loc)
-            m_iHead = i;
-         else
-            m_piNext[m_piPrior[i]] = i;
-
-         if (m_iTail == loc)
-            m_iTail = i;
-         else
-            m_piPrior[m_piNext[i]] = i;
-      }
-
-      m_iLength --;
-
-      return true;
-   }
-
-   // There is no loss sequence in the current position
-   // the "seqno" may be contained in a previous node
-
-   // searching previous node
-   int i = (loc - 1 + m_iSize) % m_iSize;
-   while (-1 == m_piData1[i])
-      i = (i - 1 + m_iSize) % m_iSize;
-
-   // not contained in this node, return
-   if ((-1 == m_piData2[i]) || (CSeqNo::seqcmp(seqno, m_piData2[i]) > 0))
-       return false;
-
-   if (seqno == m_piData2[i])
-   {
-      // it is the sequence end
-
-      if (seqno == CSeqNo::incseq(m_piData1[i]))
-         m_piData2[i] = -1;
-      else
-         m_piData2[i] = CSeqNo::decseq(seqno);
-   }
-   else
-   {
-      // split the sequence
-
-      // construct the second sequence from CSeqNo::incseq(seqno) to the original sequence end
-      // located at "loc + 1"
-      loc = (loc + 1) % m_iSize;
-
-      m_piData1[loc] = CSeqNo::incseq(seqno);
-      if (CSeqNo::seqcmp(m_piData2[i], m_piData1[loc]) > 0)      
-         m_piData2[loc] = m_piData2[i];
-
-      // the first (original) sequence is between the original sequence start to CSeqNo::decseq(seqno)
-      if (seqno == CSeqNo::incseq(m_piData1[i]))
-         m_piData2[i] = -1;
-      else
-         m_piData2[i] = CSeqNo::decseq(seqno);
-
-      // update the list pointer
-      m_piNext[loc] = m_piNext[i];
-      m_piNext[i] = loc;
-      m_piPrior[loc] = i;
-
-      if (m_iTail == i)
-         m_iTail = loc;
-      else
-         m_piPrior[m_piNext[loc]] = loc;
-   }
+   if (!m_Loss.test(seqno))
+      return false;
 
+   m_Loss.clear(seqno, seqno);
    m_iLength --;
 
+   // the next loss becomes the new head
+   if ((m_iLength > 0) && (seqno == m_iHead))
+      m_iHead = m_Loss.find(CSeqNo::incseq(seqno), m_iTail, true);
+
    return true;
 }
 
 bool CRcvLossList::remove(int32_t seqno1, int32_t seqno2)
 {
-   if (seqno1 <= seqno2)
-   {
-      for (int32_t i = seqno1; i <= seqno2; ++ i)
-         remove(i);
-   }
-   else
-   {
-      for (int32_t j = seqno1; j < CSeqNo::m_iMaxSeqNo; ++ j)
-         remove(j);
-      for (int32_t k = 0; k <= seqno2; ++ k)
-         remove(k);
-   }
+   if (0 == m_iLength)
+      return false;
+
+   // only the part overlapping the list matters
+   if (CSeqNo::seqcmp(seqno1, m_iHead) < 0)
+      seqno1 = m_iHead;
+   if (CSeqNo::seqcmp(seqno2, m_iTail) > 0)
+      seqno2 = m_iTail;
+   if (CSeqNo::seqcmp(seqno1, seqno2) > 0)
+      return true;
+
+   m_iLength -= m_Loss.clear(seqno1, seqno2);
+
+   if ((m_iLength > 0) && (seqno1 == m_iHead))
+      m_iHead = m_Loss.find(seqno1, m_iTail, true);
 
    return true;
 }
@@ -651,19 +427,14 @@ bool CRcvLossList::find(int32_t seqno1, int32_t seqno2) const
    if (0 == m_iLength)
       return false;
 
-   int p = m_iHead;
-
-   while (-1 != p)
-   {
-      if ((CSeqNo::seqcmp(m_piData1[p], seqno1) == 0) ||
-          ((CSeqNo::seqcmp(m_piData1[p], seqno1) > 0) && (CSeqNo::seqcmp(m_piData1[p], seqno2) <= 0)) ||
-          ((CSeqNo::seqcmp(m_piData1[p], seqno1) < 0) && (m_piData2[p] != -1) && CSeqNo::seqcmp(m_piData2[p], seqno1) >= 0))
-          return true;
-
-      p = m_piNext[p];
-   }
+   if (CSeqNo::seqcmp(seqno1, m_iHead) < 0)
+      seqno1 = m_iHead;
+   if (CSeqNo::seqcmp(seqno2, m_iTail) > 0)
+      seqno2 = m_iTail;
+   if (CSeqNo::seqcmp(seqno1, seqno2) > 0)
+      return false;
 
-   return false;
+   return -1 != m_Loss.find(seqno1, seqno2, true);
 }
 
 int CRcvLossList::getLossLength() const
@@ -676,28 +447,65 @@ int CRcvLossList::getFirstLostSeq() const
    if (0 == m_iLength)
       return -1;
 
-   return m_piData1[m_iHead];
+   return m_iHead;
 }
 
 void CRcvLossList::getLossArray(int32_t* array, int& len, int limit)
+{
+   getLossArray(array, len, limit, m_iHead, m_iTail);
+}
+
+void CRcvLossList::getLossArray(int32_t* array, int& len, int limit, int32_t seqno1, int32_t seqno2)
 {
    len = 0;
 
-   int i = m_iHead;
+   if (0 == m_iLength)
+      return;
+
+   if (CSeqNo::seqcmp(seqno1, m_iHead) < 0)
+      seqno1 = m_iHead;
+   if (CSeqNo::seqcmp(seqno2, m_iTail) > 0)
+      seqno2 = m_iTail;
+   if (CSeqNo::seqcmp(seqno1, seqno2) > 0)
+      return;
+
+   int32_t start = m_Loss.find(seqno1, seqno2, true);
+   if (-1 == start)
+      return;
 
-   while ((len < limit - 1) && (-1 != i))
+   while (len < limit - 1)
    {
-      array[len] = m_piData1[i];
-      if (-1 != m_piData2[i])
+      // the loss sequence ends right before the first received packet
+      int32_t end = m_Loss.find(start, seqno2, false);
+      end = (-1 == end) ? seqno2 : CSeqNo::decseq(end);
+
+      array[len] = start;
+      if (end != start)
       {
          // there are more than 1 loss in the sequence
          array[len] |= 0x80000000;
          ++ len;
-         array[len] = m_piData2[i];
+         array[len] = end;
       }
 
       ++ len;
 
-      i = m_piNext[i];
+      if (end == seqno2)
+         break;
+
+      start = m_Loss.find(CSeqNo::incseq(end), seqno2, true);
+      if (-1 == start)
+         break;
    }
 }
+
+void CRcvLossList::release()
+{
+   if (0 == m_iLength)
+      m_Loss.release();
+}
+
+int CRcvLossList::getMemSize() const
+{
+   return m_Loss.getMemSize();
+}
@@ -46,6 +46,94 @@ written by
 #include "common.h"
 
 
+// A circular bitmap indexed by sequence number, one bit per packet.
+// The number of bits is a power of 2, so the mapping remains continuous when sequence numbers wrap.
+// All sequence numbers kept in the bitmap at the same time must fall into a window no larger than its capacity.
+
+class CSeqBitmap
+{
+public:
+   CSeqBitmap(int size = 1024);
+   ~CSeqBitmap();
+
+      // Functionality:
+      //    Read the number of sequence numbers the bitmap can hold.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    capacity of the bitmap, in packets.
+
+   int getCapacity() const;
+
+      // Functionality:
+      //    Set the bits between "seqno1" and "seqno2", inclusive.
+      // Parameters:
+      //    0) [in] seqno1: sequence number starts.
+      //    1) [in] seqno2: sequence number ends.
+      // Returned value:
+      //    number of bits that were not set previously.
+
+   int set(int32_t seqno1, int32_t seqno2);
+
+      // Functionality:
+      //    Clear the bits between "seqno1" and "seqno2", inclusive.
+      // Parameters:
+      //    0) [in] seqno1: sequence number starts.
+      //    1) [in] seqno2: sequence number ends.
+      // Returned value:
+      //    number of bits that were set previously.
+
+   int clear(int32_t seqno1, int32_t seqno2);
+
+      // Functionality:
+      //    Read the bit of a sequence number.
+      // Parameters:
+      //    0) [in] seqno: sequence number.
+      // Returned value:
+      //    true if the bit is set, otherwise false.
+
+   bool test(int32_t seqno) const;
+
+      // Functionality:
+      //    Find the first sequence number between "seqno1" and "seqno2" whose bit equals "value", scanning a word at a time.
+      // Parameters:
+      //    0) [in] seqno1: sequence number starts.
+      //    1) [in] seqno2: sequence number ends.
+      //    2) [in] value: the bit value to look for.
+      // Returned value:
+      //    the sequence number, or -1 if there is none in the range.
+
+   int32_t find(int32_t seqno1, int32_t seqno2, bool value) const;
+
+      // Functionality:
+      //    Clear all bits and free the bitmap memory; it is allocated again by the next set().
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void release();
+
+      // Functionality:
+      //    Query the memory held by the bitmap.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    size of the bitmap, in bytes.
+
+   int getMemSize() const;
+
+private:
+   uint64_t* m_pWords;                  // the bitmap, NULL while no bit has been set
+   int m_iCapacity;                     // number of bits, a power of 2 and a multiple of 64
+
+private:
+   CSeqBitmap(const CSeqBitmap&);
+   CSeqBitmap& operator=(const CSeqBitmap&);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 class CSndLossList
 {
 public:
@@ -71,6 +159,16 @@ public:
 
    void remove(int32_t seqno);
 
+      // Functionality:
+      //    Remove the seq. no. between "seqno1" and "seqno2", inclusive, e.g., packets reported received by SACK.
+      // Parameters:
+      //    0) [in] seqno1: sequence number starts.
+      //    1) [in] seqno2: sequence number ends.
+      // Returned value:
+      //    number of packets removed from the list.
+
+   int remove(int32_t seqno1, int32_t seqno2);
+
       // Functionality:
       //    Read the loss length.
       // Parameters:
@@ -89,15 +187,29 @@ public:
 
    int32_t getLostSeq();
 
-private:
-   int32_t* m_piData1;                  // sequence number starts
-   int32_t* m_piData2;                  // seqnence number ends
-   int* m_piNext;                       // next node in the list
+      // Functionality:
+      //    Free the memory of an empty list; it is allocated again by the next insert.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void release();
+
+      // Functionality:
+      //    Query the memory held by the list.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    size of the loss bitmap, in bytes.
 
-   int m_iHead;                         // first node
+   int getMemSize() const;
+
+private:
+   CSeqBitmap m_Loss;                   // lost packets
+   int32_t m_iHead;                     // first (smallest) lost seq. no.
+   int32_t m_iTail;                     // last (largest) lost seq. no.
    int m_iLength;                       // loss length
-   int m_iSize;                         // size of the static array
-   int m_iLastInsertPos;                // position of last insert node
 
    pthread_mutex_t m_ListLock;          // used to synchronize list operation
 
@@ -182,16 +294,42 @@ public:
 
    void getLossArray(int32_t* array, int& len, int limit);
 
-private:
-   int32_t* m_piData1;                  // sequence number starts
-   int32_t* m_piData2;                  // sequence number ends
-   int* m_piNext;                       // next node in the list
-   int* m_piPrior;                      // prior node in the list;
+      // Functionality:
+      //    Get a encoded loss array of the lost packets between "seqno1" and "seqno2" only.
+      // Parameters:
+      //    0) [out] array: the result list of seq. no. to be included in NAK.
+      //    1) [out] physical length of the result array.
+      //    2) [in] limit: maximum length of the array.
+      //    3) [in] seqno1: start sequence number.
+      //    4) [in] seqno2: end sequence number.
+      // Returned value:
+      //    None.
 
-   int m_iHead;                         // first node in the list
-   int m_iTail;                         // last node in the list;
+   void getLossArray(int32_t* array, int& len, int limit, int32_t seqno1, int32_t seqno2);
+
+      // Functionality:
+      //    Free the memory of an empty list; it is allocated again by the next insert.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void release();
+
+      // Functionality:
+      //    Query the memory held by the list.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    size of the loss bitmap, in bytes.
+
+   int getMemSize() const;
+
+private:
+   CSeqBitmap m_Loss;                   // lost packets
+   int32_t m_iHead;                     // first (smallest) lost seq. no.
+   int32_t m_iTail;                     // upper bound of the lost seq. no., the last insert
    int m_iLength;                       // loss length
-   int m_iSize;                         // size of the static array
 
 private:
    CRcvLossList(const CRcvLossList&);
@@ -72,6 +72,9 @@ written by
 //   bit o:
 //      0: in order delivery not required
 //      1: in order delivery required
+//   with the coalescing extension, the payload of a solo message packet is one or more
+//   messages, each preceded by its length as a 16-bit integer in network byte order;
+//   the messages of one packet share its message number
 //
 //    0                   1                   2                   3
 //    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
@@ -119,6 +122,17 @@ written by
 //      8: Error Signal from the Peer Side
 //              Add. Info:    Error code
 //              Control Info: None
+//      9: FEC Parity
+//              Add. Info:    First sequence number covered by the parity
+//              Control Info: number of packets (bit 0 - 15), XOR of their lengths (bit 16 - 31)
+//                            XOR of their message number fields
+//                            XOR of their payloads
+//      10: Path MTU Probe
+//              Add. Info:    Probe ID
+//              Control Info: zero padding up to the probed packet size
+//      11: Path MTU Probe Acknowledgement
+//              Add. Info:    Probe ID
+//              Control Info: size of the probe packet as received, including the IP/UDP headers
 //      0x7FFF: Explained by bits 16 - 31
 //              
 //   bit 16 - 31:
@@ -149,6 +163,15 @@ written by
 
 const int CPacket::m_iPktHdrSize = 16;
 const int CHandShake::m_iContentSize = 48;
+const int32_t CHandShake::m_iExtSACK = 1;
+const int32_t CHandShake::m_iExtFEC = 2;
+const int32_t CHandShake::m_iExtPMTUD = 4;
+const int32_t CHandShake::m_iExtOWD = 8;
+const int32_t CHandShake::m_iExtCoalesce = 16;
+const int32_t CHandShake::m_iExtCoalescing = 32;
+const int32_t CHandShake::m_iExtResume = 64;
+const int32_t CHandShake::m_iExtAware = 128;
+const int CHandShake::m_iTokenSize = 24;
 
 
 // Set up the aliases in the constructure
@@ -197,6 +220,7 @@ void CPacket::pack(int pkttype, void* lparam, void* rparam, int size)
 
       // data ACK seq. no. 
       // optional: RTT (microsends), RTT variance (microseconds) advertised flow window size (packets), and estimated link capacity (packets per second)
+      // extensions: one-way delay of the data (microseconds, receiver time minus packet time stamp), then SACK blocks
       m_PacketVector[1].iov_base = (char *)rparam;
       m_PacketVector[1].iov_len = size;
 
@@ -272,6 +296,36 @@ void CPacket::pack(int pkttype, void* lparam, void* rparam, int size)
 
       break;
 
+   case 9: //1001 - FEC Parity
+      // first seq no covered by the parity
+      m_nHeader[1] = *(int32_t *)lparam;
+
+      // packet count and XOR of the lengths, XOR of the msg no, XOR of the payloads
+      m_PacketVector[1].iov_base = (char *)rparam;
+      m_PacketVector[1].iov_len = size;
+
+      break;
+
+   case 10: //1010 - Path MTU Probe
+      // probe ID
+      m_nHeader[1] = *(int32_t *)lparam;
+
+      // padding that brings the packet to the probed size
+      m_PacketVector[1].iov_base = (char *)rparam;
+      m_PacketVector[1].iov_len = size;
+
+      break;
+
+   case 11: //1011 - Path MTU Probe Acknowledgement
+      // probe ID
+      m_nHeader[1] = *(int32_t *)lparam;
+
+      // received probe size
+      m_PacketVector[1].iov_base = (char *)rparam;
+      m_PacketVector[1].iov_len = 4;
+
+      break;
+
    case 32767: //0x7FFF - Reserved for user defined control packets
       // for extended control packet
       // "lparam" contains the extended type information for bit 16 - 31
@@ -359,13 +413,17 @@ m_iVersion(0),
 m_iType(0),
 m_iISN(0),
 m_iMSS(0),
+m_iExtension(0),
 m_iFlightFlagSize(0),
 m_iReqType(0),
 m_iID(0),
-m_iCookie(0)
+m_iCookie(0),
+m_bToken(false)
 {
    for (int i = 0; i < 4; ++ i)
       m_piPeerIP[i] = 0;
+   for (int i = 0; i < 6; ++ i)
+      m_piToken[i] = 0;
 }
 
 int CHandShake::serialize(char* buf, int& size)
@@ -373,11 +431,16 @@ int CHandShake::serialize(char* buf, int& size)
    if (size < m_iContentSize)
       return -1;
 
+   int buf_size = size;
+
    int32_t* p = (int32_t*)buf;
    *p++ = m_iVersion;
    *p++ = m_iType;
    *p++ = m_iISN;
-   *p++ = m_iMSS;
+   // the MSS never exceeds 16 bits, the upper half carries the extension flags;
+   // a peer that does not know them would take the whole word as the MSS, so they are
+   // only sent once the peer has shown it understands them (m_iExtAware)
+   *p++ = (m_iMSS & 0xFFFF) | ((m_iExtension & 0x7FFF) << 16);
    *p++ = m_iFlightFlagSize;
    *p++ = m_iReqType;
    *p++ = m_iID;
@@ -387,6 +450,14 @@ int CHandShake::serialize(char* buf, int& size)
 
    size = m_iContentSize;
 
+   // the token is an optional trailer, a peer that does not know it reads only the fixed part
+   if (m_bToken && (size + m_iTokenSize <= buf_size))
+   {
+      for (int i = 0; i < 6; ++ i)
+         *p++ = m_piToken[i];
+      size += m_iTokenSize;
+   }
+
    return 0;
 }
 
@@ -399,7 +470,8 @@ int CHandShake::deserialize(const char* buf, int size)
    m_iVersion = *p++;
    m_iType = *p++;
    m_iISN = *p++;
-   m_iMSS = *p++;
+   m_iMSS = *p & 0xFFFF;
+   m_iExtension = (*p++ >> 16) & 0x7FFF;
    m_iFlightFlagSize = *p++;
    m_iReqType = *p++;
    m_iID = *p++;
@@ -407,5 +479,9 @@ int CHandShake::deserialize(const char* buf, int size)
    for (int i = 0; i < 4; ++ i)
       m_piPeerIP[i] = *p++;
 
+   m_bToken = (size >= m_iContentSize + m_iTokenSize);
+   for (int i = 0; i < 6; ++ i)
+      m_piToken[i] = m_bToken ? *p++ : 0;
+
    return 0;
 }
@@ -206,17 +206,29 @@ public:
 
 public:
    static const int m_iContentSize;	// Size of hand shake data
+   static const int32_t m_iExtSACK;	// Extension flag: selective acknowledgement blocks in ACK
+   static const int32_t m_iExtFEC;	// Extension flag: XOR parity packets, group size in bits 8 - 14
+   static const int32_t m_iExtPMTUD;	// Extension flag: path MTU probes
+   static const int32_t m_iExtOWD;	// Extension flag: one-way delay of the data in full ACKs
+   static const int32_t m_iExtCoalesce;	// Extension flag: single packet messages are length prefixed, so several can share a packet
+   static const int32_t m_iExtCoalescing;	// Extension flag: the side sending the handshake packs small messages
+   static const int32_t m_iExtResume;	// Extension flag: request: the client takes a resumption token; response: the connection was resumed
+   static const int32_t m_iExtAware;	// Extension flag: the sender understands the extension flags; the listener sets it in the cookie response
+   static const int m_iTokenSize;	// Size of the resumption token that may follow the hand shake data
 
 public:
    int32_t m_iVersion;          // UDT version
    int32_t m_iType;             // UDT socket type
    int32_t m_iISN;              // random initial sequence number
    int32_t m_iMSS;              // maximum segment size
+   int32_t m_iExtension;        // protocol extension flags, carried in the upper 16 bits of the MSS field
    int32_t m_iFlightFlagSize;   // flow control window size
-   int32_t m_iReqType;          // connection request type: 1: regular connection request, 0: rendezvous connection request, -1/-2: response
+   int32_t m_iReqType;          // connection request type: 1: regular connection request, 0: rendezvous connection request, 2: resumption request, -1/-2: response
    int32_t m_iID;		// socket ID
-   int32_t m_iCookie;		// cookie
+   int32_t m_iCookie;		// cookie; in a resumption request, the size of the data that follows the token
    uint32_t m_piPeerIP[4];	// The IP address that the peer's UDP port is bound to
+   bool m_bToken;		// if a resumption token follows the hand shake data
+   int32_t m_piToken[6];	// resumption token: issue time, in seconds of the listener's clock, serial number, and the listener's signature
 };
 
 
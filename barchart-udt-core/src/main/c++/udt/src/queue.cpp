@@ -46,6 +46,12 @@ written by
    #endif
 #endif
 #include <cstring>
+#ifdef LINUX
+   #include <sys/epoll.h>
+   #include <sys/eventfd.h>
+   #include <sys/timerfd.h>
+   #include <unistd.h>
+#endif
 
 #include "common.h"
 #include "core.h"
@@ -60,7 +66,8 @@ m_pLastQueue(NULL),
 m_iSize(0),
 m_iCount(0),
 m_iMSS(),
-m_iIPversion()
+m_iIPversion(),
+m_iNode(-1)
 {
 }
 
@@ -82,7 +89,7 @@ CUnitQueue::~CUnitQueue()
    }
 }
 
-int CUnitQueue::init(int size, int mss, int version)
+int CUnitQueue::init(int size, int mss, int version, int node)
 {
    CQEntry* tempq = NULL;
    CUnit* tempu = NULL;
@@ -103,9 +110,14 @@ int CUnitQueue::init(int size, int mss, int version)
       return -1;
    }
 
+   CAffinity::setMemNode(tempb, size * mss, node);
+
    for (int i = 0; i < size; ++ i)
    {
       tempu[i].m_iFlag = 0;
+      tempu[i].m_iLent = 0;
+      tempu[i].m_iLoan = 0;
+      tempu[i].m_pLender = NULL;
       tempu[i].m_Packet.m_pcData = tempb + i * mss;
    }
    tempq->m_pUnit = tempu;
@@ -120,6 +132,7 @@ int CUnitQueue::init(int size, int mss, int version)
    m_iSize = size;
    m_iMSS = mss;
    m_iIPversion = version;
+   m_iNode = node;
 
    return 0;
 }
@@ -167,9 +180,14 @@ int CUnitQueue::increase()
       return -1;
    }
 
+   CAffinity::setMemNode(tempb, size * m_iMSS, m_iNode);
+
    for (int i = 0; i < size; ++ i)
    {
       tempu[i].m_iFlag = 0;
+      tempu[i].m_iLent = 0;
+      tempu[i].m_iLoan = 0;
+      tempu[i].m_pLender = NULL;
       tempu[i].m_Packet.m_pcData = tempb + i * m_iMSS;
    }
    tempq->m_pUnit = tempu;
@@ -230,7 +248,8 @@ m_iLastEntry(-1),
 m_ListLock(),
 m_pWindowLock(NULL),
 m_pWindowCond(NULL),
-m_pTimer(NULL)
+m_pTimer(NULL),
+m_pChannel(NULL)
 {
    m_pHeap = new CSNode*[m_iArrayLength];
 
@@ -303,7 +322,7 @@ void CSndUList::update(const CUDT* u, bool reschedule)
    insert_(1, u);
 }
 
-int CSndUList::pop(sockaddr*& addr, CPacket& pkt)
+int CSndUList::pop(sockaddr*& addr, CPacket& pkt, bool& fragment)
 {
    CGuard listguard(m_ListLock);
 
@@ -322,12 +341,20 @@ int CSndUList::pop(sockaddr*& addr, CPacket& pkt)
    if (!u->m_bConnected || u->m_bBroken)
       return -1;
 
-   // pack a packet from the socket
+   // pack a packet from the socket; with nothing to send now, it may still ask to come back later
+   uint64_t currtime = ts;
    if (u->packData(pkt, ts) <= 0)
+   {
+      if (ts > currtime)
+         insert_(ts, u);
       return -1;
+   }
 
    addr = u->m_pPeerAddr;
 
+   // a retransmission cut before the path MTU went down
+   fragment = pkt.getLength() > u->m_iPayloadSize;
+
    // insert a new entry, ts is the next processing time
    if (ts > 0)
       insert_(ts, u);
@@ -335,6 +362,43 @@ int CSndUList::pop(sockaddr*& addr, CPacket& pkt)
    return 1;
 }
 
+int CSndUList::sendNow(const CUDT* u)
+{
+   CGuard listguard(m_ListLock);
+
+   // a socket on the list is already paced by the sending worker
+   if (u->m_pSNode->m_iHeapLoc >= 0)
+      return 0;
+
+   if (!u->m_bConnected || u->m_bBroken)
+   {
+      insert_(1, u);
+      return 0;
+   }
+
+   // the socket left the list after its last packet was due, so the pacing interval has passed;
+   // packData() still checks the congestion and flow windows
+   uint64_t currtime, ts;
+   CTimer::rdtsc(currtime);
+   ts = currtime;
+
+   CPacket pkt;
+   if (u->m_pSNode->m_pUDT->packData(pkt, ts) <= 0)
+   {
+      if (ts > currtime)
+         insert_(ts, u);
+      return 0;
+   }
+
+   // send before the worker can see the socket again, so that the packets leave in order
+   m_pChannel->sendto(u->m_pPeerAddr, pkt, pkt.getLength() > u->m_iPayloadSize);
+
+   if (ts > 0)
+      insert_(ts, u);
+
+   return 1;
+}
+
 void CSndUList::remove(const CUDT* u)
 {
    CGuard listguard(m_ListLock);
@@ -487,7 +551,7 @@ CSndQueue::~CSndQueue()
    delete m_pSndUList;
 }
 
-void CSndQueue::init(CChannel* c, CTimer* t)
+void CSndQueue::init(CChannel* c, CTimer* t, bool worker)
 {
    m_pChannel = c;
    m_pTimer = t;
@@ -495,6 +559,10 @@ void CSndQueue::init(CChannel* c, CTimer* t)
    m_pSndUList->m_pWindowLock = &m_WindowLock;
    m_pSndUList->m_pWindowCond = &m_WindowCond;
    m_pSndUList->m_pTimer = m_pTimer;
+   m_pSndUList->m_pChannel = m_pChannel;
+
+   if (!worker)
+      return;
 
    #ifndef WIN32
       if (0 != pthread_create(&m_WorkerThread, NULL, CSndQueue::worker, this))
@@ -510,6 +578,11 @@ void CSndQueue::init(CChannel* c, CTimer* t)
    #endif
 }
 
+void CSndQueue::setCPU(uint64_t mask)
+{
+   CAffinity::setThreadCPU(m_WorkerThread, mask);
+}
+
 #ifndef WIN32
    void* CSndQueue::worker(void* param)
 #else
@@ -533,10 +606,11 @@ void CSndQueue::init(CChannel* c, CTimer* t)
          // it is time to send the next pkt
          sockaddr* addr;
          CPacket pkt;
-         if (self->m_pSndUList->pop(addr, pkt) < 0)
+         bool fragment;
+         if (self->m_pSndUList->pop(addr, pkt, fragment) < 0)
             continue;
 
-         self->m_pChannel->sendto(addr, pkt);
+         self->m_pChannel->sendto(addr, pkt, fragment);
       }
       else
       {
@@ -749,6 +823,8 @@ void CHash::remove(int32_t id)
 //
 CRendezvousQueue::CRendezvousQueue():
 m_lRendezvousID(),
+m_mRendezvousIndex(),
+m_ullNextCheck(0),
 m_RIDVectorLock()
 {
    #ifndef WIN32
@@ -775,12 +851,18 @@ CRendezvousQueue::~CRendezvousQueue()
    }
 
    m_lRendezvousID.clear();
+   m_mRendezvousIndex.clear();
 }
 
 void CRendezvousQueue::insert(const UDTSOCKET& id, CUDT* u, int ipv, const sockaddr* addr, uint64_t ttl)
 {
    CGuard vg(m_RIDVectorLock);
 
+   // a socket connecting again replaces its old request
+   map<UDTSOCKET, list<CRL>::iterator>::iterator p = m_mRendezvousIndex.find(id);
+   if (p != m_mRendezvousIndex.end())
+      erase(p->second);
+
    CRL r;
    r.m_iID = id;
    r.m_pUDT = u;
@@ -790,36 +872,42 @@ void CRendezvousQueue::insert(const UDTSOCKET& id, CUDT* u, int ipv, const socka
    r.m_ullTTL = ttl;
 
    m_lRendezvousID.push_back(r);
+   m_mRendezvousIndex[id] = -- m_lRendezvousID.end();
+
+   // the caller sends the first request right away
+   uint64_t next = CTimer::getTime() + 250000;
+   if (ttl < next)
+      next = ttl;
+   if (next < m_ullNextCheck)
+      m_ullNextCheck = next;
 }
 
 void CRendezvousQueue::remove(const UDTSOCKET& id)
 {
    CGuard vg(m_RIDVectorLock);
 
-   for (list<CRL>::iterator i = m_lRendezvousID.begin(); i != m_lRendezvousID.end(); ++ i)
-   {
-      if (i->m_iID == id)
-      {
-         if (AF_INET == i->m_iIPversion)
-            delete (sockaddr_in*)i->m_pPeerAddr;
-         else
-            delete (sockaddr_in6*)i->m_pPeerAddr;
-
-         m_lRendezvousID.erase(i);
-
-         return;
-      }
-   }
+   map<UDTSOCKET, list<CRL>::iterator>::iterator p = m_mRendezvousIndex.find(id);
+   if (p != m_mRendezvousIndex.end())
+      erase(p->second);
 }
 
 CUDT* CRendezvousQueue::retrieve(const sockaddr* addr, UDTSOCKET& id)
 {
    CGuard vg(m_RIDVectorLock);
 
-   // TODO: optimize search
+   if (0 != id)
+   {
+      map<UDTSOCKET, list<CRL>::iterator>::iterator p = m_mRendezvousIndex.find(id);
+      if ((p != m_mRendezvousIndex.end()) && CIPAddress::ipcmp(addr, p->second->m_pPeerAddr, p->second->m_iIPversion))
+         return p->second->m_pUDT;
+
+      return NULL;
+   }
+
+   // a rendezvous peer does not know the socket ID yet
    for (list<CRL>::iterator i = m_lRendezvousID.begin(); i != m_lRendezvousID.end(); ++ i)
    {
-      if (CIPAddress::ipcmp(addr, i->m_pPeerAddr, i->m_iIPversion) && ((0 == id) || (id == i->m_iID)))
+      if (CIPAddress::ipcmp(addr, i->m_pPeerAddr, i->m_iIPversion))
       {
          id = i->m_iID;
          return i->m_pUDT;
@@ -834,34 +922,77 @@ void CRendezvousQueue::updateConnStatus()
    if (m_lRendezvousID.empty())
       return;
 
+   // the requests are looked at only when one of them is due
+   uint64_t currtime = CTimer::getTime();
+   if (currtime < m_ullNextCheck)
+      return;
+
    CGuard vg(m_RIDVectorLock);
 
-   for (list<CRL>::iterator i = m_lRendezvousID.begin(); i != m_lRendezvousID.end(); ++ i)
+   uint64_t next = currtime + 250000;
+
+   for (list<CRL>::iterator i = m_lRendezvousID.begin(); i != m_lRendezvousID.end();)
    {
-      // avoid sending too many requests, at most 1 request per 250ms
-      if (CTimer::getTime() - i->m_pUDT->m_llLastReqTime > 250000)
+      if (currtime >= i->m_ullTTL)
       {
-         if (CTimer::getTime() >= i->m_ullTTL)
-         {
-            // connection timer expired, acknowledge app via epoll
-            i->m_pUDT->m_bConnecting = false;
-            CUDT::s_UDTUnited.m_EPoll.update_events(i->m_iID, i->m_pUDT->m_sPollID, UDT_EPOLL_ERR, true);
-            continue;
-         }
+         // connection timer expired, acknowledge app via epoll
+         i->m_pUDT->m_bConnecting = false;
+         CUDT::s_UDTUnited.m_EPoll.update_events(i->m_iID, i->m_pUDT->m_sPollID, UDT_EPOLL_ERR, true);
 
-         CPacket request;
-         char* reqdata = new char [i->m_pUDT->m_iPayloadSize];
-         request.pack(0, NULL, reqdata, i->m_pUDT->m_iPayloadSize);
-         // ID = 0, connection request
-         request.m_iID = !i->m_pUDT->m_bRendezvous ? 0 : i->m_pUDT->m_ConnRes.m_iID;
-         int hs_size = i->m_pUDT->m_iPayloadSize;
-         i->m_pUDT->m_ConnReq.serialize(reqdata, hs_size);
-         request.setLength(hs_size);
-         i->m_pUDT->m_pSndQueue->sendto(i->m_pPeerAddr, request);
-         i->m_pUDT->m_llLastReqTime = CTimer::getTime();
-         delete [] reqdata;
+         // close() does not remove a socket that is no longer connecting
+         erase(i ++);
+         continue;
       }
+
+      // avoid sending too many requests, at most 1 request per 250ms
+      if (currtime - i->m_pUDT->m_llLastReqTime > 250000)
+         sendRequest(*i, currtime);
+
+      uint64_t due = i->m_pUDT->m_llLastReqTime + 250001;
+      if (i->m_ullTTL < due)
+         due = i->m_ullTTL;
+      if (due < next)
+         next = due;
+
+      ++ i;
    }
+
+   m_ullNextCheck = next;
+}
+
+void CRendezvousQueue::updateConnStatus(const UDTSOCKET& id)
+{
+   CGuard vg(m_RIDVectorLock);
+
+   map<UDTSOCKET, list<CRL>::iterator>::iterator p = m_mRendezvousIndex.find(id);
+   if ((p != m_mRendezvousIndex.end()) && p->second->m_pUDT->m_bConnecting)
+      sendRequest(*(p->second), CTimer::getTime());
+}
+
+void CRendezvousQueue::sendRequest(const CRL& r, uint64_t currtime)
+{
+   CPacket request;
+   char* reqdata = new char [r.m_pUDT->m_iPayloadSize];
+   request.pack(0, NULL, reqdata, r.m_pUDT->m_iPayloadSize);
+   // ID = 0, connection request
+   request.m_iID = !r.m_pUDT->m_bRendezvous ? 0 : r.m_pUDT->m_ConnRes.m_iID;
+   int hs_size = r.m_pUDT->m_iPayloadSize;
+   r.m_pUDT->m_ConnReq.serialize(reqdata, hs_size);
+   request.setLength(hs_size);
+   r.m_pUDT->m_pSndQueue->sendto(r.m_pPeerAddr, request);
+   r.m_pUDT->m_llLastReqTime = currtime;
+   delete [] reqdata;
+}
+
+void CRendezvousQueue::erase(list<CRL>::iterator i)
+{
+   if (AF_INET == i->m_iIPversion)
+      delete (sockaddr_in*)i->m_pPeerAddr;
+   else
+      delete (sockaddr_in6*)i->m_pPeerAddr;
+
+   m_mRendezvousIndex.erase(i->m_iID);
+   m_lRendezvousID.erase(i);
 }
 
 //
@@ -937,11 +1068,11 @@ CRcvQueue::~CRcvQueue()
    }
 }
 
-void CRcvQueue::init(int qsize, int payload, int version, int hsize, CChannel* cc, CTimer* t)
+void CRcvQueue::init(int qsize, int payload, int version, int hsize, CChannel* cc, CTimer* t, int node, bool worker)
 {
    m_iPayloadSize = payload;
 
-   m_UnitQueue.init(qsize, payload, version);
+   m_UnitQueue.init(qsize, payload, version, node);
 
    m_pHash = new CHash;
    m_pHash->init(hsize);
@@ -952,6 +1083,9 @@ void CRcvQueue::init(int qsize, int payload, int version, int hsize, CChannel* c
    m_pRcvUList = new CRcvUList;
    m_pRendezvousQueue = new CRendezvousQueue;
 
+   if (!worker)
+      return;
+
    #ifndef WIN32
       if (0 != pthread_create(&m_WorkerThread, NULL, CRcvQueue::worker, this))
       {
@@ -966,6 +1100,11 @@ void CRcvQueue::init(int qsize, int payload, int version, int hsize, CChannel* c
    #endif
 }
 
+void CRcvQueue::setCPU(uint64_t mask)
+{
+   CAffinity::setThreadCPU(m_WorkerThread, mask);
+}
+
 #ifndef WIN32
    void* CRcvQueue::worker(void* param)
 #else
@@ -975,8 +1114,6 @@ void CRcvQueue::init(int qsize, int payload, int version, int hsize, CChannel* c
    CRcvQueue* self = (CRcvQueue*)param;
 
    sockaddr* addr = (AF_INET == self->m_UnitQueue.m_iIPversion) ? (sockaddr*) new sockaddr_in : (sockaddr*) new sockaddr_in6;
-   CUDT* u = NULL;
-   int32_t id;
 
    while (!self->m_bClosing)
    {
@@ -984,123 +1121,147 @@ void CRcvQueue::init(int qsize, int payload, int version, int hsize, CChannel* c
          self->m_pTimer->tick();
       #endif
 
-      // check waiting list, if new socket, insert it to the list
-      while (self->ifNewEntry())
-      {
-         CUDT* ne = self->getNewEntry();
-         if (NULL != ne)
-         {
-            self->m_pRcvUList->insert(ne);
-            self->m_pHash->insert(ne->m_SocketID, ne);
-         }
-      }
+      // a busy polling channel returns at once, let other threads have the CPU between polls
+      if ((self->receive(addr) < 0) && (self->m_pChannel->getBusyPoll() > 0))
+         CTimer::yield();
 
-      // find next available slot for incoming packet
-      CUnit* unit = self->m_UnitQueue.getNextAvailUnit();
-      if (NULL == unit)
-      {
-         // no space, skip this packet
-         CPacket temp;
-         temp.m_pcData = new char[self->m_iPayloadSize];
-         temp.setLength(self->m_iPayloadSize);
-         self->m_pChannel->recvfrom(addr, temp);
-         delete [] temp.m_pcData;
-         goto TIMER_CHECK;
-      }
+      self->checkTimers();
+   }
+
+   if (AF_INET == self->m_UnitQueue.m_iIPversion)
+      delete (sockaddr_in*)addr;
+   else
+      delete (sockaddr_in6*)addr;
+
+   #ifndef WIN32
+      return NULL;
+   #else
+      SetEvent(self->m_ExitCond);
+      return 0;
+   #endif
+}
+
+int CRcvQueue::receive(sockaddr* addr)
+{
+   CUDT* u = NULL;
+   int32_t id;
 
-      unit->m_Packet.setLength(self->m_iPayloadSize);
+   // check waiting list, if new socket, insert it to the list
+   addNewEntries();
 
-      // reading next incoming packet, recvfrom returns -1 is nothing has been received
-      if (self->m_pChannel->recvfrom(addr, unit->m_Packet) < 0)
-         goto TIMER_CHECK;
+   // find next available slot for incoming packet
+   CUnit* unit = m_UnitQueue.getNextAvailUnit();
+   if (NULL == unit)
+   {
+      // no space, skip this packet
+      CPacket temp;
+      temp.m_pcData = new char[m_iPayloadSize];
+      temp.setLength(m_iPayloadSize);
+      int res = m_pChannel->recvfrom(addr, temp);
+      delete [] temp.m_pcData;
+      return res;
+   }
+
+   unit->m_Packet.setLength(m_iPayloadSize);
+
+   // reading next incoming packet, recvfrom returns -1 is nothing has been received
+   if (m_pChannel->recvfrom(addr, unit->m_Packet) < 0)
+      return -1;
 
-      id = unit->m_Packet.m_iID;
+   id = unit->m_Packet.m_iID;
 
-      // ID 0 is for connection request, which should be passed to the listening socket or rendezvous sockets
-      if (0 == id)
+   // ID 0 is for connection request, which should be passed to the listening socket or rendezvous sockets
+   if (0 == id)
+   {
+      if (NULL != m_pListener)
+         m_pListener->listen(addr, unit);
+      else if (NULL != (u = m_pRendezvousQueue->retrieve(addr, id)))
       {
-         if (NULL != self->m_pListener)
-            self->m_pListener->listen(addr, unit->m_Packet);
-         else if (NULL != (u = self->m_pRendezvousQueue->retrieve(addr, id)))
+         // asynchronous connect: call connect here
+         // otherwise wait for the UDT socket to retrieve this packet
+         if (!u->m_bSynRecving)
          {
-            // asynchronous connect: call connect here
-            // otherwise wait for the UDT socket to retrieve this packet
-            if (!u->m_bSynRecving)
-               u->connect(unit->m_Packet);
-            else
-               self->storePkt(id, unit->m_Packet.clone());
+            if (u->connect(unit->m_Packet) > 0)
+               m_pRendezvousQueue->updateConnStatus(id);
          }
+         else
+            storePkt(id, unit->m_Packet.clone());
+      }
+   }
+   else if (id > 0)
+   {
+      // the socket may have got connected while this packet was awaited; the unit is held meanwhile,
+      // so that the packets stored for the socket are passed on first
+      if (ifNewEntry() && (NULL == m_pHash->lookup(id)))
+      {
+         unit->m_iFlag = 1;
+         addNewEntries();
+         unit->m_iFlag = 0;
       }
-      else if (id > 0)
+
+      if (NULL != (u = m_pHash->lookup(id)))
       {
-         if (NULL != (u = self->m_pHash->lookup(id)))
+         if (CIPAddress::ipcmp(addr, u->m_pPeerAddr, u->m_iIPversion))
          {
-            if (CIPAddress::ipcmp(addr, u->m_pPeerAddr, u->m_iIPversion))
+            if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
             {
-               if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
-               {
-                  if (0 == unit->m_Packet.getFlag())
-                     u->processData(unit);
-                  else
-                     u->processCtrl(unit->m_Packet);
-
-                  u->checkTimers();
-                  self->m_pRcvUList->update(u);
-               }
+               if (0 == unit->m_Packet.getFlag())
+                  u->processData(unit);
+               else
+                  u->processCtrl(unit->m_Packet);
+
+               u->checkTimers();
+               m_pRcvUList->update(u);
             }
          }
-         else if (NULL != (u = self->m_pRendezvousQueue->retrieve(addr, id)))
+      }
+      else if (NULL != (u = m_pRendezvousQueue->retrieve(addr, id)))
+      {
+         if (!u->m_bSynRecving)
          {
-            if (!u->m_bSynRecving)
-               u->connect(unit->m_Packet);
-            else
-               self->storePkt(id, unit->m_Packet.clone());
+            // a response calling for another handshake is answered at once
+            if (u->connect(unit->m_Packet) > 0)
+               m_pRendezvousQueue->updateConnStatus(id);
          }
+         else
+            storePkt(id, unit->m_Packet.clone());
       }
+   }
 
-TIMER_CHECK:
-      // take care of the timing event for all UDT sockets
+   return 0;
+}
 
-      uint64_t currtime;
-      CTimer::rdtsc(currtime);
+void CRcvQueue::checkTimers()
+{
+   // take care of the timing event for all UDT sockets
 
-      CRNode* ul = self->m_pRcvUList->m_pUList;
-      uint64_t ctime = currtime - 100000 * CTimer::getCPUFrequency();
-      while ((NULL != ul) && (ul->m_llTimeStamp < ctime))
-      {
-         CUDT* u = ul->m_pUDT;
+   uint64_t currtime;
+   CTimer::rdtsc(currtime);
 
-         if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
-         {
-            u->checkTimers();
-            self->m_pRcvUList->update(u);
-         }
-         else
-         {
-            // the socket must be removed from Hash table first, then RcvUList
-            self->m_pHash->remove(u->m_SocketID);
-            self->m_pRcvUList->remove(u);
-            u->m_pRNode->m_bOnList = false;
-         }
+   CRNode* ul = m_pRcvUList->m_pUList;
+   uint64_t ctime = currtime - 100000 * CTimer::getCPUFrequency();
+   while ((NULL != ul) && (ul->m_llTimeStamp < ctime))
+   {
+      CUDT* u = ul->m_pUDT;
 
-         ul = self->m_pRcvUList->m_pUList;
+      if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
+      {
+         u->checkTimers();
+         m_pRcvUList->update(u);
+      }
+      else
+      {
+         // the socket must be removed from Hash table first, then RcvUList
+         m_pHash->remove(u->m_SocketID);
+         m_pRcvUList->remove(u);
+         u->m_pRNode->m_bOnList = false;
       }
 
-      // Check connection requests status for all sockets in the RendezvousQueue.
-      self->m_pRendezvousQueue->updateConnStatus();
+      ul = m_pRcvUList->m_pUList;
    }
 
-   if (AF_INET == self->m_UnitQueue.m_iIPversion)
-      delete (sockaddr_in*)addr;
-   else
-      delete (sockaddr_in6*)addr;
-
-   #ifndef WIN32
-      return NULL;
-   #else
-      SetEvent(self->m_ExitCond);
-      return 0;
-   #endif
+   // Check connection requests status for all sockets in the RendezvousQueue.
+   m_pRendezvousQueue->updateConnStatus();
 }
 
 int CRcvQueue::recvfrom(int32_t id, CPacket& packet)
@@ -1183,10 +1344,14 @@ void CRcvQueue::registerConnector(const UDTSOCKET& id, CUDT* u, int ipv, const s
    m_pRendezvousQueue->insert(id, u, ipv, addr, ttl);
 }
 
-void CRcvQueue::removeConnector(const UDTSOCKET& id)
+void CRcvQueue::removeConnector(const UDTSOCKET& id, bool keep)
 {
    m_pRendezvousQueue->remove(id);
 
+   // packets that followed the handshake are passed to the socket once it is registered
+   if (keep)
+      return;
+
    CGuard bufferlock(m_PassLock);
 
    map<int32_t, std::queue<CPacket*> >::iterator i = m_mBuffer.find(id);
@@ -1213,6 +1378,67 @@ bool CRcvQueue::ifNewEntry()
    return !(m_vNewEntry.empty());
 }
 
+void CRcvQueue::addNewEntries()
+{
+   while (ifNewEntry())
+   {
+      CUDT* ne = getNewEntry();
+      if (NULL != ne)
+      {
+         m_pRcvUList->insert(ne);
+         m_pHash->insert(ne->m_SocketID, ne);
+         passStoredPkts(ne);
+      }
+   }
+}
+
+void CRcvQueue::passStoredPkts(CUDT* u)
+{
+   std::queue<CPacket*> pkts;
+
+   {
+      CGuard bufferlock(m_PassLock);
+
+      map<int32_t, std::queue<CPacket*> >::iterator i = m_mBuffer.find(u->m_SocketID);
+      if (i == m_mBuffer.end())
+         return;
+
+      pkts = i->second;
+      m_mBuffer.erase(i);
+   }
+
+   // a blocking connect() leaves here what arrived after the handshake response, e.g. data sent by
+   // a peer that accepted a resumed connection, which would otherwise wait for a retransmission
+   while (!pkts.empty())
+   {
+      CPacket* pkt = pkts.front();
+      pkts.pop();
+
+      if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
+      {
+         if (0 == pkt->getFlag())
+         {
+            CUnit* unit = m_UnitQueue.getNextAvailUnit();
+            if ((NULL != unit) && (pkt->getLength() <= m_iPayloadSize))
+            {
+               memcpy(unit->m_Packet.m_nHeader, pkt->m_nHeader, CPacket::m_iPktHdrSize);
+               memcpy(unit->m_Packet.m_pcData, pkt->m_pcData, pkt->getLength());
+               unit->m_Packet.setLength(pkt->getLength());
+               u->processData(unit);
+            }
+         }
+         else
+            u->processCtrl(*pkt);
+
+         u->checkTimers();
+         m_pRcvUList->update(u);
+      }
+
+      delete [] pkt->m_pcData;
+      delete pkt;
+   }
+}
+
 CUDT* CRcvQueue::getNewEntry()
 {
    CGuard listguard(m_IDLock);
@@ -1251,3 +1477,287 @@ void CRcvQueue::storePkt(int32_t id, CPacket* pkt)
       i->second.push(pkt);
    }
 }
+
+#ifdef LINUX
+//
+CWorkerPool::CWorkerPool():
+m_vLoops(),
+m_mOwner(),
+m_PoolLock()
+{
+   pthread_mutex_init(&m_PoolLock, NULL);
+}
+
+CWorkerPool::~CWorkerPool()
+{
+   for (vector<CLoop*>::iterator i = m_vLoops.begin(); i != m_vLoops.end(); ++ i)
+   {
+      CLoop* l = *i;
+
+      l->m_bClosing = true;
+      eventfd_write(l->m_iWakeFD, 1);
+      pthread_join(l->m_WorkerThread, NULL);
+
+      // multiplexers not yet removed, e.g., at cleanup
+      for (vector<CMux>::iterator m = l->m_vNewMux.begin(); m != l->m_vNewMux.end(); ++ m)
+         l->m_mMux[m->m_pChannel->getSocket()] = *m;
+      for (vector<CMux>::iterator m = l->m_vOldMux.begin(); m != l->m_vOldMux.end(); ++ m)
+         l->m_mMux[m->m_pChannel->getSocket()] = *m;
+      for (map<int, CMux>::iterator m = l->m_mMux.begin(); m != l->m_mMux.end(); ++ m)
+         release(m->second);
+
+      ::close(l->m_iEpollFD);
+      ::close(l->m_iWakeFD);
+      ::close(l->m_iTimerFD);
+      pthread_mutex_destroy(&l->m_Lock);
+      delete l;
+   }
+
+   pthread_mutex_destroy(&m_PoolLock);
+}
+
+void CWorkerPool::init(int threads)
+{
+   for (int i = 0; i < threads; ++ i)
+   {
+      CLoop* l = new CLoop;
+      l->m_iEpollFD = epoll_create(64);
+      l->m_iWakeFD = eventfd(0, EFD_NONBLOCK);
+      l->m_iTimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+      l->m_iLoad = 0;
+      l->m_bClosing = false;
+      pthread_mutex_init(&l->m_Lock, NULL);
+
+      if ((l->m_iEpollFD < 0) || (l->m_iWakeFD < 0) || (l->m_iTimerFD < 0))
+      {
+         ::close(l->m_iEpollFD);
+         ::close(l->m_iWakeFD);
+         ::close(l->m_iTimerFD);
+         pthread_mutex_destroy(&l->m_Lock);
+         delete l;
+         throw CUDTException(3, 1, errno);
+      }
+
+      epoll_event ev;
+      ev.events = EPOLLIN;
+      ev.data.fd = l->m_iWakeFD;
+      epoll_ctl(l->m_iEpollFD, EPOLL_CTL_ADD, l->m_iWakeFD, &ev);
+      ev.data.fd = l->m_iTimerFD;
+      epoll_ctl(l->m_iEpollFD, EPOLL_CTL_ADD, l->m_iTimerFD, &ev);
+
+      if (0 != pthread_create(&l->m_WorkerThread, NULL, CWorkerPool::worker, l))
+      {
+         ::close(l->m_iEpollFD);
+         ::close(l->m_iWakeFD);
+         ::close(l->m_iTimerFD);
+         pthread_mutex_destroy(&l->m_Lock);
+         delete l;
+         throw CUDTException(3, 1);
+      }
+
+      m_vLoops.push_back(l);
+   }
+}
+
+void CWorkerPool::add(CSndQueue* sq, CRcvQueue* rq, CChannel* c, CTimer* t)
+{
+   CGuard poolguard(m_PoolLock);
+
+   CLoop* l = m_vLoops.front();
+   for (vector<CLoop*>::iterator i = m_vLoops.begin(); i != m_vLoops.end(); ++ i)
+   {
+      if ((*i)->m_iLoad < l->m_iLoad)
+         l = *i;
+   }
+
+   ++ l->m_iLoad;
+   m_mOwner[c] = l;
+
+   // any new event on the timer, e.g., an earlier packet to send, wakes up the worker
+   t->setWakeFD(l->m_iWakeFD);
+
+   CMux m;
+   m.m_pSndQueue = sq;
+   m.m_pRcvQueue = rq;
+   m.m_pChannel = c;
+   m.m_pTimer = t;
+
+   CGuard loopguard(l->m_Lock);
+   l->m_vNewMux.push_back(m);
+   t->tick();
+}
+
+void CWorkerPool::remove(CSndQueue* sq, CRcvQueue* rq, CChannel* c, CTimer* t)
+{
+   CGuard poolguard(m_PoolLock);
+
+   map<CChannel*, CLoop*>::iterator i = m_mOwner.find(c);
+   if (i == m_mOwner.end())
+      return;
+
+   CLoop* l = i->second;
+   -- l->m_iLoad;
+   m_mOwner.erase(i);
+
+   CMux m;
+   m.m_pSndQueue = sq;
+   m.m_pRcvQueue = rq;
+   m.m_pChannel = c;
+   m.m_pTimer = t;
+
+   CGuard loopguard(l->m_Lock);
+   l->m_vOldMux.push_back(m);
+   t->tick();
+}
+
+void* CWorkerPool::worker(void* param)
+{
+   CLoop* self = (CLoop*)param;
+
+   // large enough for both IPv4 and IPv6 addresses
+   sockaddr_in6 addrbuf;
+   sockaddr* addr = (sockaddr*)&addrbuf;
+
+   const int maxevents = 64;
+   const int batch = 64;
+   epoll_event events[maxevents];
+
+   uint64_t lasttimercheck = 0;
+   int timeout = -1;
+
+   while (!self->m_bClosing)
+   {
+      // new or closed multiplexers; the lists are only filled here to keep the lock order of the callers
+      {
+         CGuard loopguard(self->m_Lock);
+
+         for (vector<CMux>::iterator i = self->m_vOldMux.begin(); i != self->m_vOldMux.end(); ++ i)
+         {
+            int fd = i->m_pChannel->getSocket();
+            epoll_ctl(self->m_iEpollFD, EPOLL_CTL_DEL, fd, NULL);
+            self->m_mMux.erase(fd);
+            release(*i);
+         }
+         self->m_vOldMux.clear();
+
+         for (vector<CMux>::iterator i = self->m_vNewMux.begin(); i != self->m_vNewMux.end(); ++ i)
+         {
+            int fd = i->m_pChannel->getSocket();
+            epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(self->m_iEpollFD, EPOLL_CTL_ADD, fd, &ev);
+            self->m_mMux[fd] = *i;
+         }
+         self->m_vNewMux.clear();
+      }
+
+      int n = epoll_wait(self->m_iEpollFD, events, maxevents, timeout);
+
+      for (int e = 0; e < n; ++ e)
+      {
+         int fd = events[e].data.fd;
+
+         // the timer is reset when armed again below
+         if (fd == self->m_iTimerFD)
+            continue;
+
+         if (fd == self->m_iWakeFD)
+         {
+            eventfd_t count;
+            eventfd_read(fd, &count);
+            continue;
+         }
+
+         map<int, CMux>::iterator i = self->m_mMux.find(fd);
+         if (i == self->m_mMux.end())
+            continue;
+
+         // a bounded batch per channel, so that one busy multiplexer cannot starve the others
+         for (int k = 0; k < batch; ++ k)
+         {
+            if (i->second.m_pRcvQueue->receive(addr) < 0)
+               break;
+         }
+      }
+
+      // timing events of all sockets, at least every millisecond
+      uint64_t currtime = CTimer::getTime();
+      if (currtime - lasttimercheck >= 1000)
+      {
+         for (map<int, CMux>::iterator i = self->m_mMux.begin(); i != self->m_mMux.end(); ++ i)
+            i->second.m_pRcvQueue->checkTimers();
+         lasttimercheck = currtime;
+      }
+
+      // send the packets due, and find the time of the next one
+      uint64_t nexttime = 0;
+      bool due = false;
+      for (map<int, CMux>::iterator i = self->m_mMux.begin(); i != self->m_mMux.end(); ++ i)
+      {
+         CSndQueue* sq = i->second.m_pSndQueue;
+
+         for (int k = 0; k < batch; ++ k)
+         {
+            uint64_t ts = sq->m_pSndUList->getNextProcTime();
+            if (0 == ts)
+               break;
+
+            uint64_t now;
+            CTimer::rdtsc(now);
+            if (now < ts)
+            {
+               if ((0 == nexttime) || (ts < nexttime))
+                  nexttime = ts;
+               break;
+            }
+
+            sockaddr* peer;
+            CPacket pkt;
+            bool fragment;
+            if (sq->m_pSndUList->pop(peer, pkt, fragment) >= 0)
+               sq->m_pChannel->sendto(peer, pkt, fragment);
+
+            // the batch is over with packets still due, come back at once
+            if (k == batch - 1)
+               due = true;
+         }
+      }
+
+      // sleep until the next packet is due, at most as long as a dedicated receiving thread would
+      uint64_t wait = 10000;
+      if (nexttime > 0)
+      {
+         uint64_t now;
+         CTimer::rdtsc(now);
+         uint64_t us = (nexttime > now) ? (nexttime - now) / CTimer::getCPUFrequency() : 0;
+         if (us < wait)
+            wait = us;
+      }
+
+      if (due || (0 == wait))
+         timeout = 0;
+      else
+      {
+         itimerspec its;
+         its.it_interval.tv_sec = 0;
+         its.it_interval.tv_nsec = 0;
+         its.it_value.tv_sec = 0;
+         its.it_value.tv_nsec = wait * 1000;
+         timerfd_settime(self->m_iTimerFD, 0, &its, NULL);
+         timeout = -1;
+      }
+   }
+
+   return NULL;
+}
+
+void CWorkerPool::release(CMux& m)
+{
+   m.m_pChannel->close();
+   delete m.m_pSndQueue;
+   delete m.m_pRcvQueue;
+   delete m.m_pTimer;
+   delete m.m_pChannel;
+}
+#endif
@@ -51,11 +51,16 @@ written by
 #include <vector>
 
 class CUDT;
+class CRcvBuffer;
 
 struct CUnit
 {
    CPacket m_Packet;		// packet
-   int m_iFlag;			// 0: free, 1: occupied, 2: msg read but not freed (out-of-order), 3: msg dropped
+   int m_iFlag;			// 0: free, 1: occupied, 2: msg read but not freed (out-of-order), 3: msg dropped, 4: lent to application
+   int m_iMsgOffset;		// read position of the next message packed in the payload
+   int m_iLent;			// number of slices of the unit held by the application
+   int m_iLoan;			// loan number, changes each time the unit is lent anew
+   CRcvBuffer* m_pLender;	// receiver buffer that lent the unit, NULL if no slice is out
 };
 
 class CUnitQueue
@@ -75,10 +80,11 @@ public:
       //    1) [in] size: queue size
       //    2) [in] mss: maximum segament size
       //    3) [in] version: IP version
+      //    4) [in] node: NUMA node of the unit buffers, -1 for any
       // Returned value:
       //    0: success, -1: failure.
 
-   int init(int size, int mss, int version);
+   int init(int size, int mss, int version, int node);
 
       // Functionality:
       //    Increase (double) the unit queue size.
@@ -127,6 +133,7 @@ private:
 
    int m_iMSS;			// unit buffer size
    int m_iIPversion;		// IP version
+   int m_iNode;			// NUMA node of the unit buffers, -1: any
 
 private:
    CUnitQueue(const CUnitQueue&);
@@ -176,10 +183,21 @@ public:
       // Parameters:
       //    0) [out] addr: destination address of the next packet
       //    1) [out] pkt: the next packet to be sent
+      //    2) [out] fragment: if the packet is larger than the path carries now and may be split by the IP layer
       // Returned value:
       //    1 if successfully retrieved, -1 if no packet found.
 
-   int pop(sockaddr*& addr, CPacket& pkt);
+   int pop(sockaddr*& addr, CPacket& pkt, bool& fragment);
+
+      // Functionality:
+      //    Send the next packet of a UDT instance that is not on the list from the calling thread,
+      //    and schedule the rest of its data as update() does.
+      // Parameters:
+      //    1) [in] u: pointer to the UDT instance
+      // Returned value:
+      //    1 if a packet was sent, 0 if it is left to the sending worker.
+
+   int sendNow(const CUDT* u);
 
       // Functionality:
       //    Remove UDT instance from the list.
@@ -214,6 +232,7 @@ private:
    pthread_cond_t* m_pWindowCond;
 
    CTimer* m_pTimer;
+   CChannel* m_pChannel;		// UDP channel used by sendNow()
 
 private:
    CSndUList(const CSndUList&);
@@ -351,6 +370,15 @@ public:
 
    void updateConnStatus();
 
+      // Functionality:
+      //    Send the next handshake of a connecting socket at once, after it got a response.
+      // Parameters:
+      //    1) [in] id: UDT socket ID
+      // Returned value:
+      //    None.
+
+   void updateConnStatus(const UDTSOCKET& id);
+
 private:
    struct CRL
    {
@@ -361,14 +389,22 @@ private:
       uint64_t m_ullTTL;			// the time that this request expires
    };
    std::list<CRL> m_lRendezvousID;      // The sockets currently in rendezvous mode
+   std::map<UDTSOCKET, std::list<CRL>::iterator> m_mRendezvousIndex;	// the same sockets, by ID
+
+   volatile uint64_t m_ullNextCheck;	// no request is due to be sent again or to expire before this time
 
    pthread_mutex_t m_RIDVectorLock;
+
+private:
+   void sendRequest(const CRL& r, uint64_t currtime);
+   void erase(std::list<CRL>::iterator i);
 };
 
 class CSndQueue
 {
 friend class CUDT;
 friend class CUDTUnited;
+friend class CWorkerPool;
 
 public:
    CSndQueue();
@@ -381,10 +417,20 @@ public:
       // Parameters:
       //    1) [in] c: UDP channel to be associated to the queue
       //    2) [in] t: Timer
+      //    3) [in] worker: start a sending thread of its own, false if a CWorkerPool serves the queue
+      // Returned value:
+      //    None.
+
+   void init(CChannel* c, CTimer* t, bool worker);
+
+      // Functionality:
+      //    Restrict the sending thread to a set of CPUs.
+      // Parameters:
+      //    1) [in] mask: bit i allows CPU i
       // Returned value:
       //    None.
 
-   void init(CChannel* c, CTimer* t);
+   void setCPU(uint64_t mask);
 
       // Functionality:
       //    Send out a packet to a given address.
@@ -425,6 +471,7 @@ class CRcvQueue
 {
 friend class CUDT;
 friend class CUDTUnited;
+friend class CWorkerPool;
 
 public:
    CRcvQueue();
@@ -441,10 +488,21 @@ public:
       //    4) [in] hsize: hash table size
       //    5) [in] c: UDP channel to be associated to the queue
       //    6) [in] t: timer
+      //    7) [in] node: NUMA node of the unit buffers, -1 for any
+      //    8) [in] worker: start a receiving thread of its own, false if a CWorkerPool serves the queue
+      // Returned value:
+      //    None.
+
+   void init(int size, int payload, int version, int hsize, CChannel* c, CTimer* t, int node, bool worker);
+
+      // Functionality:
+      //    Restrict the receiving thread to a set of CPUs.
+      // Parameters:
+      //    1) [in] mask: bit i allows CPU i
       // Returned value:
       //    None.
 
-   void init(int size, int payload, int version, int hsize, CChannel* c, CTimer* t);
+   void setCPU(uint64_t mask);
 
       // Functionality:
       //    Read a packet for a specific UDT socket id.
@@ -463,6 +521,24 @@ private:
    static DWORD WINAPI worker(LPVOID param);
 #endif
 
+      // Functionality:
+      //    Read one packet from the channel and pass it to its UDT socket.
+      // Parameters:
+      //    1) [out] addr: buffer for the source address
+      // Returned value:
+      //    0 if a packet was read, -1 if none was waiting.
+
+   int receive(sockaddr* addr);
+
+      // Functionality:
+      //    Run the timers of the sockets not served by a packet recently, and the pending connections.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void checkTimers();
+
    pthread_t m_WorkerThread;
 
 private:
@@ -483,13 +559,15 @@ private:
    void removeListener(const CUDT* u);
 
    void registerConnector(const UDTSOCKET& id, CUDT* u, int ipv, const sockaddr* addr, uint64_t ttl);
-   void removeConnector(const UDTSOCKET& id);
+   void removeConnector(const UDTSOCKET& id, bool keep = false);
 
    void setNewEntry(CUDT* u);
    bool ifNewEntry();
    CUDT* getNewEntry();
+   void addNewEntries();
 
    void storePkt(int32_t id, CPacket* pkt);
+   void passStoredPkts(CUDT* u);
 
 private:
    pthread_mutex_t m_LSLock;
@@ -508,6 +586,89 @@ private:
    CRcvQueue& operator=(const CRcvQueue&);
 };
 
+#ifdef LINUX
+class CWorkerPool
+{
+public:
+   CWorkerPool();
+   ~CWorkerPool();
+
+public:
+
+      // Functionality:
+      //    Start the worker threads.
+      // Parameters:
+      //    1) [in] threads: number of worker threads
+      // Returned value:
+      //    None.
+
+   void init(int threads);
+
+      // Functionality:
+      //    Let the least loaded worker serve a multiplexer, whose queues were initialized without threads.
+      // Parameters:
+      //    1) [in] sq: sending queue
+      //    2) [in] rq: receiving queue
+      //    3) [in] c: UDP channel of both queues
+      //    4) [in] t: timer of both queues
+      // Returned value:
+      //    None.
+
+   void add(CSndQueue* sq, CRcvQueue* rq, CChannel* c, CTimer* t);
+
+      // Functionality:
+      //    Stop serving a multiplexer, then close its channel and delete its queues, timer and channel.
+      //    The worker does this once it is done with them, the caller must not touch them any more.
+      // Parameters:
+      //    1) [in] sq: sending queue
+      //    2) [in] rq: receiving queue
+      //    3) [in] c: UDP channel of both queues, still open
+      //    4) [in] t: timer of both queues
+      // Returned value:
+      //    None.
+
+   void remove(CSndQueue* sq, CRcvQueue* rq, CChannel* c, CTimer* t);
+
+private:
+   struct CMux
+   {
+      CSndQueue* m_pSndQueue;
+      CRcvQueue* m_pRcvQueue;
+      CChannel* m_pChannel;
+      CTimer* m_pTimer;
+   };
+
+   struct CLoop
+   {
+      pthread_t m_WorkerThread;
+      int m_iEpollFD;				// readable UDP sockets, wake-ups and the pacing timer
+      int m_iWakeFD;				// eventfd, written when a sending list gets an earlier event or the multiplexers change
+      int m_iTimerFD;				// timerfd, armed for the next packet due
+      int m_iLoad;				// number of multiplexers served
+
+      pthread_mutex_t m_Lock;			// protects the two lists below
+      std::vector<CMux> m_vNewMux;		// multiplexers to be served
+      std::vector<CMux> m_vOldMux;		// multiplexers to be deleted
+
+      std::map<int, CMux> m_mMux;		// multiplexers being served, by UDP socket; the worker's own
+
+      volatile bool m_bClosing;
+   };
+
+   std::vector<CLoop*> m_vLoops;
+   std::map<CChannel*, CLoop*> m_mOwner;	// worker serving each multiplexer
+   pthread_mutex_t m_PoolLock;			// protects the two containers above
+
+private:
+   static void* worker(void* param);
+   static void release(CMux& m);
+
+private:
+   CWorkerPool(const CWorkerPool&);
+   CWorkerPool& operator=(const CWorkerPool&);
+};
+#endif
+
 struct CMultiplexer
 {
    CSndQueue* m_pSndQueue;	// The sending queue
@@ -518,6 +679,10 @@ struct CMultiplexer
    int m_iPort;			// The UDP port number of this multiplexer
    int m_iIPversion;		// IP version
    int m_iMSS;			// Maximum Segment Size
+   int m_iBusyPoll;		// busy polling time of the receiving thread in microseconds, 0: blocking receives
+   uint64_t m_llCPUMask;	// CPUs the sending and receiving threads run on, 0: any
+   int m_iNode;			// NUMA node of the packet buffers, -1: any
+   bool m_bPooled;		// served by the shared CWorkerPool instead of threads of its own
    int m_iRefCount;		// number of UDT instances that are associated with this multiplexer
    bool m_bReusable;		// if this one can be shared with others
 
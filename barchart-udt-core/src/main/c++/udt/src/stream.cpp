@@ -0,0 +1,876 @@
+/*****************************************************************************
+Copyright (c) 2001 - 2011, The Board of Trustees of the University of Illinois.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the
+  above copyright notice, this list of conditions
+  and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the University of Illinois
+  nor the names of its contributors may be used to
+  endorse or promote products derived from this
+  software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************/
+
+#ifdef WIN32
+   #include <winsock2.h>
+   #include <ws2tcpip.h>
+#endif
+#include <cstring>
+#include "core.h"
+#include "stream.h"
+
+using namespace std;
+
+// frame header: type, flags, 2 bytes zero, stream ID and a 64-bit value, all in network order;
+// the value of a data frame is the stream offset of its data, that of a window frame the offset the receiver grants up to,
+// that of a reset frame the offset the receiver stopped reading at
+static const int s_iHeaderSize = 16;
+static const int s_iData = 1;
+static const int s_iWindow = 2;
+static const int s_iReset = 3;
+static const int s_iFin = 1;                    // the last frame of the stream; on a reset frame, the stream is refused and ends at its value
+static const int s_iOpener = 2;                 // the sender of the frame opened the stream
+
+static const int s_iMaxSegments = 16;           // most blocks of the sending queue a frame is gathered from
+static const int s_iInitialWindow = 65536;      // what a new stream may send before the receiver tells its window
+static const int s_iMaxPeerGap = 1024;          // most streams of the peer whose first frames may still be on their way
+static const int s_iMaxPeerStreams = 1024;      // most streams opened by the peer at a time, the others are refused
+static const int s_iMaxAcceptQueue = 128;       // most streams of the peer waiting to be accepted
+static const int s_iMinBacklog = 64;            // packets the sending buffer of the connection may hold, whatever the congestion window
+static const int s_iBacklogTime = 20000;        // time the packets in the sending buffer of the connection may take to go, in microseconds
+
+static void packHeader(char* buf, int type, int flags, int id, int64_t value)
+{
+   buf[0] = char(type);
+   buf[1] = char(flags);
+   buf[2] = buf[3] = 0;
+   for (int i = 0; i < 4; ++ i)
+      buf[4 + i] = char(uint32_t(id) >> (24 - 8 * i));
+   for (int i = 0; i < 8; ++ i)
+      buf[8 + i] = char(uint64_t(value) >> (56 - 8 * i));
+}
+
+static bool unpackHeader(const char* buf, int& type, int& flags, int& id, int64_t& value)
+{
+   type = (unsigned char)buf[0];
+   flags = (unsigned char)buf[1];
+
+   uint32_t v32 = 0;
+   for (int i = 0; i < 4; ++ i)
+      v32 = (v32 << 8) | (unsigned char)buf[4 + i];
+   uint64_t v64 = 0;
+   for (int i = 0; i < 8; ++ i)
+      v64 = (v64 << 8) | (unsigned char)buf[8 + i];
+
+   id = int(v32);
+   value = int64_t(v64);
+
+   return ((s_iData == type) || (s_iWindow == type) || (s_iReset == type)) && (id > 0) && (id < (1 << 30)) && (value >= 0);
+}
+
+// the flag telling the peer which side opened the stream of "key"
+static int opener(int key)
+{
+   return (0 == (key & 1)) ? s_iOpener : 0;
+}
+
+// a closed stream is forgotten once both of its directions are over
+static bool finished(const CStream* s)
+{
+   return s->m_bClosed && s->m_bFinSent && (s->m_llFinOffset >= 0) && (s->m_llRecvNext >= s->m_llFinOffset);
+}
+
+static bool expired(uint64_t exptime)
+{
+   return (0 != exptime) && (CTimer::getTime() >= exptime);
+}
+
+CStream::CStream():
+m_lSendQueue(),
+m_iSendHead(0),
+m_iSendQueued(0),
+m_llSendOffset(0),
+m_llSendLimit(s_iInitialWindow),
+m_bFinSent(false),
+m_bReset(false),
+m_lRecvQueue(),
+m_iRecvHead(0),
+m_iRecvQueued(0),
+m_mRecvAhead(),
+m_llRecvNext(0),
+m_llRecvRead(0),
+m_llRecvLimit(0),
+m_llFinOffset(-1),
+m_bClosed(false)
+{
+}
+
+CStreamMux::CStreamMux(CUDT* udt, int window):
+m_pUDT(udt),
+m_iWindow(window),
+m_mStreams(),
+m_lAcceptQueue(),
+m_sWindowDue(),
+m_sResetDue(),
+m_iNextID(1),
+m_iPeerMaxID(0),
+m_sPeerGaps(),
+m_iPeerStreams(0),
+m_iLastServed(0),
+m_iSndTimeOut(udt->m_iSndTimeOut),
+m_iRcvTimeOut(udt->m_iRcvTimeOut),
+m_bStarted(false),
+m_bClosing(false),
+m_bBroken(false),
+m_Error()
+{
+   // the timeouts now apply to the stream calls; the threads always block on the connection
+   udt->m_iSndTimeOut = -1;
+   udt->m_iRcvTimeOut = -1;
+
+   CGuard::createMutex(m_Lock);
+   CGuard::createCond(m_RecvCond);
+   CGuard::createCond(m_SendCond);
+   CGuard::createCond(m_WorkCond);
+}
+
+CStreamMux::~CStreamMux()
+{
+   stop();
+
+   m_pUDT->m_iSndTimeOut = m_iSndTimeOut;
+   m_pUDT->m_iRcvTimeOut = m_iRcvTimeOut;
+
+   for (map<int, CStream*>::iterator i = m_mStreams.begin(); i != m_mStreams.end(); ++ i)
+      delete i->second;
+
+   CGuard::releaseMutex(m_Lock);
+   CGuard::releaseCond(m_RecvCond);
+   CGuard::releaseCond(m_SendCond);
+   CGuard::releaseCond(m_WorkCond);
+}
+
+void CStreamMux::start()
+{
+   #ifndef WIN32
+      pthread_create(&m_SendThread, NULL, sendFrames, this);
+      pthread_create(&m_RecvThread, NULL, recvFrames, this);
+   #else
+      m_SendThread = CreateThread(NULL, 0, sendFrames, this, 0, NULL);
+      m_RecvThread = CreateThread(NULL, 0, recvFrames, this, 0, NULL);
+   #endif
+
+   m_bStarted = true;
+}
+
+void CStreamMux::stop()
+{
+   CGuard::enterCS(m_Lock);
+   m_bClosing = true;
+   signal(m_RecvCond);
+   signal(m_SendCond);
+   signal(m_WorkCond);
+   CGuard::leaveCS(m_Lock);
+
+   if (!m_bStarted)
+      return;
+
+   #ifndef WIN32
+      pthread_join(m_SendThread, NULL);
+      pthread_join(m_RecvThread, NULL);
+   #else
+      WaitForSingleObject(m_SendThread, INFINITE);
+      CloseHandle(m_SendThread);
+      WaitForSingleObject(m_RecvThread, INFINITE);
+      CloseHandle(m_RecvThread);
+   #endif
+
+   m_bStarted = false;
+}
+
+int CStreamMux::open()
+{
+   CGuard muxguard(m_Lock);
+
+   check();
+
+   if (m_iNextID >= (1 << 30))
+      throw CUDTException(3, 0, 0);
+
+   int key = (m_iNextID ++) << 1;
+   create(key);
+
+   return key;
+}
+
+int CStreamMux::accept()
+{
+   CGuard muxguard(m_Lock);
+
+   uint64_t exptime = (m_iRcvTimeOut < 0) ? 0 : CTimer::getTime() + m_iRcvTimeOut * 1000ULL;
+
+   while (m_lAcceptQueue.empty())
+   {
+      check();
+
+      if (expired(exptime))
+         throw CUDTException(6, 3, 0);
+
+      wait(m_RecvCond, exptime);
+   }
+
+   int key = m_lAcceptQueue.front();
+   m_lAcceptQueue.pop_front();
+
+   return key;
+}
+
+int CStreamMux::send(int id, const char* data, int len)
+{
+   CGuard muxguard(m_Lock);
+
+   CStream* s = find(id);
+
+   if (len <= 0)
+      return 0;
+
+   uint64_t exptime = (m_iSndTimeOut < 0) ? 0 : CTimer::getTime() + m_iSndTimeOut * 1000ULL;
+
+   while (!s->m_bReset && (s->m_iSendQueued >= m_iWindow))
+   {
+      check();
+
+      if (expired(exptime))
+         throw CUDTException(6, 3, 0);
+
+      wait(m_SendCond, exptime);
+
+      // the stream may have been closed meanwhile
+      s = find(id);
+   }
+
+   check();
+
+   if (s->m_bReset)
+      throw CUDTException(2, 3, 0);
+
+   int size = min(len, m_iWindow - s->m_iSendQueued);
+   s->m_lSendQueue.push_back(vector<char>(data, data + size));
+   s->m_iSendQueued += size;
+
+   signal(m_WorkCond);
+
+   return size;
+}
+
+int CStreamMux::recv(int id, char* data, int len)
+{
+   CGuard muxguard(m_Lock);
+
+   CStream* s = find(id);
+
+   if (len <= 0)
+      return 0;
+
+   uint64_t exptime = (m_iRcvTimeOut < 0) ? 0 : CTimer::getTime() + m_iRcvTimeOut * 1000ULL;
+
+   // the data that has arrived is read even after the connection failed
+   while (0 == s->m_iRecvQueued)
+   {
+      if ((s->m_llFinOffset >= 0) && (s->m_llRecvNext >= s->m_llFinOffset))
+         return 0;
+
+      check();
+
+      if (expired(exptime))
+         throw CUDTException(6, 3, 0);
+
+      wait(m_RecvCond, exptime);
+
+      s = find(id);
+   }
+
+   int read = 0;
+   while ((read < len) && !s->m_lRecvQueue.empty())
+   {
+      vector<char>& block = s->m_lRecvQueue.front();
+      int size = min(len - read, int(block.size()) - s->m_iRecvHead);
+      memcpy(data + read, &block[s->m_iRecvHead], size);
+      read += size;
+
+      if ((s->m_iRecvHead += size) == int(block.size()))
+      {
+         s->m_lRecvQueue.pop_front();
+         s->m_iRecvHead = 0;
+      }
+   }
+
+   s->m_iRecvQueued -= read;
+   s->m_llRecvRead += read;
+   grant(id, s);
+
+   return read;
+}
+
+void CStreamMux::close(int id)
+{
+   CGuard muxguard(m_Lock);
+
+   CStream* s = find(id);
+   s->m_bClosed = true;
+
+   // nobody reads the stream any more: what has arrived is dropped and counted as read,
+   // what is still on its way is dropped as it comes, and the peer is told to send nothing more
+   for (map<int64_t, vector<char> >::iterator i = s->m_mRecvAhead.begin(); i != s->m_mRecvAhead.end(); ++ i)
+      s->m_llRecvNext += i->second.size();
+   s->m_mRecvAhead.clear();
+   s->m_lRecvQueue.clear();
+   s->m_iRecvHead = 0;
+   s->m_iRecvQueued = 0;
+   s->m_llRecvRead = s->m_llRecvNext;
+   if ((s->m_llFinOffset < 0) || (s->m_llRecvNext < s->m_llFinOffset))
+      m_sResetDue.insert(id);
+
+   // the end of the stream follows the data still queued
+   signal(m_WorkCond);
+   signal(m_RecvCond);
+   signal(m_SendCond);
+
+   if (finished(s))
+      remove(id);
+}
+
+bool CStreamMux::setOpt(UDTOpt optName, const void* optval)
+{
+   CGuard muxguard(m_Lock);
+
+   switch (optName)
+   {
+   case UDT_SNDSYN:
+   case UDT_RCVSYN:
+      // nothing would tell when a stream is ready
+      if (!*(bool *)optval)
+         throw CUDTException(5, 14, 0);
+      return true;
+
+   case UDT_SNDTIMEO:
+      m_iSndTimeOut = *(int*)optval;
+      return true;
+
+   case UDT_RCVTIMEO:
+      m_iRcvTimeOut = *(int*)optval;
+      return true;
+
+   default:
+      return false;
+   }
+}
+
+bool CStreamMux::getOpt(UDTOpt optName, void* optval, int& optlen)
+{
+   CGuard muxguard(m_Lock);
+
+   switch (optName)
+   {
+   case UDT_SNDTIMEO:
+      *(int*)optval = m_iSndTimeOut;
+      optlen = sizeof(int);
+      return true;
+
+   case UDT_RCVTIMEO:
+      *(int*)optval = m_iRcvTimeOut;
+      optlen = sizeof(int);
+      return true;
+
+   default:
+      return false;
+   }
+}
+
+#ifndef WIN32
+void* CStreamMux::sendFrames(void* self)
+#else
+DWORD WINAPI CStreamMux::sendFrames(LPVOID self)
+#endif
+{
+   ((CStreamMux*)self)->sendLoop();
+
+   #ifndef WIN32
+      return NULL;
+   #else
+      return 0;
+   #endif
+}
+
+#ifndef WIN32
+void* CStreamMux::recvFrames(void* self)
+#else
+DWORD WINAPI CStreamMux::recvFrames(LPVOID self)
+#endif
+{
+   ((CStreamMux*)self)->recvLoop();
+
+   #ifndef WIN32
+      return NULL;
+   #else
+      return 0;
+   #endif
+}
+
+void CStreamMux::sendLoop()
+{
+   char header[s_iHeaderSize];
+   CIOVec iov[s_iMaxSegments + 1];
+   iov[0].data = header;
+   iov[0].len = s_iHeaderSize;
+
+   // a frame fills one packet with its header, leaving room for the length of a packed message
+   int framesize = m_pUDT->m_iPayloadSize - s_iHeaderSize - ((m_pUDT->m_iCoalesce >= 0) ? 2 : 0);
+
+   CGuard::enterCS(m_Lock);
+
+   while (!m_bClosing && !m_bBroken)
+   {
+      int key;
+      CStream* s = NULL;
+      int num = 1;
+      int len = 0;
+      bool fin = false;
+
+      if (!m_sWindowDue.empty())
+      {
+         // windows go first, the peer may be waiting for them
+         key = *m_sWindowDue.begin();
+         m_sWindowDue.erase(m_sWindowDue.begin());
+
+         map<int, CStream*>::iterator i = m_mStreams.find(key);
+         if (i == m_mStreams.end())
+            continue;
+
+         packHeader(header, s_iWindow, opener(key), key >> 1, i->second->m_llRecvLimit);
+      }
+      else if (!m_sResetDue.empty())
+      {
+         key = *m_sResetDue.begin();
+         m_sResetDue.erase(m_sResetDue.begin());
+
+         // a refused stream of the peer has no state here, and nothing comes back on it
+         map<int, CStream*>::iterator i = m_mStreams.find(key);
+         if (i == m_mStreams.end())
+            packHeader(header, s_iReset, opener(key) | s_iFin, key >> 1, 0);
+         else
+            packHeader(header, s_iReset, opener(key), key >> 1, i->second->m_llRecvNext);
+      }
+      else if (NULL != (s = next(key)))
+      {
+         // the peer reads no more: the queued data is dropped and the end of the stream goes out alone
+         if (s->m_bReset && (s->m_iSendQueued > 0))
+         {
+            s->m_lSendQueue.clear();
+            s->m_iSendHead = 0;
+            s->m_iSendQueued = 0;
+         }
+
+         int room = int(min(int64_t(min(framesize, s->m_iSendQueued)), s->m_llSendLimit - s->m_llSendOffset));
+
+         // gather the frame from the queued blocks; they stay in place until it is sent,
+         // and the application only adds blocks behind them
+         int pos = s->m_iSendHead;
+         for (list<vector<char> >::iterator b = s->m_lSendQueue.begin(); (len < room) && (num <= s_iMaxSegments); ++ b)
+         {
+            iov[num].data = &(*b)[pos];
+            iov[num].len = min(room - len, int(b->size()) - pos);
+            len += iov[num ++].len;
+            pos = 0;
+         }
+
+         fin = (s->m_bClosed || s->m_bReset) && (len == s->m_iSendQueued);
+         packHeader(header, s_iData, opener(key) | (fin ? s_iFin : 0), key >> 1, s->m_llSendOffset);
+      }
+      else
+      {
+         wait(m_WorkCond, 0);
+         continue;
+      }
+
+      CGuard::leaveCS(m_Lock);
+
+      try
+      {
+         pace();
+         m_pUDT->sendmsgv(iov, num, -1, false);
+      }
+      catch (CUDTException& e)
+      {
+         CGuard::enterCS(m_Lock);
+         fail(e);
+         break;
+      }
+
+      CGuard::enterCS(m_Lock);
+
+      if (NULL == s)
+         continue;
+
+      // drop what has been sent from the queue
+      for (int left = len; left > 0;)
+      {
+         vector<char>& block = s->m_lSendQueue.front();
+         int size = min(left, int(block.size()) - s->m_iSendHead);
+         left -= size;
+
+         if ((s->m_iSendHead += size) == int(block.size()))
+         {
+            s->m_lSendQueue.pop_front();
+            s->m_iSendHead = 0;
+         }
+      }
+
+      // a writer only waits for a full queue
+      if (s->m_iSendQueued >= m_iWindow)
+         signal(m_SendCond);
+
+      s->m_iSendQueued -= len;
+      s->m_llSendOffset += len;
+      m_iLastServed = key;
+
+      if (fin)
+      {
+         s->m_bFinSent = true;
+         if (finished(s))
+            remove(key);
+      }
+   }
+
+   CGuard::leaveCS(m_Lock);
+}
+
+void CStreamMux::recvLoop()
+{
+   char header[s_iHeaderSize];
+   vector<char> frame(m_pUDT->m_iMSS);
+   CIOVec iov[2];
+   iov[0].data = header;
+   iov[0].len = s_iHeaderSize;
+   iov[1].data = &frame[0];
+   iov[1].len = int(frame.size());
+
+   while (true)
+   {
+      int len;
+
+      try
+      {
+         len = m_pUDT->recvmsgv(iov, 2);
+      }
+      catch (CUDTException& e)
+      {
+         CGuard muxguard(m_Lock);
+         fail(e);
+         break;
+      }
+
+      // anything but a frame is dropped
+      int type, flags, id;
+      int64_t value;
+      if ((len < s_iHeaderSize) || !unpackHeader(header, type, flags, id, value))
+         continue;
+      len -= s_iHeaderSize;
+
+      CGuard muxguard(m_Lock);
+
+      if (m_bClosing)
+         break;
+
+      // the opener flag is set by the side the stream belongs to
+      int key = (id << 1) | ((flags & s_iOpener) ? 1 : 0);
+
+      CStream* s;
+      map<int, CStream*>::iterator i = m_mStreams.find(key);
+      if (i != m_mStreams.end())
+         s = i->second;
+      else if (0 == (key & 1))
+         continue; // a stream of ours that is over
+      else
+      {
+         // a new stream of the peer, unless it is one that is over; the IDs it skips are kept, up to a limit
+         if (id > m_iPeerMaxID)
+         {
+            if (id - m_iPeerMaxID - 1 + int(m_sPeerGaps.size()) > s_iMaxPeerGap)
+               continue;
+            for (int gap = m_iPeerMaxID + 1; gap < id; ++ gap)
+               m_sPeerGaps.insert(gap);
+            m_iPeerMaxID = id;
+         }
+         else if (0 == m_sPeerGaps.erase(id))
+            continue;
+
+         // beyond the limits the stream is refused: its ID is used up, the peer is told to stop
+         if ((m_iPeerStreams >= s_iMaxPeerStreams) || (int(m_lAcceptQueue.size()) >= s_iMaxAcceptQueue))
+         {
+            m_sResetDue.insert(key);
+            signal(m_WorkCond);
+            continue;
+         }
+
+         s = create(key);
+         ++ m_iPeerStreams;
+         m_lAcceptQueue.push_back(key);
+         signal(m_RecvCond);
+      }
+
+      if (s_iWindow == type)
+      {
+         if (value > s->m_llSendLimit)
+         {
+            s->m_llSendLimit = value;
+            signal(m_WorkCond);
+         }
+      }
+      else if (s_iReset == type)
+      {
+         s->m_bReset = true;
+         if ((flags & s_iFin) && (s->m_llFinOffset < 0))
+            s->m_llFinOffset = value;
+
+         // writers fail, a reader of a refused stream sees its end
+         signal(m_WorkCond);
+         signal(m_SendCond);
+         signal(m_RecvCond);
+
+         if (finished(s))
+            remove(key);
+      }
+      else
+         deliver(key, s, value, &frame[0], len, 0 != (flags & s_iFin));
+   }
+}
+
+CStream* CStreamMux::find(int id)
+{
+   map<int, CStream*>::iterator i = m_mStreams.find(id);
+   if ((i == m_mStreams.end()) || i->second->m_bClosed)
+      throw CUDTException(5, 15, 0);
+
+   return i->second;
+}
+
+CStream* CStreamMux::create(int key)
+{
+   CStream* s = new CStream;
+   s->m_llRecvLimit = m_iWindow;
+   m_mStreams[key] = s;
+
+   // the peer starts with a small window until it learns this one
+   m_sWindowDue.insert(key);
+   signal(m_WorkCond);
+
+   return s;
+}
+
+CStream* CStreamMux::next(int& key)
+{
+   // take turns, starting after the stream served last
+   map<int, CStream*>::iterator from = m_mStreams.upper_bound(m_iLastServed);
+
+   for (int round = 0; round < 2; ++ round)
+   {
+      map<int, CStream*>::iterator i = (0 == round) ? from : m_mStreams.begin();
+      map<int, CStream*>::iterator end = (0 == round) ? m_mStreams.end() : from;
+
+      for (; i != end; ++ i)
+      {
+         CStream* s = i->second;
+         if (s->m_bFinSent)
+            continue;
+
+         if (s->m_bReset || ((s->m_iSendQueued > 0) && (s->m_llSendOffset < s->m_llSendLimit)) || (s->m_bClosed && (0 == s->m_iSendQueued)))
+         {
+            key = i->first;
+            return s;
+         }
+      }
+   }
+
+   return NULL;
+}
+
+void CStreamMux::deliver(int key, CStream* s, int64_t offset, const char* data, int len, bool fin)
+{
+   if (fin)
+      s->m_llFinOffset = offset + len;
+
+   if (s->m_bClosed)
+   {
+      // the peer has been told to stop; what it sent before is counted, until its end arrives
+      s->m_llRecvNext += len;
+      s->m_llRecvRead = s->m_llRecvNext;
+
+      if (finished(s))
+         remove(key);
+      return;
+   }
+
+   // beyond the window or below what is already queued, the frame is not a valid one
+   if ((offset < s->m_llRecvNext) || (offset + len > s->m_llRecvLimit))
+      return;
+
+   bool empty = (0 == s->m_iRecvQueued);
+
+   if (offset > s->m_llRecvNext)
+   {
+      if (len > 0)
+         s->m_mRecvAhead[offset].assign(data, data + len);
+   }
+   else
+   {
+      if (len > 0)
+      {
+         s->m_lRecvQueue.push_back(vector<char>(data, data + len));
+         s->m_iRecvQueued += len;
+         s->m_llRecvNext += len;
+      }
+
+      // the frames that were waiting for this one follow it
+      for (map<int64_t, vector<char> >::iterator i = s->m_mRecvAhead.begin(); (i != s->m_mRecvAhead.end()) && (i->first == s->m_llRecvNext); s->m_mRecvAhead.erase(i ++))
+      {
+         s->m_iRecvQueued += int(i->second.size());
+         s->m_llRecvNext += i->second.size();
+         s->m_lRecvQueue.push_back(vector<char>());
+         s->m_lRecvQueue.back().swap(i->second);
+      }
+   }
+
+   // a reader only waits for an empty stream
+   if ((empty && (s->m_iRecvQueued > 0)) || fin)
+      signal(m_RecvCond);
+}
+
+void CStreamMux::grant(int key, CStream* s)
+{
+   // the room made by reading is told to the peer once it is half of the window, not after every read
+   if ((s->m_llFinOffset >= 0) || (s->m_llRecvRead + m_iWindow - s->m_llRecvLimit < m_iWindow / 2))
+      return;
+
+   s->m_llRecvLimit = s->m_llRecvRead + m_iWindow;
+   m_sWindowDue.insert(key);
+   signal(m_WorkCond);
+}
+
+void CStreamMux::remove(int key)
+{
+   map<int, CStream*>::iterator i = m_mStreams.find(key);
+   if (i == m_mStreams.end())
+      return;
+
+   delete i->second;
+   m_mStreams.erase(i);
+   m_sWindowDue.erase(key);
+   m_sResetDue.erase(key);
+
+   if (0 != (key & 1))
+      -- m_iPeerStreams;
+}
+
+void CStreamMux::fail(const CUDTException& e)
+{
+   if (!m_bBroken)
+   {
+      m_Error = e;
+      m_bBroken = true;
+   }
+
+   signal(m_RecvCond);
+   signal(m_SendCond);
+   signal(m_WorkCond);
+}
+
+void CStreamMux::check()
+{
+   if (m_bBroken)
+      throw CUDTException(m_Error);
+   if (m_bClosing)
+      throw CUDTException(2, 1, 0);
+}
+
+void CStreamMux::pace()
+{
+   // keep the sending buffer of the connection short: a frame of a stream that has just got data
+   // should not queue behind more frames of the others than the congestion window takes
+   CUDT* u = m_pUDT;
+
+   while (!m_bClosing && !u->m_bClosing && !u->m_bBroken)
+   {
+      // what the window allows, but no more than the connection sends in two ACK intervals
+      double rate = double(u->m_ullCPUFrequency) / max(u->m_ullInterval + 0, (uint64_t)1);
+      int backlog = max(s_iMinBacklog, int(min(2 * u->m_dCongestionWindow, rate * s_iBacklogTime)));
+      if (u->m_pSndBuffer->getCurrBufSize() < backlog)
+         return;
+
+      // every ACK signals the send condition
+      #ifndef WIN32
+         uint64_t exptime = CTimer::getTime() + 10000;
+         timespec locktime;
+         locktime.tv_sec = exptime / 1000000;
+         locktime.tv_nsec = (exptime % 1000000) * 1000;
+
+         pthread_mutex_lock(&u->m_SendBlockLock);
+         if (u->m_pSndBuffer->getCurrBufSize() >= backlog)
+            pthread_cond_timedwait(&u->m_SendBlockCond, &u->m_SendBlockLock, &locktime);
+         pthread_mutex_unlock(&u->m_SendBlockLock);
+      #else
+         WaitForSingleObject(u->m_SendBlockCond, 10);
+      #endif
+   }
+}
+
+void CStreamMux::wait(pthread_cond_t& cond, uint64_t exptime)
+{
+   #ifndef WIN32
+      if (0 == exptime)
+         pthread_cond_wait(&cond, &m_Lock);
+      else
+      {
+         timespec locktime;
+         locktime.tv_sec = exptime / 1000000;
+         locktime.tv_nsec = (exptime % 1000000) * 1000;
+         pthread_cond_timedwait(&cond, &m_Lock, &locktime);
+      }
+   #else
+      // an event wakes up one waiter only, so the others look again after a while
+      ReleaseMutex(m_Lock);
+      WaitForSingleObject(cond, 100);
+      WaitForSingleObject(m_Lock, INFINITE);
+   #endif
+}
+
+void CStreamMux::signal(pthread_cond_t& cond)
+{
+   #ifndef WIN32
+      pthread_cond_broadcast(&cond);
+   #else
+      SetEvent(cond);
+   #endif
+}
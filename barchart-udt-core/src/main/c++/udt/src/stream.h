@@ -0,0 +1,223 @@
+/*****************************************************************************
+Copyright (c) 2001 - 2011, The Board of Trustees of the University of Illinois.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the
+  above copyright notice, this list of conditions
+  and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the University of Illinois
+  nor the names of its contributors may be used to
+  endorse or promote products derived from this
+  software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************/
+
+#ifndef __UDT_STREAM_H__
+#define __UDT_STREAM_H__
+
+
+#include "udt.h"
+#include "common.h"
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+class CUDT;
+
+// Independent streams carried by one message mode connection. Each stream is cut into frames that
+// are sent as unordered messages, so all the streams share the congestion control and the sequence
+// numbers of the connection, while a lost frame only holds back the stream it belongs to.
+// Every stream is reassembled by its byte offsets, limited by a window the receiver grants, and the
+// sender serves the streams with data in turn, one frame each. A receiver that stops reading a stream
+// resets it, so the sender drops what is queued and ends the stream instead of sending the rest.
+// The stream calls only block: the epoll of the socket does not tell which streams are ready.
+
+struct CStream
+{
+   CStream();
+
+   std::list<std::vector<char> > m_lSendQueue;  // data accepted from the application, not yet framed
+   int m_iSendHead;                             // bytes of the first block already framed
+   int m_iSendQueued;                           // bytes in the sending queue, not yet framed
+   int64_t m_llSendOffset;                      // stream offset of the next frame
+   int64_t m_llSendLimit;                       // stream offset the peer has granted sending up to
+   bool m_bFinSent;                             // the last frame has been sent
+   bool m_bReset;                               // the peer reads no more, the data queued is dropped
+
+   std::list<std::vector<char> > m_lRecvQueue;  // data ready for the application
+   int m_iRecvHead;                             // bytes of the first block already read
+   int m_iRecvQueued;                           // bytes ready for the application
+   std::map<int64_t, std::vector<char> > m_mRecvAhead;  // frames that arrived before the ones they follow, by offset
+   int64_t m_llRecvNext;                        // stream offset of the next frame to be queued
+   int64_t m_llRecvRead;                        // bytes read by the application
+   int64_t m_llRecvLimit;                       // stream offset granted to the peer
+   int64_t m_llFinOffset;                       // stream length announced by the peer; -1 until then
+
+   bool m_bClosed;                              // closed by the application
+};
+
+class CStreamMux
+{
+public:
+   CStreamMux(CUDT* udt, int window);
+   ~CStreamMux();
+
+      // Functionality:
+      //    Start the threads that frame the outgoing data and dispatch the incoming frames.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void start();
+
+      // Functionality:
+      //    Wake up every waiting call and stop the threads; the connection must be released first.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void stop();
+
+      // Functionality:
+      //    Open a new stream to the peer.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    stream ID.
+
+   int open();
+
+      // Functionality:
+      //    Wait for a stream opened by the peer.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    stream ID.
+
+   int accept();
+
+      // Functionality:
+      //    Queue data on a stream.
+      // Parameters:
+      //    0) [in] id: stream ID.
+      //    1) [in] data: data to be sent.
+      //    2) [in] len: size of the data.
+      // Returned value:
+      //    bytes queued, at most the stream window.
+
+   int send(int id, const char* data, int len);
+
+      // Functionality:
+      //    Read data of a stream, in order.
+      // Parameters:
+      //    0) [in] id: stream ID.
+      //    1) [out] data: buffer to read into.
+      //    2) [in] len: size of the buffer.
+      // Returned value:
+      //    bytes read, 0 at the end of the stream.
+
+   int recv(int id, char* data, int len);
+
+      // Functionality:
+      //    Close a stream: the queued data is still sent, then the end of the stream; incoming data is discarded
+      //    and the peer is told to stop sending.
+      // Parameters:
+      //    0) [in] id: stream ID.
+      // Returned value:
+      //    None.
+
+   void close(int id);
+
+      // Functionality:
+      //    Timeouts of the socket, which apply to the stream calls once the streams are on;
+      //    the socket cannot be made non-blocking any more.
+      // Parameters:
+      //    0) [in] optName: option name.
+      //    1) [in/out] optval: option value.
+      //    2) [out] optlen: size of the option value.
+      // Returned value:
+      //    true if the option is one of them.
+
+   bool setOpt(UDTOpt optName, const void* optval);
+   bool getOpt(UDTOpt optName, void* optval, int& optlen);
+
+private:
+#ifndef WIN32
+   static void* sendFrames(void* self);
+   static void* recvFrames(void* self);
+#else
+   static DWORD WINAPI sendFrames(LPVOID self);
+   static DWORD WINAPI recvFrames(LPVOID self);
+#endif
+
+   void sendLoop();
+   void recvLoop();
+
+   CStream* find(int id);
+   CStream* create(int key);
+   CStream* next(int& key);
+   void deliver(int key, CStream* s, int64_t offset, const char* data, int len, bool fin);
+   void grant(int key, CStream* s);
+   void remove(int key);
+   void fail(const CUDTException& e);
+   void check();
+   void pace();
+   void wait(pthread_cond_t& cond, uint64_t exptime);
+   void signal(pthread_cond_t& cond);
+
+private:
+   CUDT* m_pUDT;                                // connection carrying the streams
+   int m_iWindow;                               // receiving window of each stream, in bytes
+
+   std::map<int, CStream*> m_mStreams;          // streams by key: ID of the opening side, shifted left by one, OR 1 if opened by the peer
+   std::list<int> m_lAcceptQueue;               // streams opened by the peer, not yet accepted
+   std::set<int> m_sWindowDue;                  // streams whose window the peer has to be told about
+   std::set<int> m_sResetDue;                   // streams the peer has to be told to stop sending on; a key without a stream is a refused one
+   int m_iNextID;                               // ID of the next stream opened here
+   int m_iPeerMaxID;                            // highest ID of a stream opened by the peer
+   std::set<int> m_sPeerGaps;                   // IDs below m_iPeerMaxID not seen yet, their first frames were late
+   int m_iPeerStreams;                          // streams opened by the peer and not over
+   int m_iLastServed;                           // key of the stream the last data frame was sent for
+
+   int m_iSndTimeOut;                           // timeout of send, in milliseconds
+   int m_iRcvTimeOut;                           // timeout of recv and accept, in milliseconds
+
+   volatile bool m_bStarted;
+   volatile bool m_bClosing;                    // stop() has been called
+   volatile bool m_bBroken;                     // the connection failed
+   CUDTException m_Error;                       // why the connection failed
+
+   pthread_mutex_t m_Lock;
+   pthread_cond_t m_RecvCond;                   // signalled when data, a stream or the end of one arrives
+   pthread_cond_t m_SendCond;                   // signalled when a sending queue has room
+   pthread_cond_t m_WorkCond;                   // signalled when there is something to frame
+   pthread_t m_SendThread;
+   pthread_t m_RecvThread;
+};
+
+
+#endif
@@ -0,0 +1,593 @@
+/*****************************************************************************
+Copyright (c) 2001 - 2011, The Board of Trustees of the University of Illinois.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the
+  above copyright notice, this list of conditions
+  and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the University of Illinois
+  nor the names of its contributors may be used to
+  endorse or promote products derived from this
+  software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************/
+
+#ifndef WIN32
+   #include <unistd.h>
+   #include <fcntl.h>
+   #include <cerrno>
+#else
+   #include <winsock2.h>
+   #include <ws2tcpip.h>
+#endif
+#include <fstream>
+#include "stripe.h"
+
+using namespace std;
+
+CStripeManifest::CStripeManifest(int64_t size, int64_t stripe):
+m_llSize(size),
+m_llStripe(stripe),
+m_iStripes(0),
+m_iDone(0),
+m_iTaken(0),
+m_iNext(0),
+m_vState(),
+m_strPath(),
+m_pLog(NULL)
+{
+   m_iStripes = int((size + stripe - 1) / stripe);
+   m_vState.resize(m_iStripes, 0);
+
+   CGuard::createMutex(m_Lock);
+   CGuard::createCond(m_Cond);
+}
+
+CStripeManifest::~CStripeManifest()
+{
+   if (NULL != m_pLog)
+      fclose(m_pLog);
+
+   CGuard::releaseMutex(m_Lock);
+   CGuard::releaseCond(m_Cond);
+}
+
+int CStripeManifest::open(const char* path)
+{
+   m_strPath = path;
+
+   // the log starts with the sizes it was written for, then lists the stripes done, one per line
+   bool valid = false;
+   FILE* f = fopen(path, "r");
+   if (NULL != f)
+   {
+      long long size, stripe;
+      if ((2 == fscanf(f, "udt-stripes %lld %lld\n", &size, &stripe)) && (size == m_llSize) && (stripe == m_llStripe))
+      {
+         valid = true;
+
+         int index;
+         while (1 == fscanf(f, "%d\n", &index))
+         {
+            if ((index < 0) || (index >= m_iStripes) || (2 == m_vState[index]))
+               continue;
+
+            m_vState[index] = 2;
+            ++ m_iDone;
+         }
+      }
+      fclose(f);
+   }
+
+   m_pLog = fopen(path, valid ? "a" : "w");
+   if (NULL == m_pLog)
+      return -1;
+
+   if (!valid)
+   {
+      fprintf(m_pLog, "udt-stripes %lld %lld\n", (long long)m_llSize, (long long)m_llStripe);
+      fflush(m_pLog);
+   }
+
+   return 0;
+}
+
+int CStripeManifest::take(int64_t& offset, int64_t& len, bool wait)
+{
+   CGuard manifestguard(m_Lock);
+
+   while (true)
+   {
+      for (; m_iNext < m_iStripes; ++ m_iNext)
+      {
+         if (0 != m_vState[m_iNext])
+            continue;
+
+         int index = m_iNext ++;
+         m_vState[index] = 1;
+         ++ m_iTaken;
+         offset = index * m_llStripe;
+         len = (index == m_iStripes - 1) ? m_llSize - offset : m_llStripe;
+         return index;
+      }
+
+      // the stripes still taken may come back from a failing connection
+      if (!wait || (m_iDone == m_iStripes) || (0 == m_iTaken))
+         return -1;
+
+      #ifndef WIN32
+         pthread_cond_wait(&m_Cond, &m_Lock);
+      #else
+         ReleaseMutex(m_Lock);
+         WaitForSingleObject(m_Cond, 100);
+         WaitForSingleObject(m_Lock, INFINITE);
+      #endif
+   }
+}
+
+void CStripeManifest::release(int index)
+{
+   CGuard manifestguard(m_Lock);
+
+   m_vState[index] = 0;
+   -- m_iTaken;
+   if (index < m_iNext)
+      m_iNext = index;
+
+   #ifndef WIN32
+      pthread_cond_broadcast(&m_Cond);
+   #else
+      SetEvent(m_Cond);
+   #endif
+}
+
+void CStripeManifest::complete(int index)
+{
+   CGuard manifestguard(m_Lock);
+
+   m_vState[index] = 2;
+   -- m_iTaken;
+   ++ m_iDone;
+
+   if (NULL != m_pLog)
+   {
+      fprintf(m_pLog, "%d\n", index);
+      fflush(m_pLog);
+      #ifndef WIN32
+         fsync(fileno(m_pLog));
+      #endif
+   }
+
+   #ifndef WIN32
+      pthread_cond_broadcast(&m_Cond);
+   #else
+      SetEvent(m_Cond);
+   #endif
+}
+
+bool CStripeManifest::finished()
+{
+   CGuard manifestguard(m_Lock);
+
+   return m_iDone == m_iStripes;
+}
+
+void CStripeManifest::close()
+{
+   if (NULL == m_pLog)
+      return;
+
+   fclose(m_pLog);
+   m_pLog = NULL;
+
+   // nothing to resume any more
+   if (finished())
+      remove(m_strPath.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// a stripe request: file position and size, both 64-bit big endian; a size of 0 ends the connection
+static const int s_iRequestSize = 16;
+
+static void packRequest(char* buf, int64_t offset, int64_t len)
+{
+   for (int i = 0; i < 8; ++ i)
+   {
+      buf[i] = char(offset >> (56 - 8 * i));
+      buf[8 + i] = char(len >> (56 - 8 * i));
+   }
+}
+
+static void unpackRequest(const char* buf, int64_t& offset, int64_t& len)
+{
+   offset = len = 0;
+   for (int i = 0; i < 8; ++ i)
+   {
+      offset = (offset << 8) | (unsigned char)buf[i];
+      len = (len << 8) | (unsigned char)buf[8 + i];
+   }
+}
+
+static int sendAll(UDTSOCKET u, const char* buf, int len)
+{
+   for (int sent = 0; sent < len; )
+   {
+      int ss = UDT::send(u, buf + sent, len - sent, 0);
+      if (UDT::ERROR == ss)
+         return -1;
+      sent += ss;
+   }
+   return 0;
+}
+
+static int recvAll(UDTSOCKET u, char* buf, int len)
+{
+   for (int got = 0; got < len; )
+   {
+      int rs = UDT::recv(u, buf + got, len - got, 0);
+      if (UDT::ERROR == rs)
+         return -1;
+      got += rs;
+   }
+   return 0;
+}
+
+// one thread per connection
+struct CStripeWorker
+{
+   UDTSOCKET m_Socket;
+   const char* m_pcPath;                // file, each connection opens it on its own
+   int m_iFlags;                        // open() flags for the file
+   int m_iBlock;
+   CStripeManifest* m_pManifest;        // receiver only
+   bool m_bSync;                        // stripes reach the disk before they are logged
+
+   int64_t m_llBytes;                   // data moved over this connection
+   bool m_bFinished;                    // the connection ended with the end request
+   CUDTException m_Error;               // why it did not
+
+   #ifndef WIN32
+      pthread_t m_Thread;
+   #else
+      HANDLE m_Thread;
+   #endif
+};
+
+#ifndef WIN32
+static void* sendStripes(void* param)
+#else
+static DWORD WINAPI sendStripes(LPVOID param)
+#endif
+{
+   CStripeWorker* w = (CStripeWorker*)param;
+
+   #ifndef WIN32
+      int fd = ::open(w->m_pcPath, w->m_iFlags);
+      if (fd < 0)
+      {
+         w->m_Error = CUDTException(4, 1, errno);
+         return NULL;
+      }
+   #else
+      fstream ifs(w->m_pcPath, ios::in | ios::binary);
+   #endif
+
+   bool shortfile = false;
+   char req[s_iRequestSize];
+   while (0 == recvAll(w->m_Socket, req, s_iRequestSize))
+   {
+      int64_t offset, len;
+      unpackRequest(req, offset, len);
+      if (0 == len)
+      {
+         w->m_bFinished = true;
+         break;
+      }
+
+      #ifndef WIN32
+         int64_t sent = UDT::sendfilefd(w->m_Socket, fd, &offset, len, w->m_iBlock);
+      #else
+         int64_t sent = UDT::sendfile(w->m_Socket, ifs, offset, len, w->m_iBlock);
+      #endif
+
+      if (UDT::ERROR == sent)
+         break;
+
+      w->m_llBytes += sent;
+
+      // the file is shorter than the receiver expects, the rest of the stream would not line up
+      if (sent < len)
+      {
+         w->m_Error = CUDTException(4, 2, 0);
+         shortfile = true;
+         break;
+      }
+   }
+
+   if (!w->m_bFinished && !shortfile)
+      w->m_Error = UDT::getlasterror();
+
+   #ifndef WIN32
+      ::close(fd);
+      return NULL;
+   #else
+      return 0;
+   #endif
+}
+
+#ifndef WIN32
+static void* recvStripes(void* param)
+#else
+static DWORD WINAPI recvStripes(LPVOID param)
+#endif
+{
+   CStripeWorker* w = (CStripeWorker*)param;
+
+   #ifndef WIN32
+      int fd = ::open(w->m_pcPath, w->m_iFlags);
+      if (fd < 0)
+      {
+         // the stripes are left to the other connections
+         w->m_Error = CUDTException(4, 3, errno);
+         return NULL;
+      }
+   #else
+      fstream ofs(w->m_pcPath, ios::in | ios::out | ios::binary);
+   #endif
+
+   // the next request goes out before the current stripe has arrived, so the sender never waits for one
+   int queue[2];
+   int64_t offset[2], len[2];
+   int head = 0, count = 0;
+   bool failed = false;
+
+   while (true)
+   {
+      while (count < 2)
+      {
+         int tail = (head + count) % 2;
+         int index = w->m_pManifest->take(offset[tail], len[tail], 0 == count);
+         if (index < 0)
+            break;
+
+         char req[s_iRequestSize];
+         packRequest(req, offset[tail], len[tail]);
+         queue[tail] = index;
+         ++ count;
+
+         if (sendAll(w->m_Socket, req, s_iRequestSize) < 0)
+         {
+            failed = true;
+            break;
+         }
+      }
+
+      if (failed || (0 == count))
+         break;
+
+      int64_t pos = offset[head];
+      #ifndef WIN32
+         int64_t got = UDT::recvfilefd(w->m_Socket, fd, &pos, len[head], w->m_iBlock);
+      #else
+         int64_t got = UDT::recvfile(w->m_Socket, ofs, pos, len[head], w->m_iBlock);
+      #endif
+
+      if (got != len[head])
+      {
+         failed = true;
+         break;
+      }
+
+      #ifndef WIN32
+         if (w->m_bSync)
+            fdatasync(fd);
+      #else
+         ofs.flush();
+      #endif
+
+      w->m_pManifest->complete(queue[head]);
+      w->m_llBytes += got;
+      head = (head + 1) % 2;
+      -- count;
+   }
+
+   if (failed)
+   {
+      w->m_Error = UDT::getlasterror();
+
+      // the other connections take over what this one had asked for
+      for (; count > 0; -- count, head = (head + 1) % 2)
+         w->m_pManifest->release(queue[head]);
+   }
+   else
+   {
+      char req[s_iRequestSize];
+      packRequest(req, 0, 0);
+      if (0 == sendAll(w->m_Socket, req, s_iRequestSize))
+         w->m_bFinished = true;
+      else
+         w->m_Error = UDT::getlasterror();
+   }
+
+   #ifndef WIN32
+      ::close(fd);
+      return NULL;
+   #else
+      return 0;
+   #endif
+}
+
+// run one worker per connection and wait for all of them
+static void runWorkers(vector<CStripeWorker>& workers, bool sender)
+{
+   for (vector<CStripeWorker>::iterator i = workers.begin(); i != workers.end(); ++ i)
+   {
+      #ifndef WIN32
+         pthread_create(&i->m_Thread, NULL, sender ? sendStripes : recvStripes, &(*i));
+      #else
+         i->m_Thread = CreateThread(NULL, 0, sender ? sendStripes : recvStripes, &(*i), 0, NULL);
+      #endif
+   }
+
+   for (vector<CStripeWorker>::iterator i = workers.begin(); i != workers.end(); ++ i)
+   {
+      #ifndef WIN32
+         pthread_join(i->m_Thread, NULL);
+      #else
+         WaitForSingleObject(i->m_Thread, INFINITE);
+         CloseHandle(i->m_Thread);
+      #endif
+   }
+}
+
+static vector<CStripeWorker> newWorkers(const UDTSOCKET* socks, int num, const char* path, int flags, int block, CStripeManifest* manifest, bool sync)
+{
+   CStripeWorker w;
+   w.m_pcPath = path;
+   w.m_iFlags = flags;
+   w.m_iBlock = block;
+   w.m_pManifest = manifest;
+   w.m_bSync = sync;
+   w.m_llBytes = 0;
+   w.m_bFinished = false;
+
+   vector<CStripeWorker> workers(num, w);
+   for (int i = 0; i < num; ++ i)
+      workers[i].m_Socket = socks[i];
+
+   return workers;
+}
+
+int64_t CStripedFile::send(const UDTSOCKET* socks, int num, const char* path, int block)
+{
+   if ((NULL == socks) || (num <= 0) || (NULL == path))
+      throw CUDTException(5, 3, 0);
+
+   // fail early, before any connection serves a request
+   int flags = 0;
+   #ifndef WIN32
+      flags = O_RDONLY;
+      int fd = ::open(path, flags);
+      if (fd < 0)
+         throw CUDTException(4, 1, errno);
+      ::close(fd);
+   #else
+      if (ifstream(path, ios::in | ios::binary).fail())
+         throw CUDTException(4, 1, 0);
+   #endif
+
+   vector<CStripeWorker> workers = newWorkers(socks, num, path, flags, block, NULL, false);
+   runWorkers(workers, true);
+
+   int64_t total = 0;
+   bool finished = false;
+   for (vector<CStripeWorker>::iterator i = workers.begin(); i != workers.end(); ++ i)
+   {
+      total += i->m_llBytes;
+      finished = finished || i->m_bFinished;
+   }
+
+   // the receiver has the final word, a connection lost on the way is covered by the others
+   if (!finished)
+      throw workers[0].m_Error;
+
+   return total;
+}
+
+int64_t CStripedFile::recv(const UDTSOCKET* socks, int num, const char* path, int64_t size, const char* manifest, int64_t stripe, int block)
+{
+   if ((NULL == socks) || (num <= 0) || (NULL == path) || (size < 0))
+      throw CUDTException(5, 3, 0);
+
+   // every connection should get a share of a small file
+   int64_t share = (size + num - 1) / num;
+   if ((stripe <= 0) || (stripe > share))
+      stripe = share;
+   if (stripe <= 0)
+      stripe = 1;
+
+   // whole pages, so every stripe but the last starts and ends aligned for O_DIRECT
+   stripe = (stripe + 4095) / 4096 * 4096;
+
+   CStripeManifest m(size, stripe);
+   if ((NULL != manifest) && (m.open(manifest) < 0))
+      throw CUDTException(4, 3, 0);
+
+   int flags = 0;
+   #ifndef WIN32
+      flags = O_WRONLY | O_CREAT;
+      #ifdef O_DIRECT
+         bool direct = false;
+         int optlen = sizeof(bool);
+         if ((UDT::ERROR != UDT::getsockopt(socks[0], 0, UDT_DIRECTIO, &direct, &optlen)) && direct)
+            flags |= O_DIRECT;
+      #endif
+
+      int fd = ::open(path, flags, 0644);
+      #ifdef O_DIRECT
+         if ((fd < 0) && (EINVAL == errno) && (flags & O_DIRECT))
+         {
+            flags &= ~O_DIRECT;
+            fd = ::open(path, flags, 0644);
+         }
+      #endif
+
+      // the stripes are written in place; the stripes done before are kept
+      if ((fd < 0) || (ftruncate(fd, size) < 0))
+      {
+         int err = errno;
+         if (fd >= 0)
+            ::close(fd);
+         throw CUDTException(4, 3, err);
+      }
+      ::close(fd);
+      flags &= ~O_CREAT;
+   #else
+      // create the file if needed, without touching its contents
+      fstream(path, ios::out | ios::app | ios::binary).close();
+   #endif
+
+   vector<CStripeWorker> workers = newWorkers(socks, num, path, flags, block, &m, NULL != manifest);
+   runWorkers(workers, false);
+
+   bool finished = m.finished();
+   m.close();
+
+   int64_t total = 0;
+   for (vector<CStripeWorker>::iterator i = workers.begin(); i != workers.end(); ++ i)
+      total += i->m_llBytes;
+
+   if (!finished)
+   {
+      for (vector<CStripeWorker>::iterator i = workers.begin(); i != workers.end(); ++ i)
+      {
+         if (!i->m_bFinished)
+            throw i->m_Error;
+      }
+      throw CUDTException(2, 1, 0);
+   }
+
+   return total;
+}
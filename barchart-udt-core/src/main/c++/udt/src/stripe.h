@@ -0,0 +1,162 @@
+/*****************************************************************************
+Copyright (c) 2001 - 2011, The Board of Trustees of the University of Illinois.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are
+met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the
+  above copyright notice, this list of conditions
+  and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the University of Illinois
+  nor the names of its contributors may be used to
+  endorse or promote products derived from this
+  software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************/
+
+#ifndef __UDT_STRIPE_H__
+#define __UDT_STRIPE_H__
+
+
+#include "udt.h"
+#include "common.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// A file is cut into stripes of equal size. The receiver asks for the stripes it misses, one or
+// two at a time per connection, and the sender answers each request with the data of the stripe.
+// The stripes that have reached the disk are logged, so an interrupted transfer only asks for the rest.
+
+class CStripeManifest
+{
+public:
+   CStripeManifest(int64_t size, int64_t stripe);
+   ~CStripeManifest();
+
+      // Functionality:
+      //    Take over the stripes logged by an earlier transfer of the same file, and log the new ones to the same file.
+      // Parameters:
+      //    0) [in] path: manifest file; a log of another size or stripe size is started again.
+      // Returned value:
+      //    0 on success, -1 if the manifest cannot be written.
+
+   int open(const char* path);
+
+      // Functionality:
+      //    Pick a stripe that is neither done nor taken by another connection.
+      // Parameters:
+      //    0) [out] offset: file position of the stripe.
+      //    1) [out] len: size of the stripe.
+      //    2) [in] wait: while other connections hold stripes, wait for one of them to be given back.
+      // Returned value:
+      //    stripe index, or -1 if there is nothing left to take.
+
+   int take(int64_t& offset, int64_t& len, bool wait);
+
+      // Functionality:
+      //    Give a stripe back after its connection failed, for another connection to take.
+      // Parameters:
+      //    0) [in] index: stripe index from take().
+      // Returned value:
+      //    None.
+
+   void release(int index);
+
+      // Functionality:
+      //    Record that a stripe has been written.
+      // Parameters:
+      //    0) [in] index: stripe index from take().
+      // Returned value:
+      //    None.
+
+   void complete(int index);
+
+      // Functionality:
+      //    Check if every stripe has been written.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    true if the transfer is complete.
+
+   bool finished();
+
+      // Functionality:
+      //    Close the log, and delete it when the transfer is complete.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void close();
+
+private:
+   int64_t m_llSize;                    // file size
+   int64_t m_llStripe;                  // stripe size
+   int m_iStripes;                      // number of stripes
+   int m_iDone;                         // number of stripes written
+   int m_iTaken;                        // number of stripes being transferred
+   int m_iNext;                         // lowest stripe that may still be free
+   std::vector<char> m_vState;          // per stripe: 0 free, 1 taken, 2 done
+
+   std::string m_strPath;               // manifest file, empty for none
+   FILE* m_pLog;                        // append-only log of the stripes done
+
+   pthread_mutex_t m_Lock;
+   pthread_cond_t m_Cond;               // signalled when a stripe is done or given back
+};
+
+class CStripedFile
+{
+public:
+
+      // Functionality:
+      //    Serve the stripe requests of a receiver over all the connections, until each of them is finished or fails.
+      // Parameters:
+      //    0) [in] socks: connections to the receiver.
+      //    1) [in] num: number of connections.
+      //    2) [in] path: file to send.
+      //    3) [in] block: size of block per read from disk.
+      // Returned value:
+      //    bytes sent; an exception is thrown if the file cannot be opened or no connection finished.
+
+   static int64_t send(const UDTSOCKET* socks, int num, const char* path, int block);
+
+      // Functionality:
+      //    Receive a file over all the connections, each asking for stripes until none are left.
+      //    A connection that fails hands its stripes to the others.
+      // Parameters:
+      //    0) [in] socks: connections to the sender.
+      //    1) [in] num: number of connections.
+      //    2) [in] path: file to write; it is set to "size" bytes and written in place.
+      //    3) [in] size: file size.
+      //    4) [in] manifest: log of the stripes written, to resume an interrupted transfer; NULL for none.
+      //    5) [in] stripe: stripe size, rounded up to whole 4096-byte pages.
+      //    6) [in] block: size of block per write to disk.
+      // Returned value:
+      //    bytes received by this call; an exception is thrown unless the file is complete.
+
+   static int64_t recv(const UDTSOCKET* socks, int num, const char* path, int64_t size, const char* manifest, int64_t stripe, int block);
+};
+
+
+#endif
@@ -151,7 +151,34 @@ enum UDTOpt
    UDT_STATE,		// current socket state, see UDTSTATUS, read only
    UDT_EVENT,		// current avalable events associated with the socket
    UDT_SNDDATA,		// size of data in the sending buffer
-   UDT_RCVDATA		// size of data available for recv
+   UDT_RCVDATA,		// size of data available for recv
+   UDT_SACK,		// use selective acknowledgement blocks if the peer supports them
+   UDT_REORDER,		// maximum reorder window (in packets) before a sequence gap is reported as loss
+   UDT_FEC,		// number of data packets protected by one XOR parity packet, 0 to disable
+   UDT_PMTUD,		// find the largest packet size the path carries, up to UDT_MSS
+   UDT_CCALGO,		// built-in congestion control algorithm, see UDTCCAlgo
+   UDT_COALESCE,	// pack small messages into shared packets, waiting at most this many microseconds; -1 to disable
+   UDT_LOWLATENCY,	// send the first packet of a write from the calling thread when the connection is idle
+   UDT_BUSYPOLL,	// spin this many microseconds on receives instead of sleeping, per multiplexer; 0 to disable
+   UDT_POLLCPU,		// CPU to pin the receiving thread of the multiplexer to, -1 for none
+   UDT_CPUMASK,		// CPUs (bit i for CPU i) the threads of the multiplexer run on, 0 for any
+   UDT_NUMANODE,	// NUMA node the packet buffers are allocated on, -1 for any
+   UDT_WORKERPOOL,	// serve the multiplexer from a pool of this many threads shared by all multiplexers, 0 for threads of its own
+   // A resumption token lets one connection skip the cookie round trip, and only with the listener that issued it:
+   // each token is accepted once, for 10 minutes, and is bound to the client's IP address, not its port. A
+   // listener remembers up to 16384 used tokens and resumes no connection while that many are unexpired.
+   UDT_RESUME,		// a listener issues resumption tokens, so that a client connecting again skips the cookie round trip
+   UDT_DIRECTIO,	// sendfile2/recvfile2 bypass the page cache: received data is written with O_DIRECT, sent pages are dropped
+   UDT_STREAMWND	// receiving window of each stream carried by a SOCK_DGRAM connection, in bytes
+};
+
+enum UDTCCAlgo
+{
+   UDT_CCALGO_CUSTOM = -1,	// a factory installed through UDT_CC, read only
+   UDT_CCALGO_DAIMD,		// native UDT rate control (CUDTCC), the default
+   UDT_CCALGO_BBR,		// bottleneck bandwidth and RTT model (CBBRCC)
+   UDT_CCALGO_CUBIC,		// TCP friendly cubic window growth (CCUBICCC)
+   UDT_CCALGO_LEDBAT		// low extra delay background transport, yields to other traffic (CLEDBATCC)
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -194,6 +221,58 @@ struct CPerfMon
    double mbpsBandwidth;                // estimated bandwidth, in Mb/s
    int byteAvailSndBuf;                 // available UDT sender buffer size
    int byteAvailRcvBuf;                 // available UDT receiver buffer size
+
+   // later measurements, kept after the fields above so that their offsets do not change
+
+   // global measurements
+   int pktRcvSpuriousTotal;             // total number of duplicate packets received (spurious retransmissions)
+   int pktSentParityTotal;              // total number of sent FEC parity packets
+   int pktRecvParityTotal;              // total number of received FEC parity packets
+   int pktRcvRecoveredTotal;            // total number of data packets rebuilt from FEC parity
+   int64_t pktSentCtrlTotal;            // total number of sent control packets of all types
+   int64_t pktRecvCtrlTotal;            // total number of received control packets of all types
+   int64_t msgSentTotal;                // total number of messages handed to sendmsg
+   int64_t msgRecvTotal;                // total number of messages delivered by recvmsg/recvlend
+
+   // local measurements
+   int pktRcvSpurious;                  // number of duplicate packets received (spurious retransmissions)
+   int pktSentParity;                   // number of sent FEC parity packets
+   int pktRecvParity;                   // number of received FEC parity packets
+   int pktRcvRecovered;                 // number of data packets rebuilt from FEC parity
+   int64_t pktSentCtrl;                 // number of sent control packets of all types
+   int64_t pktRecvCtrl;                 // number of received control packets of all types
+   double msgpsSendRate;                // messages handed to sendmsg per second
+   double msgpsRecvRate;                // messages delivered to the application per second
+   double bytePktPayload;               // average payload of the sent data packets, in bytes
+
+   // instant measurements
+   int pktReorderTolerance;             // current reorder window before a gap is reported as loss, in packets
+   int pktLightACKInterval;             // current number of data packets between two light ACKs
+   int byteMSS;                         // current packet size used on the path, including the IP/UDP headers
+   int ccPhase;                         // phase of the congestion control, algorithm specific, 0 is slow start
+   int pktSlowStartThreshold;           // congestion window at which slow start ends, in number of packets
+   int pktMaxWindow;                    // congestion window before the last reduction, in number of packets
+   double msQueuingDelay;               // queuing delay seen by the congestion control, in milliseconds
+   double mbpsModelBandwidth;           // bottleneck bandwidth in the congestion control model, in Mb/s
+   int64_t byteMemUsed;                 // memory held by the buffers, loss lists and ACK history of the connection, in bytes
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct CRcvSlice
+{
+   char* data;                          // payload inside the UDT receiver buffer, valid until released
+   int len;                             // size of the payload, in bytes
+   void* handle;                        // opaque reference to the lent unit, must be passed back to recvrelease
+   int loan;                            // loan number of the unit, passed back untouched with the handle
+                                        // release each slice once: a stale loan is ignored, but a slice released twice
+                                        // while other messages packed in its unit are still out is undefined
+};
+
+struct CIOVec
+{
+   char* data;                          // start of the segment
+   int len;                             // size of the segment, in bytes
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -203,6 +282,7 @@ class UDT_API CUDTException
 public:
    CUDTException(int major = 0, int minor = 0, int err = -1);
    CUDTException(const CUDTException& e);
+   CUDTException& operator=(const CUDTException& e);
    virtual ~CUDTException();
 
       // Functionality:
@@ -260,6 +340,7 @@ public: // Error Code
    static const int ECONNFAIL;
    static const int ECONNLOST;
    static const int ENOCONN;
+   static const int ESTREAMRESET;
    static const int ERESOURCE;
    static const int ETHREAD;
    static const int ENOBUF;
@@ -282,6 +363,8 @@ public: // Error Code
    static const int EDUPLISTEN;
    static const int ELARGEMSG;
    static const int EINVPOLLID;
+   static const int EMUXSOCK;
+   static const int EINVSTREAM;
    static const int EASYNCFAIL;
    static const int EASYNCSND;
    static const int EASYNCRCV;
@@ -303,6 +386,8 @@ namespace UDT
 typedef CUDTException ERRORINFO;
 typedef UDTOpt SOCKOPT;
 typedef CPerfMon TRACEINFO;
+typedef CRcvSlice RCVSLICE;
+typedef CIOVec IOVEC;
 typedef ud_set UDSET;
 
 UDT_API extern const UDTSOCKET INVALID_SOCK;
@@ -316,7 +401,10 @@ UDT_API int bind(UDTSOCKET u, const struct sockaddr* name, int namelen);
 UDT_API int bind2(UDTSOCKET u, UDPSOCKET udpsock);
 UDT_API int listen(UDTSOCKET u, int backlog);
 UDT_API UDTSOCKET accept(UDTSOCKET u, struct sockaddr* addr, int* addrlen);
+UDT_API int acceptmany(UDTSOCKET u, UDTSOCKET* socks, int num);
 UDT_API int connect(UDTSOCKET u, const struct sockaddr* name, int namelen);
+UDT_API int connect(UDTSOCKET u, const struct sockaddr* name, int namelen, const char* buf, int len);
+UDT_API int connectmany(const UDTSOCKET* socks, const struct sockaddr* names, int namelen, int num);
 UDT_API int close(UDTSOCKET u);
 UDT_API int getpeername(UDTSOCKET u, struct sockaddr* name, int* namelen);
 UDT_API int getsockname(UDTSOCKET u, struct sockaddr* name, int* namelen);
@@ -326,10 +414,31 @@ UDT_API int send(UDTSOCKET u, const char* buf, int len, int flags);
 UDT_API int recv(UDTSOCKET u, char* buf, int len, int flags);
 UDT_API int sendmsg(UDTSOCKET u, const char* buf, int len, int ttl = -1, bool inorder = false);
 UDT_API int recvmsg(UDTSOCKET u, char* buf, int len);
+UDT_API int sendv(UDTSOCKET u, const IOVEC* iov, int num, int flags);
+UDT_API int recvv(UDTSOCKET u, const IOVEC* iov, int num, int flags);
+UDT_API int sendmsgv(UDTSOCKET u, const IOVEC* iov, int num, int ttl = -1, bool inorder = false);
+UDT_API int recvmsgv(UDTSOCKET u, const IOVEC* iov, int num);
+UDT_API int recvlend(UDTSOCKET u, RCVSLICE* slices, int num);
+UDT_API int recvrelease(UDTSOCKET u, const RCVSLICE* slices, int num);
 UDT_API int64_t sendfile(UDTSOCKET u, std::fstream& ifs, int64_t& offset, int64_t size, int block = 364000);
 UDT_API int64_t recvfile(UDTSOCKET u, std::fstream& ofs, int64_t& offset, int64_t size, int block = 7280000);
 UDT_API int64_t sendfile2(UDTSOCKET u, const char* path, int64_t* offset, int64_t size, int block = 364000);
 UDT_API int64_t recvfile2(UDTSOCKET u, const char* path, int64_t* offset, int64_t size, int block = 7280000);
+#ifndef WIN32
+UDT_API int64_t sendfilefd(UDTSOCKET u, int fd, int64_t* offset, int64_t size, int block = 364000);
+UDT_API int64_t recvfilefd(UDTSOCKET u, int fd, int64_t* offset, int64_t size, int block = 7280000);
+#endif
+UDT_API int64_t sendfilestriped(const UDTSOCKET* socks, int num, const char* path, int block = 364000);
+UDT_API int64_t recvfilestriped(const UDTSOCKET* socks, int num, const char* path, int64_t size, const char* manifest = NULL, int64_t stripe = 67108864, int block = 7280000);
+
+// independent streams inside one SOCK_DGRAM connection, sharing its congestion control;
+// once they are used the connection carries nothing else, so sendmsg/recvmsg fail on it.
+// The stream calls block, up to UDT_SNDTIMEO/UDT_RCVTIMEO, and need a blocking socket; epoll does not report streams.
+UDT_API int openstream(UDTSOCKET u);
+UDT_API int acceptstream(UDTSOCKET u);
+UDT_API int sendstream(UDTSOCKET u, int stream, const char* buf, int len);
+UDT_API int recvstream(UDTSOCKET u, int stream, char* buf, int len);
+UDT_API int closestream(UDTSOCKET u, int stream);
 
 // select and selectEX are DEPRECATED; please use epoll. 
 UDT_API int select(int nfds, UDSET* readfds, UDSET* writefds, UDSET* exceptfds, const struct timeval* timeout);
@@ -351,6 +460,8 @@ UDT_API int getlasterror_code();
 UDT_API const char* getlasterror_desc();
 UDT_API int perfmon(UDTSOCKET u, TRACEINFO* perf, bool clear = true);
 UDT_API UDTSTATUS getsockstate(UDTSOCKET u);
+UDT_API int savecache(const char* path);
+UDT_API int loadcache(const char* path);
 
 }  // namespace UDT
 
@@ -50,14 +50,10 @@ m_piACKSeqNo(NULL),
 m_piACK(NULL),
 m_pTimeStamp(NULL),
 m_iSize(size),
+m_iCapacity(0),
 m_iHead(0),
 m_iTail(0)
 {
-   m_piACKSeqNo = new int32_t[m_iSize];
-   m_piACK = new int32_t[m_iSize];
-   m_pTimeStamp = new uint64_t[m_iSize];
-
-   m_piACKSeqNo[0] = -1;
 }
 
 CACKWindow::~CACKWindow()
@@ -69,19 +65,113 @@ CACKWindow::~CACKWindow()
 
 void CACKWindow::store(int32_t seq, int32_t ack)
 {
+   if (0 == m_iCapacity)
+   {
+      try
+      {
+         increase();
+      }
+      catch (...)
+      {
+         return;
+      }
+   }
+
    m_piACKSeqNo[m_iHead] = seq;
    m_piACK[m_iHead] = ack;
    m_pTimeStamp[m_iHead] = CTimer::getTime();
 
-   m_iHead = (m_iHead + 1) % m_iSize;
+   m_iHead = (m_iHead + 1) % m_iCapacity;
 
-   // overwrite the oldest ACK since it is not likely to be acknowledged
    if (m_iHead == m_iTail)
-      m_iTail = (m_iTail + 1) % m_iSize;
+   {
+      // the window is full; grow it while it is smaller than its size,
+      // otherwise overwrite the oldest ACK since it is not likely to be acknowledged
+      try
+      {
+         if (m_iCapacity < m_iSize)
+            increase();
+         else
+            m_iTail = (m_iTail + 1) % m_iCapacity;
+      }
+      catch (...)
+      {
+         m_iTail = (m_iTail + 1) % m_iCapacity;
+      }
+   }
+}
+
+void CACKWindow::release()
+{
+   delete [] m_piACKSeqNo;
+   delete [] m_piACK;
+   delete [] m_pTimeStamp;
+   m_piACKSeqNo = NULL;
+   m_piACK = NULL;
+   m_pTimeStamp = NULL;
+
+   m_iCapacity = 0;
+   m_iHead = m_iTail = 0;
+}
+
+int CACKWindow::getMemSize() const
+{
+   return m_iCapacity * (2 * sizeof(int32_t) + sizeof(uint64_t));
+}
+
+void CACKWindow::increase()
+{
+   // most connections have a few ACKs waiting for their ACK-2 at a time
+   int capacity = (0 == m_iCapacity) ? 16 : m_iCapacity * 2;
+   if (capacity > m_iSize)
+      capacity = m_iSize;
+
+   int32_t* seqno = new int32_t[capacity];
+   int32_t* ack = NULL;
+   uint64_t* ts = NULL;
+   try
+   {
+      ack = new int32_t[capacity];
+      ts = new uint64_t[capacity];
+   }
+   catch (...)
+   {
+      delete [] seqno;
+      delete [] ack;
+      throw;
+   }
+
+   // the records, oldest first; only called when the window is empty or full
+   int n = 0;
+   if (m_iCapacity > 0)
+   {
+      for (int i = m_iTail; n < m_iCapacity; i = (i + 1) % m_iCapacity, ++ n)
+      {
+         seqno[n] = m_piACKSeqNo[i];
+         ack[n] = m_piACK[i];
+         ts[n] = m_pTimeStamp[i];
+      }
+   }
+   else
+      seqno[0] = -1;
+
+   delete [] m_piACKSeqNo;
+   delete [] m_piACK;
+   delete [] m_pTimeStamp;
+   m_piACKSeqNo = seqno;
+   m_piACK = ack;
+   m_pTimeStamp = ts;
+
+   m_iCapacity = capacity;
+   m_iTail = 0;
+   m_iHead = n % m_iCapacity;
 }
 
 int CACKWindow::acknowledge(int32_t seq, int32_t& ack)
 {
+   if (0 == m_iCapacity)
+      return -1;
+
    if (m_iHead >= m_iTail)
    {
       // Head has not exceeded the physical boundary of the window
@@ -103,7 +193,7 @@ int CACKWindow::acknowledge(int32_t seq, int32_t& ack)
                m_piACKSeqNo[0] = -1;
             }
             else
-               m_iTail = (i + 1) % m_iSize;
+               m_iTail = (i + 1) % m_iCapacity;
 
             return rtt;
          }
@@ -114,13 +204,13 @@ int CACKWindow::acknowledge(int32_t seq, int32_t& ack)
    }
 
    // Head has exceeded the physical window boundary, so it is behind tail
-   for (int j = m_iTail, n = m_iHead + m_iSize; j < n; ++ j)
+   for (int j = m_iTail, n = m_iHead + m_iCapacity; j < n; ++ j)
    {
       // looking for indentical ACK seq. no.
-      if (seq == m_piACKSeqNo[j % m_iSize])
+      if (seq == m_piACKSeqNo[j % m_iCapacity])
       {
          // return Data ACK
-         j %= m_iSize;
+         j %= m_iCapacity;
          ack = m_piACK[j];
 
          // calculate RTT
@@ -132,7 +222,7 @@ int CACKWindow::acknowledge(int32_t seq, int32_t& ack)
             m_piACKSeqNo[0] = -1;
          }
          else
-            m_iTail = (j + 1) % m_iSize;
+            m_iTail = (j + 1) % m_iCapacity;
 
          return rtt;
       }
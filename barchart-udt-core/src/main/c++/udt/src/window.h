@@ -75,12 +75,34 @@ public:
 
    int acknowledge(int32_t seq, int32_t& ack);
 
+      // Functionality:
+      //    Forget all ACK records and free the window; it is allocated again by the next store().
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    None.
+
+   void release();
+
+      // Functionality:
+      //    Query the memory held by the window.
+      // Parameters:
+      //    None.
+      // Returned value:
+      //    size of the ACK records, in bytes.
+
+   int getMemSize() const;
+
+private:
+   void increase();
+
 private:
    int32_t* m_piACKSeqNo;       // Seq. No. for the ACK packet
    int32_t* m_piACK;            // Data Seq. No. carried by the ACK packet
    uint64_t* m_pTimeStamp;      // The timestamp when the ACK was sent
 
    int m_iSize;                 // Size of the ACK history window
+   int m_iCapacity;             // Number of records allocated, grows up to m_iSize; 0: not allocated
    int m_iHead;                 // Pointer to the lastest ACK record
    int m_iTail;                 // Pointer to the oldest ACK record
 
@@ -39,6 +39,9 @@ public class CCC {
 
 	protected native void setACKInterval(final int pktINT);
 
+	protected native void setLightACKRange(final int minPktINT,
+			final int maxPktINT);
+
 	protected native void setRTO(final int usRTO);
 
 	protected native void setPacketSndPeriod(final double sndPeriod);
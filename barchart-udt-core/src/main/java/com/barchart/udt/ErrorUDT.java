@@ -33,6 +33,8 @@ public enum ErrorUDT {
 
 	ENOCONN(2002, "connection does not exist"), //
 
+	ESTREAMRESET(2003, "peer stopped reading the stream"), //
+
 	ERESOURCE(3000, "system resource failure"), //
 
 	ETHREAD(3001, "could not create new thread"), //
@@ -80,6 +82,10 @@ public enum ErrorUDT {
 
 	EINVPOLLID(5013, "epoll ID is invalid"), //
 
+	EMUXSOCK(5014, "operation not supported on a socket carrying streams"), //
+
+	EINVSTREAM(5015, "stream ID is invalid"), //
+
 	EASYNCFAIL(6000, "non-blocking call failure"), //
 
 	EASYNCSND(6001, "no buffer available for sending"), //
@@ -117,6 +117,60 @@ public class MonitorUDT {
 		return pktRecvNAKTotal;
 	}
 
+	/**
+	 * total number of duplicate packets received (spurious retransmissions)
+	 */
+	protected volatile int pktRcvSpuriousTotal;
+
+	public int globalReceivedSpuriousTotal() {
+		return pktRcvSpuriousTotal;
+	}
+
+	/**
+	 * total number of sent FEC parity packets
+	 */
+	protected volatile int pktSentParityTotal;
+
+	public int globalSentParityTotal() {
+		return pktSentParityTotal;
+	}
+
+	/**
+	 * total number of received FEC parity packets
+	 */
+	protected volatile int pktRecvParityTotal;
+
+	public int globalReceivedParityTotal() {
+		return pktRecvParityTotal;
+	}
+
+	/**
+	 * total number of data packets rebuilt from FEC parity
+	 */
+	protected volatile int pktRcvRecoveredTotal;
+
+	public int globalReceivedRecoveredTotal() {
+		return pktRcvRecoveredTotal;
+	}
+
+	/**
+	 * total number of sent control packets of all types
+	 */
+	protected volatile long pktSentCtrlTotal;
+
+	public long globalSentControlTotal() {
+		return pktSentCtrlTotal;
+	}
+
+	/**
+	 * total number of received control packets of all types
+	 */
+	protected volatile long pktRecvCtrlTotal;
+
+	public long globalReceivedControlTotal() {
+		return pktRecvCtrlTotal;
+	}
+
 	/**
 	 * total time duration when UDT is sending data (idle time exclusive)
 	 */
@@ -126,6 +180,24 @@ public class MonitorUDT {
 		return usSndDurationTotal;
 	}
 
+	/**
+	 * total number of messages handed to sendmsg
+	 */
+	protected volatile long msgSentTotal;
+
+	public long globalSentMessageTotal() {
+		return msgSentTotal;
+	}
+
+	/**
+	 * total number of messages delivered by recvmsg/recvlend
+	 */
+	protected volatile long msgRecvTotal;
+
+	public long globalReceivedMessageTotal() {
+		return msgRecvTotal;
+	}
+
 	// ### local measurements
 
 	/**
@@ -209,6 +281,60 @@ public class MonitorUDT {
 		return pktRecvNAK;
 	}
 
+	/**
+	 * number of duplicate packets received (spurious retransmissions)
+	 */
+	protected volatile int pktRcvSpurious;
+
+	public int localReceivedSpurious() {
+		return pktRcvSpurious;
+	}
+
+	/**
+	 * number of sent FEC parity packets
+	 */
+	protected volatile int pktSentParity;
+
+	public int localSentParity() {
+		return pktSentParity;
+	}
+
+	/**
+	 * number of received FEC parity packets
+	 */
+	protected volatile int pktRecvParity;
+
+	public int localReceivedParity() {
+		return pktRecvParity;
+	}
+
+	/**
+	 * number of data packets rebuilt from FEC parity
+	 */
+	protected volatile int pktRcvRecovered;
+
+	public int localReceivedRecovered() {
+		return pktRcvRecovered;
+	}
+
+	/**
+	 * number of sent control packets of all types
+	 */
+	protected volatile long pktSentCtrl;
+
+	public long localSentControl() {
+		return pktSentCtrl;
+	}
+
+	/**
+	 * number of received control packets of all types
+	 */
+	protected volatile long pktRecvCtrl;
+
+	public long localReceivedControl() {
+		return pktRecvCtrl;
+	}
+
 	/**
 	 * sending rate in Mb/s
 	 */
@@ -227,6 +353,33 @@ public class MonitorUDT {
 		return mbpsRecvRate;
 	}
 
+	/**
+	 * messages handed to sendmsg per second
+	 */
+	protected volatile double msgpsSendRate;
+
+	public double messagesPerSecondSendRate() {
+		return msgpsSendRate;
+	}
+
+	/**
+	 * messages delivered to the application per second
+	 */
+	protected volatile double msgpsRecvRate;
+
+	public double messagesPerSecondReceiveRate() {
+		return msgpsRecvRate;
+	}
+
+	/**
+	 * average payload of the sent data packets, in bytes
+	 */
+	protected volatile double bytePktPayload;
+
+	public double bytesPayloadPerPacket() {
+		return bytePktPayload;
+	}
+
 	/**
 	 * busy sending time (i.e., idle time exclusive)
 	 */
@@ -310,6 +463,88 @@ public class MonitorUDT {
 		return byteAvailRcvBuf;
 	}
 
+	/**
+	 * current reorder window before a gap is reported as loss, in packets
+	 */
+	protected volatile int pktReorderTolerance;
+
+	public int currentReorderTolerance() {
+		return pktReorderTolerance;
+	}
+
+	/**
+	 * current number of data packets between two light ACKs
+	 */
+	protected volatile int pktLightACKInterval;
+
+	public int currentLightACKInterval() {
+		return pktLightACKInterval;
+	}
+
+	/**
+	 * current packet size used on the path, including the IP/UDP headers
+	 */
+	protected volatile int byteMSS;
+
+	public int currentMaximumSegmentSize() {
+		return byteMSS;
+	}
+
+	/**
+	 * phase of the congestion control, algorithm specific, 0 is slow start
+	 */
+	protected volatile int ccPhase;
+
+	public int currentCongestionControlPhase() {
+		return ccPhase;
+	}
+
+	/**
+	 * congestion window at which slow start ends, in number of packets
+	 */
+	protected volatile int pktSlowStartThreshold;
+
+	public int currentSlowStartThreshold() {
+		return pktSlowStartThreshold;
+	}
+
+	/**
+	 * congestion window before the last reduction, in number of packets
+	 */
+	protected volatile int pktMaxWindow;
+
+	public int currentMaxWindow() {
+		return pktMaxWindow;
+	}
+
+	/**
+	 * queuing delay seen by the congestion control, in milliseconds
+	 */
+	protected volatile double msQueuingDelay;
+
+	public double currentMillisQueuingDelay() {
+		return msQueuingDelay;
+	}
+
+	/**
+	 * bottleneck bandwidth in the congestion control model, in Mb/s
+	 */
+	protected volatile double mbpsModelBandwidth;
+
+	public double currentMbpsModelBandwidth() {
+		return mbpsModelBandwidth;
+	}
+
+	/**
+	 * memory held by the buffers, loss lists and ACK history of the
+	 * connection, in bytes; an idle connection frees most of it
+	 */
+	protected volatile long byteMemUsed;
+
+	public long currentBytesMemoryUsed() {
+		return byteMemUsed;
+	}
+
 	/**
 	 * current monitor status snapshot for all parameters
 	 */
@@ -46,7 +46,12 @@ import com.barchart.udt.util.HelpUDT;
  * UDT_STATE, // current socket state, see UDTSTATUS, read only
  * UDT_EVENT, // current avalable events associated with the socket
  * UDT_SNDDATA, // size of data in the sending buffer
- * UDT_RCVDATA // size of data available for recv
+ * UDT_RCVDATA, // size of data available for recv
+ * UDT_SACK, // use selective acknowledgement blocks if the peer supports them
+ * UDT_REORDER, // maximum reorder window (in packets) before a sequence gap is reported as loss
+ * UDT_FEC, // number of data packets protected by one XOR parity packet, 0 to disable
+ * UDT_PMTUD, // find the largest packet size the path carries, up to UDT_MSS
+ * UDT_CCALGO // built-in congestion control algorithm, see UDTCCAlgo
  * </pre>
  */
 public class OptionUDT<T> {
@@ -197,6 +202,111 @@ public class OptionUDT<T> {
 	public static final OptionUDT<Integer> Receive_Buffer_Available = //
 	NEW(20, Integer.class, DECIMAL);
 
+	/** use selective acknowledgement blocks if the peer supports them */
+	public static final OptionUDT<Boolean> UDT_SACK = //
+	NEW(21, Boolean.class, BOOLEAN);
+	/** report received ranges above the ACK, so a timeout does not resend them. true/false */
+	public static final OptionUDT<Boolean> Is_Selective_Ack_Enabled = //
+	NEW(21, Boolean.class, BOOLEAN);
+
+	/** maximum reorder window (in packets) before a sequence gap is reported as loss */
+	public static final OptionUDT<Integer> UDT_REORDER = //
+	NEW(22, Integer.class, DECIMAL);
+	/** how many later packets may arrive before a gap is reported as loss; 0 reports at once */
+	public static final OptionUDT<Integer> Maximum_Reorder_Window = //
+	NEW(22, Integer.class, DECIMAL);
+
+	/** number of data packets protected by one XOR parity packet, 0 to disable */
+	public static final OptionUDT<Integer> UDT_FEC = //
+	NEW(23, Integer.class, DECIMAL);
+	/** send one parity packet per this many data packets (1 - 64), so that a single loss can be rebuilt; 0 turns it off */
+	public static final OptionUDT<Integer> Forward_Error_Correction_Group = //
+	NEW(23, Integer.class, DECIMAL);
+
+	/** find the largest packet size the path carries, up to UDT_MSS */
+	public static final OptionUDT<Boolean> UDT_PMTUD = //
+	NEW(24, Boolean.class, BOOLEAN);
+	/** find the largest packet the path carries, up to the maximum segment size, and use it. true/false */
+	public static final OptionUDT<Boolean> Is_Path_MTU_Discovery_Enabled = //
+	NEW(24, Boolean.class, BOOLEAN);
+
+	/** built-in congestion control algorithm, see UDTCCAlgo; -1 when a factory is installed, read only */
+	public static final OptionUDT<Integer> UDT_CCALGO = //
+	NEW(25, Integer.class, DECIMAL);
+	/** 0 for the native UDT rate control, 1 for the BBR bandwidth and RTT model, 2 for CUBIC, 3 for LEDBAT background transfer; set before connecting */
+	public static final OptionUDT<Integer> Congestion_Control_Algorithm = //
+	NEW(25, Integer.class, DECIMAL);
+
+	/** pack small messages into shared packets, waiting at most this many microseconds; -1 to disable */
+	public static final OptionUDT<Integer> UDT_COALESCE = //
+	NEW(26, Integer.class, DECIMAL);
+	/** longest time in microseconds a small message waits for others to fill its packet, 0 packs only while the sender is busy, -1 sends each message alone; message sockets only, set before connecting */
+	public static final OptionUDT<Integer> Message_Coalescing_Delay = //
+	NEW(26, Integer.class, DECIMAL);
+
+	/** send the first packet of a write from the calling thread when the connection is idle */
+	public static final OptionUDT<Boolean> UDT_LOWLATENCY = //
+	NEW(27, Boolean.class, BOOLEAN);
+	/** an idle connection sends the first packet of each write from the calling thread instead of handing it to the sending thread, trading some throughput for latency. true/false */
+	public static final OptionUDT<Boolean> Is_Low_Latency_Send_Enabled = //
+	NEW(27, Boolean.class, BOOLEAN);
+
+	/** spin this many microseconds on receives instead of sleeping, per multiplexer; 0 to disable */
+	public static final OptionUDT<Integer> UDT_BUSYPOLL = //
+	NEW(28, Integer.class, DECIMAL);
+	/** the receiving thread of the port never sleeps, and blocking reads spin this many microseconds before they do; costs a CPU core per port, 0 turns it off; set before binding */
+	public static final OptionUDT<Integer> Busy_Poll_Time = //
+	NEW(28, Integer.class, DECIMAL);
+
+	/** CPU to pin the receiving thread of the multiplexer to, -1 for none */
+	public static final OptionUDT<Integer> UDT_POLLCPU = //
+	NEW(29, Integer.class, DECIMAL);
+	/** CPU number the receiving thread of a new port is pinned to, -1 leaves it to the scheduler; Linux and Windows only, set before binding */
+	public static final OptionUDT<Integer> Receive_Thread_CPU = //
+	NEW(29, Integer.class, DECIMAL);
+
+	/** CPUs (bit i for CPU i) the threads of the multiplexer run on, 0 for any */
+	public static final OptionUDT<Long> UDT_CPUMASK = //
+	NEW(30, Long.class, HEXADECIMAL);
+	/** bit mask of the CPUs the sending and receiving threads of a new port may run on, bit i for CPU i, 0 for any; Linux and Windows only, set before binding */
+	public static final OptionUDT<Long> Worker_Thread_CPU_Mask = //
+	NEW(30, Long.class, HEXADECIMAL);
+
+	/** NUMA node the packet buffers are allocated on, -1 for any */
+	public static final OptionUDT<Integer> UDT_NUMANODE = //
+	NEW(31, Integer.class, DECIMAL);
+	/** NUMA node that holds the packet buffers of a new port and of its connections, best matched with a CPU mask of the same node; -1 for any; Linux only, set before binding */
+	public static final OptionUDT<Integer> Buffer_NUMA_Node = //
+	NEW(31, Integer.class, DECIMAL);
+
+	/** serve the multiplexer from a pool of this many threads shared by all multiplexers, 0 for threads of its own */
+	public static final OptionUDT<Integer> UDT_WORKERPOOL = //
+	NEW(32, Integer.class, DECIMAL);
+	/** number of threads shared by all ports that set it, 0 gives a new port its own sending and receiving threads; the first port to use the pool sets its size; ignored with busy polling; Linux only, set before binding */
+	public static final OptionUDT<Integer> Worker_Pool_Threads = //
+	NEW(32, Integer.class, DECIMAL);
+
+	/** a listener issues resumption tokens, so that a client connecting again skips the cookie round trip */
+	public static final OptionUDT<Boolean> UDT_RESUME = //
+	NEW(33, Boolean.class, BOOLEAN);
+	/** a listening socket gives each client a token that lets its next connection from the same host skip the cookie round trip, for 10 minutes; each token resumes one connection. true/false */
+	public static final OptionUDT<Boolean> Is_Resumption_Enabled = //
+	NEW(33, Boolean.class, BOOLEAN);
+
+	/** sendfile2/recvfile2 bypass the page cache: received data is written with O_DIRECT, sent pages are dropped */
+	public static final OptionUDT<Boolean> UDT_DIRECTIO = //
+	NEW(34, Boolean.class, BOOLEAN);
+	/** file transfers keep the page cache clear: {@link SocketUDT#receiveFile} writes the file with O_DIRECT where the file system allows it, {@link SocketUDT#sendFile} drops the pages it has sent; Linux only. true/false */
+	public static final OptionUDT<Boolean> Is_Direct_File_IO_Enabled = //
+	NEW(34, Boolean.class, BOOLEAN);
+
+	/** receiving window of each stream carried by a SOCK_DGRAM connection, in bytes */
+	public static final OptionUDT<Integer> UDT_STREAMWND = //
+	NEW(35, Integer.class, DECIMAL);
+	/** bytes of a stream, see {@link SocketUDT#openStream()}, that may be on their way or waiting to be read; set before the first stream is opened or accepted, at least 65536 (default 1048576); a smaller window lets the other streams of the connection pass a busy one sooner */
+	public static final OptionUDT<Integer> Stream_Window_Size = //
+	NEW(35, Integer.class, DECIMAL);
+
 	//
 
 	protected OptionUDT(final int code, final Class<T> klaz, final Format format) {
@@ -307,6 +417,17 @@ public class OptionUDT<T> {
 			}
 		}, //
 
+		HEXADECIMAL() {
+			@Override
+			public String convert(final Object value) {
+				if (value instanceof Number) {
+					final long number = ((Number) value).longValue();
+					return String.format("0x%x", number);
+				}
+				return "invalid format";
+			}
+		}, //
+
 		BOOLEAN() {
 			@Override
 			public String convert(final Object value) {
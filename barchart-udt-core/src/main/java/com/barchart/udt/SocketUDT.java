@@ -247,6 +247,24 @@ public class SocketUDT {
 	 */
 	protected static native void initClass0() throws ExceptionUDT;
 
+	/**
+	 * Load a network information cache file written by
+	 * {@link #saveCache(String)}, typically right after a restart, so that new
+	 * connections to known peers start from their last RTT and sending rate
+	 * instead of a cold start.
+	 * 
+	 * @return number of peer entries loaded
+	 */
+	public static int loadCache(final String path) throws ExceptionUDT {
+		return loadCache0(path);
+	}
+
+	/**
+	 * @see #loadCache(String)
+	 */
+	protected static native int loadCache0(final String path)
+			throws ExceptionUDT;
+
 	/**
 	 * receive into a complete byte array
 	 * 
@@ -293,6 +311,27 @@ public class SocketUDT {
 			final int limit //
 	) throws ExceptionUDT;
 
+	/**
+	 * receive into a sequence of {@link java.nio.channels.DirectByteBuffer},
+	 * filling each before the next; in message mode one message is spread
+	 * over the buffers
+	 * 
+	 * @param bounds
+	 *            position and limit of each buffer in the sequence, in pairs
+	 * @see <a
+	 *      href="http://udt.sourceforge.net/udt4/doc/recv.htm">UDT::recv()</a>
+	 * @see <a
+	 *      href="http://udt.sourceforge.net/udt4/doc/recv.htm">UDT::recvmsg()</a>
+	 */
+	protected static native int receive3( //
+			final int socketID, //
+			final int socketType, //
+			final ByteBuffer[] buffers, //
+			final int offset, //
+			final int length, //
+			final int[] bounds //
+	) throws ExceptionUDT;
+
 	/**
 	 * Receive file.
 	 * 
@@ -307,6 +346,36 @@ public class SocketUDT {
 			int block //
 	) throws ExceptionUDT;
 
+	/**
+	 * receive stream data into {@link java.nio.channels.DirectByteBuffer}
+	 * 
+	 * @see #receiveStream(int, ByteBuffer)
+	 */
+	protected static native int receiveStream0( //
+			final int socketID, //
+			final int streamID, //
+			final ByteBuffer buffer, //
+			final int position, //
+			final int limit //
+	) throws ExceptionUDT;
+
+	/**
+	 * Write the network information cache, RTT, bandwidth and the last sending
+	 * rate per peer address, to a memory mapped file; the file is replaced
+	 * atomically.
+	 * 
+	 * @return number of peer entries written
+	 */
+	public static int saveCache(final String path) throws ExceptionUDT {
+		return saveCache0(path);
+	}
+
+	/**
+	 * @see #saveCache(String)
+	 */
+	protected static native int saveCache0(final String path)
+			throws ExceptionUDT;
+
 	/**
 	 * Basic access to UDT socket readiness selection feature. Based on
 	 * {@link java.nio.DirectIntBuffer} info exchange.Timeout is in
@@ -410,6 +479,30 @@ public class SocketUDT {
 			final int bufferLimit //
 	) throws ExceptionUDT;
 
+	/**
+	 * send from a sequence of {@link java.nio.DirectByteBuffer}, as one block
+	 * or, in message mode, as one message;
+	 * 
+	 * wrapper for <em>UDT::sendv()</em>, <em>UDT::sendmsgv()</em>
+	 * 
+	 * @param bounds
+	 *            position and limit of each buffer in the sequence, in pairs
+	 * @see <a
+	 *      href="http://udt.sourceforge.net/udt4/doc/send.htm">UDT::send()</a>
+	 * @see <a
+	 *      href="http://udt.sourceforge.net/udt4/doc/sendmsg.htm">UDT::sendmsg()</a>
+	 */
+	protected static native int send3( //
+			final int socketID, //
+			final int socketType, //
+			final int timeToLive, //
+			final boolean isOrdered, //
+			final ByteBuffer[] buffers, //
+			final int offset, //
+			final int length, //
+			final int[] bounds //
+	) throws ExceptionUDT;
+
 	/**
 	 * Send file.
 	 * 
@@ -424,6 +517,19 @@ public class SocketUDT {
 			int block //
 	) throws ExceptionUDT;
 
+	/**
+	 * send stream data from {@link java.nio.channels.DirectByteBuffer}
+	 * 
+	 * @see #sendStream(int, ByteBuffer)
+	 */
+	protected static native int sendStream0( //
+			final int socketID, //
+			final int streamID, //
+			final ByteBuffer buffer, //
+			final int position, //
+			final int limit //
+	) throws ExceptionUDT;
+
 	/**
 	 * Call this before unloading native library.
 	 * 
@@ -570,6 +676,42 @@ public class SocketUDT {
 	 */
 	protected native SocketUDT accept0() throws ExceptionUDT;
 
+	/**
+	 * Accept queued connections in bulk, oldest first; blocking mode waits for
+	 * the first connection only, and takes the others already queued.
+	 * 
+	 * @param array
+	 *            receives the newly accepted sockets, at most array.length
+	 * @return 0 : no incoming connections (non-blocking mode only)<br>
+	 *         >0 : number of SocketUDT stored from the start of the array<br>
+	 */
+	public int acceptMany(final SocketUDT[] array) throws ExceptionUDT {
+		if (array == null || array.length == 0) {
+			throw new IllegalArgumentException("array is empty");
+		}
+		return acceptMany0(array);
+	}
+
+	/**
+	 * @see #acceptMany(SocketUDT[])
+	 */
+	protected native int acceptMany0(SocketUDT[] array) throws ExceptionUDT;
+
+	/**
+	 * Accept a stream opened by the peer on this connected
+	 * {@link TypeUDT#DATAGRAM} socket; see {@link #openStream()}.
+	 * 
+	 * @return stream id
+	 */
+	public int acceptStream() throws ExceptionUDT {
+		return acceptStream0();
+	}
+
+	/**
+	 * @see #acceptStream()
+	 */
+	protected native int acceptStream0() throws ExceptionUDT;
+
 	public void bind(final InetSocketAddress localSocketAddress) //
 			throws ExceptionUDT, IllegalArgumentException {
 		HelpUDT.checkSocketAddress(localSocketAddress);
@@ -635,6 +777,19 @@ public class SocketUDT {
 	 */
 	protected native void close0() throws ExceptionUDT;
 
+	/**
+	 * Close a stream: the data already sent still goes out, followed by the
+	 * end of the stream; data still coming in is discarded.
+	 */
+	public void closeStream(final int streamID) throws ExceptionUDT {
+		closeStream0(streamID);
+	}
+
+	/**
+	 * @see #closeStream(int)
+	 */
+	protected native void closeStream0(int streamID) throws ExceptionUDT;
+
 	/**
 	 * Connect to remote UDT socket.
 	 * <p>
@@ -663,6 +818,40 @@ public class SocketUDT {
 	protected native void connect0(final InetSocketAddress remoteSocketAddress)
 			throws ExceptionUDT;
 
+	/**
+	 * Start connecting many non-blocking sockets at once, over one shared UDP
+	 * port: sockets not yet bound take the port of the first unbound one.
+	 * Each socket reports its completion through epoll, as write ready when
+	 * connected or as error when the request failed or timed out.
+	 * 
+	 * @param sockets
+	 *            non-blocking sockets, see
+	 *            {@link OptionUDT#Is_Receive_Synchronous}
+	 * @param addresses
+	 *            remote address for the socket at the same index
+	 * @return number of sockets from the start of the array with a connection
+	 *         request under way
+	 */
+	public static int connectMany(final SocketUDT[] sockets,
+			final InetSocketAddress[] addresses) throws ExceptionUDT {
+		if (sockets == null || sockets.length == 0) {
+			throw new IllegalArgumentException("sockets is empty");
+		}
+		if (addresses == null || addresses.length != sockets.length) {
+			throw new IllegalArgumentException("addresses do not match sockets");
+		}
+		for (final InetSocketAddress address : addresses) {
+			HelpUDT.checkSocketAddress(address);
+		}
+		return connectMany0(sockets, addresses);
+	}
+
+	/**
+	 * @see #connectMany(SocketUDT[], InetSocketAddress[])
+	 */
+	protected static native int connectMany0(SocketUDT[] sockets,
+			InetSocketAddress[] addresses) throws ExceptionUDT;
+
 	/**
 	 * Note: equality is based on {@link #socketID}.
 	 */
@@ -1151,6 +1340,31 @@ public class SocketUDT {
 		return monitor;
 	}
 
+	/**
+	 * Open a new stream to the peer of this connected
+	 * {@link TypeUDT#DATAGRAM} socket.
+	 * <p>
+	 * Streams share the congestion control of the connection, while each one
+	 * is delivered in order and flow controlled by itself; a lost packet only
+	 * delays its own stream. Once streams are used, the socket carries nothing
+	 * else: message send / receive fail with {@link ErrorUDT#EMUXSOCK}.
+	 * <p>
+	 * The stream calls block, so the socket must be in blocking mode; selectors
+	 * do not report stream readiness. Sending on a stream the peer has closed
+	 * fails with {@link ErrorUDT#ESTREAMRESET}.
+	 * 
+	 * @return stream id
+	 * @see OptionUDT#Stream_Window_Size
+	 */
+	public int openStream() throws ExceptionUDT {
+		return openStream0();
+	}
+
+	/**
+	 * @see #openStream()
+	 */
+	protected native int openStream0() throws ExceptionUDT;
+
 	/**
 	 * receive into byte[] array upto <code>array.length</code> bytes
 	 * 
@@ -1218,10 +1432,65 @@ public class SocketUDT {
 
 	}
 
+	/**
+	 * receive into a sequence of {@link java.nio.channels.DirectByteBuffer},
+	 * filling each before the next, without an intermediate copy; upto the
+	 * sum of their {@link java.nio.ByteBuffer#remaining()} bytes
+	 * 
+	 * @return <code>-1</code> : nothing received (non-blocking only)<br>
+	 *         <code>=0</code> : timeout expired (blocking only)<br>
+	 *         <code>>0</code> : normal receive, byte count<br>
+	 * @see #receive3(int, int, ByteBuffer[], int, int, int[])
+	 */
+	public int receive(final ByteBuffer[] buffers, final int offset,
+			final int length) throws ExceptionUDT {
+
+		final int[] bounds = bounds(buffers, offset, length);
+
+		final int sizeReceived = //
+		receive3(socketID, type.code, buffers, offset, length, bounds);
+
+		if (sizeReceived > 0) {
+			advance(buffers, offset, length, sizeReceived);
+		}
+
+		return sizeReceived;
+
+	}
+
 	//
 
+	/**
+	 * receive stream data into {@link java.nio.channels.DirectByteBuffer},
+	 * upto <code>buffer.remaining()</code> bytes, in stream order
+	 * 
+	 * @return <code>=0</code> : end of stream<br>
+	 *         <code>>0</code> : normal receive, byte count<br>
+	 * @see #receiveStream0(int, int, ByteBuffer, int, int)
+	 */
+	public int receiveStream(final int streamID, final ByteBuffer buffer)
+			throws ExceptionUDT {
+
+		HelpUDT.checkBuffer(buffer);
+
+		final int position = buffer.position();
+
+		final int sizeReceived = receiveStream0( //
+				socketID, streamID, buffer, position, buffer.limit());
+
+		if (sizeReceived > 0) {
+			buffer.position(position + sizeReceived);
+		}
+
+		return sizeReceived;
+
+	}
+
 	/**
 	 * Receive file from remote peer.
+	 * <p>
+	 * The data is written at the given offset; an offset of 0 replaces the
+	 * file, any other offset keeps the rest of an existing file.
 	 * 
 	 * @see #receiveFile0(int, String, long, long, int)
 	 */
@@ -1361,6 +1630,102 @@ public class SocketUDT {
 
 	}
 
+	/**
+	 * send from a sequence of {@link java.nio.DirectByteBuffer}, such as the
+	 * components of a composite buffer, without concatenating them first; in
+	 * message mode all of them make one message
+	 * 
+	 * @return <code>-1</code> : no buffer space (non-blocking only)<br>
+	 *         <code>=0</code> : timeout expired (blocking only)<br>
+	 *         <code>>0</code> : normal send, actual sent byte count<br>
+	 * @see #send3(int, int, int, boolean, ByteBuffer[], int, int, int[])
+	 */
+	public int send(final ByteBuffer[] buffers, final int offset,
+			final int length) throws ExceptionUDT {
+
+		final int[] bounds = bounds(buffers, offset, length);
+
+		final int sizeSent = send3( //
+				socketID, //
+				type.code, //
+				messageTimeTolive, //
+				messageIsOrdered, //
+				buffers, //
+				offset, //
+				length, //
+				bounds //
+		);
+
+		if (sizeSent > 0) {
+			advance(buffers, offset, length, sizeSent);
+		}
+
+		return sizeSent;
+
+	}
+
+	/** position and limit of each buffer, in pairs, for send3 / receive3 */
+	protected static int[] bounds(final ByteBuffer[] buffers,
+			final int offset, final int length) {
+
+		if (buffers == null) {
+			throw new IllegalArgumentException("buffers == null");
+		}
+		if (offset < 0 || length < 0 || offset + length > buffers.length) {
+			throw new IndexOutOfBoundsException("offset / length");
+		}
+
+		final int[] bounds = new int[2 * length];
+
+		for (int index = 0; index < length; index++) {
+			final ByteBuffer buffer = buffers[offset + index];
+			HelpUDT.checkBuffer(buffer);
+			bounds[2 * index] = buffer.position();
+			bounds[2 * index + 1] = buffer.limit();
+		}
+
+		return bounds;
+
+	}
+
+	/** move buffer positions past the bytes transferred, in sequence order */
+	protected static void advance(final ByteBuffer[] buffers,
+			final int offset, final int length, int size) {
+
+		for (int index = offset; index < offset + length && size > 0; index++) {
+			final ByteBuffer buffer = buffers[index];
+			final int step = Math.min(size, buffer.remaining());
+			buffer.position(buffer.position() + step);
+			size -= step;
+		}
+
+	}
+
+	/**
+	 * send stream data from {@link java.nio.channels.DirectByteBuffer}; the
+	 * stream takes as much as its sending queue has room for
+	 * 
+	 * @return <code>>0</code> : normal send, actual sent byte count<br>
+	 * @see #sendStream0(int, int, ByteBuffer, int, int)
+	 */
+	public int sendStream(final int streamID, final ByteBuffer buffer)
+			throws ExceptionUDT {
+
+		HelpUDT.checkBuffer(buffer);
+
+		final int position = buffer.position();
+
+		final int sizeSent = sendStream0( //
+				socketID, streamID, buffer, position, buffer.limit());
+
+		if (sizeSent > 0) {
+			buffer.position(position + sizeSent);
+		}
+
+		return sizeSent;
+
+	}
+
 	/**
 	 * Send file to remote peer.
 	 * 
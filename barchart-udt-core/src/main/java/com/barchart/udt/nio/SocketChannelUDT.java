@@ -357,10 +357,70 @@ public class SocketChannelUDT extends SocketChannel implements ChannelUDT {
 
 	}
 
+	/**
+	 * See {@link java.nio.channels.ScatteringByteChannel#read(ByteBuffer[])}
+	 * contract; direct buffers are filled in one native call, otherwise only
+	 * the first buffer with space is read into
+	 * 
+	 * @see com.barchart.udt.SocketUDT#receive(ByteBuffer[], int, int)
+	 */
 	@Override
 	public long read(final ByteBuffer[] dsts, final int offset,
 			final int length) throws IOException {
-		throw new RuntimeException("feature not available");
+
+		if (!isDirect(dsts, offset, length)) {
+			for (int index = offset; index < offset + length; index++) {
+				if (dsts[index].hasRemaining()) {
+					return read(dsts[index]);
+				}
+			}
+			return 0;
+		}
+
+		final boolean isBlocking = isBlockingMode;
+
+		final int sizeReceived;
+
+		try {
+
+			if (isBlocking) {
+				begin(); // JDK contract for NIO blocking calls
+			}
+
+			sizeReceived = socketUDT.receive(dsts, offset, length);
+
+		} finally {
+			if (isBlocking) {
+				end(true); // JDK contract for NIO blocking calls
+			}
+		}
+
+		// see contract for receive()
+
+		return sizeReceived > 0 ? sizeReceived : 0;
+
+	}
+
+	/** any buffer in the range still has bytes to transfer */
+	private static boolean hasRemaining(final ByteBuffer[] buffers,
+			final int offset, final int length) {
+		for (int index = offset; index < offset + length; index++) {
+			if (buffers[index].hasRemaining()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** all buffers in the range are direct and can be passed to native code */
+	private static boolean isDirect(final ByteBuffer[] buffers,
+			final int offset, final int length) {
+		for (int index = offset; index < offset + length; index++) {
+			if (!buffers[index].isDirect()) {
+				return false;
+			}
+		}
+		return true;
 	}
 
 	@Override
@@ -477,10 +537,56 @@ public class SocketChannelUDT extends SocketChannel implements ChannelUDT {
 
 	}
 
+	/**
+	 * See {@link java.nio.channels.GatheringByteChannel#write(ByteBuffer[])}
+	 * contract; direct buffers go out in one native call, without being
+	 * concatenated first; otherwise a {@link TypeUDT#DATAGRAM} channel copies
+	 * the range into one heap buffer, so it still goes out as one message
+	 * 
+	 * @see com.barchart.udt.SocketUDT#send(ByteBuffer[], int, int)
+	 */
 	@Override
 	public long write(final ByteBuffer[] bufferArray, final int offset,
 			final int length) throws IOException {
 
+		if (isDirect(bufferArray, offset, length)) {
+
+			final boolean isBlocking = isBlockingMode;
+
+			long total = 0;
+
+			try {
+
+				if (isBlocking) {
+					begin(); // JDK contract for NIO blocking calls
+				}
+
+				int ret;
+
+				do {
+					ret = socketUDT.send(bufferArray, offset, length);
+
+					if (ret > 0) {
+						total += ret;
+					}
+
+				} while (ret > 0 && isBlocking
+						&& hasRemaining(bufferArray, offset, length));
+
+			} finally {
+				if (isBlocking) {
+					end(true); // JDK contract for NIO blocking calls
+				}
+			}
+
+			return total;
+
+		}
+
+		if (typeUDT() == TypeUDT.DATAGRAM) {
+			return writeMessage(bufferArray, offset, length);
+		}
+
 		try {
 
 			long total = 0;
@@ -509,6 +615,34 @@ public class SocketChannelUDT extends SocketChannel implements ChannelUDT {
 
 	}
 
+	/** send the remaining bytes of the range as one message; all or nothing */
+	private int writeMessage(final ByteBuffer[] bufferArray,
+			final int offset, final int length) throws IOException {
+
+		int size = 0;
+		for (int index = offset; index < offset + length; index++) {
+			size += bufferArray[index].remaining();
+		}
+
+		final ByteBuffer message = ByteBuffer.allocate(size);
+		for (int index = offset; index < offset + length; index++) {
+			message.put(bufferArray[index].duplicate());
+		}
+		message.flip();
+
+		final int sizeSent = write(message);
+
+		if (sizeSent == size) {
+			for (int index = offset; index < offset + length; index++) {
+				final ByteBuffer buffer = bufferArray[index];
+				buffer.position(buffer.limit());
+			}
+		}
+
+		return sizeSent;
+
+	}
+
 	@Override
 	public TypeUDT typeUDT() {
 		return providerUDT().type();
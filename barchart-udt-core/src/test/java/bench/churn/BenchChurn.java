@@ -0,0 +1,173 @@
+/**
+ * Copyright (C) 2009-2013 Barchart, Inc. <http://www.barchart.com/>
+ *
+ * All rights reserved. Licensed under the OSI BSD License.
+ *
+ * http://www.opensource.org/licenses/bsd-license.php
+ */
+package bench.churn;
+
+import static util.UnitHelp.*;
+
+import java.net.InetSocketAddress;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import util.ConsoleReporterUDT;
+
+import com.barchart.udt.SocketUDT;
+import com.barchart.udt.StatusUDT;
+import com.barchart.udt.TypeUDT;
+import com.yammer.metrics.Metrics;
+import com.yammer.metrics.core.Meter;
+import com.yammer.metrics.core.Timer;
+import com.yammer.metrics.core.TimerContext;
+
+/**
+ * short lived connections: open, transfer 1 KB, close; reports connections
+ * per second
+ */
+public class BenchChurn {
+
+	static final Logger log = LoggerFactory.getLogger(BenchChurn.class);
+
+	/** benchmark duration */
+	static final int time = 60 * 1000;
+
+	/** payload per connection */
+	static final int size = 1024;
+
+	static final Meter connRate = Metrics.newMeter( //
+			BenchChurn.class, "connection rate", "connections",
+			TimeUnit.SECONDS);
+
+	static final Timer connectTime = Metrics.newTimer(BenchChurn.class,
+			"connect time", TimeUnit.MICROSECONDS, TimeUnit.SECONDS);
+
+	static final Timer closeTime = Metrics.newTimer(BenchChurn.class,
+			"close time", TimeUnit.MICROSECONDS, TimeUnit.SECONDS);
+
+	public static void main(final String[] args) throws Exception {
+
+		log.info("init");
+
+		final SocketUDT accept = new SocketUDT(TypeUDT.STREAM);
+		accept.setBlocking(true);
+		accept.bind(localSocketAddress());
+		accept.listen(1024);
+		socketAwait(accept, StatusUDT.LISTENING);
+		log.info("accept : {}", accept);
+
+		final InetSocketAddress clientAddress = localSocketAddress();
+
+		final AtomicBoolean isOn = new AtomicBoolean(true);
+
+		final Runnable serverTask = new Runnable() {
+
+			@Override
+			public void run() {
+				try {
+					while (isOn.get()) {
+						runCore();
+					}
+				} catch (final Exception e) {
+					log.error("", e);
+				}
+			}
+
+			final byte[] array = new byte[size];
+
+			void runCore() throws Exception {
+
+				final SocketUDT server = accept.accept();
+				server.setBlocking(true);
+
+				int count = 0;
+				while (count < size) {
+					final int done = server.receive(array, count, size);
+					if (done <= 0) {
+						break;
+					}
+					count += done;
+				}
+
+				server.close();
+
+				if (count != size) {
+					throw new Exception("count");
+				}
+
+			}
+
+		};
+
+		final Runnable clientTask = new Runnable() {
+
+			@Override
+			public void run() {
+				try {
+					while (isOn.get()) {
+						runCore();
+					}
+				} catch (final Exception e) {
+					log.error("", e);
+				}
+			}
+
+			final byte[] array = new byte[size];
+
+			void runCore() throws Exception {
+
+				final SocketUDT client = new SocketUDT(TypeUDT.STREAM);
+				client.setBlocking(true);
+				client.setReuseAddress(true);
+				client.bind(clientAddress);
+
+				final TimerContext connectTimer = connectTime.time();
+				client.connect(accept.getLocalSocketAddress());
+				connectTimer.stop();
+
+				if (client.send(array) != size) {
+					throw new Exception("send");
+				}
+
+				final TimerContext closeTimer = closeTime.time();
+				client.close();
+				closeTimer.stop();
+
+				connRate.mark();
+
+			}
+
+		};
+
+		final ExecutorService executor = Executors.newFixedThreadPool(2);
+
+		executor.submit(serverTask);
+
+		executor.submit(clientTask);
+
+		ConsoleReporterUDT.enable(3, TimeUnit.SECONDS);
+
+		Thread.sleep(time);
+
+		isOn.set(false);
+
+		Thread.sleep(1 * 1000);
+
+		executor.shutdownNow();
+
+		Metrics.defaultRegistry().shutdown();
+
+		accept.close();
+
+		log.info("done");
+
+	}
+
+}
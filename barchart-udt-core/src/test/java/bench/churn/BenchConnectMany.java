@@ -0,0 +1,165 @@
+/**
+ * Copyright (C) 2009-2013 Barchart, Inc. <http://www.barchart.com/>
+ *
+ * All rights reserved. Licensed under the OSI BSD License.
+ *
+ * http://www.opensource.org/licenses/bsd-license.php
+ */
+package bench.churn;
+
+import static util.UnitHelp.*;
+
+import java.net.InetSocketAddress;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import util.ConsoleReporterUDT;
+
+import com.barchart.udt.SocketUDT;
+import com.barchart.udt.StatusUDT;
+import com.barchart.udt.TypeUDT;
+import com.yammer.metrics.Metrics;
+import com.yammer.metrics.core.Meter;
+import com.yammer.metrics.core.Timer;
+import com.yammer.metrics.core.TimerContext;
+
+/**
+ * connection setup in batches: connect many sockets over one shared port,
+ * wait for all of them, close; reports connections per second
+ */
+public class BenchConnectMany {
+
+	static final Logger log = LoggerFactory.getLogger(BenchConnectMany.class);
+
+	/** benchmark duration */
+	static final int time = 60 * 1000;
+
+	/** sockets per batch */
+	static final int batch = 1000;
+
+	static final Meter connRate = Metrics.newMeter( //
+			BenchConnectMany.class, "connection rate", "connections",
+			TimeUnit.SECONDS);
+
+	static final Timer batchTime = Metrics.newTimer(BenchConnectMany.class,
+			"batch time", TimeUnit.MILLISECONDS, TimeUnit.SECONDS);
+
+	public static void main(final String[] args) throws Exception {
+
+		log.info("init");
+
+		final SocketUDT accept = new SocketUDT(TypeUDT.STREAM);
+		accept.setBlocking(true);
+		accept.bind(localSocketAddress());
+		accept.listen(batch);
+		socketAwait(accept, StatusUDT.LISTENING);
+		log.info("accept : {}", accept);
+
+		final AtomicBoolean isOn = new AtomicBoolean(true);
+
+		final Runnable serverTask = new Runnable() {
+
+			@Override
+			public void run() {
+				try {
+					while (isOn.get()) {
+						runCore();
+					}
+				} catch (final Exception e) {
+					log.error("", e);
+				}
+			}
+
+			final SocketUDT[] array = new SocketUDT[batch];
+
+			void runCore() throws Exception {
+
+				final int count = accept.acceptMany(array);
+
+				for (int k = 0; k < count; k++) {
+					array[k].close();
+					array[k] = null;
+				}
+
+			}
+
+		};
+
+		final Runnable clientTask = new Runnable() {
+
+			@Override
+			public void run() {
+				try {
+					while (isOn.get()) {
+						runCore();
+					}
+				} catch (final Exception e) {
+					log.error("", e);
+				}
+			}
+
+			final SocketUDT[] clients = new SocketUDT[batch];
+
+			final InetSocketAddress[] addresses = new InetSocketAddress[batch];
+
+			void runCore() throws Exception {
+
+				for (int k = 0; k < batch; k++) {
+					clients[k] = new SocketUDT(TypeUDT.STREAM);
+					clients[k].setBlocking(false);
+					addresses[k] = accept.getLocalSocketAddress();
+				}
+
+				final TimerContext batchTimer = batchTime.time();
+
+				final int count = SocketUDT.connectMany(clients, addresses);
+
+				for (int k = 0; k < count; k++) {
+					while (clients[k].status() == StatusUDT.CONNECTING) {
+						Thread.sleep(1);
+					}
+					if (clients[k].status() == StatusUDT.CONNECTED) {
+						connRate.mark();
+					}
+				}
+
+				batchTimer.stop();
+
+				for (final SocketUDT client : clients) {
+					client.close();
+				}
+
+			}
+
+		};
+
+		final ExecutorService executor = Executors.newFixedThreadPool(2);
+
+		executor.submit(serverTask);
+
+		executor.submit(clientTask);
+
+		ConsoleReporterUDT.enable(3, TimeUnit.SECONDS);
+
+		Thread.sleep(time);
+
+		isOn.set(false);
+
+		Thread.sleep(1 * 1000);
+
+		executor.shutdownNow();
+
+		Metrics.defaultRegistry().shutdown();
+
+		accept.close();
+
+		log.info("done");
+
+	}
+
+}
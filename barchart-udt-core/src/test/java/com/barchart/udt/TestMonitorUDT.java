@@ -7,6 +7,7 @@
  */
 package com.barchart.udt;
 
+import static org.junit.Assert.*;
 import static util.UnitHelp.*;
 
 import java.net.InetSocketAddress;
@@ -48,4 +49,33 @@ public class TestMonitorUDT extends TestAny {
 
 	}
 
+	@Test
+	public void testMonitorMemory() throws Exception {
+
+		final SocketUDT serverSocket = new SocketUDT(TypeUDT.DATAGRAM);
+		final InetSocketAddress serverAddress = localSocketAddress();
+		serverSocket.bind(serverAddress);
+		serverSocket.listen(1);
+
+		final SocketUDT clientSocket = new SocketUDT(TypeUDT.DATAGRAM);
+		clientSocket.bind(localSocketAddress());
+		clientSocket.connect(serverAddress);
+
+		final SocketUDT acceptSocket = serverSocket.accept();
+
+		clientSocket.updateMonitor(false);
+		final long idle = clientSocket.monitor().currentBytesMemoryUsed();
+		assertTrue(idle > 0);
+
+		// the send buffer is allocated by the first write
+		clientSocket.send(new byte[1000]);
+		clientSocket.updateMonitor(false);
+		assertTrue(clientSocket.monitor().currentBytesMemoryUsed() > idle);
+
+		acceptSocket.close();
+		clientSocket.close();
+		serverSocket.close();
+
+	}
+
 }
@@ -91,6 +91,166 @@ public class TestOptionUDT extends TestAny {
 
 	}
 
+	@Test
+	public void testOptionSelectiveAck() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Boolean> option = OptionUDT.UDT_SACK;
+
+		assertEquals(false, socket.getOption(option));
+		socket.setOption(option, true);
+		assertEquals(true, socket.getOption(option));
+		socket.setOption(option, false);
+		assertEquals(false, socket.getOption(option));
+
+	}
+
+	@Test
+	public void testOptionReorderWindow() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Integer> option = OptionUDT.UDT_REORDER;
+
+		assertEquals(0, socket.getOption(option).intValue());
+		socket.setOption(option, 64);
+		assertEquals(64, socket.getOption(option).intValue());
+
+	}
+
+	@Test
+	public void testOptionForwardErrorCorrection() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.DATAGRAM);
+
+		final OptionUDT<Integer> option = OptionUDT.UDT_FEC;
+
+		assertEquals(0, socket.getOption(option).intValue());
+		socket.setOption(option, 8);
+		assertEquals(8, socket.getOption(option).intValue());
+
+	}
+
+	@Test
+	public void testOptionPathMTUDiscovery() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Boolean> option = OptionUDT.UDT_PMTUD;
+
+		assertEquals(false, socket.getOption(option));
+		socket.setOption(option, true);
+		assertEquals(true, socket.getOption(option));
+
+	}
+
+	@Test
+	public void testOptionCongestionControlAlgorithm() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Integer> option = OptionUDT.UDT_CCALGO;
+
+		assertEquals(0, socket.getOption(option).intValue());
+		socket.setOption(option, 1);
+		assertEquals(1, socket.getOption(option).intValue());
+		socket.setOption(option, 3);
+		assertEquals(3, socket.getOption(option).intValue());
+
+	}
+
+	@Test
+	public void testOptionMessageCoalescing() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.DATAGRAM);
+
+		final OptionUDT<Integer> option = OptionUDT.UDT_COALESCE;
+
+		assertEquals(-1, socket.getOption(option).intValue());
+		socket.setOption(option, 500);
+		assertEquals(500, socket.getOption(option).intValue());
+
+	}
+
+	@Test
+	public void testOptionLowLatencySend() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Boolean> option = OptionUDT.UDT_LOWLATENCY;
+
+		assertEquals(false, socket.getOption(option));
+		socket.setOption(option, true);
+		assertEquals(true, socket.getOption(option));
+
+	}
+
+	@Test
+	public void testOptionBusyPoll() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.DATAGRAM);
+
+		final OptionUDT<Integer> option = OptionUDT.UDT_BUSYPOLL;
+
+		assertEquals(0, socket.getOption(option).intValue());
+		socket.setOption(option, 50);
+		assertEquals(50, socket.getOption(option).intValue());
+
+	}
+
+	@Test
+	public void testOptionCPUMask() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Long> option = OptionUDT.UDT_CPUMASK;
+
+		assertEquals(0, socket.getOption(option).longValue());
+		socket.setOption(option, 0x3L);
+		assertEquals(0x3L, socket.getOption(option).longValue());
+
+	}
+
+	@Test
+	public void testOptionWorkerPool() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Integer> option = OptionUDT.UDT_WORKERPOOL;
+
+		assertEquals(0, socket.getOption(option).intValue());
+		socket.setOption(option, 2);
+		assertEquals(2, socket.getOption(option).intValue());
+
+	}
+
+	@Test
+	public void testOptionResume() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Boolean> option = OptionUDT.Is_Resumption_Enabled;
+
+		assertEquals(false, socket.getOption(option));
+		socket.setOption(option, true);
+		assertEquals(true, socket.getOption(option));
+
+	}
+
+	@Test
+	public void testOptionDirectIO() throws Exception {
+
+		final SocketUDT socket = new SocketUDT(TypeUDT.STREAM);
+
+		final OptionUDT<Boolean> option = OptionUDT.Is_Direct_File_IO_Enabled;
+
+		assertEquals(false, socket.getOption(option));
+		socket.setOption(option, true);
+		assertEquals(true, socket.getOption(option));
+
+	}
+
 	@Test
 	public void testOptionsPrint() throws Exception {
 
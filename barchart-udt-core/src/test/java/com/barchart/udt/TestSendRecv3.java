@@ -0,0 +1,115 @@
+/**
+ * Copyright (C) 2009-2013 Barchart, Inc. <http://www.barchart.com/>
+ *
+ * All rights reserved. Licensed under the OSI BSD License.
+ *
+ * http://www.opensource.org/licenses/bsd-license.php
+ */
+package com.barchart.udt;
+
+import static org.junit.Assert.*;
+
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+
+/**
+ * messages sent as header + body segments, received split at another point
+ */
+public class TestSendRecv3 extends TestSendRecvAbstract<byte[]> {
+
+	final static int HEADER = 16;
+	final static int SPLIT = 100;
+
+	static ByteBuffer[] segments(final int first) {
+		return new ByteBuffer[] { //
+		ByteBuffer.allocateDirect(first), //
+				ByteBuffer.allocateDirect(SIZE - first) //
+		};
+	}
+
+	static byte[] join(final ByteBuffer[] buffers) {
+		final byte[] data = new byte[SIZE];
+		int offset = 0;
+		for (final ByteBuffer buffer : buffers) {
+			buffer.flip();
+			final int size = buffer.remaining();
+			buffer.get(data, offset, size);
+			offset += size;
+		}
+		return data;
+	}
+
+	static void sendSegments(final SocketUDT socket, final byte[] data,
+			final int first) throws Exception {
+
+		final ByteBuffer[] buffers = segments(first);
+		buffers[0].put(data, 0, first).flip();
+		buffers[1].put(data, first, SIZE - first).flip();
+
+		// blocks here
+		final int size = socket.send(buffers, 0, buffers.length);
+		assertEquals(SIZE, size);
+
+		assertFalse(buffers[0].hasRemaining());
+		assertFalse(buffers[1].hasRemaining());
+
+	}
+
+	static byte[] receiveSegments(final SocketUDT socket, final int first)
+			throws Exception {
+
+		final ByteBuffer[] buffers = segments(first);
+
+		// blocks here
+		final int size = socket.receive(buffers, 0, buffers.length);
+		assertEquals(SIZE, size);
+
+		return join(buffers);
+
+	}
+
+	@Override
+	protected void doClientReader() throws Exception {
+
+		// blocks here
+		final byte[] dataSent = clientQueue.take();
+
+		final byte[] dataReceived = receiveSegments(client, SPLIT);
+
+		assertTrue(Arrays.equals(dataSent, dataReceived));
+
+	}
+
+	@Override
+	protected void doClientWriter() throws Exception {
+
+		final byte[] array = new byte[SIZE];
+
+		generator.nextBytes(array);
+
+		sendSegments(client, array, HEADER);
+
+		clientQueue.put(array);
+
+	}
+
+	@Override
+	protected void doServerReader() throws Exception {
+
+		final byte[] array = receiveSegments(connector, HEADER);
+
+		serverQueue.put(array);
+
+	}
+
+	@Override
+	protected void doServerWriter() throws Exception {
+
+		// blocks here
+		final byte[] array = serverQueue.take();
+
+		sendSegments(connector, array, SPLIT);
+
+	}
+
+}
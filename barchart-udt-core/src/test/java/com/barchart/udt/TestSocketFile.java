@@ -12,6 +12,7 @@ import static util.UnitHelp.*;
 
 import java.io.File;
 import java.net.InetSocketAddress;
+import java.util.Arrays;
 import java.util.Random;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
@@ -129,4 +130,105 @@ public class TestSocketFile extends TestAny {
 		peer2.close();
 
 	}
+
+	/**
+	 * verify file receive with {@link OptionUDT#UDT_DIRECTIO} into the middle
+	 * of a file, at an offset and with a length that are not page aligned
+	 */
+	@Test(timeout = 10 * 1000)
+	public void fileTransferDirectUnaligned() throws Exception {
+
+		final InetSocketAddress addr1 = localSocketAddress();
+		final InetSocketAddress addr2 = localSocketAddress();
+
+		final SocketUDT peer1 = new SocketUDT(TypeUDT.STREAM);
+		final SocketUDT peer2 = new SocketUDT(TypeUDT.STREAM);
+
+		peer2.setOption(OptionUDT.UDT_DIRECTIO, true);
+		assertTrue(peer2.getOption(OptionUDT.UDT_DIRECTIO));
+
+		peer1.setBlocking(false);
+		peer2.setBlocking(false);
+
+		peer1.setRendezvous(true);
+		peer2.setRendezvous(true);
+
+		peer1.bind(addr1);
+		peer2.bind(addr2);
+
+		socketAwait(peer1, StatusUDT.OPENED);
+		socketAwait(peer2, StatusUDT.OPENED);
+
+		peer1.connect(addr2);
+		peer2.connect(addr1);
+
+		socketAwait(peer1, StatusUDT.CONNECTED);
+		socketAwait(peer2, StatusUDT.CONNECTED);
+
+		final int size = 256 * 1024;
+		final int offset = 1000;
+		final int length = 100 * 1000 + 1;
+
+		final Random random = new Random(0);
+		final byte[] array1 = new byte[size];
+		final byte[] array2 = new byte[size];
+		random.nextBytes(array1);
+		random.nextBytes(array2);
+
+		final File folder = new File("./target/file");
+		folder.mkdirs();
+
+		final File source = File.createTempFile("source", "data", folder);
+		final File target = File.createTempFile("target", "data", folder);
+
+		FileUtils.writeByteArrayToFile(source, array1);
+		FileUtils.writeByteArrayToFile(target, array2);
+
+		// sender
+		final Runnable task1 = new Runnable() {
+			@Override
+			public void run() {
+				try {
+					final long sent = peer1.sendFile(source, offset, length);
+					assertEquals(length, sent);
+				} catch (final Exception e) {
+					log.error("", e);
+				}
+			}
+		};
+
+		// receiver
+		final Runnable task2 = new Runnable() {
+			@Override
+			public void run() {
+				try {
+					final long received = peer2.receiveFile(target, offset,
+							length);
+					assertEquals(length, received);
+				} catch (final Exception e) {
+					log.error("", e);
+				}
+			}
+		};
+
+		final ExecutorService executor = Executors.newFixedThreadPool(2);
+
+		executor.submit(task1);
+		executor.submit(task2);
+
+		Thread.sleep(5 * 1000);
+
+		executor.shutdownNow();
+
+		// the range is replaced, the rest of the file is kept
+		final byte[] expected = array2.clone();
+		System.arraycopy(array1, offset, expected, offset, length);
+
+		assertTrue("range is received",
+				Arrays.equals(expected, FileUtils.readFileToByteArray(target)));
+
+		peer1.close();
+		peer2.close();
+
+	}
 }
@@ -10,7 +10,14 @@ package com.barchart.udt;
 import static org.junit.Assert.*;
 import static util.UnitHelp.*;
 
+import java.io.File;
+import java.io.FileOutputStream;
 import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.charset.Charset;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.Set;
 
 import org.junit.After;
 import org.junit.Before;
@@ -37,6 +44,33 @@ public class TestSocketUDT extends TestAny {
 
 	}
 
+	@Test
+	public void cacheSaveLoad() throws Exception {
+
+		final File file = File.createTempFile("udt-cache", ".bin");
+		file.deleteOnExit();
+
+		final int count = SocketUDT.saveCache(file.getPath());
+		assertTrue(count >= 0);
+
+		assertEquals(count, SocketUDT.loadCache(file.getPath()));
+
+	}
+
+	@Test(expected = ExceptionUDT.class)
+	public void cacheLoadInvalid() throws Exception {
+
+		final File file = File.createTempFile("udt-cache", ".bin");
+		file.deleteOnExit();
+
+		final FileOutputStream output = new FileOutputStream(file);
+		output.write(new byte[64]);
+		output.close();
+
+		SocketUDT.loadCache(file.getPath());
+
+	}
+
 	@Test(timeout = 3 * 1000)
 	public void acceptListenOne() throws Exception {
 
@@ -73,6 +107,194 @@ public class TestSocketUDT extends TestAny {
 
 	}
 
+	@Test(timeout = 3 * 1000)
+	public void acceptManyInOrder() throws Exception {
+
+		final SocketUDT accept = new SocketUDT(TypeUDT.DATAGRAM);
+		accept.setBlocking(false);
+		accept.bind(localSocketAddress());
+		accept.listen(8);
+
+		socketAwait(accept, StatusUDT.LISTENING);
+
+		final SocketUDT[] array = new SocketUDT[4];
+
+		assertEquals(0, accept.acceptMany(array));
+
+		final SocketUDT[] clients = new SocketUDT[3];
+		for (int k = 0; k < clients.length; k++) {
+			clients[k] = new SocketUDT(TypeUDT.DATAGRAM);
+			clients[k].setBlocking(true);
+			clients[k].bind(localSocketAddress());
+			clients[k].connect(accept.getLocalSocketAddress());
+		}
+
+		assertEquals(clients.length, accept.acceptMany(array));
+
+		for (int k = 0; k < clients.length; k++) {
+			assertEquals(clients[k].getLocalSocketAddress(),
+					array[k].getRemoteSocketAddress());
+			array[k].close();
+			clients[k].close();
+		}
+
+		assertNull(array[3]);
+
+		assertEquals(0, accept.acceptMany(array));
+
+		accept.close();
+
+	}
+
+	@Test(timeout = 5 * 1000)
+	public void connectManyShared() throws Exception {
+
+		final SocketUDT accept = new SocketUDT(TypeUDT.DATAGRAM);
+		accept.setBlocking(false);
+		accept.bind(localSocketAddress());
+		accept.listen(8);
+
+		socketAwait(accept, StatusUDT.LISTENING);
+
+		final SocketUDT[] clients = new SocketUDT[4];
+		final InetSocketAddress[] addresses = new InetSocketAddress[clients.length];
+		for (int k = 0; k < clients.length; k++) {
+			clients[k] = new SocketUDT(TypeUDT.DATAGRAM);
+			clients[k].setBlocking(false);
+			addresses[k] = accept.getLocalSocketAddress();
+		}
+
+		assertEquals(clients.length, SocketUDT.connectMany(clients, addresses));
+
+		for (final SocketUDT client : clients) {
+			socketAwait(client, StatusUDT.CONNECTED);
+			assertEquals(clients[0].getLocalInetPort(),
+					client.getLocalInetPort());
+		}
+
+		final SocketUDT[] array = new SocketUDT[clients.length];
+		assertEquals(clients.length, accept.acceptMany(array));
+
+		for (int k = 0; k < clients.length; k++) {
+			array[k].close();
+			clients[k].close();
+		}
+
+		accept.close();
+
+	}
+
+	@Test(timeout = 5 * 1000)
+	public void streamsOverOneConnection() throws Exception {
+
+		final SocketUDT accept = new SocketUDT(TypeUDT.DATAGRAM);
+		accept.setBlocking(true);
+		accept.bind(localSocketAddress());
+		accept.listen(1);
+
+		final SocketUDT client = new SocketUDT(TypeUDT.DATAGRAM);
+		client.setBlocking(true);
+		client.bind(localSocketAddress());
+		client.connect(accept.getLocalSocketAddress());
+
+		final SocketUDT server = accept.accept();
+
+		final int first = client.openStream();
+		final int second = client.openStream();
+		assertTrue(first != second);
+
+		final Charset ascii = Charset.forName("US-ASCII");
+		final ByteBuffer data = ByteBuffer.allocateDirect(64);
+
+		data.put("second".getBytes(ascii)).flip();
+		assertEquals(6, client.sendStream(second, data));
+		data.clear();
+		data.put("first".getBytes(ascii)).flip();
+		assertEquals(5, client.sendStream(first, data));
+
+		client.closeStream(first);
+		client.closeStream(second);
+
+		final Set<String> received = new HashSet<String>();
+
+		for (int k = 0; k < 2; k++) {
+			final int stream = server.acceptStream();
+			final ByteBuffer buffer = ByteBuffer.allocateDirect(64);
+			while (server.receiveStream(stream, buffer) > 0) {
+			}
+			buffer.flip();
+			received.add(ascii.decode(buffer).toString());
+			server.closeStream(stream);
+		}
+
+		assertEquals(new HashSet<String>(Arrays.asList("first", "second")),
+				received);
+
+		/** messages of the connection are the frames of its streams */
+		try {
+			server.receive(new byte[16]);
+			fail("message receive on a socket carrying streams");
+		} catch (final ExceptionUDT e) {
+			assertEquals(ErrorUDT.EMUXSOCK, e.getError());
+		}
+
+		client.close();
+		server.close();
+		accept.close();
+
+	}
+
+	@Test(timeout = 5 * 1000)
+	public void streamClosedByReceiver() throws Exception {
+
+		final SocketUDT accept = new SocketUDT(TypeUDT.DATAGRAM);
+		accept.setBlocking(true);
+		accept.bind(localSocketAddress());
+		accept.listen(1);
+
+		final SocketUDT client = new SocketUDT(TypeUDT.DATAGRAM);
+		client.setBlocking(true);
+		client.bind(localSocketAddress());
+		client.connect(accept.getLocalSocketAddress());
+
+		final SocketUDT server = accept.accept();
+
+		final int stream = client.openStream();
+		final ByteBuffer data = ByteBuffer.allocateDirect(64 * 1024);
+
+		assertEquals(data.remaining(), client.sendStream(stream, data));
+
+		// the receiver stops reading
+		server.closeStream(server.acceptStream());
+
+		// the sender fails, instead of filling a window nobody reads
+		ErrorUDT error = null;
+		try {
+			while (true) {
+				data.clear();
+				client.sendStream(stream, data);
+			}
+		} catch (final ExceptionUDT e) {
+			error = e.getError();
+		}
+		assertEquals(ErrorUDT.ESTREAMRESET, error);
+
+		// streams only work with blocking calls
+		try {
+			client.setBlocking(false);
+			fail("non-blocking mode is refused on a socket carrying streams");
+		} catch (final ExceptionUDT e) {
+			assertEquals(ErrorUDT.EMUXSOCK, e.getError());
+		}
+
+		client.closeStream(stream);
+
+		client.close();
+		server.close();
+		accept.close();
+
+	}
+
 	@Test(expected = ExceptionUDT.class)
 	public void acceptNoListen() throws Exception {
 
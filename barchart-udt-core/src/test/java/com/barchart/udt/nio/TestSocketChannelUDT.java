@@ -8,10 +8,16 @@
 package com.barchart.udt.nio;
 
 import static org.junit.Assert.*;
+import static util.UnitHelp.*;
+
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.Random;
 
 import org.junit.Test;
 
 import com.barchart.udt.SocketUDT;
+import com.barchart.udt.StatusUDT;
 import com.barchart.udt.TypeUDT;
 
 public class TestSocketChannelUDT {
@@ -41,4 +47,57 @@ public class TestSocketChannelUDT {
 
 	}
 
+	/**
+	 * heap buffers written to a datagram channel arrive as one message
+	 */
+	@Test(timeout = 3 * 1000)
+	public void gatheringWriteHeapDatagram() throws Exception {
+
+		final SocketUDT accept = new SocketUDT(TypeUDT.DATAGRAM);
+		accept.setBlocking(false);
+		accept.bind(localSocketAddress());
+		socketAwait(accept, StatusUDT.OPENED);
+		accept.listen(1);
+		socketAwait(accept, StatusUDT.LISTENING);
+
+		final SocketUDT client = new SocketUDT(TypeUDT.DATAGRAM);
+		client.setBlocking(false);
+		client.bind(localSocketAddress());
+		socketAwait(client, StatusUDT.OPENED);
+		client.connect(accept.getLocalSocketAddress());
+		socketAwait(client, StatusUDT.CONNECTED);
+
+		SocketUDT server;
+		while ((server = accept.accept()) == null) {
+			Thread.sleep(10);
+		}
+		server.setBlocking(true);
+
+		final SocketChannelUDT channel = new SocketChannelUDT(
+				SelectorProviderUDT.DATAGRAM, client);
+		channel.configureBlocking(true);
+
+		final byte[] data = new byte[1016];
+		new Random(0).nextBytes(data);
+
+		final ByteBuffer[] buffers = new ByteBuffer[] { //
+		ByteBuffer.wrap(data, 0, 16).slice(), //
+				ByteBuffer.wrap(data, 16, 1000).slice() //
+		};
+
+		assertEquals(data.length, channel.write(buffers, 0, buffers.length));
+		assertFalse(buffers[0].hasRemaining());
+		assertFalse(buffers[1].hasRemaining());
+
+		final byte[] message = new byte[2 * data.length];
+		final int size = server.receive(message);
+		assertEquals(data.length, size);
+		assertTrue(Arrays.equals(data, Arrays.copyOf(message, size)));
+
+		channel.close();
+		server.close();
+		accept.close();
+
+	}
+
 }